@@ -0,0 +1,50 @@
+#ifndef EASY_PROFILER_BENCHMARK_CAPTURE_H
+#define EASY_PROFILER_BENCHMARK_CAPTURE_H
+
+#include <cstdio>
+#include <easy/profiler.h>
+
+namespace easy_benchmark {
+
+/** Temporary file used to drop captured blocks and to generate files for reader benchmarks. */
+EASY_CONSTEXPR const char* TEMP_FILENAME = "easy_profiler_benchmark.prof";
+
+/** Drops all captured blocks by dumping them into the temporary file.
+
+\note Also disables profiler.
+*/
+inline uint32_t dropCapture()
+{
+    const auto blocksNumber = profiler::dumpBlocksToFile(TEMP_FILENAME);
+    std::remove(TEMP_FILENAME);
+    return blocksNumber;
+}
+
+/** Enables profiler for the benchmark (if required) and drops captured blocks on destruction.
+
+Blocks captured by hot path benchmarks are not needed: they are dropped after each run
+to keep memory consumption constant for any number of iterations.
+*/
+class CaptureScope
+{
+    const bool m_enabled;
+
+public:
+
+    explicit CaptureScope(bool _enabled) : m_enabled(_enabled)
+    {
+        EASY_MAIN_THREAD;
+        if (m_enabled)
+            EASY_PROFILER_ENABLE;
+    }
+
+    ~CaptureScope()
+    {
+        if (m_enabled)
+            dropCapture();
+    }
+};
+
+} // END of namespace easy_benchmark.
+
+#endif // EASY_PROFILER_BENCHMARK_CAPTURE_H
@@ -0,0 +1,174 @@
+// Benchmarks of the recording hot path: cost of instrumentation macros with profiler enabled (capturing)
+// and disabled, cost of time measurement and cost of storage (chunk) expansion.
+//
+// All blocks are nested into one parent "Benchmark" block, so frame time accounting is not measured.
+// Argument "capture" is 1 when profiler is enabled and 0 when it is disabled.
+
+#include <chrono>
+#include <string>
+
+#include <benchmark/benchmark.h>
+#include <easy/profiler.h>
+#include <easy/arbitrary_value.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+# include <x86intrin.h>
+# define EASY_BENCHMARK_RDTSC
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+# include <intrin.h>
+# define EASY_BENCHMARK_RDTSC
+#endif
+
+#include "benchmark_capture.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+static void BM_Block(benchmark::State& state)
+{
+    easy_benchmark::CaptureScope capture(state.range(0) != 0);
+    EASY_BLOCK("Benchmark");
+    for (auto _ : state)
+    {
+        EASY_BLOCK("Block");
+    }
+}
+BENCHMARK(BM_Block)->ArgName("capture")->Arg(0)->Arg(1);
+
+static void BM_BlockOff(benchmark::State& state)
+{
+    easy_benchmark::CaptureScope capture(state.range(0) != 0);
+    EASY_BLOCK("Benchmark");
+    for (auto _ : state)
+    {
+        EASY_BLOCK("BlockOff", profiler::OFF);
+    }
+}
+BENCHMARK(BM_BlockOff)->ArgName("capture")->Arg(0)->Arg(1);
+
+static void BM_BlockDisabledCategory(benchmark::State& state)
+{
+    easy_benchmark::CaptureScope capture(state.range(0) != 0);
+    profiler::setCategoriesEnabled(profiler::categories::Net, false);
+    EASY_BLOCK("Benchmark");
+    for (auto _ : state)
+    {
+        EASY_BLOCK("BlockDisabledCategory", profiler::categories::Net);
+    }
+    profiler::setCategoriesEnabled(profiler::categories::Net, true);
+}
+BENCHMARK(BM_BlockDisabledCategory)->ArgName("capture")->Arg(0)->Arg(1);
+
+static void BM_BlockRuntimeName(benchmark::State& state)
+{
+    easy_benchmark::CaptureScope capture(state.range(0) != 0);
+    const std::string name = "Runtime name";
+    EASY_BLOCK("Benchmark");
+    for (auto _ : state)
+    {
+        EASY_BLOCK(name.c_str());
+    }
+}
+BENCHMARK(BM_BlockRuntimeName)->ArgName("capture")->Arg(0)->Arg(1);
+
+static void BM_Function(benchmark::State& state)
+{
+    easy_benchmark::CaptureScope capture(state.range(0) != 0);
+    EASY_BLOCK("Benchmark");
+    for (auto _ : state)
+    {
+        EASY_FUNCTION();
+    }
+}
+BENCHMARK(BM_Function)->ArgName("capture")->Arg(0)->Arg(1);
+
+static void BM_NonScopedBlock(benchmark::State& state)
+{
+    easy_benchmark::CaptureScope capture(state.range(0) != 0);
+    EASY_BLOCK("Benchmark");
+    for (auto _ : state)
+    {
+        EASY_NONSCOPED_BLOCK("NonScopedBlock");
+        EASY_END_BLOCK;
+    }
+}
+BENCHMARK(BM_NonScopedBlock)->ArgName("capture")->Arg(0)->Arg(1);
+
+static void BM_Event(benchmark::State& state)
+{
+    easy_benchmark::CaptureScope capture(state.range(0) != 0);
+    EASY_BLOCK("Benchmark");
+    for (auto _ : state)
+    {
+        EASY_EVENT("Event");
+    }
+}
+BENCHMARK(BM_Event)->ArgName("capture")->Arg(0)->Arg(1);
+
+static void BM_Value(benchmark::State& state)
+{
+    easy_benchmark::CaptureScope capture(state.range(0) != 0);
+    EASY_BLOCK("Benchmark");
+    int value = 0;
+    for (auto _ : state)
+    {
+        ++value;
+        EASY_VALUE("Value", value);
+    }
+}
+BENCHMARK(BM_Value)->ArgName("capture")->Arg(0)->Arg(1);
+
+//////////////////////////////////////////////////////////////////////////
+
+static void BM_ClockProfilerNow(benchmark::State& state)
+{
+    for (auto _ : state)
+        benchmark::DoNotOptimize(profiler::now());
+}
+BENCHMARK(BM_ClockProfilerNow);
+
+static void BM_ClockSteady(benchmark::State& state)
+{
+    for (auto _ : state)
+        benchmark::DoNotOptimize(std::chrono::steady_clock::now());
+}
+BENCHMARK(BM_ClockSteady);
+
+static void BM_ClockHighResolution(benchmark::State& state)
+{
+    for (auto _ : state)
+        benchmark::DoNotOptimize(std::chrono::high_resolution_clock::now());
+}
+BENCHMARK(BM_ClockHighResolution);
+
+static void BM_ClockSystem(benchmark::State& state)
+{
+    for (auto _ : state)
+        benchmark::DoNotOptimize(std::chrono::system_clock::now());
+}
+BENCHMARK(BM_ClockSystem);
+
+#ifdef EASY_BENCHMARK_RDTSC
+static void BM_ClockRdtsc(benchmark::State& state)
+{
+    for (auto _ : state)
+        benchmark::DoNotOptimize(__rdtsc());
+}
+BENCHMARK(BM_ClockRdtsc);
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+
+// Storage expansion: blocks with long run-time names fill chunks of thread storage faster,
+// so a new chunk is allocated every few blocks. Argument is the run-time name length.
+static void BM_ChunkExpansion(benchmark::State& state)
+{
+    easy_benchmark::CaptureScope capture(true);
+    const std::string name(static_cast<size_t>(state.range(0)), 'x');
+    EASY_BLOCK("Benchmark");
+    for (auto _ : state)
+    {
+        EASY_BLOCK(name.c_str());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * (state.range(0) + 1));
+}
+BENCHMARK(BM_ChunkExpansion)->ArgName("name_length")->Arg(16)->Arg(256)->Arg(1024)->Arg(2048);
@@ -0,0 +1,152 @@
+// Benchmarks of serialization: dumpBlocksToFile() throughput (the same as ProfileManager::dumpBlocksToStream()
+// plus writing to file) and fillTreesFromStream() parse rate for captured files of different size.
+//
+// Note: dumping includes fixed 20 ms wait for finishing of all storeBlock() operations in other threads.
+// Maximum size of parsed files is set by EASY_BENCHMARK_MAX_PARSE_BLOCKS cmake option.
+
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <benchmark/benchmark.h>
+#include <easy/profiler.h>
+#include <easy/reader.h>
+
+#include "benchmark_capture.h"
+
+#ifndef EASY_BENCHMARK_MAX_PARSE_BLOCKS
+# define EASY_BENCHMARK_MAX_PARSE_BLOCKS 10000000
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+
+// Captures approximately _blocksNumber blocks. Each frame contains 16 children with 3 nested blocks each.
+static void captureBlocks(int64_t _blocksNumber)
+{
+    EASY_CONSTEXPR int64_t BlocksPerFrame = 1 + 16 * 4;
+
+    EASY_MAIN_THREAD;
+    EASY_PROFILER_ENABLE;
+    for (int64_t i = 0; i < _blocksNumber; i += BlocksPerFrame)
+    {
+        EASY_BLOCK("Frame");
+        for (int child = 0; child < 16; ++child)
+        {
+            EASY_BLOCK("Child");
+            for (int nested = 0; nested < 3; ++nested)
+            {
+                EASY_BLOCK("Nested");
+            }
+        }
+    }
+}
+
+static int64_t fileSize(const char* _filename)
+{
+    std::ifstream file(_filename, std::fstream::binary | std::fstream::ate);
+    return file.is_open() ? static_cast<int64_t>(file.tellg()) : 0;
+}
+
+static void BM_DumpBlocks(benchmark::State& state)
+{
+    int64_t blocksNumber = 0, bytesNumber = 0;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        captureBlocks(state.range(0));
+        state.ResumeTiming();
+
+        blocksNumber += profiler::dumpBlocksToFile(easy_benchmark::TEMP_FILENAME);
+
+        state.PauseTiming();
+        bytesNumber += fileSize(easy_benchmark::TEMP_FILENAME);
+        std::remove(easy_benchmark::TEMP_FILENAME);
+        state.ResumeTiming();
+    }
+
+    state.SetItemsProcessed(blocksNumber);
+    state.SetBytesProcessed(bytesNumber);
+}
+BENCHMARK(BM_DumpBlocks)->ArgName("blocks")->RangeMultiplier(10)->Range(100000, 1000000)->Unit(benchmark::kMillisecond);
+
+//////////////////////////////////////////////////////////////////////////
+
+// Returns contents of captured file with approximately _blocksNumber blocks.
+// The last generated file is cached: it is used for several arguments of the parse benchmark.
+static const std::string& capturedFile(int64_t _blocksNumber)
+{
+    static int64_t cachedBlocksNumber = 0;
+    static std::string contents;
+
+    if (cachedBlocksNumber != _blocksNumber)
+    {
+        std::string().swap(contents);
+
+        captureBlocks(_blocksNumber);
+        profiler::dumpBlocksToFile(easy_benchmark::TEMP_FILENAME);
+
+        std::ifstream file(easy_benchmark::TEMP_FILENAME, std::fstream::binary);
+        std::ostringstream buffer;
+        buffer << file.rdbuf();
+        contents = buffer.str();
+
+        file.close();
+        std::remove(easy_benchmark::TEMP_FILENAME);
+        cachedBlocksNumber = _blocksNumber;
+    }
+
+    return contents;
+}
+
+static void BM_FillTreesFromStream(benchmark::State& state)
+{
+    const auto& contents = capturedFile(state.range(0));
+    const bool gatherStatistics = state.range(1) != 0;
+
+    int64_t blocksNumber = 0;
+    std::string error;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        std::stringstream stream(contents);
+        std::stringstream log;
+        std::atomic<int> progress(0);
+        profiler::SerializedData serializedBlocks, serializedDescriptors;
+        profiler::descriptors_list_t descriptors;
+        profiler::blocks_t blocks;
+        profiler::thread_blocks_tree_t threadedTrees;
+        profiler::bookmarks_t bookmarks;
+        profiler::BeginEndTime beginEndTime;
+        uint32_t descriptorsNumber = 0, version = 0;
+        profiler::processid_t pid = 0;
+        profiler::timestamp_t blockOverhead = 0;
+        state.ResumeTiming();
+
+        const auto result = fillTreesFromStream(progress, stream, beginEndTime, serializedBlocks, serializedDescriptors,
+                                                descriptors, blocks, threadedTrees, bookmarks, descriptorsNumber,
+                                                version, pid, blockOverhead, gatherStatistics, log);
+        if (result == 0)
+        {
+            error = log.str();
+            state.SkipWithError(error.c_str());
+            break;
+        }
+
+        blocksNumber += result;
+
+        // Destruction of loaded trees is not measured
+        state.PauseTiming();
+        {
+            profiler::blocks_t().swap(blocks);
+            profiler::thread_blocks_tree_t().swap(threadedTrees);
+        }
+        state.ResumeTiming();
+    }
+
+    state.SetItemsProcessed(blocksNumber);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(contents.size()));
+}
+BENCHMARK(BM_FillTreesFromStream)->ArgNames({"blocks", "stats"})
+    ->ArgsProduct({benchmark::CreateRange(1000000, EASY_BENCHMARK_MAX_PARSE_BLOCKS, 10), {0, 1}})
+    ->Unit(benchmark::kMillisecond);
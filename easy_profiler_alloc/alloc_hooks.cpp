@@ -0,0 +1,247 @@
+/**
+Lightweight profiler library for c++
+Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+
+Licensed under either of
+    * MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+    * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+at your option.
+
+The MIT License
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights 
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies 
+    of the Software, and to permit persons to whom the Software is furnished 
+    to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all 
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+    PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE 
+    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, 
+    TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE 
+    USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+The Apache License, Version 2.0 (the "License");
+    You may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+**/
+
+/*
+ * Heap allocations tracking library.
+ *
+ * Interposes malloc, calloc, realloc, free and global operator new/delete and reports every
+ * allocation to profiler::storeAllocation(), which attributes it to the current opened block.
+ *
+ * Usage: either link the application with easy_profiler_alloc or preload it:
+ *     LD_PRELOAD=libeasy_profiler_alloc.so ./application
+ *
+ * Set EASY_ALLOC_SAMPLE=N environment variable to report only every N-th allocation of each thread
+ * (reported bytes and count are scaled by N).
+ */
+
+#include <easy/profiler.h>
+#include <algorithm>
+#include <dlfcn.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+
+namespace {
+
+using malloc_t = void* (*)(size_t);
+using calloc_t = void* (*)(size_t, size_t);
+using realloc_t = void* (*)(void*, size_t);
+using free_t = void (*)(void*);
+
+malloc_t   real_malloc = nullptr;
+calloc_t   real_calloc = nullptr;
+realloc_t real_realloc = nullptr;
+free_t       real_free = nullptr;
+
+bool         resolving = false;
+bool           enabled = false;
+uint32_t sampleInterval = 1;
+
+// dlsym() may allocate memory before real functions are resolved. Such requests are served from this buffer.
+EASY_CONSTEXPR size_t BOOTSTRAP_SIZE = 16384;
+alignas(16) char bootstrapBuffer[BOOTSTRAP_SIZE];
+size_t bootstrapUsed = 0;
+
+// Initial-exec TLS model is used because default model may allocate memory on first access
+__thread int32_t hookDepth __attribute__((tls_model("initial-exec"))) = 0;
+__thread uint32_t sampleCounter __attribute__((tls_model("initial-exec"))) = 0;
+
+struct HookGuard EASY_FINAL
+{
+    HookGuard() { ++hookDepth; }
+    ~HookGuard() { --hookDepth; }
+};
+
+void* bootstrapAlloc(size_t _size)
+{
+    const size_t aligned = (_size + 15) & ~size_t(15);
+    if (bootstrapUsed + aligned > BOOTSTRAP_SIZE)
+        return nullptr;
+    void* p = bootstrapBuffer + bootstrapUsed;
+    bootstrapUsed += aligned;
+    return p;
+}
+
+inline bool isBootstrap(const void* _ptr)
+{
+    return _ptr >= static_cast<const void*>(bootstrapBuffer) && _ptr < static_cast<const void*>(bootstrapBuffer + BOOTSTRAP_SIZE);
+}
+
+void resolve()
+{
+    if (real_free != nullptr)
+        return;
+
+    resolving = true;
+    real_malloc = reinterpret_cast<malloc_t>(dlsym(RTLD_NEXT, "malloc"));
+    real_calloc = reinterpret_cast<calloc_t>(dlsym(RTLD_NEXT, "calloc"));
+    real_realloc = reinterpret_cast<realloc_t>(dlsym(RTLD_NEXT, "realloc"));
+    real_free = reinterpret_cast<free_t>(dlsym(RTLD_NEXT, "free"));
+    resolving = false;
+}
+
+inline void record(size_t _size)
+{
+    if (!enabled || hookDepth != 0)
+        return;
+
+    if (sampleInterval > 1)
+    {
+        if (++sampleCounter < sampleInterval)
+            return;
+        sampleCounter = 0;
+    }
+
+    // Profiler may allocate memory itself (i.e. when growing per-thread counters)
+    HookGuard guard;
+    profiler::storeAllocation(static_cast<uint64_t>(_size) * sampleInterval, sampleInterval);
+}
+
+void* allocate(size_t _size)
+{
+    void* p = malloc(_size);
+    while (p == nullptr)
+    {
+        auto handler = std::get_new_handler();
+        if (handler == nullptr)
+            throw std::bad_alloc();
+        handler();
+        p = malloc(_size);
+    }
+    return p;
+}
+
+__attribute__((constructor)) void initialize()
+{
+    HookGuard guard;
+    resolve();
+
+    const char* sample = getenv("EASY_ALLOC_SAMPLE");
+    if (sample != nullptr)
+    {
+        const auto interval = strtoul(sample, nullptr, 10);
+        if (interval > 1)
+            sampleInterval = static_cast<uint32_t>(interval);
+    }
+
+    profiler::enableAllocationsTracking();
+    enabled = true;
+}
+
+} // end of namespace <noname>.
+
+extern "C" {
+
+void* malloc(size_t _size)
+{
+    if (real_malloc == nullptr)
+    {
+        if (resolving)
+            return bootstrapAlloc(_size);
+        resolve();
+    }
+
+    void* p = real_malloc(_size);
+    if (p != nullptr)
+        record(_size);
+
+    return p;
+}
+
+void* calloc(size_t _number, size_t _size)
+{
+    if (real_calloc == nullptr)
+    {
+        if (resolving)
+            return bootstrapAlloc(_number * _size); // bootstrap buffer is zero-initialized
+        resolve();
+    }
+
+    void* p = real_calloc(_number, _size);
+    if (p != nullptr)
+        record(_number * _size);
+
+    return p;
+}
+
+void* realloc(void* _ptr, size_t _size)
+{
+    if (isBootstrap(_ptr))
+    {
+        void* p = malloc(_size);
+        if (p != nullptr)
+            memcpy(p, _ptr, std::min(_size, static_cast<size_t>(bootstrapBuffer + BOOTSTRAP_SIZE - static_cast<char*>(_ptr))));
+        return p;
+    }
+
+    if (real_realloc == nullptr)
+        resolve();
+
+    void* p = real_realloc(_ptr, _size);
+    if (p != nullptr && _size != 0)
+        record(_size);
+
+    return p;
+}
+
+void free(void* _ptr)
+{
+    if (_ptr == nullptr || isBootstrap(_ptr))
+        return;
+
+    if (real_free == nullptr)
+        resolve();
+
+    real_free(_ptr);
+}
+
+} // extern "C"
+
+// Global operators new/delete are replaced to report allocations once even if C++ runtime does not use malloc.
+
+void* operator new(size_t _size) { return allocate(_size); }
+void* operator new[](size_t _size) { return allocate(_size); }
+void* operator new(size_t _size, const std::nothrow_t&) EASY_NOEXCEPT { return malloc(_size); }
+void* operator new[](size_t _size, const std::nothrow_t&) EASY_NOEXCEPT { return malloc(_size); }
+void operator delete(void* _ptr) EASY_NOEXCEPT { free(_ptr); }
+void operator delete[](void* _ptr) EASY_NOEXCEPT { free(_ptr); }
+void operator delete(void* _ptr, const std::nothrow_t&) EASY_NOEXCEPT { free(_ptr); }
+void operator delete[](void* _ptr, const std::nothrow_t&) EASY_NOEXCEPT { free(_ptr); }
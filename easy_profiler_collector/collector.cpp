@@ -0,0 +1,854 @@
+/**
+Lightweight profiler library for c++
+Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+
+Licensed under either of
+	* MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+    * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+at your option.
+
+The MIT License
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+	of the Software, and to permit persons to whom the Software is furnished
+	to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+	PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+	LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+	USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+The Apache License, Version 2.0 (the "License");
+	You may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+**/
+
+#include "collector.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <easy/profiler.h>
+#include <easy/easy_net.h>
+#include <easy/easy_compression.h>
+#include <easy/serialized_block.h>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+const uint32_t PROFILER_SIGNATURE = ('E' << 24) | ('a' << 16) | ('s' << 8) | 'y';
+const int CLOCK_SYNC_ROUNDS = 16;
+const int HANDSHAKE_TIMEOUTS = 5; // Number of receive timeouts (1 second each) before giving up
+
+uint64_t local_time()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+bool receive_exactly(EasySocket& _socket, char* _buffer, size_t _size, int _timeouts, const std::atomic_bool* _stop)
+{
+    while (_size != 0)
+    {
+        const int bytes = _socket.receive(_buffer, _size);
+        if (bytes <= 0)
+        {
+            if (bytes < 0 && !_socket.isDisconnected() && _timeouts-- != 0 &&
+                (_stop == nullptr || !_stop->load(std::memory_order_acquire)))
+                continue; // timeout
+            return false;
+        }
+
+        _buffer += bytes;
+        _size -= static_cast<size_t>(bytes);
+    }
+
+    return true;
+}
+
+/** Receives one message: _message contains the whole message structure, _data contains DataMessage payload.
+
+\param _timeouts Number of receive timeouts before giving up (negative value means infinite waiting).
+\param _stop Optional flag which interrupts waiting.
+*/
+bool receive_message(EasySocket& _socket, std::string& _message, std::string& _data, int _timeouts,
+                     const std::atomic_bool* _stop = nullptr)
+{
+    _message.resize(sizeof(profiler::net::Message));
+    _data.clear();
+
+    if (!receive_exactly(_socket, &_message[0], _message.size(), _timeouts, _stop))
+        return false;
+
+    const auto message = reinterpret_cast<const profiler::net::Message*>(_message.data());
+    if (!message->isEasyNetMessage())
+        return false;
+
+    size_t size = sizeof(profiler::net::Message);
+    bool hasData = false;
+    switch (message->type)
+    {
+        case profiler::net::MessageType::Connection_Accepted:
+            size = sizeof(profiler::net::EasyProfilerStatus);
+            break;
+
+        case profiler::net::MessageType::Reply_Clock_Sync:
+            size = sizeof(profiler::net::ClockSyncMessage);
+            break;
+
+        case profiler::net::MessageType::Reply_Blocks:
+        case profiler::net::MessageType::Reply_Blocks_Compressed:
+        case profiler::net::MessageType::Reply_Triggered_Capture:
+            size = sizeof(profiler::net::DataMessage);
+            hasData = true;
+            break;
+
+        default:
+            break;
+    }
+
+    _message.resize(size);
+    if (size > sizeof(profiler::net::Message) && !receive_exactly(_socket, &_message[sizeof(profiler::net::Message)],
+                                                                  size - sizeof(profiler::net::Message), _timeouts, _stop))
+    {
+        return false;
+    }
+
+    if (hasData)
+    {
+        _data.resize(reinterpret_cast<const profiler::net::DataMessage*>(_message.data())->size);
+        if (!_data.empty() && !receive_exactly(_socket, &_data[0], _data.size(), _timeouts, _stop))
+            return false;
+    }
+
+    return true;
+}
+
+template <class T>
+const T& message_cast(const std::string& _message)
+{
+    return *reinterpret_cast<const T*>(_message.data());
+}
+
+profiler::net::MessageType message_type(const std::string& _message)
+{
+    return message_cast<profiler::net::Message>(_message).type;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+class BufferReader EASY_FINAL
+{
+    const std::string& m_data;
+    size_t           m_offset;
+
+public:
+
+    explicit BufferReader(const std::string& _data) : m_data(_data), m_offset(0) {}
+
+    size_t offset() const { return m_offset; }
+
+    template <class T>
+    bool read(T& _value)
+    {
+        if (m_data.size() - m_offset < sizeof(T))
+            return false;
+        memcpy(&_value, m_data.data() + m_offset, sizeof(T));
+        m_offset += sizeof(T);
+        return true;
+    }
+
+    bool skip(size_t _size)
+    {
+        if (m_data.size() - m_offset < _size)
+            return false;
+        m_offset += _size;
+        return true;
+    }
+
+    /** Skips _count records (uint16_t size + payload). */
+    bool skipRecords(uint32_t _count)
+    {
+        for (uint32_t i = 0; i < _count; ++i)
+        {
+            uint16_t size = 0;
+            if (!read(size) || !skip(size))
+                return false;
+        }
+        return true;
+    }
+
+}; // END of class BufferReader.
+
+struct ProfThread
+{
+    profiler::thread_id_t id = 0;
+    std::string         name;
+    uint32_t       csCount = 0;
+    uint32_t   blocksCount = 0;
+    size_t        csOffset = 0; ///< Offset of the first context switch record
+    size_t    blocksOffset = 0; ///< Offset of the first block record
+};
+
+struct ProfFile
+{
+    std::vector<ProfThread> threads;
+    std::vector<bool> asyncDescriptors; ///< True for descriptors of async spans and flow links (indexed by block id)
+    uint64_t                    pid = 0;
+    int64_t            cpuFrequency = 0;
+    uint64_t              beginTime = 0;
+    uint64_t                endTime = 0;
+    uint64_t          blockOverhead = 0; ///< Measured cost of one empty nested block (in CPU ticks)
+    uint64_t             memorySize = 0;
+    uint64_t  descriptorsMemorySize = 0;
+    uint32_t            blocksCount = 0;
+    uint32_t       descriptorsCount = 0;
+    size_t        descriptorsOffset = 0;
+};
+
+bool parse_prof(const std::string& _data, ProfFile& _file, std::string& _error)
+{
+    BufferReader reader(_data);
+
+    uint32_t signature = 0, version = 0, threadsCount = 0;
+    uint16_t bookmarksCount = 0, padding = 0;
+
+    if (!reader.read(signature) || signature != PROFILER_SIGNATURE)
+    {
+        _error = "wrong signature";
+        return false;
+    }
+
+    if (!reader.read(version) || version != profiler::version())
+    {
+        _error = "unsupported version " + std::to_string(version);
+        return false;
+    }
+
+    if (!reader.read(_file.pid) || !reader.read(_file.cpuFrequency) || !reader.read(_file.beginTime) ||
+        !reader.read(_file.endTime) || !reader.read(_file.memorySize) || !reader.read(_file.descriptorsMemorySize) ||
+        !reader.read(_file.blocksCount) || !reader.read(_file.descriptorsCount) || !reader.read(threadsCount) ||
+        !reader.read(bookmarksCount) || !reader.read(padding) || !reader.read(_file.blockOverhead))
+    {
+        _error = "unexpected end of header";
+        return false;
+    }
+
+    // Block type is stored right after id, line and color of profiler::BaseBlockDescriptor
+    const size_t typeOffset = sizeof(profiler::block_id_t) + sizeof(int32_t) + sizeof(profiler::color_t);
+
+    _file.descriptorsOffset = reader.offset();
+    _file.asyncDescriptors.assign(_file.descriptorsCount, false);
+    for (uint32_t i = 0; i < _file.descriptorsCount; ++i)
+    {
+        uint16_t size = 0;
+        if (!reader.read(size) || !reader.skip(size))
+        {
+            _error = "unexpected end of descriptors section";
+            return false;
+        }
+
+        if (size > typeOffset)
+        {
+            const auto type = static_cast<profiler::BlockType>(_data[reader.offset() - size + typeOffset]);
+            _file.asyncDescriptors[i] = type == profiler::BlockType::Async || type == profiler::BlockType::Flow;
+        }
+    }
+
+    _file.threads.resize(threadsCount);
+    for (auto& thread : _file.threads)
+    {
+        uint16_t nameSize = 0;
+        if (!reader.read(thread.id) || !reader.read(nameSize) || !reader.skip(nameSize))
+        {
+            _error = "unexpected end of threads section";
+            return false;
+        }
+
+        if (nameSize > 1)
+            thread.name.assign(_data.data() + reader.offset() - nameSize, nameSize - 1u);
+
+        if (!reader.read(thread.csCount))
+        {
+            _error = "unexpected end of threads section";
+            return false;
+        }
+
+        thread.csOffset = reader.offset();
+        if (!reader.skipRecords(thread.csCount) || !reader.read(thread.blocksCount))
+        {
+            _error = "unexpected end of context switches section";
+            return false;
+        }
+
+        thread.blocksOffset = reader.offset();
+        if (!reader.skipRecords(thread.blocksCount))
+        {
+            _error = "unexpected end of blocks section";
+            return false;
+        }
+    }
+
+    // Bookmarks are created by user in the UI and never sent by profiled application, so they are not parsed
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+/** Converts timestamps of one application into collector time (nanoseconds). */
+class TimeConverter EASY_FINAL
+{
+    uint64_t m_syncTime;
+    uint64_t m_localTime;
+    double      m_scale;
+
+public:
+
+    TimeConverter(const CollectorSource& _source, int64_t _cpuFrequency)
+        : m_syncTime(_source.syncTime)
+        , m_localTime(_source.syncLocalTime)
+        , m_scale(_cpuFrequency != 0 ? 1e9 / static_cast<double>(_cpuFrequency) : 1.)
+    {
+    }
+
+    uint64_t operator () (uint64_t _time) const
+    {
+        const auto delta = static_cast<double>(static_cast<int64_t>(_time - m_syncTime)) * m_scale;
+        return m_localTime + static_cast<uint64_t>(static_cast<int64_t>(std::llround(delta)));
+    }
+
+}; // END of class TimeConverter.
+
+template <class T>
+void write(std::ostream& _stream, const T& _value)
+{
+    _stream.write(reinterpret_cast<const char*>(&_value), sizeof(T));
+}
+
+template <class T>
+void patch(char* _data, const T& _value)
+{
+    memcpy(_data, &_value, sizeof(T));
+}
+
+template <class T>
+T load(const char* _data)
+{
+    T value;
+    memcpy(&value, _data, sizeof(T));
+    return value;
+}
+
+using thread_ids_t = std::unordered_map<profiler::thread_id_t, profiler::thread_id_t>;
+
+/** Writes _count records (uint16_t size + payload) starting from _offset, converting begin and end timestamps.
+
+\param _hasId Records contain block id which is shifted by _descriptorOffset (context switch records have no block id).
+\param _file If not null then source thread of async spans and flow links is replaced using _threadIds.
+*/
+void write_events(std::ostream& _stream, const std::string& _data, size_t _offset, uint32_t _count,
+                  const TimeConverter& _converter, uint32_t _descriptorOffset, bool _hasId, std::vector<char>& _buffer,
+                  const ProfFile* _file = nullptr, const thread_ids_t* _threadIds = nullptr)
+{
+    const size_t idOffset = sizeof(profiler::timestamp_t) * 2;
+    const size_t sourceThreadOffset = sizeof(profiler::AsyncEvent) - sizeof(profiler::thread_id_t);
+
+    for (uint32_t i = 0; i < _count; ++i)
+    {
+        const auto size = load<uint16_t>(_data.data() + _offset);
+        _offset += sizeof(uint16_t);
+
+        _buffer.assign(_data.data() + _offset, _data.data() + _offset + size);
+        _offset += size;
+
+        if (size >= idOffset)
+        {
+            patch(_buffer.data(), _converter(load<profiler::timestamp_t>(_buffer.data())));
+            patch(_buffer.data() + sizeof(profiler::timestamp_t),
+                  _converter(load<profiler::timestamp_t>(_buffer.data() + sizeof(profiler::timestamp_t))));
+
+            if (_hasId && size >= idOffset + sizeof(profiler::block_id_t))
+            {
+                const auto id = load<profiler::block_id_t>(_buffer.data() + idOffset);
+                patch(_buffer.data() + idOffset, id + _descriptorOffset);
+
+                if (_file != nullptr && size == sizeof(profiler::AsyncEvent) && id < _file->asyncDescriptors.size()
+                    && _file->asyncDescriptors[id])
+                {
+                    auto it = _threadIds->find(load<profiler::thread_id_t>(_buffer.data() + sourceThreadOffset));
+                    if (it != _threadIds->end())
+                        patch(_buffer.data() + sourceThreadOffset, it->second);
+                }
+            }
+        }
+
+        write(_stream, size);
+        _stream.write(_buffer.data(), size);
+    }
+}
+
+} // END of namespace <noname>.
+
+//////////////////////////////////////////////////////////////////////////
+
+Collector::Collector() : m_compression(false)
+{
+    m_stop = false;
+}
+
+void Collector::addSource(const std::string& _address, uint16_t _port)
+{
+    m_sources.emplace_back(_address, _port);
+}
+
+void Collector::setCompressionEnabled(bool _enabled)
+{
+    m_compression = _enabled;
+}
+
+bool Collector::connect(std::ostream& _log)
+{
+    bool result = true;
+    std::string message, data;
+
+    for (auto& source : m_sources)
+    {
+        _log << "Connecting to " << source.address << ':' << source.port << "... ";
+
+        if (!source.socket.setAddress(source.address.c_str(), source.port) || source.socket.connect() != 0)
+        {
+            _log << "FAILED\n";
+            result = false;
+            continue;
+        }
+
+        if (!receive_message(source.socket, message, data, HANDSHAKE_TIMEOUTS) ||
+            message_type(message) != profiler::net::MessageType::Connection_Accepted)
+        {
+            _log << "FAILED (connection was not accepted)\n";
+            result = false;
+            continue;
+        }
+
+        const auto& status = message_cast<profiler::net::EasyProfilerStatus>(message);
+        source.compression = m_compression ? (status.compression & profiler::net::COMPRESSION_SUPPORTED) : 0;
+        if (source.compression != 0)
+        {
+            const profiler::net::CompressionMessage request(source.compression);
+            source.socket.send(&request, sizeof(request));
+        }
+
+        if (!syncClock(source))
+        {
+            _log << "FAILED (clock synchronization is not supported)\n";
+            result = false;
+            continue;
+        }
+
+        _log << "OK (pid " << source.pid << ", round trip " << source.syncRoundTrip / 1000 << " us)\n";
+    }
+
+    return result;
+}
+
+bool Collector::syncClock(CollectorSource& _source)
+{
+    const profiler::net::Message request(profiler::net::MessageType::Request_Clock_Sync);
+    std::string message, data;
+
+    _source.syncRoundTrip = std::numeric_limits<uint64_t>::max();
+    for (int i = 0; i < CLOCK_SYNC_ROUNDS; ++i)
+    {
+        const auto sendTime = local_time();
+        _source.socket.send(&request, sizeof(request));
+
+        if (!receive_message(_source.socket, message, data, HANDSHAKE_TIMEOUTS) ||
+            message_type(message) != profiler::net::MessageType::Reply_Clock_Sync)
+        {
+            return false;
+        }
+
+        const auto roundTrip = local_time() - sendTime;
+        if (roundTrip < _source.syncRoundTrip)
+        {
+            // Smaller round trip time means smaller uncertainty of the moment when reply has been created
+            const auto& reply = message_cast<profiler::net::ClockSyncMessage>(message);
+            _source.pid = reply.pid;
+            _source.syncTime = reply.time;
+            _source.syncLocalTime = sendTime + roundTrip / 2;
+            _source.syncRoundTrip = roundTrip;
+        }
+    }
+
+    return true;
+}
+
+bool Collector::startCapture(std::ostream& _log)
+{
+    // Send all requests first to start capturing as simultaneously as possible
+    const profiler::net::Message request(profiler::net::MessageType::Request_Start_Capture);
+    for (auto& source : m_sources)
+        source.socket.send(&request, sizeof(request));
+
+    bool result = true;
+    std::string message, data;
+
+    for (auto& source : m_sources)
+    {
+        if (!receive_message(source.socket, message, data, HANDSHAKE_TIMEOUTS) ||
+            message_type(message) != profiler::net::MessageType::Reply_Capturing_Started)
+        {
+            _log << "Can not start capturing for " << source.address << ':' << source.port << '\n';
+            result = false;
+        }
+    }
+
+    return result;
+}
+
+bool Collector::stopCapture(std::ostream& _log)
+{
+    const profiler::net::Message request(profiler::net::MessageType::Request_Stop_Capture);
+    for (auto& source : m_sources)
+        source.socket.send(&request, sizeof(request));
+
+    // Applications are dumping their data in parallel, so receive it in parallel too
+    std::vector<std::thread> threads;
+    threads.reserve(m_sources.size());
+    for (auto& source : m_sources)
+        threads.emplace_back(&Collector::receiveCapture, this, std::ref(source));
+
+    for (auto& thread : threads)
+        thread.join();
+
+    bool result = true;
+    for (const auto& source : m_sources)
+    {
+        _log << source.address << ':' << source.port << " (pid " << source.pid << "): ";
+        if (source.error.empty())
+        {
+            _log << source.data.size() << " bytes received\n";
+        }
+        else
+        {
+            _log << source.error << '\n';
+            result = false;
+        }
+    }
+
+    return result;
+}
+
+void Collector::receiveCapture(CollectorSource& _source)
+{
+    std::string message, data;
+
+    _source.data.clear();
+    while (true)
+    {
+        // Dumping could take a lot of time, so wait until connection is closed
+        if (!receive_message(_source.socket, message, data, -1))
+        {
+            _source.error = "connection lost";
+            return;
+        }
+
+        switch (message_type(message))
+        {
+            case profiler::net::MessageType::Reply_Blocks:
+            {
+                _source.data.swap(data);
+                break;
+            }
+
+            case profiler::net::MessageType::Reply_Blocks_Compressed:
+            {
+                profiler::net::CompressedDataHeader header;
+                if (data.size() < sizeof(header))
+                {
+                    _source.error = "corrupted data";
+                    return;
+                }
+
+                memcpy(&header, data.data(), sizeof(header));
+
+                size_t consumed = 0;
+                const auto size = data.size() - sizeof(header);
+                if (!profiler::net::unpackChunks(data.data() + sizeof(header), size, consumed, _source.data) ||
+                    consumed != size || _source.data.size() != header.rawSize ||
+                    ((header.flags & profiler::net::COMPRESSION_TIMESTAMP_DELTA) != 0 &&
+                     !profiler::net::decodeTimestampDeltas(&_source.data[0], _source.data.size())))
+                {
+                    _source.error = "corrupted data";
+                    return;
+                }
+
+                break;
+            }
+
+            case profiler::net::MessageType::Reply_Blocks_End:
+            {
+                if (_source.data.empty())
+                    _source.error = "nothing captured";
+                return;
+            }
+
+            default:
+                break;
+        }
+    }
+}
+
+uint32_t Collector::writeMergedFile(const std::string& _filename, std::ostream& _log) const
+{
+    std::vector<ProfFile> files;
+    std::vector<TimeConverter> converters;
+    files.reserve(m_sources.size());
+    converters.reserve(m_sources.size());
+
+    uint64_t beginTime = std::numeric_limits<uint64_t>::max(), endTime = 0, memorySize = 0, descriptorsMemorySize = 0;
+    uint64_t blockOverhead = 0;
+    uint32_t blocksCount = 0, descriptorsCount = 0, threadsCount = 0;
+
+    for (const auto& source : m_sources)
+    {
+        std::string error;
+        files.emplace_back();
+        auto& file = files.back();
+
+        if (!parse_prof(source.data, file, error))
+        {
+            _log << "Can not parse data of " << source.address << ':' << source.port << ": " << error << '\n';
+            return 0;
+        }
+
+        converters.emplace_back(source, file.cpuFrequency);
+        const auto& converter = converters.back();
+
+        if (file.beginTime != 0)
+            beginTime = std::min(beginTime, converter(file.beginTime));
+        if (file.endTime != 0)
+            endTime = std::max(endTime, converter(file.endTime));
+
+        // The smallest overhead is used for all sources: compensation should never subtract more than was added
+        if (file.blockOverhead != 0)
+        {
+            const auto overhead = file.cpuFrequency != 0 ? file.blockOverhead * 1000000000ULL / file.cpuFrequency
+                                                         : file.blockOverhead;
+            if (blockOverhead == 0 || overhead < blockOverhead)
+                blockOverhead = overhead;
+        }
+
+        memorySize += file.memorySize;
+        descriptorsMemorySize += file.descriptorsMemorySize;
+        blocksCount += file.blocksCount;
+        descriptorsCount += file.descriptorsCount;
+        threadsCount += static_cast<uint32_t>(file.threads.size());
+    }
+
+    if (files.empty())
+        return 0;
+
+    if (beginTime > endTime)
+        beginTime = endTime;
+
+    std::ofstream output(_filename, std::fstream::binary);
+    if (!output.is_open())
+    {
+        _log << "Can not open " << _filename << " for writing\n";
+        return 0;
+    }
+
+    // All timestamps are converted into nanoseconds
+    const int64_t cpuFrequency = 1000000000LL;
+
+    write(output, PROFILER_SIGNATURE);
+    write(output, profiler::version());
+    write(output, files.front().pid);
+    write(output, cpuFrequency);
+    write(output, beginTime);
+    write(output, endTime);
+    write(output, memorySize);
+    write(output, descriptorsMemorySize);
+    write(output, blocksCount);
+    write(output, descriptorsCount);
+    write(output, threadsCount);
+    write(output, static_cast<uint16_t>(0)); // Bookmarks count
+    write(output, static_cast<uint16_t>(0)); // padding
+    write(output, blockOverhead);
+
+    // Descriptors of all sources are written one after another, so block ids are shifted by descriptors offset
+    std::vector<uint32_t> descriptorOffsets;
+    descriptorOffsets.reserve(files.size());
+
+    std::vector<char> buffer;
+    uint32_t descriptorOffset = 0;
+    auto source = m_sources.begin();
+    for (size_t i = 0; i < files.size(); ++i, ++source)
+    {
+        const auto& file = files[i];
+        const auto& data = source->data;
+
+        descriptorOffsets.push_back(descriptorOffset);
+
+        size_t offset = file.descriptorsOffset;
+        for (uint32_t j = 0; j < file.descriptorsCount; ++j)
+        {
+            const auto size = load<uint16_t>(data.data() + offset);
+            offset += sizeof(uint16_t);
+
+            buffer.assign(data.data() + offset, data.data() + offset + size);
+            offset += size;
+
+            if (size >= sizeof(profiler::block_id_t))
+                patch(buffer.data(), load<profiler::block_id_t>(buffer.data()) + descriptorOffset);
+
+            write(output, size);
+            output.write(buffer.data(), size);
+        }
+
+        descriptorOffset += file.descriptorsCount;
+    }
+
+    // Thread ids of different processes may collide: such threads get new ids.
+    // This is done before writing blocks because async spans and flow links refer to their source threads.
+    std::unordered_set<profiler::thread_id_t> threadIds;
+    std::vector<thread_ids_t> fileThreadIds(files.size());
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        for (const auto& thread : files[i].threads)
+        {
+            auto id = thread.id;
+            if (!threadIds.insert(id).second)
+            {
+                id = (files[i].pid << 32) | (id & 0xffffffffULL);
+                threadIds.insert(id);
+            }
+
+            fileThreadIds[i].emplace(thread.id, id);
+        }
+    }
+
+    source = m_sources.begin();
+    for (size_t i = 0; i < files.size(); ++i, ++source)
+    {
+        const auto& file = files[i];
+        const auto& converter = converters[i];
+
+        for (const auto& thread : file.threads)
+        {
+            const auto id = fileThreadIds[i].at(thread.id);
+
+            std::string name = "PID " + std::to_string(file.pid);
+            if (!thread.name.empty())
+                name += ": " + thread.name;
+
+            const auto nameSize = static_cast<uint16_t>(std::min(name.size() + 1, static_cast<size_t>(0xffff)));
+            write(output, id);
+            write(output, nameSize);
+            output.write(name.c_str(), nameSize - 1);
+            output.put(0);
+
+            write(output, thread.csCount);
+            write_events(output, source->data, thread.csOffset, thread.csCount, converter, 0, false, buffer);
+
+            write(output, thread.blocksCount);
+            write_events(output, source->data, thread.blocksOffset, thread.blocksCount, converter,
+                         descriptorOffsets[i], true, buffer, &file, &fileThreadIds[i]);
+        }
+    }
+
+    write(output, PROFILER_SIGNATURE);
+
+    if (!output.good())
+    {
+        _log << "Can not write " << _filename << '\n';
+        return 0;
+    }
+
+    return blocksCount;
+}
+
+void Collector::startTriggeredCaptures(const std::string& _prefix, std::ostream& _log)
+{
+    const profiler::net::BoolMessage request(profiler::net::MessageType::Change_Triggered_Capture, true);
+
+    m_stop.store(false, std::memory_order_release);
+    for (auto& source : m_sources)
+    {
+        source.socket.send(&request, sizeof(request));
+        m_threads.emplace_back(&Collector::receiveTriggeredCaptures, this, std::ref(source), _prefix, std::ref(_log));
+    }
+}
+
+uint32_t Collector::stopTriggeredCaptures()
+{
+    m_stop.store(true, std::memory_order_release);
+    for (auto& thread : m_threads)
+        thread.join();
+    m_threads.clear();
+
+    uint32_t capturesCount = 0;
+    for (const auto& source : m_sources)
+        capturesCount += source.triggeredCaptures;
+
+    return capturesCount;
+}
+
+void Collector::receiveTriggeredCaptures(CollectorSource& _source, const std::string& _prefix, std::ostream& _log)
+{
+    std::string message, data;
+
+    while (!m_stop.load(std::memory_order_acquire))
+    {
+        if (!receive_message(_source.socket, message, data, -1, &m_stop))
+        {
+            if (!m_stop.load(std::memory_order_acquire))
+            {
+                std::lock_guard<std::mutex> lock(m_logMutex);
+                _log << _source.address << ':' << _source.port << ": connection lost" << std::endl;
+            }
+            return;
+        }
+
+        if (message_type(message) != profiler::net::MessageType::Reply_Triggered_Capture)
+            continue;
+
+        const auto filename = _prefix + "_" + std::to_string(_source.pid) + "_" +
+                              std::to_string(++_source.triggeredCaptures) + ".prof";
+
+        std::ofstream output(filename, std::fstream::binary);
+        output.write(data.data(), static_cast<std::streamsize>(data.size()));
+
+        std::lock_guard<std::mutex> lock(m_logMutex);
+        if (output.good())
+            _log << "Triggered capture from pid " << _source.pid << " (" << data.size() << " bytes) has been written to " << filename << std::endl;
+        else
+            _log << "Can not write " << filename << std::endl;
+    }
+}
@@ -0,0 +1,132 @@
+/**
+Lightweight profiler library for c++
+Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+
+Licensed under either of
+	* MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+    * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+at your option.
+
+The MIT License
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+	of the Software, and to permit persons to whom the Software is furnished
+	to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+	PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+	LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+	USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+The Apache License, Version 2.0 (the "License");
+	You may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+**/
+
+#ifndef EASY_PROFILER_COLLECTOR_H
+#define EASY_PROFILER_COLLECTOR_H
+
+#include <stdint.h>
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <easy/easy_socket.h>
+
+/** Connection to one profiled application. */
+struct CollectorSource EASY_FINAL
+{
+    std::string        address;
+    EasySocket          socket;
+    std::string           data; ///< Received .prof file contents
+    std::string          error; ///< Last error (empty if there were no errors)
+    uint64_t               pid = 0;
+    uint64_t          syncTime = 0; ///< Application timestamp received in Reply_Clock_Sync
+    uint64_t     syncLocalTime = 0; ///< Collector time (ns) corresponding to syncTime
+    uint64_t     syncRoundTrip = 0; ///< Round trip time (ns) of the best clock sync request
+    uint32_t triggeredCaptures = 0; ///< Number of received triggered captures
+    uint16_t              port = 0;
+    uint8_t        compression = 0; ///< Enabled profiler::net::CompressionFlags
+
+    CollectorSource(const std::string& _address, uint16_t _port) : address(_address), port(_port) {}
+
+    CollectorSource(const CollectorSource&) = delete;
+    CollectorSource& operator = (const CollectorSource&) = delete;
+
+}; // END of struct CollectorSource.
+
+/** Captures several profiled applications simultaneously and merges results into one .prof file.
+
+Timestamps of every application are converted into collector's own clock (nanoseconds)
+using Reply_Clock_Sync (the request with the smallest round trip time is used) and CPU frequency
+from .prof header, so blocks of different processes are aligned on the common timeline.
+*/
+class Collector EASY_FINAL
+{
+    std::list<CollectorSource>   m_sources;
+    std::vector<std::thread>     m_threads;
+    std::mutex                 m_logMutex;
+    std::atomic_bool               m_stop;
+    bool                    m_compression;
+
+public:
+
+    Collector();
+
+    void addSource(const std::string& _address, uint16_t _port);
+    void setCompressionEnabled(bool _enabled);
+
+    bool connect(std::ostream& _log);
+    bool startCapture(std::ostream& _log);
+    bool stopCapture(std::ostream& _log);
+
+    /** Writes merged .prof file.
+
+    Thread names are prefixed with process id of the source application. Thread ids are left
+    unchanged unless there is a collision (then process id is written into higher 32 bits).
+
+    \returns Number of written blocks (0 in case of error).
+    */
+    uint32_t writeMergedFile(const std::string& _filename, std::ostream& _log) const;
+
+    /** Subscribes to triggered captures (see profiler::addFrameTrigger()) and starts receiving them in background.
+
+    Every received capture is saved as "<_prefix>_<pid>_<number>.prof".
+    */
+    void startTriggeredCaptures(const std::string& _prefix, std::ostream& _log);
+
+    /** Stops receiving triggered captures.
+
+    \returns Total number of received captures.
+    */
+    uint32_t stopTriggeredCaptures();
+
+private:
+
+    bool syncClock(CollectorSource& _source);
+    void receiveCapture(CollectorSource& _source);
+    void receiveTriggeredCaptures(CollectorSource& _source, const std::string& _prefix, std::ostream& _log);
+
+}; // END of class Collector.
+
+#endif // EASY_PROFILER_COLLECTOR_H
@@ -0,0 +1,130 @@
+///std
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <easy/profiler.h>
+#include "collector.h"
+
+void printUsage(const char* _program)
+{
+    std::cout << "Usage: " << _program << " [-o OUTPUT_PROF_FILE] [-d DURATION_MS] [-t] [-c] HOST[:PORT] [HOST[:PORT] ...]\n"
+                                          "where:\n"
+                                          "OUTPUT_PROF_FILE (merged.prof by default) // Optional\n"
+                                          "DURATION_MS (if not specified capturing is stopped by pressing Enter) // Optional\n"
+                                          "-t receive triggered captures instead of capturing (saved as OUTPUT_<pid>_<number>.prof) // Optional\n"
+                                          "-c enables network data compression (for slow networks: it reduces throughput of fast ones) // Optional\n"
+                                          "HOST[:PORT] address of profiled application (default port is "
+                                       << profiler::DEFAULT_PORT << ") // At least one is required\n";
+}
+
+int main(int argc, char* argv[])
+{
+    std::string output_filename = "merged.prof";
+    int duration_ms = -1;
+    bool triggered = false;
+
+    Collector collector;
+    int sources_count = 0;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "-o" && i + 1 < argc)
+        {
+            output_filename = argv[++i];
+        }
+        else if (arg == "-d" && i + 1 < argc)
+        {
+            duration_ms = std::atoi(argv[++i]);
+        }
+        else if (arg == "-t")
+        {
+            triggered = true;
+        }
+        else if (arg == "-c")
+        {
+            collector.setCompressionEnabled(true);
+        }
+        else if (!arg.empty() && arg[0] != '-')
+        {
+            const auto colon = arg.rfind(':');
+            const auto port = colon != std::string::npos ? std::atoi(arg.c_str() + colon + 1) : profiler::DEFAULT_PORT;
+            if (port <= 0 || port > 0xffff)
+            {
+                std::cout << "Wrong port in " << arg << std::endl;
+                return 1;
+            }
+
+            collector.addSource(arg.substr(0, colon), static_cast<uint16_t>(port));
+            ++sources_count;
+        }
+        else
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (sources_count == 0)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if (!collector.connect(std::cout))
+        return 1;
+
+    if (triggered)
+    {
+        auto prefix = output_filename;
+        if (prefix.size() > 5 && prefix.compare(prefix.size() - 5, 5, ".prof") == 0)
+            prefix.resize(prefix.size() - 5);
+
+        collector.startTriggeredCaptures(prefix, std::cout);
+
+        if (duration_ms < 0)
+        {
+            std::cout << "Waiting for triggered captures... Press Enter to stop" << std::endl;
+            std::string line;
+            std::getline(std::cin, line);
+        }
+        else
+        {
+            std::cout << "Waiting for triggered captures for " << duration_ms << " ms..." << std::endl;
+            std::this_thread::sleep_for(std::chrono::milliseconds(duration_ms));
+        }
+
+        std::cout << "Triggered captures received: " << collector.stopTriggeredCaptures() << std::endl;
+
+        return 0;
+    }
+
+    if (!collector.startCapture(std::cout))
+        return 1;
+
+    if (duration_ms < 0)
+    {
+        std::cout << "Capturing... Press Enter to stop" << std::endl;
+        std::string line;
+        std::getline(std::cin, line);
+    }
+    else
+    {
+        std::cout << "Capturing for " << duration_ms << " ms..." << std::endl;
+        std::this_thread::sleep_for(std::chrono::milliseconds(duration_ms));
+    }
+
+    if (!collector.stopCapture(std::cout))
+        return 1;
+
+    const auto blocks_count = collector.writeMergedFile(output_filename, std::cout);
+    if (blocks_count == 0)
+        return 1;
+
+    std::cout << "Blocks count: " << blocks_count << "\nMerged profile has been written to " << output_filename << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,177 @@
+/**
+Lightweight profiler library for c++
+Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+
+Licensed under either of
+	* MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+    * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+at your option.
+
+The MIT License
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+	of the Software, and to permit persons to whom the Software is furnished
+	to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+	PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+	LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+	USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+The Apache License, Version 2.0 (the "License");
+	You may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+**/
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include "call_path_trie.h"
+
+CallPathTrie::CallPathTrie() : m_nodes(1), m_threadFrame(0)
+{
+}
+
+uint32_t CallPathTrie::child(uint32_t _parent, uint32_t _frame)
+{
+    const uint64_t key = (static_cast<uint64_t>(_parent) << 32) | _frame;
+    const auto it = m_children.find(key);
+    if (it != m_children.end())
+        return it->second;
+
+    const auto index = static_cast<uint32_t>(m_nodes.size());
+    m_nodes.emplace_back();
+    m_nodes.back().parent = _parent;
+    m_nodes.back().frame = _frame;
+    m_children.emplace(key, index);
+
+    return index;
+}
+
+uint64_t CallPathTrie::addBlock(const profiler::reader::BlockRef& _block, uint32_t _parent)
+{
+    const auto& descriptor = _block.descriptor();
+    const auto type = static_cast<profiler::BlockType>(descriptor.blockType);
+    if (type == profiler::BlockType::Event || type == profiler::BlockType::Value)
+        return 0;
+
+    const auto index = child(_parent, descriptor.id);
+    const uint64_t duration = _block.endTime() - _block.beginTime();
+
+    uint64_t childrenDuration = 0;
+    for (const auto child : _block.children())
+        childrenDuration += addBlock(child, index);
+
+    // Node reference is taken after children: adding children may reallocate nodes
+    auto& node = m_nodes[index];
+    node.inclusive += duration;
+    node.exclusive += duration > childrenDuration ? duration - childrenDuration : 0;
+    ++node.calls;
+
+    return duration;
+}
+
+void CallPathTrie::merge(const CallPathTrie& _trie, uint32_t _parent)
+{
+    std::vector<uint32_t> indices(_trie.m_nodes.size());
+    indices[ROOT] = _parent;
+
+    for (size_t i = 1; i < _trie.m_nodes.size(); ++i)
+    {
+        const auto& source = _trie.m_nodes[i];
+        indices[i] = child(indices[source.parent], source.frame);
+
+        auto& node = m_nodes[indices[i]];
+        node.inclusive += source.inclusive;
+        node.exclusive += source.exclusive;
+        node.calls += source.calls;
+    }
+}
+
+void CallPathTrie::build(const profiler::reader::FileReader& _reader)
+{
+    m_nodes.assign(1, Node());
+    m_children.clear();
+    m_threadNames.clear();
+    m_threadFrame = static_cast<uint32_t>(_reader.getBlockDescriptors().size());
+
+    const auto& threads = _reader.getThreads();
+
+    std::vector<CallPathTrie> tries(threads.size());
+    std::atomic<size_t> nextThread(0);
+    std::vector<std::thread> workers;
+
+    const size_t workersNumber = std::min(static_cast<size_t>(std::thread::hardware_concurrency()), threads.size());
+    for (size_t i = 0; i < workersNumber; ++i)
+    {
+        workers.emplace_back([&]
+        {
+            for (auto thread = nextThread++; thread < threads.size(); thread = nextThread++)
+            {
+                for (const auto block : _reader.getThreadBlocks(threads[thread]))
+                    tries[thread].addBlock(block, ROOT);
+            }
+        });
+    }
+
+    for (auto& worker : workers)
+        worker.join();
+
+    for (size_t i = 0; i < threads.size(); ++i)
+    {
+        auto& trie = tries[i];
+        if (workersNumber == 0)
+        {
+            for (const auto block : _reader.getThreadBlocks(threads[i]))
+                trie.addBlock(block, ROOT);
+        }
+
+        auto name = _reader.getThreadName(threads[i]);
+        if (name.empty())
+            name = "Thread " + std::to_string(threads[i]);
+
+        auto frame = static_cast<uint32_t>(std::find(m_threadNames.begin(), m_threadNames.end(), name) - m_threadNames.begin());
+        if (frame == m_threadNames.size())
+            m_threadNames.push_back(std::move(name));
+        frame += m_threadFrame;
+
+        const auto index = child(ROOT, frame);
+        merge(trie, index);
+
+        uint64_t duration = 0;
+        for (size_t c = 1; c < trie.m_nodes.size(); ++c)
+        {
+            if (trie.m_nodes[c].parent == ROOT)
+                duration += trie.m_nodes[c].inclusive;
+        }
+
+        m_nodes[index].inclusive += duration;
+        m_nodes[ROOT].inclusive += duration;
+
+        trie = CallPathTrie(); // release memory
+    }
+}
+
+const char* CallPathTrie::frameName(const profiler::reader::FileReader& _reader, uint32_t _frame) const
+{
+    if (isThreadFrame(_frame))
+        return threadName(_frame).c_str();
+    return _reader.getBlockDescriptors()[_frame].blockName;
+}
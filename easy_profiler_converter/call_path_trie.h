@@ -0,0 +1,112 @@
+/**
+Lightweight profiler library for c++
+Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+
+Licensed under either of
+	* MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+    * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+at your option.
+
+The MIT License
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+	of the Software, and to permit persons to whom the Software is furnished
+	to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+	PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+	LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+	USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+The Apache License, Version 2.0 (the "License");
+	You may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+**/
+
+#ifndef EASY_PROFILER_CONVERTER_CALL_PATH_TRIE_H
+#define EASY_PROFILER_CONVERTER_CALL_PATH_TRIE_H
+
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "reader.h"
+
+/** Aggregated call paths of all threads.
+
+Every node is a unique call path: thread frame followed by descriptor ids of nested blocks.
+Threads with the same name are merged into one thread frame. Events and arbitrary values are not included.
+*/
+class CallPathTrie EASY_FINAL
+{
+public:
+
+    struct Node EASY_FINAL
+    {
+        uint64_t inclusive = 0; ///< Total duration of blocks on this path (ns)
+        uint64_t exclusive = 0; ///< Total duration minus duration of children (ns)
+        uint64_t     calls = 0; ///< Number of blocks on this path
+        uint32_t    parent = 0; ///< Index of parent node
+        uint32_t     frame = 0; ///< Descriptor id or thread frame (see isThreadFrame())
+    };
+
+    using nodes_t = std::vector<Node>;
+
+    EASY_STATIC_CONSTEXPR uint32_t ROOT = 0;
+
+private:
+
+    nodes_t                                   m_nodes; ///< All nodes, m_nodes[ROOT] is the root. Parent index is always less than child index.
+    std::unordered_map<uint64_t, uint32_t> m_children; ///< (parent index, frame) -> child index
+    std::vector<std::string>            m_threadNames; ///< Names of thread frames
+    uint32_t                            m_threadFrame; ///< The first thread frame (is equal to descriptors number)
+
+public:
+
+    CallPathTrie();
+
+    /** Aggregates blocks of all threads. Threads are aggregated in parallel and then merged in the original order. */
+    void build(const profiler::reader::FileReader& _reader);
+
+    const nodes_t& nodes() const {
+        return m_nodes;
+    }
+
+    bool isThreadFrame(uint32_t _frame) const {
+        return _frame >= m_threadFrame;
+    }
+
+    const std::string& threadName(uint32_t _frame) const {
+        return m_threadNames[_frame - m_threadFrame];
+    }
+
+    /** Returns name of the frame: block name or thread name. */
+    const char* frameName(const profiler::reader::FileReader& _reader, uint32_t _frame) const;
+
+private:
+
+    uint32_t child(uint32_t _parent, uint32_t _frame);
+    uint64_t addBlock(const profiler::reader::BlockRef& _block, uint32_t _parent);
+    void merge(const CallPathTrie& _trie, uint32_t _parent);
+
+}; // end of class CallPathTrie.
+
+#endif // EASY_PROFILER_CONVERTER_CALL_PATH_TRIE_H
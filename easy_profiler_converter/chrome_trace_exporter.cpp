@@ -0,0 +1,244 @@
+/**
+Lightweight profiler library for c++
+Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+
+Licensed under either of
+	* MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+    * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+at your option.
+
+The MIT License
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+	of the Software, and to permit persons to whom the Software is furnished
+	to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+	PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+	LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+	USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+The Apache License, Version 2.0 (the "License");
+	You may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+**/
+
+#include <iostream>
+#include <vector>
+#include "converter.h"
+#include "json_writer.h"
+
+namespace {
+
+// Top level object and traceEvents array are pretty printed, every event is written on one line
+EASY_CONSTEXPR uint32_t PRETTY_DEPTH = 2;
+
+// Trace Event format uses microseconds, nanoseconds are kept as fraction
+EASY_CONSTEXPR uint32_t MICROSECOND_DECIMALS = 3;
+
+void beginEvent(JsonWriter& _writer, const char* _phase, const char* _name, const char* _category)
+{
+    _writer.beginObject();
+    _writer.key("name");
+    _writer.value(_name);
+    if (_category != nullptr)
+    {
+        _writer.key("cat");
+        _writer.value(_category);
+    }
+    _writer.key("ph");
+    _writer.value(_phase);
+}
+
+void writeTime(JsonWriter& _writer, const char* _key, uint64_t _time)
+{
+    _writer.key(_key);
+    _writer.fixedValue(_time, MICROSECOND_DECIMALS);
+}
+
+void writeThread(JsonWriter& _writer, uint64_t _pid, profiler::thread_id_t _threadId)
+{
+    _writer.key("pid");
+    _writer.value(_pid);
+    _writer.key("tid");
+    _writer.value(static_cast<uint64_t>(_threadId));
+}
+
+} // END of namespace <noname>.
+
+void ChromeTraceExporter::convert(const profiler::reader::BlockRef& block, uint64_t pid,
+                                  profiler::thread_id_t threadId, JsonWriter& writer) const
+{
+    const auto& descriptor = block.descriptor();
+    const auto type = static_cast<profiler::BlockType>(descriptor.blockType);
+    if (type == profiler::BlockType::Value)
+        return; // Values are written as counters
+
+    if (type == profiler::BlockType::Event)
+    {
+        beginEvent(writer, "i", descriptor.blockName, "event");
+        writer.key("s");
+        writer.value("t");
+        writeTime(writer, "ts", block.beginTime());
+    }
+    else
+    {
+        beginEvent(writer, "X", descriptor.blockName, type == profiler::BlockType::Lock ? "lock" : "block");
+        writeTime(writer, "ts", block.beginTime());
+        writeTime(writer, "dur", block.endTime() - block.beginTime());
+    }
+
+    writeThread(writer, pid, threadId);
+    writer.endObject();
+
+    for (const auto child : block.children())
+        convert(child, pid, threadId, writer);
+}
+
+void ChromeTraceExporter::convertThread(const profiler::reader::FileReader& reader, profiler::thread_id_t threadId,
+                                        JsonWriter& writer) const
+{
+    const uint64_t pid = reader.getProcessId();
+
+    // Every thread section begins with thread name, so it is never empty
+    beginEvent(writer, "M", "thread_name", nullptr);
+    writeThread(writer, pid, threadId);
+    writer.key("args");
+    writer.beginObject();
+    writer.key("name");
+    const auto& name = reader.getThreadName(threadId);
+    writer.value(name.empty() ? std::to_string(threadId) : name);
+    writer.endObject();
+    writer.endObject();
+
+    for (const auto block : reader.getThreadBlocks(threadId))
+        convert(block, pid, threadId, writer);
+
+    // Thread is switched out from beginTime to endTime. Async spans are used because context switches
+    // are not nested with blocks of the thread.
+    const auto& switches = reader.getContextSwitches();
+    const auto cs = switches.find(threadId);
+    if (cs != switches.end())
+    {
+        for (const auto& event : cs->second)
+        {
+            beginEvent(writer, "b", "Context switch", "context_switch");
+            writer.key("id");
+            writer.value(static_cast<uint64_t>(threadId));
+            writeTime(writer, "ts", event.beginTime);
+            writeThread(writer, pid, threadId);
+            writer.key("args");
+            writer.beginObject();
+            writer.key("target");
+            writer.value(event.targetProcess);
+            writer.key("targetThread");
+            writer.value(static_cast<uint64_t>(event.targetThreadId));
+            writer.endObject();
+            writer.endObject();
+
+            beginEvent(writer, "e", "Context switch", "context_switch");
+            writer.key("id");
+            writer.value(static_cast<uint64_t>(threadId));
+            writeTime(writer, "ts", event.endTime);
+            writeThread(writer, pid, threadId);
+            writer.endObject();
+        }
+    }
+
+    // Counters are process wide, so thread id is used as counter id to separate values of different threads
+    const auto& values = reader.getValues();
+    const auto threadValues = values.find(threadId);
+    if (threadValues != values.end())
+    {
+        for (const auto& value : threadValues->second)
+        {
+            beginEvent(writer, "C", value.descriptor->blockName, nullptr);
+            writer.key("id");
+            writer.value(static_cast<uint64_t>(threadId));
+            writeTime(writer, "ts", value.time);
+            writeThread(writer, pid, threadId);
+            writer.key("args");
+            writer.beginObject();
+            writer.key("value");
+            writer.value(value.value);
+            writer.endObject();
+            writer.endObject();
+        }
+    }
+}
+
+void ChromeTraceExporter::convert(const ::std::string& inputFile, const ::std::string& outputFile) const
+{
+    profiler::reader::FileReader fr;
+    if (fr.readFile(inputFile) == 0)
+        return;
+
+    FILE* output = openOutputFile(outputFile, false);
+    if (output == nullptr)
+        return;
+
+    const auto& threads = fr.getThreads();
+
+    JsonWriter writer(output, 0, false, PRETTY_DEPTH);
+    writer.beginObject();
+
+    writer.key("displayTimeUnit");
+    writer.value("ns");
+
+    writer.key("otherData");
+    writer.beginObject();
+    writer.key("version");
+    writer.value(fr.getVersionString());
+    writer.endObject();
+
+    writer.key("traceEvents");
+    writer.beginArray();
+
+    for (const auto& mark : fr.getBookmarks())
+    {
+        beginEvent(writer, "i", mark.text.c_str(), "bookmark");
+        writer.key("s");
+        writer.value("g");
+        writeTime(writer, "ts", mark.pos);
+        writeThread(writer, fr.getProcessId(), 0);
+        writer.endObject();
+    }
+
+    // Threads are written in parallel into separate sections which are appended in the original order
+    writer.flush();
+    const bool hasElements = writer.hasElements();
+    const bool good = writeSections(output, threads.size(), [&](size_t i, FILE* file)
+    {
+        JsonWriter section(file, 2, hasElements || i != 0, PRETTY_DEPTH);
+        convertThread(fr, threads[i], section);
+    });
+
+    if (!threads.empty())
+        writer.setHasElements();
+    writer.endArray();
+
+    writer.endObject();
+    writer.flush();
+
+    if (!good || ferror(output) != 0)
+        ::std::cout << "Can not write Trace Event output\n";
+
+    closeOutputFile(output);
+}
@@ -40,125 +40,162 @@ The Apache License, Version 2.0 (the "License");
 
 **/
 
+#include <iostream>
+#include <vector>
 #include "converter.h"
-#include <fstream>
+#include "json_writer.h"
 
-void JsonExporter::convert(const profiler::reader::BlocksTreeNode& node, nlohmann::json& json) const
+namespace {
+
+std::string hexColor(uint32_t _color)
 {
-    if (node.info.descriptor != nullptr)
-    {
-        json = {{"id", node.info.blockIndex},
-                {"name", node.info.descriptor->blockName},
-                {"start", node.info.beginTime},
-                {"stop", node.info.endTime},
-                {"descriptor", node.info.descriptor->id}};
-    }
+    static const char hexify[16] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'};
+
+    char digits[10];
+    char* const end = digits + sizeof(digits);
+    char* begin = end;
+    do {
+        *--begin = hexify[_color & 0xf];
+        _color >>= 4;
+    } while (_color != 0);
+
+    *--begin = 'x';
+    *--begin = '0';
 
-    convertChildren(node, json);
+    return std::string(begin, end);
 }
 
-void JsonExporter::convertChildren(const profiler::reader::BlocksTreeNode& node, nlohmann::json& json) const
+} // END of namespace <noname>.
+
+void JsonExporter::convert(const profiler::reader::BlockRef& block, JsonWriter& writer) const
 {
-    if (node.children.empty())
+    // Keys are written in alphabetical order
+    writer.beginObject();
+
+    convertChildren(block.children(), writer);
+
+    const auto& descriptor = block.descriptor();
+    writer.key("descriptor");
+    writer.value(static_cast<uint64_t>(descriptor.id));
+    writer.key("id");
+    writer.value(static_cast<uint64_t>(block.index()));
+    writer.key("name");
+    writer.value(descriptor.blockName);
+    writer.key("start");
+    writer.value(static_cast<uint64_t>(block.beginTime()));
+    writer.key("stop");
+    writer.value(static_cast<uint64_t>(block.endTime()));
+
+    writer.endObject();
+}
+
+void JsonExporter::convertChildren(const profiler::reader::BlocksRange& children, JsonWriter& writer) const
+{
+    if (children.empty())
         return;
 
-    auto children = nlohmann::json::array();
-    for (const auto& child : node.children)
-    {
-        children.emplace_back();
-        convert(child, children.back());
-    }
+    writer.key("children");
+    writer.beginArray();
+    for (const auto child : children)
+        convert(child, writer);
+    writer.endArray();
+}
 
-    json["children"] = children;
+void JsonExporter::convertThread(const profiler::reader::FileReader& reader, profiler::thread_id_t threadId,
+                                 JsonWriter& writer) const
+{
+    writer.beginObject();
+    convertChildren(reader.getThreadBlocks(threadId), writer);
+    writer.key("threadId");
+    writer.value(static_cast<uint64_t>(threadId));
+    writer.key("threadName");
+    writer.value(reader.getThreadName(threadId));
+    writer.endObject();
 }
 
 void JsonExporter::convert(const ::std::string& inputFile, const ::std::string& outputFile) const
 {
+    // JSON is written while walking blocks tree without building DOM, so only output buffers are allocated.
+    // Output is the same as pretty printed nlohmann::json with indent step 1 (keys are sorted alphabetically).
+
     profiler::reader::FileReader fr;
     if (fr.readFile(inputFile) == 0)
         return;
 
-    nlohmann::json json = {{"version", fr.getVersionString()}, {"timeUnits", "ns"}};
-
-    // convert descriptors
-    {
-        auto descriptors = nlohmann::json::array();
-        const auto& block_descriptors = fr.getBlockDescriptors();
-        for (const auto& descriptor : block_descriptors)
-        {
-            descriptors.emplace_back();
-
-            std::stringstream stream;
-            stream << "0x" << std::hex << descriptor.argbColor;
-
-            auto& desc = descriptors.back();
-
-            desc["id"] = descriptor.id;
-            if (descriptor.parentId != descriptor.id)
-                desc["parentId"] = descriptor.parentId;
+    FILE* output = openOutputFile(outputFile, false);
+    if (output == nullptr)
+        return;
 
-            desc["name"] = descriptor.blockName;
-            desc["type"] = descriptor.blockType;
-            desc["color"] = stream.str();
-            desc["sourceFile"] = descriptor.fileName;
-            desc["sourceLine"] = descriptor.lineNumber;
-        }
+    const auto& threads = fr.getThreads();
 
-        json["blockDescriptors"] = descriptors;
-    }
+    JsonWriter writer(output);
+    writer.beginObject();
 
-    // convert threads and blocks
+    writer.key("blockDescriptors");
+    writer.beginArray();
+    for (const auto& descriptor : fr.getBlockDescriptors())
     {
-        auto threads = nlohmann::json::array();
-        const auto& blocks_tree = fr.getBlocksTree();
-        for (const auto& kv : blocks_tree)
+        writer.beginObject();
+        writer.key("color");
+        writer.value(hexColor(descriptor.argbColor));
+        writer.key("id");
+        writer.value(static_cast<uint64_t>(descriptor.id));
+        writer.key("name");
+        writer.value(descriptor.blockName);
+        if (descriptor.parentId != descriptor.id)
         {
-            threads.emplace_back();
-
-            auto& thread = threads.back();
-            thread["threadId"] = kv.first;
-            thread["threadName"] = fr.getThreadName(kv.first);
-
-            convertChildren(kv.second, thread);
+            writer.key("parentId");
+            writer.value(static_cast<uint64_t>(descriptor.parentId));
         }
+        writer.key("sourceFile");
+        writer.value(descriptor.fileName);
+        writer.key("sourceLine");
+        writer.value(static_cast<int64_t>(descriptor.lineNumber));
+        writer.key("type");
+        writer.value(static_cast<uint64_t>(descriptor.blockType));
+        writer.endObject();
+    }
+    writer.endArray();
 
-        json["threads"] = threads;
+    writer.key("bookmarks");
+    writer.beginArray();
+    for (const auto& mark : fr.getBookmarks())
+    {
+        writer.beginObject();
+        writer.key("color");
+        writer.value(hexColor(mark.color));
+        writer.key("text");
+        writer.value(mark.text);
+        writer.key("timestamp");
+        writer.value(static_cast<uint64_t>(mark.pos));
+        writer.endObject();
     }
+    writer.endArray();
 
-    // convert bookmarks
+    writer.key("threads");
+    writer.beginArray();
+    // Threads are written in parallel into separate sections which are appended in the original order
+    writer.flush();
+    const bool good = writeSections(output, threads.size(), [&](size_t i, FILE* file)
     {
-        auto bookmarks = nlohmann::json::array();
-        const auto& bmarks = fr.getBookmarks();
-        for (const auto& mark : bmarks)
-        {
-            std::stringstream stream;
-            stream << "0x" << std::hex << mark.color;
+        JsonWriter section(file, 2, i != 0);
+        convertThread(fr, threads[i], section);
+    });
 
-            bookmarks.emplace_back();
+    if (!threads.empty())
+        writer.setHasElements();
+    writer.endArray();
 
-            auto& bookmark = bookmarks.back();
-            bookmark["timestamp"] = mark.pos;
-            bookmark["color"] = stream.str();
-            bookmark["text"] = mark.text;
-        }
+    writer.key("timeUnits");
+    writer.value("ns");
+    writer.key("version");
+    writer.value(fr.getVersionString());
 
-        json["bookmarks"] = bookmarks;
-    }
+    writer.endObject();
+    writer.flush();
 
-    try
-    {
-        if (!outputFile.empty())
-        {
-            ::std::ofstream file(outputFile);
-            json.dump(file, true, 1);
-        }
-        else
-        {
-            json.dump(::std::cout, true, 1);
-        }
-    }
-    catch (...)
-    {
-        ::std::cout << "json.dump() error...";
-    }
+    if (!good || ferror(output) != 0)
+        ::std::cout << "Can not write JSON output\n";
+
+    closeOutputFile(output);
 }
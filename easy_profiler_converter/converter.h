@@ -44,7 +44,9 @@ The Apache License, Version 2.0 (the "License");
 #define EASY_PROFILER_CONVERTER_H
 
 #include "reader.h"
-#include "include/json.hpp"
+
+class JsonWriter;
+class TracePacketWriter;
 
 class EasyProfilerExporter
 {
@@ -64,9 +66,105 @@ public:
 
 private:
 
-    void convert(const profiler::reader::BlocksTreeNode& node, nlohmann::json& json) const;
-    void convertChildren(const profiler::reader::BlocksTreeNode& node, nlohmann::json& json) const;
+    void convert(const profiler::reader::BlockRef& block, JsonWriter& writer) const;
+    void convertChildren(const profiler::reader::BlocksRange& children, JsonWriter& writer) const;
+    void convertThread(const profiler::reader::FileReader& reader, profiler::thread_id_t threadId,
+                       JsonWriter& writer) const;
 
 }; // end of class JsonExporter.
 
+/** Exports blocks into Trace Event JSON format (chrome://tracing, Perfetto UI, Speedscope).
+
+Blocks are exported as complete events, EASY_EVENTs as instant events, scalar arbitrary values as counters,
+context switches as async spans of the switched out thread and bookmarks as global instant events.
+*/
+class ChromeTraceExporter EASY_FINAL : public EasyProfilerExporter
+{
+public:
+
+    ~ChromeTraceExporter() override {}
+    void convert(const ::std::string& inputFile, const ::std::string& outputFile) const override;
+
+private:
+
+    void convert(const profiler::reader::BlockRef& block, uint64_t pid, profiler::thread_id_t threadId,
+                 JsonWriter& writer) const;
+    void convertThread(const profiler::reader::FileReader& reader, profiler::thread_id_t threadId,
+                       JsonWriter& writer) const;
+
+}; // end of class ChromeTraceExporter.
+
+/** Exports blocks into Perfetto binary protobuf trace format (Perfetto UI, trace_processor).
+
+Every thread has it's own track with child tracks for context switches and for each scalar arbitrary value (counter).
+Block names are interned once at the beginning of the trace.
+*/
+class PerfettoExporter EASY_FINAL : public EasyProfilerExporter
+{
+public:
+
+    ~PerfettoExporter() override {}
+    void convert(const ::std::string& inputFile, const ::std::string& outputFile) const override;
+
+private:
+
+    void convert(const profiler::reader::BlockRef& block, uint64_t trackUuid, TracePacketWriter& writer) const;
+    void convertThread(const profiler::reader::FileReader& reader, size_t threadIndex, profiler::thread_id_t threadId,
+                       TracePacketWriter& writer) const;
+
+}; // end of class PerfettoExporter.
+
+/** Exports aggregated call paths (see CallPathTrie) as collapsed stacks for flamegraph tools.
+
+Every line is "thread;block;nested_block exclusive_time_ns".
+*/
+class FoldedStackExporter EASY_FINAL : public EasyProfilerExporter
+{
+public:
+
+    ~FoldedStackExporter() override {}
+    void convert(const ::std::string& inputFile, const ::std::string& outputFile) const override;
+
+}; // end of class FoldedStackExporter.
+
+/** Exports aggregated call paths (see CallPathTrie) as pprof profile (gzipped if built with zlib).
+
+Every call path is one sample with values: number of calls and exclusive time in nanoseconds.
+*/
+class PprofExporter EASY_FINAL : public EasyProfilerExporter
+{
+public:
+
+    ~PprofExporter() override {}
+    void convert(const ::std::string& inputFile, const ::std::string& outputFile) const override;
+
+}; // end of class PprofExporter.
+
+/** Exports threads, descriptors, blocks, context switches, arbitrary values and bookmarks as CSV tables.
+
+Output is a directory with one .csv file per table and schema.sql which loads them into SQLite database.
+Every block row has its parent block id and depth, so blocks could be filtered by their callers with SQL.
+*/
+class CsvExporter EASY_FINAL : public EasyProfilerExporter
+{
+public:
+
+    ~CsvExporter() override {}
+    void convert(const ::std::string& inputFile, const ::std::string& outputFile) const override;
+
+}; // end of class CsvExporter.
+
+/** Exports the same tables as CsvExporter directly into SQLite database (requires SQLite at build time).
+
+Blocks of different threads are walked in parallel while rows are inserted in large transactions.
+*/
+class SqliteExporter EASY_FINAL : public EasyProfilerExporter
+{
+public:
+
+    ~SqliteExporter() override {}
+    void convert(const ::std::string& inputFile, const ::std::string& outputFile) const override;
+
+}; // end of class SqliteExporter.
+
 #endif //EASY_PROFILER_CONVERTER_H
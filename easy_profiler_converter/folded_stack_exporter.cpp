@@ -0,0 +1,120 @@
+/**
+Lightweight profiler library for c++
+Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+
+Licensed under either of
+	* MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+    * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+at your option.
+
+The MIT License
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+	of the Software, and to permit persons to whom the Software is furnished
+	to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+	PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+	LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+	USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+The Apache License, Version 2.0 (the "License");
+	You may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+**/
+
+#include <iostream>
+#include <vector>
+#include "call_path_trie.h"
+#include "converter.h"
+#include "output_file.h"
+
+namespace {
+
+void writeNumber(OutputFile& _output, uint64_t _value)
+{
+    char digits[24];
+    char* const end = digits + sizeof(digits);
+    char* begin = end;
+    do {
+        *--begin = static_cast<char>('0' + _value % 10);
+        _value /= 10;
+    } while (_value != 0);
+
+    _output.write(begin, static_cast<size_t>(end - begin));
+}
+
+// Frame separators and line breaks in names would break the format
+void writeFrameName(OutputFile& _output, const char* _name)
+{
+    for (; *_name != 0; ++_name)
+    {
+        const char c = *_name;
+        _output.put(c == ';' || c == '\n' || c == '\r' ? '_' : c);
+    }
+}
+
+} // END of namespace <noname>.
+
+void FoldedStackExporter::convert(const ::std::string& inputFile, const ::std::string& outputFile) const
+{
+    profiler::reader::FileReader fr;
+    if (fr.readFile(inputFile) == 0)
+        return;
+
+    CallPathTrie trie;
+    trie.build(fr);
+
+    FILE* file = openOutputFile(outputFile, false);
+    if (file == nullptr)
+        return;
+
+    {
+        OutputFile output(file);
+        std::vector<uint32_t> path;
+
+        const auto& nodes = trie.nodes();
+        for (uint32_t i = 1; i < nodes.size(); ++i)
+        {
+            if (nodes[i].exclusive == 0)
+                continue;
+
+            path.clear();
+            for (auto index = i; index != CallPathTrie::ROOT; index = nodes[index].parent)
+                path.push_back(nodes[index].frame);
+
+            for (auto frame = path.rbegin(); frame != path.rend(); ++frame)
+            {
+                if (frame != path.rbegin())
+                    output.put(';');
+                writeFrameName(output, trie.frameName(fr, *frame));
+            }
+
+            output.put(' ');
+            writeNumber(output, nodes[i].exclusive);
+            output.put('\n');
+        }
+    }
+
+    if (ferror(file) != 0)
+        ::std::cout << "Can not write folded stacks output\n";
+
+    closeOutputFile(file);
+}
@@ -0,0 +1,273 @@
+/**
+Lightweight profiler library for c++
+Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+
+Licensed under either of
+	* MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+    * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+at your option.
+
+The MIT License
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+	of the Software, and to permit persons to whom the Software is furnished
+	to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+	PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+	LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+	USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+The Apache License, Version 2.0 (the "License");
+	You may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+**/
+
+#include <math.h>
+#include <string.h>
+#include "json_writer.h"
+
+JsonWriter::JsonWriter(FILE* _file, uint32_t _depth, bool _hasElements, uint32_t _prettyDepth)
+    : m_output(_file)
+    , m_levels(_depth, 1)
+    , m_prettyDepth(_prettyDepth)
+    , m_afterKey(false)
+{
+    if (!m_levels.empty())
+        m_levels.back() = _hasElements ? 1 : 0;
+}
+
+JsonWriter::~JsonWriter()
+{
+    flush();
+}
+
+void JsonWriter::flush()
+{
+    m_output.flush();
+}
+
+bool JsonWriter::pretty() const
+{
+    return m_levels.size() <= m_prettyDepth;
+}
+
+void JsonWriter::newLine()
+{
+    m_output.put('\n');
+    for (size_t i = 0, depth = m_levels.size(); i < depth; ++i)
+        m_output.put(' ');
+}
+
+void JsonWriter::separator()
+{
+    // Every element of pretty printed object or array is written on a new line
+    if (m_afterKey)
+    {
+        m_afterKey = false;
+        return;
+    }
+
+    if (m_levels.empty())
+        return;
+
+    if (m_levels.back() != 0)
+        m_output.put(',');
+    m_levels.back() = 1;
+
+    if (pretty())
+        newLine();
+}
+
+bool JsonWriter::hasElements() const
+{
+    return !m_levels.empty() && m_levels.back() != 0;
+}
+
+void JsonWriter::setHasElements()
+{
+    m_levels.back() = 1;
+}
+
+void JsonWriter::beginObject()
+{
+    separator();
+    m_output.put('{');
+    m_levels.push_back(0);
+}
+
+void JsonWriter::endObject()
+{
+    const bool hasElements = m_levels.back() != 0 && pretty();
+    m_levels.pop_back();
+    if (hasElements)
+        newLine();
+    m_output.put('}');
+}
+
+void JsonWriter::beginArray()
+{
+    separator();
+    m_output.put('[');
+    m_levels.push_back(0);
+}
+
+void JsonWriter::endArray()
+{
+    const bool hasElements = m_levels.back() != 0 && pretty();
+    m_levels.pop_back();
+    if (hasElements)
+        newLine();
+    m_output.put(']');
+}
+
+void JsonWriter::key(const char* _key)
+{
+    separator();
+    string(_key, strlen(_key));
+    if (pretty())
+        m_output.write(": ", 2);
+    else
+        m_output.put(':');
+    m_afterKey = true;
+}
+
+void JsonWriter::value(const std::string& _value)
+{
+    separator();
+    string(_value.c_str(), _value.size());
+}
+
+void JsonWriter::value(const char* _value)
+{
+    separator();
+    string(_value, strlen(_value));
+}
+
+void JsonWriter::value(uint64_t _value)
+{
+    separator();
+    number(_value);
+}
+
+void JsonWriter::value(int64_t _value)
+{
+    separator();
+    if (_value < 0)
+    {
+        m_output.put('-');
+        number(static_cast<uint64_t>(0) - static_cast<uint64_t>(_value));
+    }
+    else
+    {
+        number(static_cast<uint64_t>(_value));
+    }
+}
+
+void JsonWriter::value(double _value)
+{
+    separator();
+    if (!isfinite(_value))
+    {
+        m_output.write("null", 4);
+        return;
+    }
+
+    char digits[32];
+    const int size = snprintf(digits, sizeof(digits), "%.17g", _value);
+    m_output.write(digits, static_cast<size_t>(size));
+}
+
+void JsonWriter::fixedValue(uint64_t _value, uint32_t _decimals)
+{
+    separator();
+
+    char digits[48];
+    char* const end = digits + sizeof(digits);
+    char* begin = end;
+    for (uint32_t i = 0; i < _decimals; ++i)
+    {
+        *--begin = static_cast<char>('0' + _value % 10);
+        _value /= 10;
+    }
+
+    if (_decimals != 0)
+        *--begin = '.';
+
+    do {
+        *--begin = static_cast<char>('0' + _value % 10);
+        _value /= 10;
+    } while (_value != 0);
+
+    m_output.write(begin, static_cast<size_t>(end - begin));
+}
+
+void JsonWriter::number(uint64_t _value)
+{
+    char digits[24];
+    char* const end = digits + sizeof(digits);
+    char* begin = end;
+    do {
+        *--begin = static_cast<char>('0' + _value % 10);
+        _value /= 10;
+    } while (_value != 0);
+
+    m_output.write(begin, static_cast<size_t>(end - begin));
+}
+
+void JsonWriter::string(const char* _value, size_t _size)
+{
+    static const char hexify[16] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'};
+
+    m_output.put('"');
+
+    // Characters which do not need escaping are written in runs
+    const char* run = _value;
+    for (const char* end = _value + _size; _value != end; ++_value)
+    {
+        const auto c = static_cast<unsigned char>(*_value);
+        if (c >= 0x20 && c != '"' && c != '\\')
+            continue;
+
+        m_output.write(run, static_cast<size_t>(_value - run));
+        run = _value + 1;
+
+        m_output.put('\\');
+        switch (c)
+        {
+            case '"': m_output.put('"'); break;
+            case '\\': m_output.put('\\'); break;
+            case '\b': m_output.put('b'); break;
+            case '\f': m_output.put('f'); break;
+            case '\n': m_output.put('n'); break;
+            case '\r': m_output.put('r'); break;
+            case '\t': m_output.put('t'); break;
+            default:
+            {
+                const char escaped[5] = {'u', '0', '0', hexify[c >> 4], hexify[c & 0x0f]};
+                m_output.write(escaped, sizeof(escaped));
+                break;
+            }
+        }
+    }
+
+    m_output.write(run, static_cast<size_t>(_value - run));
+    m_output.put('"');
+}
@@ -0,0 +1,115 @@
+/**
+Lightweight profiler library for c++
+Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+
+Licensed under either of
+	* MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+    * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+at your option.
+
+The MIT License
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+	of the Software, and to permit persons to whom the Software is furnished
+	to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+	PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+	LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+	USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+The Apache License, Version 2.0 (the "License");
+	You may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+**/
+
+#ifndef EASY_PROFILER_CONVERTER_JSON_WRITER_H
+#define EASY_PROFILER_CONVERTER_JSON_WRITER_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "output_file.h"
+
+/** Streaming (SAX-style) JSON writer with internal output buffer.
+
+Output is formatted the same way as pretty printed nlohmann::json with indent step 1:
+object members must be written in alphabetical order of keys.
+Elements nested deeper than pretty printing depth are written compactly on the same line.
+*/
+class JsonWriter EASY_FINAL
+{
+    OutputFile         m_output; ///< Buffered output file
+    std::vector<char>  m_levels; ///< For each opened object or array: 1 if it already has elements
+    uint32_t      m_prettyDepth; ///< Maximum depth of pretty printed objects and arrays
+    bool             m_afterKey; ///< True if key has been written and it's value is expected
+
+public:
+
+    JsonWriter(const JsonWriter&) = delete;
+    JsonWriter& operator = (const JsonWriter&) = delete;
+
+    /** \param _file Output file.
+        \param _depth Number of arrays in which writer is nested (used to write array element into a separate file).
+        \param _hasElements True if the array in which writer is nested already has elements.
+        \param _prettyDepth Contents of objects and arrays nested deeper are not pretty printed. */
+    explicit JsonWriter(FILE* _file, uint32_t _depth = 0, bool _hasElements = false, uint32_t _prettyDepth = UINT32_MAX);
+    ~JsonWriter();
+
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+
+    void key(const char* _key);
+
+    void value(const std::string& _value);
+    void value(const char* _value);
+    void value(uint64_t _value);
+    void value(int64_t _value);
+
+    /** Writes finite floating point value with maximum precision or null. */
+    void value(double _value);
+
+    /** Writes _value / 10^_decimals as decimal number (for example, nanoseconds as microseconds). */
+    void fixedValue(uint64_t _value, uint32_t _decimals);
+
+    /** Returns true if current object or array already has elements. */
+    bool hasElements() const;
+
+    /** Must be called after array elements have been written into the file bypassing this writer. */
+    void setHasElements();
+
+    /** Writes buffered data to the file. */
+    void flush();
+
+private:
+
+    bool pretty() const;
+    void separator();
+    void newLine();
+    void string(const char* _value, size_t _size);
+    void number(uint64_t _value);
+
+}; // end of class JsonWriter.
+
+#endif // EASY_PROFILER_CONVERTER_JSON_WRITER_H
@@ -1,34 +1,72 @@
 ///std
 #include <iostream>
 #include <memory>
+#include <string.h>
 #include "converter.h"
 
 using namespace profiler::reader;
 
+static int usage(const char* program)
+{
+    std::cout << "Usage: " << program << " [-f FORMAT] INPUT_PROF_FILE [OUTPUT_FILE]\n"
+                                         "where:\n"
+                                         "INPUT_PROF_FILE // Required\n"
+                                         "OUTPUT_FILE (if not specified output will be print in stdout) // Optional\n"
+                                         "FORMAT is one of: // Optional\n"
+                                         "  json     - easy_profiler JSON (default)\n"
+                                         "  chrome   - Trace Event JSON for chrome://tracing and Perfetto UI\n"
+                                         "  perfetto - Perfetto binary protobuf trace (OUTPUT_FILE is required)\n"
+                                         "  folded   - collapsed stacks of aggregated call paths for flamegraphs\n"
+                                         "  pprof    - pprof profile of aggregated call paths (OUTPUT_FILE is required)\n"
+                                         "  csv      - CSV tables for SQL queries (OUTPUT_FILE is a directory)\n"
+                                         "  sqlite   - SQLite database with the same tables (OUTPUT_FILE is required)\n";
+    return 1;
+}
+
 int main(int argc, char* argv[])
 {
-    std::string filename, output_json_filename;
+    std::string filename, output_filename, format = "json";
+
+    int arg = 1;
+    if (argc > 2 && argv[1] && strcmp(argv[1], "-f") == 0)
+    {
+        format = argv[2];
+        arg = 3;
+    }
 
-    if (argc > 1 && argv[1])
+    if (argc > arg && argv[arg])
     {
-        filename = argv[1];
+        filename = argv[arg];
     }
     else
     {
-        std::cout << "Usage: " << argv[0] << " INPUT_PROF_FILE [OUTPUT_JSON_FILE]\n"
-                                             "where:\n"
-                                             "INPUT_PROF_FILE // Required\n"
-                                             "OUTPUT_JSON_FILE (if not specified output will be print in stdout) // Optional\n";
-        return 1;
+        return usage(argv[0]);
     }
 
-    if (argc > 2 && argv[2])
+    if (argc > arg + 1 && argv[arg + 1])
     {
-        output_json_filename = argv[2];
+        output_filename = argv[arg + 1];
     }
 
-    JsonExporter js;
-    js.convert(filename, output_json_filename);
+    std::unique_ptr<EasyProfilerExporter> exporter;
+    if (format == "json")
+        exporter.reset(new JsonExporter());
+    else if (format == "chrome")
+        exporter.reset(new ChromeTraceExporter());
+    else if (format == "perfetto")
+        exporter.reset(new PerfettoExporter());
+    else if (format == "folded")
+        exporter.reset(new FoldedStackExporter());
+    else if (format == "pprof")
+        exporter.reset(new PprofExporter());
+    else if (format == "csv")
+        exporter.reset(new CsvExporter());
+    else if (format == "sqlite")
+        exporter.reset(new SqliteExporter());
+    else
+        return usage(argv[0]);
+
+    exporter->convert(filename, output_filename);
 
     return 0;
 }
@@ -0,0 +1,166 @@
+/**
+Lightweight profiler library for c++
+Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+
+Licensed under either of
+	* MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+    * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+at your option.
+
+The MIT License
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+	of the Software, and to permit persons to whom the Software is furnished
+	to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+	PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+	LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+	USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+The Apache License, Version 2.0 (the "License");
+	You may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+**/
+
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include "output_file.h"
+
+namespace {
+
+EASY_CONSTEXPR size_t BUFFER_SIZE = 1 << 20;
+
+bool append(FILE* _output, FILE* _input)
+{
+    std::vector<char> buffer(BUFFER_SIZE);
+
+    rewind(_input);
+    size_t size = 0;
+    while ((size = fread(buffer.data(), 1, buffer.size(), _input)) != 0)
+    {
+        if (fwrite(buffer.data(), 1, size, _output) != size)
+            return false;
+    }
+
+    return ferror(_input) == 0;
+}
+
+} // END of namespace <noname>.
+
+OutputFile::OutputFile(FILE* _file)
+    : m_buffer(BUFFER_SIZE)
+    , m_file(_file)
+    , m_size(0)
+{
+}
+
+OutputFile::~OutputFile()
+{
+    flush();
+}
+
+void OutputFile::flush()
+{
+    if (m_size != 0)
+    {
+        fwrite(m_buffer.data(), 1, m_size, m_file);
+        m_size = 0;
+    }
+}
+
+void OutputFile::write(const void* _data, size_t _size)
+{
+    if (m_size + _size > m_buffer.size())
+    {
+        flush();
+        if (_size > m_buffer.size())
+        {
+            fwrite(_data, 1, _size, m_file);
+            return;
+        }
+    }
+
+    memcpy(m_buffer.data() + m_size, _data, _size);
+    m_size += _size;
+}
+
+FILE* openOutputFile(const std::string& _filename, bool _binary)
+{
+    if (_filename.empty())
+        return stdout;
+
+    FILE* file = fopen(_filename.c_str(), _binary ? "wb" : "w");
+    if (file == nullptr)
+        ::std::cout << "Can not open " << _filename << " for writing\n";
+
+    return file;
+}
+
+void closeOutputFile(FILE* _file)
+{
+    if (_file != stdout)
+        fclose(_file);
+}
+
+bool writeSections(FILE* _output, size_t _count, const std::function<void(size_t, FILE*)>& _write)
+{
+    std::vector<FILE*> sections(_count, nullptr);
+    std::atomic<size_t> nextSection(0);
+    std::vector<std::thread> workers;
+
+    const size_t workersNumber = std::min(static_cast<size_t>(std::thread::hardware_concurrency()), _count);
+    for (size_t i = 0; i < workersNumber; ++i)
+    {
+        workers.emplace_back([&]
+        {
+            for (auto section = nextSection++; section < _count; section = nextSection++)
+            {
+                FILE* file = std::tmpfile();
+                if (file == nullptr)
+                    continue;
+
+                _write(section, file);
+                sections[section] = file;
+            }
+        });
+    }
+
+    for (auto& worker : workers)
+        worker.join();
+
+    bool good = true;
+    for (size_t i = 0; i < _count; ++i)
+    {
+        if (sections[i] == nullptr)
+        {
+            _write(i, _output);
+            continue;
+        }
+
+        good = append(_output, sections[i]) && good;
+        fclose(sections[i]);
+    }
+
+    return good && ferror(_output) == 0;
+}
@@ -0,0 +1,100 @@
+/**
+Lightweight profiler library for c++
+Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+
+Licensed under either of
+	* MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+    * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+at your option.
+
+The MIT License
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+	of the Software, and to permit persons to whom the Software is furnished
+	to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+	PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+	LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+	USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+The Apache License, Version 2.0 (the "License");
+	You may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+**/
+
+#ifndef EASY_PROFILER_CONVERTER_OUTPUT_FILE_H
+#define EASY_PROFILER_CONVERTER_OUTPUT_FILE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <easy/details/easy_compiler_support.h>
+
+/** Output file writer with internal buffer. */
+class OutputFile EASY_FINAL
+{
+    std::vector<char> m_buffer; ///< Output buffer
+    FILE*               m_file; ///< Output file
+    size_t              m_size; ///< Used size of the output buffer
+
+public:
+
+    OutputFile(const OutputFile&) = delete;
+    OutputFile& operator = (const OutputFile&) = delete;
+
+    explicit OutputFile(FILE* _file);
+    ~OutputFile();
+
+    void write(const void* _data, size_t _size);
+
+    void put(char _c)
+    {
+        if (m_size == m_buffer.size())
+            flush();
+        m_buffer[m_size++] = _c;
+    }
+
+    /** Writes buffered data to the file. */
+    void flush();
+
+}; // end of class OutputFile.
+
+/** Opens output file for writing or returns stdout if _filename is empty.
+Prints error message and returns nullptr if file can not be opened. */
+FILE* openOutputFile(const std::string& _filename, bool _binary);
+
+/** Closes file opened by openOutputFile(). */
+void closeOutputFile(FILE* _file);
+
+/** Writes _count independent sections of output in parallel and appends them to _output in the original order.
+
+Each section is written by _write(index, file) into a temporary file. If temporary file can not be created
+then the section is written directly into _output after all previous sections.
+
+\note All buffered data must be flushed into _output before this call.
+
+\retval false if writing into _output has failed. */
+bool writeSections(FILE* _output, size_t _count, const std::function<void(size_t, FILE*)>& _write);
+
+#endif // EASY_PROFILER_CONVERTER_OUTPUT_FILE_H
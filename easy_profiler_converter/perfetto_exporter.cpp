@@ -0,0 +1,372 @@
+/**
+Lightweight profiler library for c++
+Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+
+Licensed under either of
+	* MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+    * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+at your option.
+
+The MIT License
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+	of the Software, and to permit persons to whom the Software is furnished
+	to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+	PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+	LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+	USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+The Apache License, Version 2.0 (the "License");
+	You may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+**/
+
+#include <iostream>
+#include <vector>
+#include "converter.h"
+#include "protobuf_writer.h"
+
+namespace {
+
+// Field numbers and enumerations of Perfetto trace protos (protos/perfetto/trace/)
+
+namespace Trace { EASY_CONSTEXPR uint32_t packet = 1; }
+
+namespace TracePacket {
+    EASY_CONSTEXPR uint32_t timestamp = 8;
+    EASY_CONSTEXPR uint32_t trusted_packet_sequence_id = 10;
+    EASY_CONSTEXPR uint32_t track_event = 11;
+    EASY_CONSTEXPR uint32_t interned_data = 12;
+    EASY_CONSTEXPR uint32_t sequence_flags = 13;
+    EASY_CONSTEXPR uint32_t track_descriptor = 60;
+
+    EASY_CONSTEXPR uint64_t SEQ_INCREMENTAL_STATE_CLEARED = 1;
+    EASY_CONSTEXPR uint64_t SEQ_NEEDS_INCREMENTAL_STATE = 2;
+}
+
+namespace InternedData { EASY_CONSTEXPR uint32_t event_names = 2; }
+
+namespace EventName {
+    EASY_CONSTEXPR uint32_t iid = 1;
+    EASY_CONSTEXPR uint32_t name = 2;
+}
+
+namespace TrackDescriptor {
+    EASY_CONSTEXPR uint32_t uuid = 1;
+    EASY_CONSTEXPR uint32_t name = 2;
+    EASY_CONSTEXPR uint32_t process = 3;
+    EASY_CONSTEXPR uint32_t thread = 4;
+    EASY_CONSTEXPR uint32_t parent_uuid = 5;
+    EASY_CONSTEXPR uint32_t counter = 8;
+}
+
+namespace ProcessDescriptor { EASY_CONSTEXPR uint32_t pid = 1; }
+
+namespace ThreadDescriptor {
+    EASY_CONSTEXPR uint32_t pid = 1;
+    EASY_CONSTEXPR uint32_t tid = 2;
+    EASY_CONSTEXPR uint32_t thread_name = 5;
+}
+
+namespace TrackEvent {
+    EASY_CONSTEXPR uint32_t debug_annotations = 4;
+    EASY_CONSTEXPR uint32_t type = 9;
+    EASY_CONSTEXPR uint32_t name_iid = 10;
+    EASY_CONSTEXPR uint32_t track_uuid = 11;
+    EASY_CONSTEXPR uint32_t name = 23;
+    EASY_CONSTEXPR uint32_t double_counter_value = 44;
+
+    EASY_CONSTEXPR uint64_t TYPE_SLICE_BEGIN = 1;
+    EASY_CONSTEXPR uint64_t TYPE_SLICE_END = 2;
+    EASY_CONSTEXPR uint64_t TYPE_INSTANT = 3;
+    EASY_CONSTEXPR uint64_t TYPE_COUNTER = 4;
+}
+
+namespace DebugAnnotation {
+    EASY_CONSTEXPR uint32_t string_value = 6;
+    EASY_CONSTEXPR uint32_t name = 10;
+}
+
+// All packets are written into one sequence: interned block names are shared by all threads
+EASY_CONSTEXPR uint64_t SEQUENCE_ID = 1;
+
+// Track uuids: process track, then for every thread: thread track, context switches track and counter tracks
+EASY_CONSTEXPR uint64_t PROCESS_TRACK_UUID = 1;
+
+uint64_t threadTrackUuid(size_t _threadIndex)
+{
+    return static_cast<uint64_t>(_threadIndex + 1) << 32;
+}
+
+uint64_t contextSwitchTrackUuid(size_t _threadIndex)
+{
+    return threadTrackUuid(_threadIndex) + 1;
+}
+
+uint64_t counterTrackUuid(size_t _threadIndex, uint32_t _descriptorId)
+{
+    return threadTrackUuid(_threadIndex) + 2 + _descriptorId;
+}
+
+// Interned name id of block descriptor (0 is invalid iid)
+uint64_t nameIid(const profiler::reader::BlockDescriptor& _descriptor)
+{
+    return static_cast<uint64_t>(_descriptor.id) + 1;
+}
+
+} // END of namespace <noname>.
+
+/** Buffered writer of TracePacket messages which reuses encoding buffers for all packets. */
+class TracePacketWriter EASY_FINAL
+{
+    OutputFile      m_output; ///< Buffered output file
+    ProtobufMessage m_packet; ///< Encoded TracePacket
+    ProtobufMessage  m_event; ///< Encoded TrackEvent or TrackDescriptor
+    ProtobufMessage m_nested; ///< Encoded message nested into m_event
+    uint64_t          m_time; ///< Timestamp of current event
+
+public:
+
+    explicit TracePacketWriter(FILE* _file) : m_output(_file), m_time(0)
+    {
+    }
+
+    void flush()
+    {
+        m_output.flush();
+    }
+
+    /** Begins TrackEvent. Additional fields may be added to returned message before endEvent(). */
+    ProtobufMessage& beginEvent(uint64_t _time, uint64_t _type, uint64_t _trackUuid)
+    {
+        m_time = _time;
+        m_event.clear();
+        m_event.varint(TrackEvent::type, _type);
+        m_event.varint(TrackEvent::track_uuid, _trackUuid);
+        return m_event;
+    }
+
+    void endEvent()
+    {
+        m_packet.clear();
+        m_packet.varint(TracePacket::timestamp, m_time);
+        m_packet.varint(TracePacket::trusted_packet_sequence_id, SEQUENCE_ID);
+        m_packet.varint(TracePacket::sequence_flags, TracePacket::SEQ_NEEDS_INCREMENTAL_STATE);
+        m_packet.message(TracePacket::track_event, m_event);
+        m_packet.writeTo(m_output, Trace::packet);
+    }
+
+    /** Adds debug annotation with string value to current event. */
+    void annotation(const char* _name, const std::string& _value)
+    {
+        m_nested.clear();
+        m_nested.bytes(DebugAnnotation::name, _name, strlen(_name));
+        m_nested.string(DebugAnnotation::string_value, _value);
+        m_event.message(TrackEvent::debug_annotations, m_nested);
+    }
+
+    /** Begins TrackDescriptor. Additional fields may be added to returned message before endTrack(). */
+    ProtobufMessage& beginTrack(uint64_t _uuid)
+    {
+        m_event.clear();
+        m_event.varint(TrackDescriptor::uuid, _uuid);
+        return m_event;
+    }
+
+    ProtobufMessage& nested()
+    {
+        m_nested.clear();
+        return m_nested;
+    }
+
+    void endTrack()
+    {
+        m_packet.clear();
+        m_packet.varint(TracePacket::trusted_packet_sequence_id, SEQUENCE_ID);
+        m_packet.message(TracePacket::track_descriptor, m_event);
+        m_packet.writeTo(m_output, Trace::packet);
+    }
+
+    void packet(const ProtobufMessage& _packet)
+    {
+        _packet.writeTo(m_output, Trace::packet);
+    }
+
+}; // end of class TracePacketWriter.
+
+void PerfettoExporter::convert(const profiler::reader::BlockRef& block, uint64_t trackUuid,
+                               TracePacketWriter& writer) const
+{
+    const auto& descriptor = block.descriptor();
+    const auto type = static_cast<profiler::BlockType>(descriptor.blockType);
+    if (type == profiler::BlockType::Value)
+        return; // Values are written into counter tracks
+
+    if (type == profiler::BlockType::Event)
+    {
+        writer.beginEvent(block.beginTime(), TrackEvent::TYPE_INSTANT, trackUuid)
+            .varint(TrackEvent::name_iid, nameIid(descriptor));
+        writer.endEvent();
+        return;
+    }
+
+    writer.beginEvent(block.beginTime(), TrackEvent::TYPE_SLICE_BEGIN, trackUuid)
+        .varint(TrackEvent::name_iid, nameIid(descriptor));
+    writer.endEvent();
+
+    for (const auto child : block.children())
+        convert(child, trackUuid, writer);
+
+    writer.beginEvent(block.endTime(), TrackEvent::TYPE_SLICE_END, trackUuid);
+    writer.endEvent();
+}
+
+void PerfettoExporter::convertThread(const profiler::reader::FileReader& reader, size_t threadIndex,
+                                     profiler::thread_id_t threadId, TracePacketWriter& writer) const
+{
+    const auto threadUuid = threadTrackUuid(threadIndex);
+
+    auto& thread = writer.nested();
+    thread.int32(ThreadDescriptor::pid, static_cast<int32_t>(reader.getProcessId()));
+    thread.int32(ThreadDescriptor::tid, static_cast<int32_t>(threadId));
+    const auto& name = reader.getThreadName(threadId);
+    if (!name.empty())
+        thread.string(ThreadDescriptor::thread_name, name);
+    writer.beginTrack(threadUuid).message(TrackDescriptor::thread, thread);
+    writer.endTrack();
+
+    for (const auto block : reader.getThreadBlocks(threadId))
+        convert(block, threadUuid, writer);
+
+    // Thread is switched out from beginTime to endTime. Context switches are not nested with blocks of the thread,
+    // so they are written into a separate child track.
+    const auto& switches = reader.getContextSwitches();
+    const auto cs = switches.find(threadId);
+    if (cs != switches.end() && !cs->second.empty())
+    {
+        const auto csUuid = contextSwitchTrackUuid(threadIndex);
+
+        auto& track = writer.beginTrack(csUuid);
+        track.varint(TrackDescriptor::parent_uuid, threadUuid);
+        track.string(TrackDescriptor::name, "Context switches");
+        writer.endTrack();
+
+        const std::string eventName("Context switch");
+        for (const auto& event : cs->second)
+        {
+            writer.beginEvent(event.beginTime, TrackEvent::TYPE_SLICE_BEGIN, csUuid).string(TrackEvent::name, eventName);
+            writer.annotation("target", event.targetProcess);
+            writer.endEvent();
+
+            writer.beginEvent(event.endTime, TrackEvent::TYPE_SLICE_END, csUuid);
+            writer.endEvent();
+        }
+    }
+
+    const auto& values = reader.getValues();
+    const auto threadValues = values.find(threadId);
+    if (threadValues != values.end())
+    {
+        // Counter track is described before the first value of every descriptor
+        std::vector<char> described(reader.getBlockDescriptors().size(), 0);
+        for (const auto& value : threadValues->second)
+        {
+            const auto id = value.descriptor->id;
+            const auto counterUuid = counterTrackUuid(threadIndex, id);
+            if (described[id] == 0)
+            {
+                described[id] = 1;
+                auto& track = writer.beginTrack(counterUuid);
+                track.varint(TrackDescriptor::parent_uuid, threadUuid);
+                track.string(TrackDescriptor::name, value.descriptor->blockName);
+                track.message(TrackDescriptor::counter, ProtobufMessage());
+                writer.endTrack();
+            }
+
+            writer.beginEvent(value.time, TrackEvent::TYPE_COUNTER, counterUuid)
+                .fixedDouble(TrackEvent::double_counter_value, value.value);
+            writer.endEvent();
+        }
+    }
+}
+
+void PerfettoExporter::convert(const ::std::string& inputFile, const ::std::string& outputFile) const
+{
+    profiler::reader::FileReader fr;
+    if (fr.readFile(inputFile) == 0)
+        return;
+
+    if (outputFile.empty())
+    {
+        ::std::cout << "Output file is required for binary Perfetto trace\n";
+        return;
+    }
+
+    FILE* output = openOutputFile(outputFile, true);
+    if (output == nullptr)
+        return;
+
+    const auto& threads = fr.getThreads();
+
+    TracePacketWriter writer(output);
+
+    {
+        // The first packet clears incremental state of the sequence and interns names of all blocks
+        ProtobufMessage names, name, packet;
+        for (const auto& descriptor : fr.getBlockDescriptors())
+        {
+            name.clear();
+            name.varint(EventName::iid, nameIid(descriptor));
+            name.string(EventName::name, descriptor.blockName);
+            names.message(InternedData::event_names, name);
+        }
+
+        packet.varint(TracePacket::trusted_packet_sequence_id, SEQUENCE_ID);
+        packet.varint(TracePacket::sequence_flags, TracePacket::SEQ_INCREMENTAL_STATE_CLEARED);
+        packet.message(TracePacket::interned_data, names);
+        writer.packet(packet);
+    }
+
+    auto& process = writer.nested();
+    process.int32(ProcessDescriptor::pid, static_cast<int32_t>(fr.getProcessId()));
+    writer.beginTrack(PROCESS_TRACK_UUID).message(TrackDescriptor::process, process);
+    writer.endTrack();
+
+    for (const auto& mark : fr.getBookmarks())
+    {
+        writer.beginEvent(mark.pos, TrackEvent::TYPE_INSTANT, PROCESS_TRACK_UUID).string(TrackEvent::name, mark.text);
+        writer.endEvent();
+    }
+
+    // Threads are written in parallel into separate sections which are appended in the original order
+    writer.flush();
+    const bool good = writeSections(output, threads.size(), [&](size_t i, FILE* file)
+    {
+        TracePacketWriter section(file);
+        convertThread(fr, i, threads[i], section);
+    });
+
+    if (!good || ferror(output) != 0)
+        ::std::cout << "Can not write Perfetto output\n";
+
+    closeOutputFile(output);
+}
@@ -0,0 +1,253 @@
+/**
+Lightweight profiler library for c++
+Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+
+Licensed under either of
+	* MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+    * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+at your option.
+
+The MIT License
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+	of the Software, and to permit persons to whom the Software is furnished
+	to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+	PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+	LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+	USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+The Apache License, Version 2.0 (the "License");
+	You may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+**/
+
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+#ifdef EASY_CONVERTER_ZLIB
+# include <zlib.h>
+#endif
+
+#include "call_path_trie.h"
+#include "converter.h"
+#include "protobuf_writer.h"
+
+namespace {
+
+// Field numbers of pprof profile.proto (github.com/google/pprof/blob/master/proto/profile.proto)
+
+namespace Profile {
+    EASY_CONSTEXPR uint32_t sample_type = 1;
+    EASY_CONSTEXPR uint32_t sample = 2;
+    EASY_CONSTEXPR uint32_t location = 4;
+    EASY_CONSTEXPR uint32_t function = 5;
+    EASY_CONSTEXPR uint32_t string_table = 6;
+    EASY_CONSTEXPR uint32_t period_type = 11;
+    EASY_CONSTEXPR uint32_t period = 12;
+}
+
+namespace ValueType {
+    EASY_CONSTEXPR uint32_t type = 1;
+    EASY_CONSTEXPR uint32_t unit = 2;
+}
+
+namespace Sample {
+    EASY_CONSTEXPR uint32_t location_id = 1;
+    EASY_CONSTEXPR uint32_t value = 2;
+}
+
+namespace Location {
+    EASY_CONSTEXPR uint32_t id = 1;
+    EASY_CONSTEXPR uint32_t line = 4;
+}
+
+namespace Line {
+    EASY_CONSTEXPR uint32_t function_id = 1;
+    EASY_CONSTEXPR uint32_t line = 2;
+}
+
+namespace Function {
+    EASY_CONSTEXPR uint32_t id = 1;
+    EASY_CONSTEXPR uint32_t name = 2;
+    EASY_CONSTEXPR uint32_t system_name = 3;
+    EASY_CONSTEXPR uint32_t filename = 4;
+    EASY_CONSTEXPR uint32_t start_line = 5;
+}
+
+/** Strings of profile are referenced by index in string table. The first string must be empty. */
+class StringTable EASY_FINAL
+{
+    std::unordered_map<std::string, uint64_t> m_indices;
+    std::vector<const std::string*>            m_strings;
+
+public:
+
+    StringTable()
+    {
+        index(std::string());
+    }
+
+    uint64_t index(const std::string& _string)
+    {
+        const auto it = m_indices.emplace(_string, static_cast<uint64_t>(m_strings.size()));
+        if (it.second)
+            m_strings.push_back(&it.first->first);
+        return it.first->second;
+    }
+
+    void writeTo(ProtobufMessage& _profile) const
+    {
+        for (auto str : m_strings)
+            _profile.string(Profile::string_table, *str);
+    }
+
+}; // end of class StringTable.
+
+void valueType(ProtobufMessage& _profile, uint32_t _field, StringTable& _strings, const char* _type, const char* _unit)
+{
+    ProtobufMessage message;
+    message.varint(ValueType::type, _strings.index(_type));
+    message.varint(ValueType::unit, _strings.index(_unit));
+    _profile.message(_field, message);
+}
+
+// Location and function ids are equal to frame + 1 (0 is invalid id)
+uint64_t frameId(uint32_t _frame)
+{
+    return static_cast<uint64_t>(_frame) + 1;
+}
+
+bool writeProfile(const std::string& _filename, const std::string& _data)
+{
+#ifdef EASY_CONVERTER_ZLIB
+    gzFile file = gzopen(_filename.c_str(), "wb");
+    if (file == nullptr)
+    {
+        ::std::cout << "Can not open " << _filename << " for writing\n";
+        return true; // error is already reported
+    }
+
+    const bool good = _data.empty() || gzwrite(file, _data.data(), static_cast<unsigned>(_data.size())) > 0;
+    return gzclose(file) == Z_OK && good;
+#else
+    // pprof reads not compressed profiles as well
+    FILE* file = openOutputFile(_filename, true);
+    if (file == nullptr)
+        return true; // error is already reported
+
+    const bool good = fwrite(_data.data(), 1, _data.size(), file) == _data.size();
+    closeOutputFile(file);
+    return good;
+#endif
+}
+
+} // END of namespace <noname>.
+
+void PprofExporter::convert(const ::std::string& inputFile, const ::std::string& outputFile) const
+{
+    profiler::reader::FileReader fr;
+    if (fr.readFile(inputFile) == 0)
+        return;
+
+    if (outputFile.empty())
+    {
+        ::std::cout << "Output file is required for binary pprof profile\n";
+        return;
+    }
+
+    CallPathTrie trie;
+    trie.build(fr);
+
+    StringTable strings;
+    ProtobufMessage profile, message, line;
+
+    valueType(profile, Profile::sample_type, strings, "calls", "count");
+    valueType(profile, Profile::sample_type, strings, "time", "nanoseconds");
+    valueType(profile, Profile::period_type, strings, "time", "nanoseconds");
+    profile.varint(Profile::period, 1);
+
+    const auto& nodes = trie.nodes();
+    std::vector<char> described;
+    std::vector<uint64_t> locations, values(2);
+
+    for (uint32_t i = 1; i < nodes.size(); ++i)
+    {
+        const auto& node = nodes[i];
+
+        // Function and location are described before the first sample with this frame
+        if (described.size() <= node.frame)
+            described.resize(node.frame + 1, 0);
+
+        if (described[node.frame] == 0)
+        {
+            described[node.frame] = 1;
+
+            const auto id = frameId(node.frame);
+            const auto name = strings.index(trie.frameName(fr, node.frame));
+            int64_t lineNumber = 0;
+
+            message.clear();
+            message.varint(Function::id, id);
+            message.varint(Function::name, name);
+            message.varint(Function::system_name, name);
+            if (!trie.isThreadFrame(node.frame))
+            {
+                const auto& descriptor = fr.getBlockDescriptors()[node.frame];
+                lineNumber = descriptor.lineNumber;
+                message.varint(Function::filename, strings.index(descriptor.fileName));
+                message.varint(Function::start_line, static_cast<uint64_t>(lineNumber));
+            }
+            profile.message(Profile::function, message);
+
+            line.clear();
+            line.varint(Line::function_id, id);
+            line.varint(Line::line, static_cast<uint64_t>(lineNumber));
+
+            message.clear();
+            message.varint(Location::id, id);
+            message.message(Location::line, line);
+            profile.message(Profile::location, message);
+        }
+
+        if (trie.isThreadFrame(node.frame))
+            continue;
+
+        // Locations of sample are listed from the leaf to the root
+        locations.clear();
+        for (auto index = i; index != CallPathTrie::ROOT; index = nodes[index].parent)
+            locations.push_back(frameId(nodes[index].frame));
+
+        values[0] = node.calls;
+        values[1] = node.exclusive;
+
+        message.clear();
+        message.packedVarints(Sample::location_id, locations);
+        message.packedVarints(Sample::value, values);
+        profile.message(Profile::sample, message);
+    }
+
+    strings.writeTo(profile);
+
+    if (!writeProfile(outputFile, profile.data()))
+        ::std::cout << "Can not write pprof output\n";
+}
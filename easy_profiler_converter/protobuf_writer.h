@@ -0,0 +1,165 @@
+/**
+Lightweight profiler library for c++
+Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+
+Licensed under either of
+	* MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+    * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+at your option.
+
+The MIT License
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+	of the Software, and to permit persons to whom the Software is furnished
+	to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+	PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+	LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+	USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+The Apache License, Version 2.0 (the "License");
+	You may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+**/
+
+#ifndef EASY_PROFILER_CONVERTER_PROTOBUF_WRITER_H
+#define EASY_PROFILER_CONVERTER_PROTOBUF_WRITER_H
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "output_file.h"
+
+/** Minimal encoder of protobuf messages (wire format only, no schema).
+
+Fields are appended in the call order. Nested message is encoded separately and then added with message().
+*/
+class ProtobufMessage EASY_FINAL
+{
+    std::string m_data; ///< Encoded fields
+
+public:
+
+    enum WireType : uint32_t
+    {
+        Varint = 0,
+        Fixed64 = 1,
+        LengthDelimited = 2
+    };
+
+    const std::string& data() const {
+        return m_data;
+    }
+
+    bool empty() const {
+        return m_data.empty();
+    }
+
+    /** Clears contents keeping allocated memory. */
+    void clear() {
+        m_data.clear();
+    }
+
+    void varint(uint32_t _field, uint64_t _value) {
+        tag(_field, Varint);
+        rawVarint(_value);
+    }
+
+    /** int32 is encoded as sign extended int64. */
+    void int32(uint32_t _field, int32_t _value) {
+        varint(_field, static_cast<uint64_t>(static_cast<int64_t>(_value)));
+    }
+
+    /** Writes packed repeated varint field. */
+    void packedVarints(uint32_t _field, const std::vector<uint64_t>& _values) {
+        size_t size = 0;
+        char buffer[10];
+        for (auto value : _values)
+            size += encodeVarint(buffer, value);
+
+        tag(_field, LengthDelimited);
+        rawVarint(size);
+        for (auto value : _values)
+            rawVarint(value);
+    }
+
+    void fixedDouble(uint32_t _field, double _value) {
+        uint64_t bits = 0;
+        memcpy(&bits, &_value, sizeof(bits));
+        tag(_field, Fixed64);
+        for (int i = 0; i < 8; ++i, bits >>= 8)
+            m_data.push_back(static_cast<char>(bits & 0xff));
+    }
+
+    void bytes(uint32_t _field, const char* _data, size_t _size) {
+        tag(_field, LengthDelimited);
+        rawVarint(_size);
+        m_data.append(_data, _size);
+    }
+
+    void string(uint32_t _field, const std::string& _value) {
+        bytes(_field, _value.data(), _value.size());
+    }
+
+    void string(uint32_t _field, const char* _value) {
+        bytes(_field, _value, strlen(_value));
+    }
+
+    void message(uint32_t _field, const ProtobufMessage& _message) {
+        bytes(_field, _message.m_data.data(), _message.m_data.size());
+    }
+
+    /** Writes this message into _output as length delimited field _field of enclosing message. */
+    void writeTo(OutputFile& _output, uint32_t _field) const {
+        char header[16];
+        size_t size = encodeVarint(header, (static_cast<uint64_t>(_field) << 3) | LengthDelimited);
+        size += encodeVarint(header + size, m_data.size());
+        _output.write(header, size);
+        _output.write(m_data.data(), m_data.size());
+    }
+
+private:
+
+    void tag(uint32_t _field, WireType _type) {
+        rawVarint((static_cast<uint64_t>(_field) << 3) | _type);
+    }
+
+    void rawVarint(uint64_t _value) {
+        char buffer[10];
+        m_data.append(buffer, encodeVarint(buffer, _value));
+    }
+
+    static size_t encodeVarint(char* _buffer, uint64_t _value) {
+        size_t size = 0;
+        while (_value >= 0x80)
+        {
+            _buffer[size++] = static_cast<char>((_value & 0x7f) | 0x80);
+            _value >>= 7;
+        }
+        _buffer[size++] = static_cast<char>(_value);
+        return size;
+    }
+
+}; // end of class ProtobufMessage.
+
+#endif // EASY_PROFILER_CONVERTER_PROTOBUF_WRITER_H
@@ -40,15 +40,52 @@ The Apache License, Version 2.0 (the "License");
 
 **/
 
+#include <string.h>
 #include <algorithm>
 #include <fstream>
-#include <deque>
-#include <functional>
 
 #include "reader.h"
 
 //////////////////////////////////////////////////////////////////////////
 
+namespace {
+
+template <class T>
+double load(const char* _data)
+{
+    T value;
+    memcpy(&value, _data, sizeof(T));
+    return static_cast<double>(value);
+}
+
+bool scalarValue(const profiler::ArbitraryValue& _value, double& _result)
+{
+    if (_value.isArray())
+        return false;
+
+    const char* data = _value.data();
+    switch (_value.type())
+    {
+        case profiler::DataType::Bool: _result = *data != 0 ? 1 : 0; return true;
+        case profiler::DataType::Char: _result = static_cast<double>(*data); return true;
+        case profiler::DataType::Int8: _result = load<int8_t>(data); return true;
+        case profiler::DataType::Uint8: _result = load<uint8_t>(data); return true;
+        case profiler::DataType::Int16: _result = load<int16_t>(data); return true;
+        case profiler::DataType::Uint16: _result = load<uint16_t>(data); return true;
+        case profiler::DataType::Int32: _result = load<int32_t>(data); return true;
+        case profiler::DataType::Uint32: _result = load<uint32_t>(data); return true;
+        case profiler::DataType::Int64: _result = load<int64_t>(data); return true;
+        case profiler::DataType::Uint64: _result = load<uint64_t>(data); return true;
+        case profiler::DataType::Float: _result = load<float>(data); return true;
+        case profiler::DataType::Double: _result = load<double>(data); return true;
+        default: return false;
+    }
+}
+
+} // END of namespace <noname>.
+
+//////////////////////////////////////////////////////////////////////////
+
 namespace profiler
 {
 
@@ -57,24 +94,24 @@ namespace reader
 
 profiler::block_index_t FileReader::readFile(const std::string& filename)
 {
-    profiler::SerializedData serialized_blocks, serialized_descriptors;
     profiler::descriptors_list_t descriptors;
-    profiler::blocks_t blocks;
-    profiler::thread_blocks_tree_t threaded_trees;
-    profiler::bookmarks_t bookmarks;
     profiler::BeginEndTime beginEndTime;
 
     profiler::processid_t pid = 0;
+    profiler::timestamp_t block_overhead = 0;
     uint32_t total_descriptors_number = 0;
 
     EASY_CONSTEXPR bool DoNotGatherStats = false;
-    const auto blocks_number = ::fillTreesFromFile(filename.c_str(), beginEndTime, serialized_blocks, serialized_descriptors,
-        descriptors, blocks, threaded_trees, bookmarks, total_descriptors_number, m_version, pid, DoNotGatherStats,
-        m_errorMessage);
+    const auto blocks_number = ::fillTreesFromFile(filename.c_str(), beginEndTime, m_serializedBlocks,
+        m_serializedDescriptors, descriptors, m_blocks, m_threadTrees, m_bookmarks, total_descriptors_number,
+        m_version, pid, block_overhead, DoNotGatherStats, m_errorMessage);
 
     if (blocks_number == 0)
         return 0;
 
+    m_pid = pid;
+
+    // Names and file names are not copied: they point into serialized descriptors and blocks which are kept loaded
     m_blockDescriptors.reserve(descriptors.size());
     uint32_t descId = 0;
     for (auto descriptor : descriptors)
@@ -86,87 +123,78 @@ profiler::block_index_t FileReader::readFile(const std::string& filename)
         desc.argbColor = descriptor->color();
         desc.blockType = static_cast<decltype(desc.blockType)>(descriptor->type());
         desc.status = descriptor->status();
-
-        if (desc.parentId == desc.id) // compile time descriptor and name
-            desc.blockName = descriptor->name();
-
+        desc.blockName = desc.parentId == desc.id ? descriptor->name() : nullptr; // compile time descriptor and name
         desc.fileName = descriptor->file();
-        m_blockDescriptors.push_back(std::move(desc));
+        m_blockDescriptors.push_back(desc);
     }
 
     descriptors.clear();
-    serialized_descriptors.clear();
 
-    for (auto& kv : threaded_trees)
-    {
-        auto& thread = kv.second;
-        auto& root = m_blocksTree[kv.first];
-        auto& cswitches = m_contextSwitches[kv.first];
+    const auto valueType = static_cast<decltype(BlockDescriptor::blockType)>(profiler::BlockType::Value);
+    std::vector<profiler::block_index_t> stack;
 
-        root.info.descriptor = nullptr;
-        if (!thread.children.empty())
-        {
-            root.info.beginTime = blocks[thread.children.front()].node->begin();
-            root.info.endTime = blocks[thread.children.back()].node->end();
-        }
-        else
-        {
-            root.info.beginTime = 0;
-            root.info.endTime = 0;
-        }
+    // Threads are sorted by id to make output independent of hash table order
+    m_threads.reserve(m_threadTrees.size());
+    for (const auto& kv : m_threadTrees)
+        m_threads.push_back(kv.first);
+    std::sort(m_threads.begin(), m_threads.end());
 
-        m_threadNames[kv.first] = std::move(thread.thread_name);
+    for (const auto& kv : m_threadTrees)
+    {
+        const auto& thread = kv.second;
 
+        auto& cswitches = m_contextSwitches[kv.first];
         cswitches.reserve(thread.sync.size());
         for (auto i : thread.sync)
         {
-            auto baseData = blocks[i].cs;
+            auto baseData = m_blocks[i].cs;
             cswitches.emplace_back(ContextSwitchEvent {baseData->begin(), baseData->end(), baseData->tid(), baseData->name()});
         }
 
-        using child_t = std::pair<profiler::block_index_t, std::reference_wrapper<BlocksTreeNode> >;
-        using children_queue_t = std::deque<child_t>;
-        children_queue_t queue;
-
-        root.children.reserve(thread.children.size());
-        for (auto i : thread.children)
-            queue.emplace_back(i, std::ref(root));
-
-        while (!queue.empty())
+        // Walk the tree in place (in pre-order) to find names of runtime named blocks and to gather values
+        auto& values = m_values[kv.first];
+        stack.assign(thread.children.rbegin(), thread.children.rend());
+        while (!stack.empty())
         {
-            auto current = queue.front();
-            queue.pop_front();
-
-            const profiler::BlocksTree& block = blocks[current.first];
-            BlocksTreeNode& parent = current.second;
-
-            parent.children.emplace_back();
-            auto& child = parent.children.back();
-
-            child.children.reserve(block.children.size());
-            for (auto i : block.children)
-                queue.emplace_back(i, std::ref(child));
+            const profiler::BlocksTree& block = m_blocks[stack.back()];
+            stack.pop_back();
+            stack.insert(stack.end(), block.children.rbegin(), block.children.rend());
 
             auto& descriptor = m_blockDescriptors[block.node->id()];
-            if (descriptor.parentId != descriptor.id && descriptor.blockName.empty())
+            if (descriptor.blockName == nullptr)
                 descriptor.blockName = block.node->name(); // runtime name
 
-            auto& info = child.info;
-            info.beginTime = block.node->begin();
-            info.endTime = block.node->end();
-            info.descriptor = &descriptor;
-            info.blockIndex = current.first;
+            double value = 0;
+            if (descriptor.blockType == valueType && scalarValue(*block.value, value))
+                values.emplace_back(ValueEvent {block.node->begin(), &descriptor, value});
         }
+
+        std::stable_sort(values.begin(), values.end(), [](const ValueEvent& a, const ValueEvent& b) {
+            return a.time < b.time;
+        });
     }
 
-    m_bookmarks.swap(bookmarks);
+    // Runtime descriptors which are not used by any block of threads trees (for example, async spans)
+    for (auto& descriptor : m_blockDescriptors)
+    {
+        if (descriptor.blockName == nullptr)
+            descriptor.blockName = "";
+    }
 
     return blocks_number;
 }
 
-const thread_blocks_tree_t& FileReader::getBlocksTree() const
+const thread_ids_t& FileReader::getThreads() const
 {
-    return m_blocksTree;
+    return m_threads;
+}
+
+BlocksRange FileReader::getThreadBlocks(profiler::thread_id_t threadId) const
+{
+    auto it = m_threadTrees.find(threadId);
+    if (it == m_threadTrees.end())
+        return BlocksRange(*this, m_emptyBlocks);
+    return BlocksRange(*this, it->second.children);
 }
 
 const descriptors_list_t& FileReader::getBlockDescriptors() const
@@ -181,10 +209,10 @@ const profiler::bookmarks_t& FileReader::getBookmarks() const
 
 const std::string& FileReader::getThreadName(uint64_t threadId) const
 {
-    auto it = m_threadNames.find(threadId);
-    if (it == m_threadNames.end())
+    auto it = m_threadTrees.find(threadId);
+    if (it == m_threadTrees.end())
         return m_emptyString;
-    return it->second;
+    return it->second.thread_name;
 }
 
 uint32_t FileReader::getVersion() const
@@ -204,6 +232,16 @@ const context_switches_t& FileReader::getContextSwitches() const
     return m_contextSwitches;
 }
 
+const values_t& FileReader::getValues() const
+{
+    return m_values;
+}
+
+profiler::processid_t FileReader::getProcessId() const
+{
+    return m_pid;
+}
+
 } // end of namespace reader.
 
 } // end of namespace profiler.
@@ -50,61 +50,110 @@ The Apache License, Version 2.0 (the "License");
 
 #include <easy/easy_protocol.h>
 #include <easy/reader.h>
+#include <easy/serialized_block.h>
 #include <easy/utility.h>
 
 namespace profiler {
 
 namespace reader {
 
-class BlocksTreeNode;
-using thread_blocks_tree_t = ::std::unordered_map<::profiler::thread_id_t, BlocksTreeNode, ::estd::hash<::profiler::thread_id_t> >;
-using thread_names_t = ::std::unordered_map<::profiler::thread_id_t, ::std::string>;
+using thread_ids_t = ::std::vector<::profiler::thread_id_t>;
 using context_switches_list_t = ::std::vector<ContextSwitchEvent>;
 using context_switches_t = ::std::unordered_map<::profiler::thread_id_t, context_switches_list_t, ::estd::hash<::profiler::thread_id_t> >;
 using descriptors_list_t = ::std::vector<BlockDescriptor>;
+using values_list_t = ::std::vector<ValueEvent>;
+using values_t = ::std::unordered_map<::profiler::thread_id_t, values_list_t, ::estd::hash<::profiler::thread_id_t> >;
 
-class BlocksTreeNode EASY_FINAL
+class FileReader;
+class BlocksRange;
+
+/** Reference to a block of the loaded blocks tree (no data is copied).
+
+It is valid while FileReader is alive.
+*/
+class BlockRef EASY_FINAL
 {
+    const FileReader*           m_reader;
+    ::profiler::block_index_t    m_index;
+
 public:
 
-    using children_t = ::std::vector<BlocksTreeNode>;
+    BlockRef(const FileReader& reader, ::profiler::block_index_t index) : m_reader(&reader), m_index(index)
+    {
+    }
+
+    ///< index of the block in the loaded blocks list
+    ::profiler::block_index_t index() const { return m_index; }
+
+    uint64_t beginTime() const;
+    uint64_t endTime() const;
+    const BlockDescriptor& descriptor() const;
+
+    ///< arbitrary value data (only for blocks with BlockType::Value descriptor)
+    const ::profiler::ArbitraryValue& value() const;
 
-    BlockInfo                   info;
-    children_t              children;
-    BlocksTreeNode* parent = nullptr;
+    BlocksRange children() const;
 
-    BlocksTreeNode(BlocksTreeNode&& other) EASY_NOEXCEPT
-        : info(other.info)
-        , children(::std::move(other.children))
-        , parent(other.parent)
+}; // end of class BlockRef.
+
+/** Range of blocks: children of a block or top-level blocks of a thread. */
+class BlocksRange EASY_FINAL
+{
+    const FileReader*                   m_reader;
+    const ::profiler::block_index_t*     m_begin;
+    const ::profiler::block_index_t*       m_end;
+
+public:
+
+    class const_iterator EASY_FINAL
     {
-    }
+        const FileReader*              m_reader;
+        const ::profiler::block_index_t* m_item;
+
+    public:
+
+        const_iterator(const FileReader& reader, const ::profiler::block_index_t* item) : m_reader(&reader), m_item(item) {}
 
-    BlocksTreeNode& operator = (BlocksTreeNode&& other) EASY_NOEXCEPT
+        BlockRef operator * () const { return BlockRef(*m_reader, *m_item); }
+        const_iterator& operator ++ () { ++m_item; return *this; }
+        bool operator == (const const_iterator& other) const { return m_item == other.m_item; }
+        bool operator != (const const_iterator& other) const { return m_item != other.m_item; }
+    };
+
+    BlocksRange(const FileReader& reader, const ::profiler::BlocksTree::children_t& indices)
+        : m_reader(&reader), m_begin(indices.data()), m_end(indices.data() + indices.size())
     {
-        info = other.info;
-        children = ::std::move(other.children);
-        parent = other.parent;
-        return *this;
     }
 
-    BlocksTreeNode() = default;
-    ~BlocksTreeNode() = default;
+    const_iterator begin() const { return const_iterator(*m_reader, m_begin); }
+    const_iterator end() const { return const_iterator(*m_reader, m_end); }
+    size_t size() const { return static_cast<size_t>(m_end - m_begin); }
+    bool empty() const { return m_begin == m_end; }
 
-    BlocksTreeNode(const BlocksTreeNode&) = delete;
-    BlocksTreeNode& operator = (const BlocksTreeNode&) = delete;
+}; // end of class BlocksRange.
 
-}; // end of class BlocksTreeNode.
+/** Loads .prof file and provides access to the blocks tree of the core reader in place.
 
+Converters walk blocks with BlockRef and BlocksRange, so the second copy of the blocks tree is never built.
+*/
 class FileReader EASY_FINAL
 {
+    friend BlockRef;
+
 public:
 
+    FileReader() = default;
+    FileReader(const FileReader&) = delete;
+    FileReader& operator = (const FileReader&) = delete;
+
     ///< initial read file with RAW data
     ::profiler::block_index_t readFile(const ::std::string& filename);
 
-    ///< get blocks tree
-    const thread_blocks_tree_t& getBlocksTree() const;
+    ///< get ids of all threads
+    const thread_ids_t& getThreads() const;
+
+    ///< get top-level blocks of the thread
+    BlocksRange getThreadBlocks(::profiler::thread_id_t threadId) const;
 
     const descriptors_list_t& getBlockDescriptors() const;
 
@@ -126,19 +175,56 @@ public:
     ///< get context switches
     const context_switches_t& getContextSwitches() const;
 
+    ///< get scalar arbitrary values of each thread sorted by time (arrays and strings are not included)
+    const values_t& getValues() const;
+
+    ///< get id of profiled process
+    ::profiler::processid_t getProcessId() const;
+
 private:
 
-    ::std::string             m_emptyString;
-    ::std::stringstream      m_errorMessage; ///< error log stream
-    thread_blocks_tree_t       m_blocksTree; ///< thread's blocks hierarchy
-    thread_names_t            m_threadNames; ///< [thread_id, thread_name]
-    context_switches_t    m_contextSwitches; ///< context switches info
-    descriptors_list_t   m_blockDescriptors; ///< block descriptors
-    profiler::bookmarks_t       m_bookmarks; ///< User bookmarks
-    uint32_t                      m_version; ///< .prof file version
+    ::std::string                     m_emptyString;
+    ::profiler::BlocksTree::children_t m_emptyBlocks;
+    ::std::stringstream              m_errorMessage; ///< error log stream
+    ::profiler::SerializedData     m_serializedBlocks; ///< blocks data (referenced by m_blocks)
+    ::profiler::SerializedData  m_serializedDescriptors; ///< descriptors data (referenced by m_blockDescriptors)
+    ::profiler::blocks_t                     m_blocks; ///< all blocks of the core reader
+    ::profiler::thread_blocks_tree_t   m_threadTrees; ///< thread's blocks hierarchy of the core reader
+    thread_ids_t                            m_threads; ///< thread ids sorted in ascending order
+    context_switches_t              m_contextSwitches; ///< context switches info
+    values_t                                 m_values; ///< scalar arbitrary values
+    descriptors_list_t             m_blockDescriptors; ///< block descriptors
+    profiler::bookmarks_t                 m_bookmarks; ///< User bookmarks
+    uint32_t                            m_version = 0; ///< .prof file version
+    ::profiler::processid_t                 m_pid = 0; ///< profiled process id
 
 }; // end of class FileReader.
 
+inline uint64_t BlockRef::beginTime() const
+{
+    return m_reader->m_blocks[m_index].node->begin();
+}
+
+inline uint64_t BlockRef::endTime() const
+{
+    return m_reader->m_blocks[m_index].node->end();
+}
+
+inline const BlockDescriptor& BlockRef::descriptor() const
+{
+    return m_reader->m_blockDescriptors[m_reader->m_blocks[m_index].node->id()];
+}
+
+inline const ::profiler::ArbitraryValue& BlockRef::value() const
+{
+    return *m_reader->m_blocks[m_index].value;
+}
+
+inline BlocksRange BlockRef::children() const
+{
+    return BlocksRange(*m_reader, m_reader->m_blocks[m_index].children);
+}
+
 } // end of namespace reader.
 
 } // end of namespace profiler.
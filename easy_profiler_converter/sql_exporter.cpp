@@ -0,0 +1,783 @@
+/**
+Lightweight profiler library for c++
+Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+
+Licensed under either of
+	* MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+    * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+at your option.
+
+The MIT License
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+	of the Software, and to permit persons to whom the Software is furnished
+	to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+	PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+	LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+	USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+The Apache License, Version 2.0 (the "License");
+	You may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+**/
+
+#include <errno.h>
+#include <stdio.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+# include <direct.h>
+#else
+# include <sys/stat.h>
+#endif
+
+#ifdef EASY_CONVERTER_SQLITE
+# include <sqlite3.h>
+#endif
+
+#include "converter.h"
+#include "output_file.h"
+
+namespace {
+
+struct TableSchema
+{
+    const char*       name;
+    const char* definition; ///< Columns with their types
+};
+
+const TableSchema THREADS = {"threads", "id INTEGER PRIMARY KEY, name TEXT"};
+const TableSchema DESCRIPTORS = {"descriptors", "id INTEGER PRIMARY KEY, parent_id INTEGER, name TEXT, file TEXT, line INTEGER, "
+                                                "type TEXT, color INTEGER"};
+const TableSchema BLOCKS = {"blocks", "id INTEGER PRIMARY KEY, thread_id INTEGER, parent_id INTEGER, depth INTEGER, "
+                                      "descriptor_id INTEGER, begin_ns INTEGER, end_ns INTEGER, duration_ns INTEGER"};
+const TableSchema CONTEXT_SWITCHES = {"context_switches", "thread_id INTEGER, begin_ns INTEGER, end_ns INTEGER, "
+                                                          "duration_ns INTEGER, target_thread_id INTEGER, target_process TEXT"};
+const TableSchema VALUES = {"arbitrary_values", "thread_id INTEGER, time_ns INTEGER, descriptor_id INTEGER, value REAL"};
+const TableSchema BOOKMARKS = {"bookmarks", "time_ns INTEGER, color INTEGER, text TEXT"};
+
+// Indexes are created after all rows are inserted: it is much faster than updating them on every insert
+const char* const INDEXES =
+    "CREATE INDEX blocks_descriptor ON blocks (descriptor_id);\n"
+    "CREATE INDEX blocks_parent ON blocks (parent_id);\n"
+    "CREATE VIEW named_blocks AS SELECT blocks.*, descriptors.name AS name, threads.name AS thread_name FROM blocks"
+    " JOIN descriptors ON descriptors.id = blocks.descriptor_id JOIN threads ON threads.id = blocks.thread_id;\n";
+
+EASY_CONSTEXPR uint64_t NO_PARENT = ~0ULL;
+EASY_CONSTEXPR size_t ROWS_BATCH_SIZE = 1 << 16; ///< Number of block rows passed from walking threads to SQLite writer at once
+
+std::string createTableStatement(const TableSchema& _table)
+{
+    return std::string("CREATE TABLE ") + _table.name + " (" + _table.definition + ");\n";
+}
+
+/** Column names without types: "id, name" for "id INTEGER PRIMARY KEY, name TEXT". */
+std::vector<std::string> columnNames(const TableSchema& _table)
+{
+    std::vector<std::string> names(1);
+    bool skip = false;
+    for (const char* c = _table.definition; *c != 0; ++c)
+    {
+        if (*c == ',')
+        {
+            names.emplace_back();
+            skip = false;
+        }
+        else if (*c == ' ')
+        {
+            skip = !names.back().empty();
+        }
+        else if (!skip)
+        {
+            names.back().push_back(*c);
+        }
+    }
+
+    return names;
+}
+
+const char* blockTypeName(uint8_t _type)
+{
+    switch (static_cast<profiler::BlockType>(_type))
+    {
+        case profiler::BlockType::Event: return "event";
+        case profiler::BlockType::Block: return "block";
+        case profiler::BlockType::Value: return "value";
+        case profiler::BlockType::Async: return "async";
+        case profiler::BlockType::Flow: return "flow";
+        case profiler::BlockType::Lock: return "lock";
+        default: return "unknown";
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+/** Writer of table rows: CSV file or SQLite table. */
+class TableWriter
+{
+public:
+
+    virtual ~TableWriter() {}
+
+    virtual void integer(int64_t _value) = 0;
+    virtual void real(double _value) = 0;
+    virtual void text(const char* _value) = 0;
+    virtual void null() = 0;
+    virtual void endRow() = 0;
+
+    void integer(uint64_t _value)
+    {
+        integer(static_cast<int64_t>(_value));
+    }
+
+}; // end of class TableWriter.
+
+struct BlockRow
+{
+    uint64_t            id; ///< Index of the block in the loaded blocks list
+    uint64_t      threadId;
+    uint64_t      parentId; ///< NO_PARENT for top-level blocks
+    uint64_t     beginTime;
+    uint64_t       endTime;
+    uint32_t  descriptorId;
+    uint32_t         depth; ///< 0 for top-level blocks
+};
+
+void writeBlockRow(TableWriter& _table, const BlockRow& _row)
+{
+    _table.integer(_row.id);
+    _table.integer(_row.threadId);
+    if (_row.parentId != NO_PARENT)
+        _table.integer(_row.parentId);
+    else
+        _table.null();
+    _table.integer(static_cast<int64_t>(_row.depth));
+    _table.integer(static_cast<int64_t>(_row.descriptorId));
+    _table.integer(_row.beginTime);
+    _table.integer(_row.endTime);
+    _table.integer(_row.endTime - _row.beginTime);
+    _table.endRow();
+}
+
+/** Calls _func(row) for every block of the subtree (parents before children). Values are skipped. */
+template <class TFunc>
+void walkBlocks(const profiler::reader::BlocksRange& _children, uint64_t _threadId, uint64_t _parentId,
+                uint32_t _depth, TFunc& _func)
+{
+    for (const auto block : _children)
+    {
+        const auto& descriptor = block.descriptor();
+        if (descriptor.blockType == static_cast<uint8_t>(profiler::BlockType::Value))
+            continue; // values are exported into arbitrary_values table
+
+        const BlockRow row = {block.index(), _threadId, _parentId, block.beginTime(), block.endTime(), descriptor.id, _depth};
+        _func(row);
+
+        walkBlocks(block.children(), _threadId, block.index(), _depth + 1, _func);
+    }
+}
+
+void writeThreads(TableWriter& _table, const profiler::reader::FileReader& _reader)
+{
+    for (const auto threadId : _reader.getThreads())
+    {
+        _table.integer(static_cast<uint64_t>(threadId));
+        _table.text(_reader.getThreadName(threadId).c_str());
+        _table.endRow();
+    }
+}
+
+void writeDescriptors(TableWriter& _table, const profiler::reader::FileReader& _reader)
+{
+    for (const auto& descriptor : _reader.getBlockDescriptors())
+    {
+        _table.integer(static_cast<int64_t>(descriptor.id));
+        _table.integer(static_cast<int64_t>(descriptor.parentId));
+        _table.text(descriptor.blockName);
+        _table.text(descriptor.fileName);
+        _table.integer(static_cast<int64_t>(descriptor.lineNumber));
+        _table.text(blockTypeName(descriptor.blockType));
+        _table.integer(static_cast<int64_t>(descriptor.argbColor));
+        _table.endRow();
+    }
+}
+
+void writeContextSwitches(TableWriter& _table, const profiler::reader::FileReader& _reader)
+{
+    const auto& contextSwitches = _reader.getContextSwitches();
+    for (const auto threadId : _reader.getThreads())
+    {
+        const auto it = contextSwitches.find(threadId);
+        if (it == contextSwitches.end())
+            continue;
+
+        for (const auto& event : it->second)
+        {
+            _table.integer(static_cast<uint64_t>(threadId));
+            _table.integer(event.beginTime);
+            _table.integer(event.endTime);
+            _table.integer(event.endTime - event.beginTime);
+            _table.integer(event.targetThreadId);
+            _table.text(event.targetProcess.c_str());
+            _table.endRow();
+        }
+    }
+}
+
+void writeValues(TableWriter& _table, const profiler::reader::FileReader& _reader)
+{
+    const auto& values = _reader.getValues();
+    for (const auto threadId : _reader.getThreads())
+    {
+        const auto it = values.find(threadId);
+        if (it == values.end())
+            continue;
+
+        for (const auto& value : it->second)
+        {
+            _table.integer(static_cast<uint64_t>(threadId));
+            _table.integer(value.time);
+            _table.integer(static_cast<int64_t>(value.descriptor->id));
+            _table.real(value.value);
+            _table.endRow();
+        }
+    }
+}
+
+void writeBookmarks(TableWriter& _table, const profiler::reader::FileReader& _reader)
+{
+    for (const auto& bookmark : _reader.getBookmarks())
+    {
+        _table.integer(bookmark.pos);
+        _table.integer(static_cast<int64_t>(bookmark.color));
+        _table.text(bookmark.text.c_str());
+        _table.endRow();
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+class CsvTable EASY_FINAL : public TableWriter
+{
+    OutputFile& m_output;
+    bool      m_newRow = true;
+
+public:
+
+    explicit CsvTable(OutputFile& _output) : m_output(_output)
+    {
+    }
+
+    ~CsvTable() override {}
+
+    void header(const TableSchema& _table)
+    {
+        for (const auto& name : columnNames(_table))
+        {
+            separate();
+            m_output.write(name.data(), name.size());
+        }
+
+        endRow();
+    }
+
+    void integer(int64_t _value) override
+    {
+        separate();
+
+        char digits[24];
+        char* const end = digits + sizeof(digits);
+        char* begin = end;
+
+        auto value = _value < 0 ? 0 - static_cast<uint64_t>(_value) : static_cast<uint64_t>(_value);
+        do {
+            *--begin = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while (value != 0);
+
+        if (_value < 0)
+            *--begin = '-';
+
+        m_output.write(begin, static_cast<size_t>(end - begin));
+    }
+
+    void real(double _value) override
+    {
+        separate();
+
+        char buffer[32];
+        const int size = snprintf(buffer, sizeof(buffer), "%.*g", std::numeric_limits<double>::max_digits10, _value);
+        if (size > 0)
+            m_output.write(buffer, static_cast<size_t>(size));
+    }
+
+    void text(const char* _value) override
+    {
+        separate();
+
+        // Strings are always quoted, quotes are doubled
+        m_output.put('"');
+        for (; *_value != 0; ++_value)
+        {
+            if (*_value == '"')
+                m_output.put('"');
+            m_output.put(*_value);
+        }
+        m_output.put('"');
+    }
+
+    void null() override
+    {
+        separate(); // empty field
+    }
+
+    void endRow() override
+    {
+        m_output.put('\n');
+        m_newRow = true;
+    }
+
+    using TableWriter::integer;
+
+private:
+
+    void separate()
+    {
+        if (!m_newRow)
+            m_output.put(',');
+        m_newRow = false;
+    }
+
+}; // end of class CsvTable.
+
+bool createDirectory(const std::string& _path)
+{
+#ifdef _WIN32
+    return _mkdir(_path.c_str()) == 0 || errno == EEXIST;
+#else
+    return mkdir(_path.c_str(), 0755) == 0 || errno == EEXIST;
+#endif
+}
+
+/** Writes one CSV table with header into _directory. */
+template <class TWrite>
+bool writeCsvTable(const std::string& _directory, const TableSchema& _table, TWrite _write)
+{
+    FILE* file = openOutputFile(_directory + "/" + _table.name + ".csv", false);
+    if (file == nullptr)
+        return false;
+
+    {
+        OutputFile output(file);
+        CsvTable table(output);
+        table.header(_table);
+        _write(table, output, file);
+    }
+
+    const bool good = ferror(file) == 0;
+    closeOutputFile(file);
+
+    return good;
+}
+
+bool writeSchemaScript(const std::string& _directory)
+{
+    FILE* file = openOutputFile(_directory + "/schema.sql", false);
+    if (file == nullptr)
+        return false;
+
+    fputs("-- Loads CSV tables into SQLite database. Run from this directory: sqlite3 capture.db < schema.sql\n", file);
+    for (const auto table : {&THREADS, &DESCRIPTORS, &BLOCKS, &CONTEXT_SWITCHES, &VALUES, &BOOKMARKS})
+        fputs(createTableStatement(*table).c_str(), file);
+
+    for (const auto table : {&THREADS, &DESCRIPTORS, &BLOCKS, &CONTEXT_SWITCHES, &VALUES, &BOOKMARKS})
+        fprintf(file, ".import --csv --skip 1 %s.csv %s\n", table->name, table->name);
+
+    fputs("UPDATE blocks SET parent_id = NULL WHERE parent_id = '';\n", file); // empty CSV fields are imported as ''
+    fputs(INDEXES, file);
+
+    const bool good = ferror(file) == 0;
+    closeOutputFile(file);
+
+    return good;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+#ifdef EASY_CONVERTER_SQLITE
+
+EASY_CONSTEXPR int64_t ROWS_PER_TRANSACTION = 1 << 20;
+
+class SqliteDatabase EASY_FINAL
+{
+    sqlite3*     m_db = nullptr;
+    int64_t m_rows = 0; ///< Rows inserted in current transaction
+
+public:
+
+    SqliteDatabase() = default;
+    SqliteDatabase(const SqliteDatabase&) = delete;
+    SqliteDatabase& operator = (const SqliteDatabase&) = delete;
+
+    ~SqliteDatabase()
+    {
+        if (m_db != nullptr)
+            sqlite3_close(m_db);
+    }
+
+    bool open(const std::string& _filename)
+    {
+        remove(_filename.c_str()); // tables are always created from scratch
+        if (sqlite3_open(_filename.c_str(), &m_db) == SQLITE_OK)
+            return true;
+
+        ::std::cout << "Can not open " << _filename << " for writing\n";
+        return false;
+    }
+
+    sqlite3* handle() const
+    {
+        return m_db;
+    }
+
+    bool exec(const char* _sql)
+    {
+        char* error = nullptr;
+        if (sqlite3_exec(m_db, _sql, nullptr, nullptr, &error) == SQLITE_OK)
+            return true;
+
+        ::std::cout << "SQLite error: " << (error != nullptr ? error : sqlite3_errmsg(m_db)) << "\n";
+        sqlite3_free(error);
+        return false;
+    }
+
+    /** Bulk inserts: rows are inserted in large transactions. */
+    bool rowInserted()
+    {
+        if (++m_rows < ROWS_PER_TRANSACTION)
+            return true;
+
+        m_rows = 0;
+        return exec("COMMIT; BEGIN");
+    }
+
+}; // end of class SqliteDatabase.
+
+class SqliteTable EASY_FINAL : public TableWriter
+{
+    SqliteDatabase&    m_db;
+    sqlite3_stmt* m_insert = nullptr;
+    int             m_column = 0;
+    bool              m_good = true;
+
+public:
+
+    SqliteTable(SqliteDatabase& _db, const TableSchema& _table) : m_db(_db)
+    {
+        std::string sql = std::string("INSERT INTO ") + _table.name + " VALUES (?";
+        for (size_t i = 1, size = columnNames(_table).size(); i < size; ++i)
+            sql += ",?";
+        sql += ")";
+
+        if (sqlite3_prepare_v2(m_db.handle(), sql.c_str(), -1, &m_insert, nullptr) != SQLITE_OK)
+            fail();
+    }
+
+    ~SqliteTable() override
+    {
+        sqlite3_finalize(m_insert);
+    }
+
+    bool good() const
+    {
+        return m_good;
+    }
+
+    void integer(int64_t _value) override
+    {
+        if (m_good)
+            sqlite3_bind_int64(m_insert, ++m_column, static_cast<sqlite3_int64>(_value));
+    }
+
+    void real(double _value) override
+    {
+        if (m_good)
+            sqlite3_bind_double(m_insert, ++m_column, _value);
+    }
+
+    void text(const char* _value) override
+    {
+        if (m_good)
+            sqlite3_bind_text(m_insert, ++m_column, _value, -1, SQLITE_TRANSIENT);
+    }
+
+    void null() override
+    {
+        if (m_good)
+            sqlite3_bind_null(m_insert, ++m_column);
+    }
+
+    void endRow() override
+    {
+        m_column = 0;
+        if (!m_good)
+            return;
+
+        if (sqlite3_step(m_insert) != SQLITE_DONE)
+            fail();
+        else if (!m_db.rowInserted())
+            m_good = false;
+
+        sqlite3_reset(m_insert);
+    }
+
+    using TableWriter::integer;
+
+private:
+
+    void fail()
+    {
+        ::std::cout << "SQLite error: " << sqlite3_errmsg(m_db.handle()) << "\n";
+        m_good = false;
+    }
+
+}; // end of class SqliteTable.
+
+/** Batches of block rows produced by several walking threads and consumed by one SQLite writer. */
+class BlockRowsQueue EASY_FINAL
+{
+    using batch_t = std::vector<BlockRow>;
+
+    std::mutex                 m_mutex;
+    std::condition_variable   m_pushed;
+    std::condition_variable   m_popped;
+    std::deque<batch_t>      m_batches;
+    const size_t            m_capacity;
+    size_t                 m_producers;
+
+public:
+
+    BlockRowsQueue(size_t _capacity, size_t _producers) : m_capacity(_capacity), m_producers(_producers)
+    {
+    }
+
+    void push(batch_t& _batch)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_popped.wait(lock, [this] { return m_batches.size() < m_capacity; });
+        m_batches.push_back(std::move(_batch));
+        m_pushed.notify_one();
+
+        _batch.clear();
+        _batch.reserve(ROWS_BATCH_SIZE);
+    }
+
+    void finish()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        --m_producers;
+        m_pushed.notify_all();
+    }
+
+    bool pop(batch_t& _batch)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_pushed.wait(lock, [this] { return !m_batches.empty() || m_producers == 0; });
+        if (m_batches.empty())
+            return false;
+
+        _batch = std::move(m_batches.front());
+        m_batches.pop_front();
+        m_popped.notify_one();
+
+        return true;
+    }
+
+}; // end of class BlockRowsQueue.
+
+/** Rows are produced by walking threads in parallel and inserted by the calling thread. */
+bool insertBlocks(SqliteDatabase& _db, const profiler::reader::FileReader& _reader)
+{
+    const auto& threads = _reader.getThreads();
+    if (threads.empty())
+        return true;
+
+    const size_t workersNumber = std::min(static_cast<size_t>(std::max(std::thread::hardware_concurrency(), 1U)),
+                                          threads.size());
+
+    BlockRowsQueue queue(workersNumber * 2, workersNumber);
+    std::atomic<size_t> nextThread(0);
+    std::vector<std::thread> workers;
+
+    for (size_t i = 0; i < workersNumber; ++i)
+    {
+        workers.emplace_back([&]
+        {
+            std::vector<BlockRow> batch;
+            batch.reserve(ROWS_BATCH_SIZE);
+
+            auto add = [&] (const BlockRow& row)
+            {
+                batch.push_back(row);
+                if (batch.size() == ROWS_BATCH_SIZE)
+                    queue.push(batch);
+            };
+
+            for (auto index = nextThread++; index < threads.size(); index = nextThread++)
+            {
+                const auto threadId = threads[index];
+                walkBlocks(_reader.getThreadBlocks(threadId), threadId, NO_PARENT, 0, add);
+            }
+
+            if (!batch.empty())
+                queue.push(batch);
+
+            queue.finish();
+        });
+    }
+
+    SqliteTable table(_db, BLOCKS);
+    std::vector<BlockRow> batch;
+    while (queue.pop(batch))
+    {
+        // Rows are consumed even after an error, otherwise walking threads would wait forever
+        for (const auto& row : batch)
+            writeBlockRow(table, row);
+    }
+
+    for (auto& worker : workers)
+        worker.join();
+
+    return table.good();
+}
+
+template <class TWrite>
+bool insertRows(SqliteDatabase& _db, const TableSchema& _table, const profiler::reader::FileReader& _reader, TWrite _write)
+{
+    SqliteTable table(_db, _table);
+    _write(table, _reader);
+    return table.good();
+}
+
+#endif // EASY_CONVERTER_SQLITE
+
+} // END of namespace <noname>.
+
+void CsvExporter::convert(const ::std::string& inputFile, const ::std::string& outputFile) const
+{
+    profiler::reader::FileReader fr;
+    if (fr.readFile(inputFile) == 0)
+        return;
+
+    if (outputFile.empty())
+    {
+        ::std::cout << "Output directory is required for CSV tables\n";
+        return;
+    }
+
+    if (!createDirectory(outputFile))
+    {
+        ::std::cout << "Can not create directory " << outputFile << "\n";
+        return;
+    }
+
+    auto simple = [&fr] (void (*_write)(TableWriter&, const profiler::reader::FileReader&))
+    {
+        return [&fr, _write] (CsvTable& table, OutputFile&, FILE*) { _write(table, fr); };
+    };
+
+    bool good = writeSchemaScript(outputFile);
+    good = writeCsvTable(outputFile, THREADS, simple(writeThreads)) && good;
+    good = writeCsvTable(outputFile, DESCRIPTORS, simple(writeDescriptors)) && good;
+    good = writeCsvTable(outputFile, CONTEXT_SWITCHES, simple(writeContextSwitches)) && good;
+    good = writeCsvTable(outputFile, VALUES, simple(writeValues)) && good;
+    good = writeCsvTable(outputFile, BOOKMARKS, simple(writeBookmarks)) && good;
+
+    // Threads are written in parallel into separate sections which are appended in the original order
+    good = writeCsvTable(outputFile, BLOCKS, [&fr] (CsvTable&, OutputFile& output, FILE* file)
+    {
+        output.flush();
+
+        const auto& threads = fr.getThreads();
+        writeSections(file, threads.size(), [&](size_t i, FILE* sectionFile)
+        {
+            OutputFile section(sectionFile);
+            CsvTable table(section);
+            auto add = [&table] (const BlockRow& row) { writeBlockRow(table, row); };
+            walkBlocks(fr.getThreadBlocks(threads[i]), threads[i], NO_PARENT, 0, add);
+        });
+    }) && good;
+
+    if (!good)
+        ::std::cout << "Can not write CSV tables\n";
+}
+
+void SqliteExporter::convert(const ::std::string& inputFile, const ::std::string& outputFile) const
+{
+#ifdef EASY_CONVERTER_SQLITE
+    if (outputFile.empty())
+    {
+        ::std::cout << "Output file is required for SQLite database\n";
+        return;
+    }
+
+    profiler::reader::FileReader fr;
+    if (fr.readFile(inputFile) == 0)
+        return;
+
+    SqliteDatabase db;
+    if (!db.open(outputFile))
+        return;
+
+    // The database is written from scratch, so there is nothing to protect with journal
+    std::string schema = "PRAGMA journal_mode = OFF; PRAGMA synchronous = OFF; PRAGMA locking_mode = EXCLUSIVE;\n";
+    for (const auto table : {&THREADS, &DESCRIPTORS, &BLOCKS, &CONTEXT_SWITCHES, &VALUES, &BOOKMARKS})
+        schema += createTableStatement(*table);
+
+    if (!db.exec(schema.c_str()) || !db.exec("BEGIN"))
+        return;
+
+    const bool good = insertRows(db, THREADS, fr, writeThreads)
+                   && insertRows(db, DESCRIPTORS, fr, writeDescriptors)
+                   && insertRows(db, CONTEXT_SWITCHES, fr, writeContextSwitches)
+                   && insertRows(db, VALUES, fr, writeValues)
+                   && insertRows(db, BOOKMARKS, fr, writeBookmarks)
+                   && insertBlocks(db, fr)
+                   && db.exec("COMMIT")
+                   && db.exec(INDEXES);
+
+    if (!good)
+        ::std::cout << "Can not write SQLite database\n";
+#else
+    (void)inputFile;
+    (void)outputFile;
+    ::std::cout << "profiler_converter is built without SQLite: use CSV tables (-f csv) instead\n";
+#endif
+}
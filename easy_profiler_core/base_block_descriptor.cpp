@@ -52,6 +52,10 @@ namespace profiler
         , m_type(_block_type)
         , m_color(_color)
         , m_status(_status)
+        , m_samplingPolicy(SamplingPolicy::None)
+        , m_samplingValue(0)
+        , m_samplingWeight(1.f)
+        , m_categories(categories::Default)
     {
 
     }
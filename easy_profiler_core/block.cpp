@@ -113,7 +113,13 @@ Block::Block(const BaseBlockDescriptor* _descriptor, const char* _runtimeName, b
     , m_status(_descriptor->status())
     , m_isScoped(_scoped)
 {
-
+    if (!isCategoryEnabled(_descriptor))
+    {
+        // EASY_BLOCK skips blocks of disabled categories before construction (see LevelGate).
+        // Non-scoped block of disabled category is treated as disabled block: it is still pushed
+        // to the stack of opened blocks to keep EASY_END_BLOCK pairing, but it is never started or stored.
+        m_status = ::profiler::OFF;
+    }
 }
 
 void Block::start()
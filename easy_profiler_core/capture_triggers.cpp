@@ -0,0 +1,264 @@
+/**
+Lightweight profiler library for c++
+Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+
+Licensed under either of
+    * MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+    * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+at your option.
+
+The MIT License
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights 
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies 
+    of the Software, and to permit persons to whom the Software is furnished 
+    to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all 
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+    PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE 
+    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, 
+    TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE 
+    USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+The Apache License, Version 2.0 (the "License");
+    You may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+**/
+
+#include "capture_triggers.h"
+#include <algorithm>
+#include <cstring>
+#include "current_time.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+template <class T>
+double value_cast(const void* _data)
+{
+    T value;
+    memcpy(&value, _data, sizeof(T));
+    return static_cast<double>(value);
+}
+
+bool to_double(profiler::DataType _type, const void* _data, double& _value)
+{
+    switch (_type)
+    {
+        case profiler::DataType::Bool:   _value = value_cast<bool>(_data); return true;
+        case profiler::DataType::Char:   _value = value_cast<char>(_data); return true;
+        case profiler::DataType::Int8:   _value = value_cast<int8_t>(_data); return true;
+        case profiler::DataType::Uint8:  _value = value_cast<uint8_t>(_data); return true;
+        case profiler::DataType::Int16:  _value = value_cast<int16_t>(_data); return true;
+        case profiler::DataType::Uint16: _value = value_cast<uint16_t>(_data); return true;
+        case profiler::DataType::Int32:  _value = value_cast<int32_t>(_data); return true;
+        case profiler::DataType::Uint32: _value = value_cast<uint32_t>(_data); return true;
+        case profiler::DataType::Int64:  _value = value_cast<int64_t>(_data); return true;
+        case profiler::DataType::Uint64: _value = value_cast<uint64_t>(_data); return true;
+        case profiler::DataType::Float:  _value = value_cast<float>(_data); return true;
+        case profiler::DataType::Double: _value = value_cast<double>(_data); return true;
+        default: return false;
+    }
+}
+
+uint64_t double_bits(double _value)
+{
+    uint64_t bits;
+    memcpy(&bits, &_value, sizeof(bits));
+    return bits;
+}
+
+double bits_double(uint64_t _bits)
+{
+    double value;
+    memcpy(&value, &_bits, sizeof(value));
+    return value;
+}
+
+} // END of namespace <noname>.
+
+//////////////////////////////////////////////////////////////////////////
+
+CaptureTriggers::CaptureTriggers() : m_nextId(0)
+{
+    for (auto& slot : m_slots)
+    {
+        slot.descriptor = 0;
+        slot.threshold = 0;
+        slot.rule = 0;
+        slot.type = 0;
+    }
+
+    m_slotsNumber = 0;
+    m_rulesNumber = 0;
+    m_frameThreshold = 0;
+    m_frameRule = 0;
+    m_firedRule = 0;
+    m_firedTime = 0;
+}
+
+bool CaptureTriggers::remove(uint32_t _ruleId)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = std::find_if(m_rules.begin(), m_rules.end(), [_ruleId](const Rule& _rule) { return _rule.id == _ruleId; });
+    if (it == m_rules.end())
+        return false;
+
+    m_rules.erase(it);
+    update();
+
+    return true;
+}
+
+void CaptureTriggers::onDescriptorAdded(profiler::block_id_t _id, const char* _name, profiler::BlockType _type)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    bool changed = false;
+    for (auto& rule : m_rules)
+    {
+        if (matches(rule, _name, _type))
+        {
+            rule.descriptors.push_back(_id);
+            changed = true;
+        }
+    }
+
+    if (changed)
+        update();
+}
+
+uint32_t CaptureTriggers::fired(profiler::timestamp_t& _time) const
+{
+    const auto rule = m_firedRule.load(std::memory_order_acquire);
+    _time = m_firedTime.load(std::memory_order_acquire);
+    return rule;
+}
+
+void CaptureTriggers::rearm()
+{
+    m_firedRule.store(0, std::memory_order_release);
+}
+
+void CaptureTriggers::fire(uint32_t _ruleId)
+{
+    // Check before exchange to avoid cache line contention while previous trigger is being processed
+    uint32_t expected = 0;
+    if (m_firedRule.load(std::memory_order_relaxed) == 0 &&
+        m_firedRule.compare_exchange_strong(expected, _ruleId, std::memory_order_acq_rel))
+    {
+        m_firedTime.store(profiler::clock::now(), std::memory_order_release);
+    }
+}
+
+void CaptureTriggers::checkValueSlow(profiler::block_id_t _id, profiler::DataType _type, const void* _data)
+{
+    double value = 0;
+    bool converted = false;
+
+    const auto slotsNumber = m_slotsNumber.load(std::memory_order_relaxed);
+    for (uint32_t i = 0; i < slotsNumber; ++i)
+    {
+        const auto& slot = m_slots[i];
+        if (slot.descriptor.load(std::memory_order_relaxed) != _id)
+            continue;
+
+        const auto type = static_cast<Type>(slot.type.load(std::memory_order_relaxed));
+        if (type != Type::ValueAbove && type != Type::ValueBelow)
+            continue;
+
+        if (!converted)
+        {
+            if (!to_double(_type, _data, value))
+                return;
+            converted = true;
+        }
+
+        const auto threshold = bits_double(slot.threshold.load(std::memory_order_relaxed));
+        if (type == Type::ValueAbove ? value > threshold : value < threshold)
+            fire(slot.rule.load(std::memory_order_relaxed));
+    }
+}
+
+void CaptureTriggers::update()
+{
+    profiler::timestamp_t frameThreshold = 0;
+    uint32_t frameRule = 0, slotsNumber = 0;
+
+    // Hide slots while they are being rewritten
+    m_slotsNumber.store(0, std::memory_order_release);
+
+    for (const auto& rule : m_rules)
+    {
+        if (rule.type == Type::Frame)
+        {
+            const auto threshold = std::max(static_cast<profiler::timestamp_t>(rule.threshold), profiler::timestamp_t(1));
+            if (frameThreshold == 0 || threshold < frameThreshold)
+            {
+                frameThreshold = threshold;
+                frameRule = rule.id;
+            }
+
+            continue;
+        }
+
+        const auto threshold = rule.type == Type::BlockDuration ? static_cast<uint64_t>(rule.threshold)
+                                                                : double_bits(rule.threshold);
+
+        for (const auto descriptor : rule.descriptors)
+        {
+            if (slotsNumber == MAX_SLOTS)
+                break;
+
+            auto& slot = m_slots[slotsNumber++];
+            slot.descriptor.store(descriptor, std::memory_order_relaxed);
+            slot.threshold.store(threshold, std::memory_order_relaxed);
+            slot.rule.store(rule.id, std::memory_order_relaxed);
+            slot.type.store(static_cast<uint8_t>(rule.type), std::memory_order_relaxed);
+        }
+    }
+
+    m_frameRule.store(frameRule, std::memory_order_relaxed);
+    m_frameThreshold.store(frameThreshold, std::memory_order_release);
+    m_slotsNumber.store(slotsNumber, std::memory_order_release);
+    m_rulesNumber.store(static_cast<uint32_t>(m_rules.size()), std::memory_order_release);
+}
+
+bool CaptureTriggers::matches(const Rule& _rule, const char* _name, profiler::BlockType _type)
+{
+    switch (_rule.type)
+    {
+        case Type::BlockDuration:
+            if (_type != profiler::BlockType::Block)
+                return false;
+            break;
+
+        case Type::ValueAbove:
+        case Type::ValueBelow:
+            if (_type != profiler::BlockType::Value)
+                return false;
+            break;
+
+        default:
+            return false;
+    }
+
+    return _rule.name == _name;
+}
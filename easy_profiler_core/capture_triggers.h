@@ -0,0 +1,205 @@
+/**
+Lightweight profiler library for c++
+Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+
+Licensed under either of
+    * MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+    * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+at your option.
+
+The MIT License
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights 
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies 
+    of the Software, and to permit persons to whom the Software is furnished 
+    to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all 
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+    PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE 
+    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, 
+    TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE 
+    USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+The Apache License, Version 2.0 (the "License");
+    You may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+**/
+
+#ifndef EASY_PROFILER_CAPTURE_TRIGGERS_H
+#define EASY_PROFILER_CAPTURE_TRIGGERS_H
+
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <easy/details/profiler_public_types.h>
+#include <easy/details/arbitrary_value_public_types.h>
+
+//////////////////////////////////////////////////////////////////////////
+
+/** Rules which fire triggered capture (see profiler::addFrameTrigger(), profiler::addBlockTrigger(),
+profiler::addValueTrigger()).
+
+Rules are modified under mutex, but profiled threads read only atomic slots (one slot per matching
+descriptor), so checking costs one relaxed load if there are no rules.
+
+Only one trigger could be fired at a time: next one is accepted only after rearm().
+*/
+class CaptureTriggers EASY_FINAL
+{
+public:
+
+    enum class Type : uint8_t
+    {
+        Frame = 0,     ///< Main thread frame duration is greater than threshold (ticks)
+        BlockDuration, ///< Block duration is greater than threshold (ticks)
+        ValueAbove,    ///< Value is greater than threshold
+        ValueBelow,    ///< Value is less than threshold
+    };
+
+    /** Maximum number of descriptors which could be checked (extra matching descriptors are ignored). */
+    EASY_STATIC_CONSTEXPR uint32_t MAX_SLOTS = 64;
+
+private:
+
+    struct Rule
+    {
+        std::vector<profiler::block_id_t> descriptors; ///< Matching descriptors
+        std::string                              name; ///< Block or value name
+        double                              threshold;
+        uint32_t                                   id;
+        Type                                     type;
+    };
+
+    struct Slot
+    {
+        std::atomic<profiler::block_id_t> descriptor;
+        std::atomic<uint64_t>              threshold; ///< Ticks for BlockDuration, double bits for values
+        std::atomic<uint32_t>                   rule;
+        std::atomic<uint8_t>                    type;
+    };
+
+    Slot                              m_slots[MAX_SLOTS];
+    std::vector<Rule>                            m_rules;
+    std::mutex                                   m_mutex;
+    std::atomic<uint32_t>                  m_slotsNumber;
+    std::atomic<uint32_t>                  m_rulesNumber;
+    std::atomic<profiler::timestamp_t>  m_frameThreshold; ///< 0 means there are no frame rules
+    std::atomic<uint32_t>                    m_frameRule;
+    std::atomic<uint32_t>                    m_firedRule; ///< 0 if there is no fired trigger
+    std::atomic<profiler::timestamp_t>       m_firedTime;
+    uint32_t                                    m_nextId;
+
+public:
+
+    CaptureTriggers();
+
+    /** Adds new rule.
+
+    \param _threshold Duration in ticks for Frame and BlockDuration rules, value for ValueAbove and ValueBelow.
+    \param _descriptors List of all registered descriptors (id, name and BlockType are used).
+
+    \returns Rule id (never 0).
+    */
+    template <class TDescriptors>
+    uint32_t add(Type _type, const char* _name, double _threshold, const TDescriptors& _descriptors)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_rules.emplace_back();
+        auto& rule = m_rules.back();
+        rule.id = ++m_nextId;
+        rule.type = _type;
+        rule.threshold = _threshold;
+        if (_name != nullptr)
+            rule.name = _name;
+
+        if (_type != Type::Frame)
+        {
+            for (const auto descriptor : _descriptors)
+            {
+                if (matches(rule, descriptor->name(), descriptor->type()))
+                    rule.descriptors.push_back(descriptor->id());
+            }
+        }
+
+        update();
+
+        return rule.id;
+    }
+
+    bool remove(uint32_t _ruleId);
+
+    /** Is called for every new descriptor to check it against existing rules. */
+    void onDescriptorAdded(profiler::block_id_t _id, const char* _name, profiler::BlockType _type);
+
+    bool empty() const {
+        return m_rulesNumber.load(std::memory_order_relaxed) == 0;
+    }
+
+    void checkFrame(profiler::timestamp_t _duration)
+    {
+        const auto threshold = m_frameThreshold.load(std::memory_order_relaxed);
+        if (threshold != 0 && _duration > threshold)
+            fire(m_frameRule.load(std::memory_order_relaxed));
+    }
+
+    void checkBlock(profiler::block_id_t _id, profiler::timestamp_t _duration)
+    {
+        const auto slotsNumber = m_slotsNumber.load(std::memory_order_relaxed);
+        for (uint32_t i = 0; i < slotsNumber; ++i)
+        {
+            const auto& slot = m_slots[i];
+            if (slot.descriptor.load(std::memory_order_relaxed) == _id &&
+                slot.type.load(std::memory_order_relaxed) == static_cast<uint8_t>(Type::BlockDuration) &&
+                _duration > slot.threshold.load(std::memory_order_relaxed))
+            {
+                fire(slot.rule.load(std::memory_order_relaxed));
+            }
+        }
+    }
+
+    void checkValue(profiler::block_id_t _id, profiler::DataType _type, const void* _data)
+    {
+        if (m_slotsNumber.load(std::memory_order_relaxed) != 0)
+            checkValueSlow(_id, _type, _data);
+    }
+
+    /** Returns fired rule id (0 if there is no fired trigger) and time when it has been fired. */
+    uint32_t fired(profiler::timestamp_t& _time) const;
+
+    /** Allows to fire next trigger. */
+    void rearm();
+
+private:
+
+    void fire(uint32_t _ruleId);
+    void checkValueSlow(profiler::block_id_t _id, profiler::DataType _type, const void* _data);
+
+    /** Rebuilds slots. Must be called under m_mutex. */
+    void update();
+
+    static bool matches(const Rule& _rule, const char* _name, profiler::BlockType _type);
+
+}; // END of class CaptureTriggers.
+
+//////////////////////////////////////////////////////////////////////////
+
+#endif // EASY_PROFILER_CAPTURE_TRIGGERS_H
@@ -84,6 +84,20 @@ EASY_CONSTEXPR auto EASY_ALIGN_SIZE = EASY_ALIGNMENT_SIZE;
 
 //////////////////////////////////////////////////////////////////////////
 
+/** Marks profiler's own allocations in current thread.
+
+Heap allocation hooks (see profiler::storeAllocation) must not attribute these allocations to user blocks.
+*/
+struct InternalAllocationGuard EASY_FINAL
+{
+    static EASY_THREAD_LOCAL int32_t depth; ///< Number of internal allocations in progress in current thread
+
+    InternalAllocationGuard() { ++depth; }
+    ~InternalAllocationGuard() { --depth; }
+};
+
+//////////////////////////////////////////////////////////////////////////
+
 template <const uint16_t N>
 class chunk_allocator
 {
@@ -118,6 +132,7 @@ class chunk_allocator
 
         void emplace_back()
         {
+            InternalAllocationGuard guard;
             auto prev = last;
             last = ::new (EASY_MALLOC(sizeof(chunk), EASY_ALIGNMENT_SIZE)) chunk();
             last->prev = prev;
@@ -264,6 +279,18 @@ public:
     \warning Data will be cleared after serialization.
     */
     void serialize(std::ostream& _outputStream)
+    {
+        serialize(_outputStream, [] (const char*, uint16_t _size) { return _size; });
+    }
+
+    /** Serialize data to stream writing only first _usedSize(payload, payloadSize) bytes of each payload.
+
+    Used for elements which reserve more memory than they finally use.
+
+    \warning Data will be cleared after serialization.
+    */
+    template <class TUsedSize>
+    void serialize(std::ostream& _outputStream, TUsedSize _usedSize)
     {
         // Chunks are stored in reversed order (stack).
         // To be able to iterate them in direct order we have to invert the chunks list.
@@ -293,7 +320,16 @@ public:
             while (chunkOffset < maxOffset && payloadSize != 0)
             {
                 const uint16_t chunkSize = sizeof(uint16_t) + payloadSize;
-                _outputStream.write(data, chunkSize);
+                const uint16_t usedSize = _usedSize(data + sizeof(uint16_t), payloadSize);
+                if (usedSize == payloadSize)
+                {
+                    _outputStream.write(data, chunkSize);
+                }
+                else
+                {
+                    _outputStream.write(reinterpret_cast<const char*>(&usedSize), sizeof(uint16_t));
+                    _outputStream.write(data + sizeof(uint16_t), usedSize);
+                }
                 data += chunkSize;
                 chunkOffset += chunkSize;
                 unaligned_load16(data, &payloadSize);
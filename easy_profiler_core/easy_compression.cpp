@@ -0,0 +1,481 @@
+/**
+Lightweight profiler library for c++
+Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+
+Licensed under either of
+    * MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+    * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+at your option.
+
+The MIT License
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights 
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies 
+    of the Software, and to permit persons to whom the Software is furnished 
+    to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all 
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+    PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE 
+    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, 
+    TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE 
+    USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+The Apache License, Version 2.0 (the "License");
+    You may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+**/
+
+#include <algorithm>
+#include <string.h>
+#include <vector>
+#include <easy/easy_compression.h>
+#include <easy/easy_net.h>
+
+extern const uint32_t EASY_PROFILER_SIGNATURE;
+extern const uint32_t EASY_PROFILER_VERSION;
+
+namespace {
+
+//////////////////////////////////////////////////////////////////////////
+// LZ4 block format:
+// sequence = token(literals length << 4 | match length - 4), [literals length], literals, offset(uint16), [match length]
+
+EASY_CONSTEXPR size_t MIN_MATCH = 4;
+EASY_CONSTEXPR size_t LAST_LITERALS = 5; ///< Last bytes of the block are always literals
+EASY_CONSTEXPR size_t MF_LIMIT = 12; ///< Last match must start at least 12 bytes before the end of the block
+EASY_CONSTEXPR size_t MAX_OFFSET = 65535;
+EASY_CONSTEXPR uint32_t HASH_LOG = 16;
+EASY_CONSTEXPR size_t WILD_COPY = 16;
+
+inline uint32_t read32(const uint8_t* _ptr)
+{
+    uint32_t value;
+    memcpy(&value, _ptr, sizeof(value));
+    return value;
+}
+
+inline uint32_t hash4(uint32_t _value)
+{
+    return (_value * 2654435761U) >> (32 - HASH_LOG);
+}
+
+inline uint8_t* write_length(uint8_t* _output, size_t _length)
+{
+    for (; _length >= 255; _length -= 255)
+        *_output++ = 255;
+    *_output++ = static_cast<uint8_t>(_length);
+    return _output;
+}
+
+inline uint8_t* write_literals(uint8_t* _output, uint8_t* _token, const uint8_t* _literals, size_t _length)
+{
+    if (_length >= 15)
+    {
+        *_token = 15 << 4;
+        _output = write_length(_output, _length - 15);
+    }
+    else
+    {
+        *_token = static_cast<uint8_t>(_length << 4);
+    }
+
+    memcpy(_output, _literals, _length);
+    return _output + _length;
+}
+
+inline bool read_length(const uint8_t*& _input, const uint8_t* _end, size_t& _length)
+{
+    uint8_t value;
+    do {
+        if (_input == _end)
+            return false;
+        value = *_input++;
+        _length += value;
+    } while (value == 255);
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+struct ProfReader EASY_FINAL
+{
+    char* cur;
+    char* end;
+
+    bool skip(size_t _size)
+    {
+        if (static_cast<size_t>(end - cur) < _size)
+            return false;
+        cur += _size;
+        return true;
+    }
+
+    template <class T>
+    bool read(T& _value)
+    {
+        if (static_cast<size_t>(end - cur) < sizeof(T))
+            return false;
+        memcpy(&_value, cur, sizeof(T));
+        cur += sizeof(T);
+        return true;
+    }
+};
+
+/** Walks through serialized .prof data and calls _func(char* _event, uint64_t& _prevBegin) for each block and
+context switch. Every event starts with profiler::Event (begin and end timestamps).
+*/
+template <class TFunc>
+bool walk_events(char* _data, size_t _size, TFunc _func)
+{
+    ProfReader reader {_data, _data + _size};
+
+    uint32_t signature = 0, version = 0, blocks_number = 0, descriptors_count = 0, threads_count = 0;
+    if (!reader.read(signature) || signature != EASY_PROFILER_SIGNATURE || !reader.read(version) || version != EASY_PROFILER_VERSION)
+        return false;
+
+    // pid, cpu frequency, begin time, end time, used memory size, descriptors memory size
+    if (!reader.skip(sizeof(uint64_t) * 6))
+        return false;
+
+    if (!reader.read(blocks_number) || !reader.read(descriptors_count) || !reader.read(threads_count))
+        return false;
+
+    // bookmarks count, padding, block overhead
+    if (!reader.skip(sizeof(uint16_t) * 2 + sizeof(uint64_t)))
+        return false;
+
+    for (uint32_t i = 0; i < descriptors_count; ++i)
+    {
+        uint16_t size = 0;
+        if (!reader.read(size) || !reader.skip(size))
+            return false;
+    }
+
+    for (uint32_t i = 0; i < threads_count; ++i)
+    {
+        uint16_t name_size = 0;
+        if (!reader.skip(sizeof(uint64_t)) || !reader.read(name_size) || !reader.skip(name_size))
+            return false;
+
+        // Context switches and blocks
+        for (int list = 0; list < 2; ++list)
+        {
+            uint32_t events_count = 0;
+            if (!reader.read(events_count))
+                return false;
+
+            uint64_t prevBegin = 0;
+            for (uint32_t j = 0; j < events_count; ++j)
+            {
+                uint16_t size = 0;
+                if (!reader.read(size) || size < sizeof(uint64_t) * 2)
+                    return false;
+
+                char* event = reader.cur;
+                if (!reader.skip(size))
+                    return false;
+
+                _func(event, prevBegin);
+            }
+        }
+    }
+
+    uint32_t end_signature = 0;
+    return reader.read(end_signature) && end_signature == EASY_PROFILER_SIGNATURE;
+}
+
+inline uint64_t zigzag_encode(uint64_t _value)
+{
+    return (_value << 1) ^ static_cast<uint64_t>(static_cast<int64_t>(_value) >> 63);
+}
+
+inline uint64_t zigzag_decode(uint64_t _value)
+{
+    return (_value >> 1) ^ (0 - (_value & 1));
+}
+
+inline void read_event(const char* _event, uint64_t& _begin, uint64_t& _end)
+{
+    memcpy(&_begin, _event, sizeof(uint64_t));
+    memcpy(&_end, _event + sizeof(uint64_t), sizeof(uint64_t));
+}
+
+inline void write_event(char* _event, uint64_t _begin, uint64_t _end)
+{
+    memcpy(_event, &_begin, sizeof(uint64_t));
+    memcpy(_event + sizeof(uint64_t), &_end, sizeof(uint64_t));
+}
+
+} // end of namespace <noname>.
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace profiler { namespace net {
+
+PROFILER_API size_t compressBound(size_t _size)
+{
+    return _size + _size / 255 + 16;
+}
+
+PROFILER_API size_t compress(const char* _data, size_t _size, char* _output)
+{
+    const auto src = reinterpret_cast<const uint8_t*>(_data);
+    const auto end = src + _size;
+    auto op = reinterpret_cast<uint8_t*>(_output);
+
+    const uint8_t* anchor = src;
+
+    if (_size > MF_LIMIT)
+    {
+        const uint8_t* const matchLimit = end - LAST_LITERALS;
+        const uint8_t* const mfLimit = end - MF_LIMIT;
+
+        // Table contains positions of the last seen 4-byte sequences
+        std::vector<uint32_t> table(static_cast<size_t>(1) << HASH_LOG, 0);
+
+        const uint8_t* ip = src;
+        while (ip < mfLimit)
+        {
+            const uint32_t sequence = read32(ip);
+            uint32_t& entry = table[hash4(sequence)];
+            const uint8_t* ref = src + entry;
+            entry = static_cast<uint32_t>(ip - src);
+
+            if (ref >= ip || static_cast<size_t>(ip - ref) > MAX_OFFSET || read32(ref) != sequence)
+            {
+                // Move faster through incompressible data
+                ip += 1 + ((ip - anchor) >> 6);
+                continue;
+            }
+
+            const uint8_t* matchEnd = ip + MIN_MATCH;
+            for (const uint8_t* r = ref + MIN_MATCH; matchEnd < matchLimit && *matchEnd == *r; ++r)
+                ++matchEnd;
+
+            while (ip > anchor && ref > src && ip[-1] == ref[-1])
+            {
+                --ip;
+                --ref;
+            }
+
+            auto token = op++;
+            op = write_literals(op, token, anchor, static_cast<size_t>(ip - anchor));
+
+            const auto offset = static_cast<uint16_t>(ip - ref);
+            *op++ = static_cast<uint8_t>(offset & 0xff);
+            *op++ = static_cast<uint8_t>(offset >> 8);
+
+            const auto matchLength = static_cast<size_t>(matchEnd - ip) - MIN_MATCH;
+            if (matchLength >= 15)
+            {
+                *token |= 15;
+                op = write_length(op, matchLength - 15);
+            }
+            else
+            {
+                *token |= static_cast<uint8_t>(matchLength);
+            }
+
+            ip = anchor = matchEnd;
+            if (ip < mfLimit)
+                table[hash4(read32(ip - 2))] = static_cast<uint32_t>(ip - 2 - src);
+        }
+    }
+
+    // Last literals
+    auto token = op++;
+    op = write_literals(op, token, anchor, static_cast<size_t>(end - anchor));
+
+    return static_cast<size_t>(op - reinterpret_cast<uint8_t*>(_output));
+}
+
+PROFILER_API bool decompress(const char* _data, size_t _size, char* _output, size_t _outputSize)
+{
+    auto ip = reinterpret_cast<const uint8_t*>(_data);
+    const auto iend = ip + _size;
+    const auto dst = reinterpret_cast<uint8_t*>(_output);
+    auto op = dst;
+    const auto oend = dst + _outputSize;
+
+    while (ip < iend)
+    {
+        const uint8_t token = *ip++;
+
+        size_t length = token >> 4;
+        if (length == 15 && !read_length(ip, iend, length))
+            return false;
+
+        if (length > static_cast<size_t>(iend - ip) || length > static_cast<size_t>(oend - op))
+            return false;
+
+        if (length <= WILD_COPY && static_cast<size_t>(iend - ip) >= WILD_COPY && static_cast<size_t>(oend - op) >= WILD_COPY)
+            memcpy(op, ip, WILD_COPY); // Fixed size copy is much faster for short literals
+        else
+            memcpy(op, ip, length);
+        ip += length;
+        op += length;
+
+        if (ip == iend)
+            break; // The last sequence contains literals only
+
+        if (iend - ip < 2)
+            return false;
+
+        const size_t offset = static_cast<size_t>(ip[0]) | (static_cast<size_t>(ip[1]) << 8);
+        ip += 2;
+
+        if (offset == 0 || offset > static_cast<size_t>(op - dst))
+            return false;
+
+        length = token & 15;
+        if (length == 15 && !read_length(ip, iend, length))
+            return false;
+        length += MIN_MATCH;
+
+        if (length > static_cast<size_t>(oend - op))
+            return false;
+
+        const uint8_t* match = op - offset;
+        if (offset >= 8 && static_cast<size_t>(oend - op) >= length + 8)
+        {
+            // Copy by 8 bytes (could write up to 7 bytes after the match which would be overwritten later)
+            const auto matchEnd = op + length;
+            for (auto out = op; out < matchEnd; out += 8, match += 8)
+                memcpy(out, match, 8);
+            op = matchEnd;
+        }
+        else if (offset >= length)
+        {
+            memcpy(op, match, length);
+            op += length;
+        }
+        else
+        {
+            // Overlapped copy (repeating pattern)
+            for (const auto matchEnd = op + length; op != matchEnd;)
+                *op++ = *match++;
+        }
+    }
+
+    return op == oend;
+}
+
+PROFILER_API bool encodeTimestampDeltas(char* _data, size_t _size)
+{
+    const auto noop = [] (char*, uint64_t&) {};
+    if (!walk_events(_data, _size, noop))
+        return false;
+
+    return walk_events(_data, _size, [] (char* _event, uint64_t& _prevBegin)
+    {
+        uint64_t begin, end;
+        read_event(_event, begin, end);
+        write_event(_event, zigzag_encode(begin - _prevBegin), end - begin);
+        _prevBegin = begin;
+    });
+}
+
+PROFILER_API bool decodeTimestampDeltas(char* _data, size_t _size)
+{
+    const auto noop = [] (char*, uint64_t&) {};
+    if (!walk_events(_data, _size, noop))
+        return false;
+
+    return walk_events(_data, _size, [] (char* _event, uint64_t& _prevBegin)
+    {
+        uint64_t begin, duration;
+        read_event(_event, begin, duration);
+        begin = _prevBegin + zigzag_decode(begin);
+        write_event(_event, begin, begin + duration);
+        _prevBegin = begin;
+    });
+}
+
+PROFILER_API void packData(char* _data, size_t _size, uint8_t _flags, std::string& _output)
+{
+    if ((_flags & COMPRESSION_TIMESTAMP_DELTA) != 0 && !encodeTimestampDeltas(_data, _size))
+        _flags &= ~COMPRESSION_TIMESTAMP_DELTA;
+    _flags &= COMPRESSION_SUPPORTED;
+
+    const CompressedDataHeader header(_flags, _size);
+    _output.reserve(_output.size() + sizeof(header) + compressBound(_size) + (_size / COMPRESSION_CHUNK_SIZE + 1) * 8);
+    _output.append(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    std::vector<char> buffer((_flags & COMPRESSION_LZ4) != 0 ? compressBound(COMPRESSION_CHUNK_SIZE) : 0);
+    for (size_t offset = 0; offset < _size; offset += COMPRESSION_CHUNK_SIZE)
+    {
+        const auto rawSize = static_cast<uint32_t>(std::min(static_cast<size_t>(COMPRESSION_CHUNK_SIZE), _size - offset));
+        const char* chunk = _data + offset;
+
+        auto packedSize = rawSize;
+        if (!buffer.empty())
+        {
+            const auto size = compress(chunk, rawSize, buffer.data());
+            if (size < rawSize)
+            {
+                packedSize = static_cast<uint32_t>(size);
+                chunk = buffer.data();
+            }
+        }
+
+        _output.append(reinterpret_cast<const char*>(&rawSize), sizeof(rawSize));
+        _output.append(reinterpret_cast<const char*>(&packedSize), sizeof(packedSize));
+        _output.append(chunk, packedSize);
+    }
+}
+
+PROFILER_API bool unpackChunks(const char* _data, size_t _size, size_t& _consumed, std::string& _output)
+{
+    _consumed = 0;
+
+    while (_size - _consumed >= sizeof(uint32_t) * 2)
+    {
+        uint32_t rawSize = 0, packedSize = 0;
+        memcpy(&rawSize, _data + _consumed, sizeof(uint32_t));
+        memcpy(&packedSize, _data + _consumed + sizeof(uint32_t), sizeof(uint32_t));
+
+        if (rawSize > COMPRESSION_CHUNK_SIZE || packedSize > compressBound(rawSize))
+            return false;
+
+        if (_size - _consumed - sizeof(uint32_t) * 2 < packedSize)
+            break; // Wait for the rest of the chunk
+
+        const char* chunk = _data + _consumed + sizeof(uint32_t) * 2;
+        if (packedSize == rawSize)
+        {
+            _output.append(chunk, rawSize);
+        }
+        else
+        {
+            const auto outputSize = _output.size();
+            _output.resize(outputSize + rawSize);
+            if (!decompress(chunk, packedSize, &_output[outputSize], rawSize))
+            {
+                _output.resize(outputSize);
+                return false;
+            }
+        }
+
+        _consumed += sizeof(uint32_t) * 2 + packedSize;
+    }
+
+    return true;
+}
+
+} // END of namespace net.
+} // END of namespace profiler.
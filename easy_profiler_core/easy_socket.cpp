@@ -352,6 +352,45 @@ int EasySocket::accept()
     return (int)m_replySocket;
 }
 
+bool EasySocket::acceptConnection(EasySocket& _client)
+{
+    if (!checkSocket(m_socket))
+        return false;
+
+    const socket_t s = ::accept(m_socket, nullptr, nullptr);
+    if (!checkSocket(s))
+        return false;
+
+    ::setsockopt(s, SOL_SOCKET, SO_SNDBUF, (char*)&SEND_BUFFER_SIZE, sizeof(int));
+
+#if defined(__APPLE__)
+    // Apple doesn't have MSG_NOSIGNAL, work around it
+    const int value = 1;
+    ::setsockopt(s, SOL_SOCKET, SO_NOSIGPIPE, &value, sizeof(value));
+#endif
+
+    // Close the socket created by _client constructor.
+    // After that accepted socket is used both as "main" and as "reply" socket (the same as for connect()).
+    _client.flush();
+    _client.m_socket = s;
+    _client.m_replySocket = s;
+    _client.m_state = ConnectionState::Connected;
+
+    return true;
+}
+
+EasySocket::socket_t EasySocket::handle() const
+{
+    return checkSocket(m_replySocket) ? m_replySocket : m_socket;
+}
+
+void EasySocket::setBlocking(bool _blocking)
+{
+    const auto s = handle();
+    if (checkSocket(s))
+        setBlocking(s, _blocking);
+}
+
 bool EasySocket::setAddress(const char* address, uint16_t port)
 {
     m_server = ::gethostbyname(address);
@@ -0,0 +1,337 @@
+/**
+Lightweight profiler library for c++
+Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+
+Licensed under either of
+    * MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+    * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+at your option.
+
+The MIT License
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights 
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies 
+    of the Software, and to permit persons to whom the Software is furnished 
+    to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all 
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+    PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE 
+    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, 
+    TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE 
+    USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+The Apache License, Version 2.0 (the "License");
+    You may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+**/
+
+#ifndef EASY_PROFILER_FILE_FORMAT_H
+#define EASY_PROFILER_FILE_FORMAT_H
+
+#include <stdint.h>
+#include <istream>
+#include <limits>
+#include <ostream>
+
+#include <easy/serialized_block.h>
+
+//////////////////////////////////////////////////////////////////////////
+
+/** Reading of .prof file header and block descriptors (shared by reader and file merging). */
+
+extern const uint32_t EASY_PROFILER_SIGNATURE;
+extern const uint32_t EASY_PROFILER_VERSION;
+
+# define EASY_VERSION_INT(v_major, v_minor, v_patch) ((static_cast<uint32_t>(v_major) << 24) | \
+                                                      (static_cast<uint32_t>(v_minor) << 16) | \
+                                                       static_cast<uint32_t>(v_patch))
+
+EASY_CONSTEXPR uint32_t MIN_COMPATIBLE_VERSION = EASY_VERSION_INT(0, 1, 0); ///< minimal compatible version (.prof file format was not changed seriously since this version)
+EASY_CONSTEXPR uint32_t EASY_V_100 = EASY_VERSION_INT(1, 0, 0); ///< in v1.0.0 some additional data were added into .prof file
+EASY_CONSTEXPR uint32_t EASY_V_130 = EASY_VERSION_INT(1, 3, 0); ///< in v1.3.0 changed sizeof(thread_id_t) uint32_t -> uint64_t
+EASY_CONSTEXPR uint32_t EASY_V_200 = EASY_VERSION_INT(2, 0, 0); ///< in v2.0.0 file header was slightly rearranged
+EASY_CONSTEXPR uint32_t EASY_V_210 = EASY_VERSION_INT(2, 1, 0); ///< in v2.1.0 user bookmarks were added
+EASY_CONSTEXPR uint32_t EASY_V_220 = EASY_VERSION_INT(2, 2, 0); ///< in v2.2.0 sampling policy and categories were added into block descriptors, block overhead was added into file header
+
+# undef EASY_VERSION_INT
+
+EASY_CONSTEXPR uint64_t TIME_FACTOR = 1000000000ULL;
+
+inline bool isCompatibleVersion(uint32_t _version)
+{
+    return _version >= MIN_COMPATIBLE_VERSION;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+inline void read(std::istream& inStream, char* value, size_t size)
+{
+    inStream.read(value, size);
+}
+
+template <class T>
+inline void read(std::istream& inStream, T& value)
+{
+    read(inStream, (char*)&value, sizeof(T));
+}
+
+/// Size of fields which were added at the end of profiler::BaseBlockDescriptor in v2.2.0 (sampling and categories)
+EASY_CONSTEXPR uint16_t V220_DESCRIPTOR_FIELDS_SIZE = static_cast<uint16_t>(sizeof(profiler::SamplingPolicy) + sizeof(uint32_t)
+                                                                            + sizeof(float) + sizeof(profiler::category_t));
+
+inline uint64_t descriptorsMemorySize(uint64_t descriptors_memory_size, uint32_t descriptors_count, uint32_t version)
+{
+    return version < EASY_V_220 ? descriptors_memory_size + V220_DESCRIPTOR_FIELDS_SIZE * static_cast<uint64_t>(descriptors_count)
+                                : descriptors_memory_size;
+}
+
+/** Reads block descriptor of _size bytes into data.
+
+Descriptors of files older than v2.2.0 are converted to current layout (they have no sampling and categories fields),
+so data must have additional V220_DESCRIPTOR_FIELDS_SIZE bytes. Returns used memory size or 0 if _size is wrong.
+*/
+inline uint16_t readDescriptor(std::istream& inStream, char* data, uint16_t _size, uint32_t version)
+{
+    if (version >= EASY_V_220)
+    {
+        read(inStream, data, _size);
+        return _size;
+    }
+
+    EASY_CONSTEXPR uint16_t OldBaseSize = static_cast<uint16_t>(sizeof(profiler::BaseBlockDescriptor) - V220_DESCRIPTOR_FIELDS_SIZE);
+    if (_size < OldBaseSize)
+        return 0;
+
+    read(inStream, data, OldBaseSize);
+    read(inStream, data + sizeof(profiler::BaseBlockDescriptor), _size - OldBaseSize);
+    auto descriptor = reinterpret_cast<profiler::SerializedBlockDescriptor*>(data);
+    descriptor->setSampling(profiler::SamplingPolicy::None, 0, 1.f);
+    descriptor->setCategories(profiler::categories::Default);
+
+    return static_cast<uint16_t>(_size + V220_DESCRIPTOR_FIELDS_SIZE);
+}
+
+inline bool tryReadMarker(std::istream& inStream, uint32_t& marker)
+{
+    read(inStream, marker);
+    return marker == EASY_PROFILER_SIGNATURE;
+}
+
+inline bool tryReadMarker(std::istream& inStream)
+{
+    uint32_t marker = 0;
+    return tryReadMarker(inStream, marker);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+struct EasyFileHeader
+{
+    uint32_t signature = 0;
+    uint32_t version = 0;
+    profiler::processid_t pid = 0;
+    int64_t cpu_frequency = 0;
+    profiler::timestamp_t begin_time = 0;
+    profiler::timestamp_t end_time = 0;
+    uint64_t memory_size = 0;
+    uint64_t descriptors_memory_size = 0;
+    uint32_t blocks_count = 0;
+    uint32_t descriptors_count = 0;
+    uint32_t threads_count = 0;
+    uint16_t bookmarks_count = 0;
+    uint16_t padding = 0;
+    profiler::timestamp_t block_overhead = 0;
+};
+
+inline bool readHeader_v1(EasyFileHeader& _header, std::istream& inStream, std::ostream& _log)
+{
+    // File header before v2.0.0
+
+    if (_header.version > EASY_V_100)
+    {
+        if (_header.version < EASY_V_130)
+        {
+            uint32_t old_pid = 0;
+            read(inStream, old_pid);
+            _header.pid = old_pid;
+        }
+        else
+        {
+            read(inStream, _header.pid);
+        }
+    }
+
+    read(inStream, _header.cpu_frequency);
+    read(inStream, _header.begin_time);
+    read(inStream, _header.end_time);
+
+    read(inStream, _header.blocks_count);
+    if (_header.blocks_count == 0)
+    {
+        _log << "Profiled blocks number == 0";
+        return false;
+    }
+
+    read(inStream, _header.memory_size);
+    if (_header.memory_size == 0)
+    {
+        _log << "Wrong memory size == 0 for " << _header.blocks_count << " blocks";
+        return false;
+    }
+
+    read(inStream, _header.descriptors_count);
+    if (_header.descriptors_count == 0)
+    {
+        _log << "Blocks description number == 0";
+        return false;
+    }
+
+    read(inStream, _header.descriptors_memory_size);
+    if (_header.descriptors_memory_size == 0)
+    {
+        _log << "Wrong memory size == 0 for " << _header.descriptors_count << " blocks descriptions";
+        return false;
+    }
+
+    return true;
+}
+
+inline bool readHeader_v2(EasyFileHeader& _header, std::istream& inStream, std::ostream& _log)
+{
+    // File header after v2.0.0
+
+    read(inStream, _header.pid);
+    read(inStream, _header.cpu_frequency);
+    read(inStream, _header.begin_time);
+    read(inStream, _header.end_time);
+
+    read(inStream, _header.memory_size);
+    if (_header.memory_size == 0)
+    {
+        _log << "Wrong memory size == 0 for " << _header.blocks_count << " blocks";
+        return false;
+    }
+
+    read(inStream, _header.descriptors_memory_size);
+    if (_header.descriptors_memory_size == 0)
+    {
+        _log << "Wrong memory size == 0 for " << _header.descriptors_count << " blocks descriptions";
+        return false;
+    }
+
+    read(inStream, _header.blocks_count);
+    if (_header.blocks_count == 0)
+    {
+        _log << "Profiled blocks number == 0";
+        return false;
+    }
+
+    read(inStream, _header.descriptors_count);
+    if (_header.descriptors_count == 0)
+    {
+        _log << "Blocks description number == 0";
+        return false;
+    }
+
+    return true;
+}
+
+inline bool readHeader_v2_1(EasyFileHeader& _header, std::istream& inStream, std::ostream& _log)
+{
+    if (!readHeader_v2(_header, inStream, _log))
+        return false;
+
+    read(inStream, _header.threads_count);
+    if (_header.threads_count == 0)
+    {
+        _log << "Threads count == 0.\nNothing to read.";
+        return false;
+    }
+
+    read(inStream, _header.bookmarks_count);
+    read(inStream, _header.padding);
+
+    if (_header.padding != 0)
+    {
+        _log << "Header padding != 0.\nFile corrupted.";
+        return false;
+    }
+
+    return true;
+}
+
+inline bool readHeader_v2_2(EasyFileHeader& _header, std::istream& inStream, std::ostream& _log)
+{
+    if (!readHeader_v2_1(_header, inStream, _log))
+        return false;
+
+    read(inStream, _header.block_overhead);
+
+    return true;
+}
+
+/** Reads signature, version and header of any compatible version. */
+inline bool readHeader(EasyFileHeader& _header, std::istream& inStream, std::ostream& _log)
+{
+    uint32_t signature = 0;
+    if (!tryReadMarker(inStream, signature))
+    {
+        _log << "Wrong signature " << signature << ".\nThis is not EasyProfiler file/stream.";
+        return false;
+    }
+
+    uint32_t version = 0;
+    read(inStream, version);
+    if (!isCompatibleVersion(version))
+    {
+        _log << "Incompatible version: v"
+             << (version >> 24) << "." << ((version & 0x00ff0000) >> 16) << "." << (version & 0x0000ffff);
+        return false;
+    }
+
+    _header.signature = signature;
+    _header.version = version;
+
+    if (version < EASY_V_200)
+    {
+        if (!readHeader_v1(_header, inStream, _log))
+            return false;
+        _header.threads_count = std::numeric_limits<decltype(_header.threads_count)>::max();
+    }
+    else if (version < EASY_V_210)
+    {
+        if (!readHeader_v2(_header, inStream, _log))
+            return false;
+        _header.threads_count = std::numeric_limits<decltype(_header.threads_count)>::max();
+    }
+    else if (version < EASY_V_220)
+    {
+        if (!readHeader_v2_1(_header, inStream, _log))
+            return false;
+    }
+    else
+    {
+        if (!readHeader_v2_2(_header, inStream, _log))
+            return false;
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+#endif // EASY_PROFILER_FILE_FORMAT_H
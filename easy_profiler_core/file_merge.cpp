@@ -0,0 +1,817 @@
+/************************************************************************
+* file name         : file_merge.cpp
+* ----------------- :
+* creation time     : 2026/10/18
+* authors           : Sergey Yagovtsev, Victor Zarubkin
+* emails            : yse.sey@gmail.com, v.s.zarubkin@gmail.com
+* ----------------- :
+* description       : The file contains implementation of mergeProfFiles function
+*                   : which merges and slices .prof files without loading blocks trees.
+* ----------------- :
+* license           : Lightweight profiler library for c++
+*                   : Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+*                   :
+*                   : Licensed under either of
+*                   :     * MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+*                   :     * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+*                   : at your option.
+*                   :
+*                   : The MIT License
+*                   :
+*                   : Permission is hereby granted, free of charge, to any person obtaining a copy
+*                   : of this software and associated documentation files (the "Software"), to deal
+*                   : in the Software without restriction, including without limitation the rights
+*                   : to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+*                   : of the Software, and to permit persons to whom the Software is furnished
+*                   : to do so, subject to the following conditions:
+*                   :
+*                   : The above copyright notice and this permission notice shall be included in all
+*                   : copies or substantial portions of the Software.
+*                   :
+*                   : THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+*                   : INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+*                   : PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+*                   : LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+*                   : TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+*                   : USE OR OTHER DEALINGS IN THE SOFTWARE.
+*                   :
+*                   : The Apache License, Version 2.0 (the "License")
+*                   :
+*                   : You may not use this file except in compliance with the License.
+*                   : You may obtain a copy of the License at
+*                   :
+*                   : http://www.apache.org/licenses/LICENSE-2.0
+*                   :
+*                   : Unless required by applicable law or agreed to in writing, software
+*                   : distributed under the License is distributed on an "AS IS" BASIS,
+*                   : WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*                   : See the License for the specific language governing permissions and
+*                   : limitations under the License.
+************************************************************************/
+
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <easy/writer.h>
+
+#include "file_format.h"
+
+namespace {
+
+using profiler::timestamp_t;
+
+EASY_CONSTEXPR profiler::block_id_t NoId = ~0U;
+EASY_CONSTEXPR uint32_t ProgressStep = 0xffff; ///< Number of records between progress updates
+
+template <class T>
+void write(std::ostream& _stream, const T& _data)
+{
+    _stream.write((const char*)&_data, sizeof(T));
+}
+
+bool update_progress_merge(std::atomic<int>& progress, int new_value, std::ostream& _log)
+{
+    auto oldprogress = progress.exchange(new_value, std::memory_order_release);
+    if (oldprogress < 0)
+    {
+        _log << "Merging was interrupted";
+        return false;
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+/** Input file which is read sequentially: header, descriptors, threads sections and bookmarks. */
+struct MergeInput EASY_FINAL
+{
+    std::string                          filename;
+    std::ifstream                          stream;
+    EasyFileHeader                         header;
+    std::vector<profiler::block_id_t>       idmap; ///< Merged descriptor id for every descriptor id of this file (NoId for null descriptors)
+    std::vector<profiler::block_type_t>     types; ///< Block type for every descriptor id of this file
+    double                  conversion_factor = 1; ///< Nanoseconds per tick
+    int64_t                             shift = 0; ///< Shift of converted timestamps (in nanoseconds) on the merged timeline
+    uint64_t                             size = 0; ///< File size in bytes
+
+    timestamp_t toNanoseconds(timestamp_t _time) const
+    {
+        // The same conversion as fillTreesFromStream() does
+        return header.cpu_frequency != 0 ? static_cast<timestamp_t>(_time * conversion_factor) : _time;
+    }
+
+    timestamp_t toMerged(timestamp_t _time) const
+    {
+        return static_cast<timestamp_t>(static_cast<int64_t>(toNanoseconds(_time)) + shift);
+    }
+
+    /** Converts begin and end of the record (all records start with profiler::Event) into merged timeline. */
+    void convertRecord(char* _data) const
+    {
+        auto t = reinterpret_cast<timestamp_t*>(_data);
+        t[0] = toMerged(t[0]);
+        t[1] = toMerged(t[1]);
+    }
+};
+
+using inputs_t = std::vector<std::unique_ptr<MergeInput> >;
+
+//////////////////////////////////////////////////////////////////////////
+
+/** Kept time range on the merged timeline. */
+struct TimeWindow EASY_FINAL
+{
+    timestamp_t begin = 0;
+    timestamp_t   end = 0;
+
+    bool intersects(timestamp_t _begin, timestamp_t _end) const
+    {
+        return begin <= _end && _begin <= end;
+    }
+
+    bool contains(timestamp_t _begin, timestamp_t _end) const
+    {
+        return begin <= _begin && _end <= end;
+    }
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+/** Union of block descriptors of all inputs.
+
+Descriptors are compared by all their fields except id, so the same descriptor registered by several processes
+of the same application is stored once.
+*/
+class DescriptorsMerger EASY_FINAL
+{
+    std::unordered_map<std::string, profiler::block_id_t> m_ids;
+    std::vector<char>                              m_serialized; ///< [size][descriptor] records ready to be written
+    profiler::block_id_t                           m_count = 0;
+
+public:
+
+    /** Returns merged id of the descriptor. Id of new descriptor is written into _data. */
+    profiler::block_id_t add(char* _data, uint16_t _size)
+    {
+        std::string key(_data + sizeof(profiler::block_id_t), _size - sizeof(profiler::block_id_t));
+        auto it = m_ids.find(key);
+        if (it != m_ids.end())
+            return it->second;
+
+        const auto id = m_count++;
+        memcpy(_data, &id, sizeof(id)); // id is the first field of profiler::BaseBlockDescriptor
+
+        const auto offset = m_serialized.size();
+        m_serialized.resize(offset + sizeof(uint16_t) + _size);
+        memcpy(m_serialized.data() + offset, &_size, sizeof(uint16_t));
+        memcpy(m_serialized.data() + offset + sizeof(uint16_t), _data, _size);
+
+        m_ids.emplace(std::move(key), id);
+        return id;
+    }
+
+    profiler::block_id_t count() const
+    {
+        return m_count;
+    }
+
+    uint64_t memorySize() const
+    {
+        return m_serialized.size();
+    }
+
+    void write(std::ostream& _output) const
+    {
+        _output.write(m_serialized.data(), static_cast<std::streamsize>(m_serialized.size()));
+    }
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+/** Writes threads sections into output stream.
+
+Section is started only when the first record is added into it, so threads which have no records
+in the kept time range are not written. Records counters are patched when their lists are finished.
+*/
+class SectionsWriter EASY_FINAL
+{
+    std::ostream&                m_output;
+    std::string              m_threadName;
+    std::streampos             m_countPos;
+    profiler::thread_id_t      m_threadId = 0;
+    uint32_t                      m_count = 0;
+    bool                        m_started = false;
+    bool                         m_blocks = false;
+
+public:
+
+    uint64_t      memory_size = 0;
+    uint32_t     blocks_count = 0;
+    uint32_t    threads_count = 0;
+    timestamp_t    begin_time = std::numeric_limits<timestamp_t>::max();
+    timestamp_t      end_time = 0;
+
+    explicit SectionsWriter(std::ostream& _output) : m_output(_output)
+    {
+    }
+
+    void beginThread(profiler::thread_id_t _id, std::string _name)
+    {
+        m_threadId = _id;
+        m_threadName = std::move(_name);
+        m_started = false;
+        m_blocks = false;
+    }
+
+    /** Finishes context switches list and starts blocks list. */
+    void beginBlocks()
+    {
+        if (m_started)
+        {
+            patchCount();
+            startCount();
+        }
+
+        m_blocks = true;
+    }
+
+    void endThread()
+    {
+        if (m_started)
+            patchCount();
+    }
+
+    void addRecord(const char* _data, uint16_t _size)
+    {
+        if (!m_started)
+            startThread();
+
+        write(m_output, _size);
+        m_output.write(_data, _size);
+
+        auto t = reinterpret_cast<const timestamp_t*>(_data);
+        begin_time = std::min(begin_time, t[0]);
+        end_time = std::max(end_time, t[1]);
+
+        memory_size += _size;
+        ++blocks_count;
+        ++m_count;
+    }
+
+private:
+
+    void startThread()
+    {
+        const auto nameSize = static_cast<uint16_t>(m_threadName.size() + 1);
+        write(m_output, m_threadId);
+        write(m_output, nameSize);
+        m_output.write(m_threadName.c_str(), nameSize);
+
+        if (m_blocks)
+            write(m_output, static_cast<uint32_t>(0)); // no context switches
+
+        startCount();
+        m_started = true;
+        ++threads_count;
+    }
+
+    void startCount()
+    {
+        m_countPos = m_output.tellp();
+        m_count = 0;
+        write(m_output, m_count);
+    }
+
+    void patchCount()
+    {
+        const auto pos = m_output.tellp();
+        m_output.seekp(m_countPos);
+        write(m_output, m_count);
+        m_output.seekp(pos);
+    }
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+/** Values of value streams which cross the kept time range bounds.
+
+They are written as separate records in order of their time, like fillTreesFromStream() inserts expanded values.
+*/
+class PendingValues EASY_FINAL
+{
+    struct Value
+    {
+        timestamp_t         time;
+        uint64_t           order;
+        std::string       record;
+
+        bool operator > (const Value& other) const
+        {
+            return time > other.time || (time == other.time && order > other.order);
+        }
+    };
+
+    std::vector<Value>                      m_values;
+    std::vector<char>                       m_buffer;
+    std::vector<profiler::ArbitraryValue*> m_records;
+    uint64_t                                 m_order = 0;
+
+public:
+
+    void add(const profiler::ValueStream& _stream, const TimeWindow& _window)
+    {
+        m_buffer.resize(static_cast<size_t>(_stream.expanded_size()));
+        m_records.resize(_stream.count());
+        const auto count = _stream.expand(m_buffer.data(), m_records.data());
+
+        for (uint16_t i = 0; i < count; ++i)
+        {
+            const auto value = m_records[i];
+            if (!_window.intersects(value->begin(), value->begin()))
+                continue;
+
+            const auto size = sizeof(profiler::ArbitraryValue) + value->data_size();
+            m_values.push_back(Value {value->begin(), m_order++, std::string(reinterpret_cast<const char*>(value), size)});
+            std::push_heap(m_values.begin(), m_values.end(), std::greater<Value>());
+        }
+    }
+
+    /** Writes all values which time is not greater than _time. */
+    void flush(timestamp_t _time, SectionsWriter& _writer)
+    {
+        while (!m_values.empty() && m_values.front().time <= _time)
+        {
+            std::pop_heap(m_values.begin(), m_values.end(), std::greater<Value>());
+            const auto& record = m_values.back().record;
+            _writer.addRecord(record.data(), static_cast<uint16_t>(record.size()));
+            m_values.pop_back();
+        }
+    }
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+bool openInput(MergeInput& _input, std::ostream& _log)
+{
+    _input.stream.open(_input.filename, std::fstream::binary);
+    if (!_input.stream.is_open())
+    {
+        _log << "Can not open file " << _input.filename;
+        return false;
+    }
+
+    _input.stream.seekg(0, std::ios::end);
+    _input.size = static_cast<uint64_t>(_input.stream.tellg());
+    _input.stream.seekg(0, std::ios::beg);
+
+    if (!readHeader(_input.header, _input.stream, _log))
+    {
+        _log << "\nin file " << _input.filename;
+        return false;
+    }
+
+    auto& header = _input.header;
+    if (header.cpu_frequency != 0)
+    {
+        _input.conversion_factor = static_cast<double>(TIME_FACTOR) / static_cast<double>(header.cpu_frequency);
+        header.begin_time = _input.toNanoseconds(header.begin_time);
+        header.end_time = _input.toNanoseconds(header.end_time);
+        header.block_overhead = _input.toNanoseconds(header.block_overhead);
+    }
+
+    return true;
+}
+
+bool readDescriptors(MergeInput& _input, DescriptorsMerger& _descriptors, std::vector<char>& _buffer, std::ostream& _log)
+{
+    const auto& header = _input.header;
+    _input.idmap.reserve(header.descriptors_count);
+    _input.types.reserve(header.descriptors_count);
+
+    for (uint32_t i = 0; i < header.descriptors_count; ++i)
+    {
+        uint16_t sz = 0;
+        read(_input.stream, sz);
+        if (sz == 0)
+        {
+            _input.idmap.push_back(NoId);
+            _input.types.push_back(profiler::BlockType::Block);
+            continue;
+        }
+
+        sz = readDescriptor(_input.stream, _buffer.data(), sz, header.version);
+        if (sz <= sizeof(profiler::block_id_t) || !_input.stream)
+        {
+            _log << "Bad block descriptor size.\nFile " << _input.filename << " corrupted.";
+            return false;
+        }
+
+        const auto descriptor = reinterpret_cast<const profiler::SerializedBlockDescriptor*>(_buffer.data());
+        _input.types.push_back(descriptor->type());
+        _input.idmap.push_back(_descriptors.add(_buffer.data(), sz));
+    }
+
+    return true;
+}
+
+bool readRecord(MergeInput& _input, char* _data, uint16_t& _size, const char* _kind, std::ostream& _log)
+{
+    read(_input.stream, _size);
+    if (_size == 0)
+    {
+        _log << "Bad " << _kind << " size == 0.\nFile " << _input.filename << " corrupted.";
+        return false;
+    }
+
+    read(_input.stream, _data, _size);
+    if (!_input.stream)
+    {
+        _log << "Unexpected end of file " << _input.filename;
+        return false;
+    }
+
+    return true;
+}
+
+/** Process id for every written thread id. */
+using thread_owners_t = std::unordered_map<profiler::thread_id_t, profiler::processid_t>;
+
+/** Streams threads sections of the input into the output.
+
+Sections of the same thread are merged by the reader, so the same thread id of another process is replaced
+with the process id stored in the upper half of thread id.
+*/
+bool mergeThreads(MergeInput& _input, SectionsWriter& _writer, const TimeWindow& _window, const std::string& _namePrefix,
+                  thread_owners_t& _threadOwners, std::vector<char>& _buffer, std::atomic<int>& progress,
+                  uint64_t _processedSize, uint64_t _totalSize, std::ostream& _log)
+{
+    const auto& header = _input.header;
+    auto& inStream = _input.stream;
+    char* data = _buffer.data();
+
+    PendingValues pending_values;
+    std::vector<char> name;
+    uint32_t read_number = 0;
+
+    auto report_progress = [&] () -> bool
+    {
+        const auto pos = static_cast<uint64_t>(inStream.tellg());
+        return update_progress_merge(progress, 5 + static_cast<int>(90 * (_processedSize + pos) / _totalSize), _log);
+    };
+
+    for (uint32_t threads_read_number = 0; threads_read_number < header.threads_count; ++threads_read_number)
+    {
+        profiler::thread_id_t thread_id = 0;
+        if (header.version < EASY_V_130)
+        {
+            uint32_t thread_id32 = 0;
+            read(inStream, thread_id32);
+            thread_id = thread_id32;
+        }
+        else
+        {
+            read(inStream, thread_id);
+        }
+
+        if (inStream.eof())
+        {
+            if (header.version < EASY_V_210)
+                break; // Old files have no threads count in the header
+
+            _log << "Unexpected end of file " << _input.filename;
+            return false;
+        }
+
+        uint16_t name_size = 0;
+        read(inStream, name_size);
+        name.resize(name_size + 1);
+        read(inStream, name.data(), name_size);
+        name.back() = 0;
+
+        const auto owner = _threadOwners.emplace(thread_id, header.pid).first;
+        if (owner->second != header.pid)
+            thread_id = (static_cast<profiler::thread_id_t>(header.pid) << 32) | (thread_id & 0xffffffffULL);
+
+        _writer.beginThread(thread_id, _namePrefix + name.data());
+
+        uint32_t count = 0;
+        read(inStream, count);
+        for (uint32_t j = 0; j < count; ++j)
+        {
+            uint16_t sz = 0;
+            if (!readRecord(_input, data, sz, "CSwitch block", _log))
+                return false;
+
+            _input.convertRecord(data);
+
+            auto t = reinterpret_cast<const timestamp_t*>(data);
+            if (_window.intersects(t[0], t[1]))
+                _writer.addRecord(data, sz);
+
+            if ((++read_number & ProgressStep) == 0 && !report_progress())
+                return false;
+        }
+
+        _writer.beginBlocks();
+
+        read(inStream, count);
+        for (uint32_t j = 0; j < count; ++j)
+        {
+            uint16_t sz = 0;
+            if (!readRecord(_input, data, sz, "block", _log))
+                return false;
+
+            auto baseData = reinterpret_cast<profiler::SerializedBlock*>(data);
+            const auto id = baseData->id();
+            if (id >= _input.idmap.size() || _input.idmap[id] == NoId)
+            {
+                _log << "Bad block id == " << id << " in file " << _input.filename;
+                return false;
+            }
+
+            _input.convertRecord(data);
+            baseData->setId(_input.idmap[id]);
+
+            const auto begin = baseData->begin();
+            const auto end = baseData->end();
+
+            if (_input.types[id] == profiler::BlockType::Value && header.version >= EASY_V_220 &&
+                profiler::ValueStream::isValueStream(reinterpret_cast<const profiler::ArbitraryValue*>(data)))
+            {
+                // Value stream which crosses the range bounds is expanded: only a part of its samples is kept
+                if (_window.contains(begin, end))
+                    _writer.addRecord(data, sz);
+                else if (_window.intersects(begin, end))
+                    pending_values.add(*reinterpret_cast<const profiler::ValueStream*>(data), _window);
+            }
+            else if (_window.intersects(begin, end))
+            {
+                pending_values.flush(end, _writer);
+                _writer.addRecord(data, sz);
+            }
+
+            if ((++read_number & ProgressStep) == 0 && !report_progress())
+                return false;
+        }
+
+        pending_values.flush(std::numeric_limits<timestamp_t>::max(), _writer);
+        _writer.endThread();
+
+        if (!report_progress())
+            return false;
+    }
+
+    return true;
+}
+
+bool readBookmarks(MergeInput& _input, const TimeWindow& _window, profiler::bookmarks_t& _bookmarks, std::ostream& _log)
+{
+    const auto& header = _input.header;
+    auto& inStream = _input.stream;
+    if (header.version < EASY_V_210 || inStream.eof())
+        return true;
+
+    if (!tryReadMarker(inStream))
+    {
+        _log << "Bad threads section end mark.\nFile " << _input.filename << " corrupted.";
+        return false;
+    }
+
+    std::vector<char> stringBuffer;
+    for (uint16_t i = 0; i < header.bookmarks_count; ++i)
+    {
+        profiler::Bookmark bookmark;
+
+        uint16_t usedMemorySize = 0;
+        read(inStream, usedMemorySize);
+        read(inStream, bookmark.pos);
+        read(inStream, bookmark.color);
+
+        if (usedMemorySize < profiler::Bookmark::BaseSize || !inStream)
+        {
+            _log << "Bad bookmark size: " << usedMemorySize << ".\nFile " << _input.filename << " corrupted.";
+            return false;
+        }
+
+        // Bookmarks are always stored in nanoseconds
+        stringBuffer.resize(usedMemorySize - profiler::Bookmark::BaseSize + 2);
+        read(inStream, stringBuffer.data(), stringBuffer.size() - 1);
+        stringBuffer.back() = 0;
+
+        bookmark.pos = static_cast<timestamp_t>(static_cast<int64_t>(bookmark.pos) + _input.shift);
+        bookmark.text = stringBuffer.data();
+
+        if (_window.intersects(bookmark.pos, bookmark.pos))
+            _bookmarks.push_back(std::move(bookmark));
+    }
+
+    return true;
+}
+
+void writeHeader(std::ostream& _output, const MergeInput& _first, const SectionsWriter& _writer,
+                 const DescriptorsMerger& _descriptors, timestamp_t _beginTime, timestamp_t _endTime,
+                 uint16_t _bookmarksCount)
+{
+    write(_output, EASY_PROFILER_SIGNATURE);
+    write(_output, EASY_PROFILER_VERSION);
+    write(_output, _first.header.pid);
+
+    // write 0 because all timestamps are converted into nanoseconds
+    write<int64_t>(_output, 0LL); // CPU frequency
+
+    write(_output, _beginTime);
+    write(_output, _endTime);
+
+    write(_output, _writer.memory_size);
+    write(_output, _descriptors.memorySize());
+    write(_output, _writer.blocks_count);
+    write(_output, _descriptors.count());
+    write(_output, _writer.threads_count);
+    write(_output, _bookmarksCount);
+    write(_output, static_cast<uint16_t>(0)); // padding
+    write(_output, _first.header.block_overhead);
+}
+
+profiler::block_index_t mergeFiles(std::atomic<int>& progress, const std::vector<std::string>& input_files,
+                                   std::ostream& output, const profiler::MergeOptions& options, std::ostream& log)
+{
+    inputs_t inputs;
+    inputs.reserve(input_files.size());
+
+    DescriptorsMerger descriptors;
+    std::vector<char> buffer(std::numeric_limits<uint16_t>::max() + static_cast<size_t>(V220_DESCRIPTOR_FIELDS_SIZE) + 1);
+    std::unordered_set<profiler::processid_t> pids;
+    uint64_t total_size = 0;
+
+    // Read headers and descriptors of all inputs. Thread sections are read later one input after another.
+    for (const auto& filename : input_files)
+    {
+        inputs.emplace_back(new MergeInput());
+        auto& input = *inputs.back();
+        input.filename = filename;
+
+        if (!openInput(input, log) || !readDescriptors(input, descriptors, buffer, log))
+            return 0;
+
+        pids.insert(input.header.pid);
+        total_size += input.size;
+    }
+
+    if (!update_progress_merge(progress, 5, log))
+        return 0;
+
+    // Re-base timelines
+    const auto& first = *inputs.front();
+    timestamp_t merged_begin = std::numeric_limits<timestamp_t>::max(), merged_end = 0;
+    for (auto& input : inputs)
+    {
+        if (options.align_begin)
+            input->shift = static_cast<int64_t>(first.header.begin_time) - static_cast<int64_t>(input->header.begin_time);
+
+        merged_begin = std::min(merged_begin, static_cast<timestamp_t>(static_cast<int64_t>(input->header.begin_time) + input->shift));
+        merged_end = std::max(merged_end, static_cast<timestamp_t>(static_cast<int64_t>(input->header.end_time) + input->shift));
+    }
+
+    EASY_CONSTEXPR auto MaxTime = std::numeric_limits<timestamp_t>::max();
+
+    TimeWindow window;
+    window.begin = options.begin_time < MaxTime - merged_begin ? merged_begin + options.begin_time : MaxTime;
+    window.end = options.end_time < MaxTime - merged_begin ? merged_begin + options.end_time : MaxTime;
+    if (window.end < window.begin)
+    {
+        log << "Empty time range";
+        return 0;
+    }
+
+    // Header and counters are rewritten when all records are written
+    SectionsWriter writer(output);
+    writeHeader(output, first, writer, descriptors, 0, 0, 0);
+    descriptors.write(output);
+
+    uint64_t processed_size = 0;
+    profiler::bookmarks_t bookmarks;
+    thread_owners_t thread_owners;
+    for (auto& input : inputs)
+    {
+        const auto prefix = pids.size() > 1 ? "[" + std::to_string(input->header.pid) + "] " : std::string();
+        if (!mergeThreads(*input, writer, window, prefix, thread_owners, buffer, progress, processed_size, total_size, log) ||
+            !readBookmarks(*input, window, bookmarks, log))
+        {
+            return 0;
+        }
+
+        processed_size += input->size;
+        input->stream.close();
+    }
+
+    if (writer.blocks_count == 0)
+    {
+        log << "Nothing to save";
+        return 0;
+    }
+
+    std::stable_sort(bookmarks.begin(), bookmarks.end(), [](const profiler::Bookmark& a, const profiler::Bookmark& b)
+    {
+        return a.pos < b.pos;
+    });
+
+    if (bookmarks.size() > std::numeric_limits<uint16_t>::max())
+    {
+        log << "Too many bookmarks: only first " << std::numeric_limits<uint16_t>::max() << " are saved.\n";
+        bookmarks.resize(std::numeric_limits<uint16_t>::max());
+    }
+
+    // End of threads section
+    write(output, EASY_PROFILER_SIGNATURE);
+
+    for (const auto& bookmark : bookmarks)
+    {
+        const auto usedMemorySize = static_cast<uint16_t>(profiler::Bookmark::BaseSize + bookmark.text.size());
+        write(output, usedMemorySize);
+        write(output, bookmark.pos);
+        write(output, bookmark.color);
+        output.write(bookmark.text.c_str(), bookmark.text.size() + 1);
+    }
+
+    // End of bookmarks section
+    write(output, EASY_PROFILER_SIGNATURE);
+
+    // The same bounds as writeTreesToStream() stores: kept range extended by blocks crossing its bounds
+    auto begin_time = std::min(writer.begin_time, std::max(window.begin, merged_begin));
+    auto end_time = std::max(writer.end_time, std::min(window.end, merged_end));
+    if (!bookmarks.empty())
+    {
+        begin_time = std::min(begin_time, bookmarks.front().pos);
+        end_time = std::max(end_time, bookmarks.back().pos);
+    }
+
+    output.seekp(0);
+    writeHeader(output, first, writer, descriptors, begin_time, end_time, static_cast<uint16_t>(bookmarks.size()));
+    output.flush();
+
+    if (!output)
+    {
+        log << "Can not write output file";
+        return 0;
+    }
+
+    if (!update_progress_merge(progress, 100, log))
+        return 0;
+
+    return writer.blocks_count;
+}
+
+} // END of namespace <noname>.
+
+//////////////////////////////////////////////////////////////////////////
+
+extern "C" PROFILER_API profiler::block_index_t mergeProfFiles(std::atomic<int>& progress,
+                                                               const std::vector<std::string>& input_files,
+                                                               const char* output_file,
+                                                               const profiler::MergeOptions& options,
+                                                               std::ostream& log)
+{
+    if (!update_progress_merge(progress, 0, log))
+        return 0;
+
+    if (input_files.empty())
+    {
+        log << "No input files";
+        return 0;
+    }
+
+    if (std::find(input_files.begin(), input_files.end(), output_file) != input_files.end())
+    {
+        log << "Output file " << output_file << " is one of input files";
+        return 0;
+    }
+
+    // Large output buffer: records are small and there may be billions of them
+    std::vector<char> buffer(1 << 20);
+    std::ofstream output;
+    output.rdbuf()->pubsetbuf(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    output.open(output_file, std::fstream::binary);
+    if (!output.is_open())
+    {
+        log << "Can not open file " << output_file;
+        return 0;
+    }
+
+    const auto result = mergeFiles(progress, input_files, output, options, log);
+    output.close();
+
+    if (result == 0)
+        std::remove(output_file);
+
+    return result;
+}
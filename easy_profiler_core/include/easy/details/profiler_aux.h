@@ -74,8 +74,73 @@ namespace profiler {
         FORCE_ON_WITHOUT_CHILDREN = FORCE_ON | OFF_RECURSIVE, ///< The block is ALWAYS ON but all of it's children are OFF.
     };
 
+    /** Bitmask of block categories.
+
+    Block is stored only if at least one of it's categories is enabled (see setCategoriesEnabled()).
+
+    \sa profiler::categories
+    */
+    enum category_t : uint32_t { };
+
+    inline EASY_CONSTEXPR_FCN category_t operator | (category_t _a, category_t _b) {
+        return static_cast<category_t>(static_cast<uint32_t>(_a) | static_cast<uint32_t>(_b));
+    }
+
+    namespace categories {
+
+        EASY_CONSTEXPR category_t Default = static_cast<category_t>(1U << 0); ///< Blocks without explicit category
+        EASY_CONSTEXPR category_t Net     = static_cast<category_t>(1U << 1);
+        EASY_CONSTEXPR category_t Db      = static_cast<category_t>(1U << 2);
+        EASY_CONSTEXPR category_t IO      = static_cast<category_t>(1U << 3);
+        EASY_CONSTEXPR category_t Render  = static_cast<category_t>(1U << 4);
+        EASY_CONSTEXPR category_t Physics = static_cast<category_t>(1U << 5);
+        EASY_CONSTEXPR category_t Audio   = static_cast<category_t>(1U << 6);
+        EASY_CONSTEXPR category_t Alloc   = static_cast<category_t>(1U << 7);
+        EASY_CONSTEXPR category_t All     = static_cast<category_t>(0xffffffffU);
+
+        /** User-defined category. Bits 16..31 are reserved for them.
+
+        \param _index Index of user category in range [0, 15].
+        */
+        inline EASY_CONSTEXPR_FCN category_t user(uint32_t _index) {
+            return static_cast<category_t>(1U << (16 + _index));
+        }
+
+    } // END of namespace categories.
+
+    /** Compile-time level of block.
+
+    Blocks with level lower than EASY_PROFILER_MIN_LEVEL are compiled to nothing (see EASY_BLOCK).
+    Level is a type (not a value) so it could be extracted from macro arguments at compile-time
+    even if other arguments (color, for example) are known only at run-time.
+
+    \sa profiler::levels
+    */
+    template <int Level>
+    struct block_level EASY_FINAL {
+        EASY_STATIC_CONSTEXPR int value = Level;
+    };
+
+    namespace levels {
+
+        EASY_CONSTEXPR block_level<0> Fine     = {}; ///< Detailed blocks for performance builds only
+        EASY_CONSTEXPR block_level<1> Normal   = {}; ///< Blocks without explicit level
+        EASY_CONSTEXPR block_level<2> Coarse   = {}; ///< High-level blocks (frames, requests, jobs)
+        EASY_CONSTEXPR block_level<3> Critical = {}; ///< Blocks which are always compiled in
+
+    } // END of namespace levels.
+
 }
 
+/** Minimum level of blocks which are compiled into application (see profiler::levels).
+
+By default all blocks are compiled. Set EASY_PROFILER_MIN_LEVEL CMake option (or define this macro
+before including easy/profiler.h) to eliminate blocks of lower levels at compile-time.
+*/
+#ifndef EASY_PROFILER_MIN_LEVEL
+# define EASY_PROFILER_MIN_LEVEL 0
+#endif
+
 //////////////////////////////////////////////////////////////////////////
 
 # define EASY_STRINGIFY(a) #a
@@ -200,8 +265,59 @@ namespace profiler
 
     //***********************************************
 
+    template <class ... TArgs>
+    inline EASY_CONSTEXPR_FCN category_t extract_category(TArgs...);
+
+    template <>
+    inline EASY_CONSTEXPR_FCN category_t extract_category<>() {
+        return ::profiler::categories::Default;
+    }
+
+    template <class T>
+    inline EASY_CONSTEXPR_FCN category_t extract_category(T) {
+        return ::profiler::categories::Default;
+    }
+
+    template <>
+    inline EASY_CONSTEXPR_FCN category_t extract_category(category_t _categories) {
+        return _categories;
+    }
+
+    template <class ... TArgs>
+    inline EASY_CONSTEXPR_FCN category_t extract_category(category_t _categories, TArgs...) {
+        return _categories;
+    }
+
+    template <class T, class ... TArgs>
+    inline EASY_CONSTEXPR_FCN category_t extract_category(T, TArgs... _args) {
+        return extract_category(_args...);
+    }
+
+    //***********************************************
+
+    template <class ... TArgs>
+    struct level_of {
+        typedef block_level<1> type; // profiler::levels::Normal
+    };
+
+    template <int Level, class ... TArgs>
+    struct level_of<block_level<Level>, TArgs...> {
+        typedef block_level<Level> type;
+    };
+
+    template <class T, class ... TArgs>
+    struct level_of<T, TArgs...> : public level_of<TArgs...> {};
+
+    /** Used in unevaluated context only: decltype(extract_level(args...))::value is a level of block. */
+    template <class ... TArgs>
+    typename level_of<typename ::std::decay<TArgs>::type...>::type extract_level(TArgs&&...);
+
+    //***********************************************
+
 } // END of namespace profiler.
 
+# define EASY_LEVEL_ENABLED(...) (decltype(::profiler::extract_level(__VA_ARGS__))::value >= EASY_PROFILER_MIN_LEVEL)
+
 # define EASY_UNIQUE_LINE_ID __FILE__ ":" EASY_STRINGIFICATION(__LINE__)
 # define EASY_COMPILETIME_NAME(name) ::profiler::NameSwitch<::std::is_reference<decltype(name)>::value>::compiletime_name(name, EASY_UNIQUE_LINE_ID)
 # define EASY_RUNTIME_NAME(name) ::profiler::NameSwitch<::std::is_reference<decltype(name)>::value>::runtime_name(name)
@@ -60,11 +60,24 @@ namespace profiler {
         Event = 0,
         Block,
         Value,
+        Async, ///< Span which may begin and end in different threads
+        Flow,  ///< Link between producer and consumer blocks in different threads
+        Lock,  ///< Time spent waiting for a lock or holding it (see easy/lock.h)
 
         TypesCount
     };
     using block_type_t = BlockType;
 
+    enum class SamplingPolicy : uint8_t
+    {
+        None = 0, ///< Every block is stored
+        OneInN,   ///< Only every N-th block is stored
+        PerFrame, ///< At most N blocks are stored per frame (per top-level block of the thread)
+        Budget,   ///< Adaptive 1-in-N which keeps about N stored blocks per second per thread
+
+        PoliciesCount
+    };
+
     enum Duration : uint8_t
     {
         TICKS = 0, ///< CPU ticks
@@ -86,6 +99,10 @@ namespace profiler {
         color_t          m_color; ///< Color of the block packed into 1-byte structure
         block_type_t      m_type; ///< Type of the block (See BlockType)
         EasyBlockStatus m_status; ///< If false then blocks with such id() will not be stored by profiler during profile session
+        SamplingPolicy m_samplingPolicy; ///< Sampling policy of blocks with such id() (See SamplingPolicy)
+        uint32_t        m_samplingValue; ///< Parameter of sampling policy (N)
+        float          m_samplingWeight; ///< Average number of calls represented by one stored block (1 if blocks are not sampled)
+        category_t         m_categories; ///< Categories of the block (See category_t)
 
         explicit BaseBlockDescriptor(block_id_t _id, EasyBlockStatus _status, int _line, block_type_t _block_type, color_t _color) EASY_NOEXCEPT;
 
@@ -98,6 +115,10 @@ namespace profiler {
         inline color_t color() const EASY_NOEXCEPT { return m_color; }
         inline block_type_t type() const EASY_NOEXCEPT { return m_type; }
         inline EasyBlockStatus status() const EASY_NOEXCEPT { return m_status; }
+        inline SamplingPolicy samplingPolicy() const EASY_NOEXCEPT { return m_samplingPolicy; }
+        inline uint32_t samplingValue() const EASY_NOEXCEPT { return m_samplingValue; }
+        inline float samplingWeight() const EASY_NOEXCEPT { return m_samplingWeight; }
+        inline category_t categories() const EASY_NOEXCEPT { return m_categories; }
 
     }; // END of class BaseBlockDescriptor.
 
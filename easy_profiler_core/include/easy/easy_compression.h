@@ -0,0 +1,104 @@
+/**
+Lightweight profiler library for c++
+Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+
+Licensed under either of
+    * MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+    * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+at your option.
+
+The MIT License
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights 
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies 
+    of the Software, and to permit persons to whom the Software is furnished 
+    to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all 
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+    PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE 
+    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, 
+    TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE 
+    USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+The Apache License, Version 2.0 (the "License");
+    You may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+**/
+
+#ifndef EASY_PROFILER_COMPRESSION_H
+#define EASY_PROFILER_COMPRESSION_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+#include <easy/details/easy_compiler_support.h>
+
+namespace profiler { namespace net {
+
+    /** Returns maximum possible size of compressed data for given input size. */
+    PROFILER_API size_t compressBound(size_t _size);
+
+    /** Compresses data using LZ4 block format.
+
+    \param _output Must be at least compressBound(_size) bytes long.
+
+    \returns Size of compressed data.
+    */
+    PROFILER_API size_t compress(const char* _data, size_t _size, char* _output);
+
+    /** Decompresses LZ4 block.
+
+    \returns false if compressed data is corrupted or it's unpacked size is not equal to _outputSize.
+    */
+    PROFILER_API bool decompress(const char* _data, size_t _size, char* _output, size_t _outputSize);
+
+    /** Replaces blocks and context switches timestamps in serialized .prof data with deltas.
+
+    Begin time is replaced with (zigzag-encoded) difference from the previous block begin time,
+    end time is replaced with block duration. Data size is not changed.
+
+    \returns false (leaving data unchanged) if data is not a valid .prof data of the current version.
+    */
+    PROFILER_API bool encodeTimestampDeltas(char* _data, size_t _size);
+
+    /** Restores timestamps replaced by encodeTimestampDeltas(). */
+    PROFILER_API bool decodeTimestampDeltas(char* _data, size_t _size);
+
+    /** Packs data into Reply_Blocks_Compressed payload (see profiler::net::CompressedDataHeader).
+
+    \param _flags Requested CompressionFlags. COMPRESSION_TIMESTAMP_DELTA is ignored if data is not a .prof data.
+
+    \note COMPRESSION_TIMESTAMP_DELTA modifies input data in place.
+    */
+    PROFILER_API void packData(char* _data, size_t _size, uint8_t _flags, std::string& _output);
+
+    /** Unpacks all complete chunks of Reply_Blocks_Compressed payload (without CompressedDataHeader).
+
+    Could be called each time a new portion of data is received.
+
+    \param _consumed Number of processed bytes (incomplete chunk at the end is left untouched).
+
+    \returns false if data is corrupted.
+    */
+    PROFILER_API bool unpackChunks(const char* _data, size_t _size, size_t& _consumed, std::string& _output);
+
+} // END of namespace net.
+} // END of namespace profiler.
+
+#endif // EASY_PROFILER_COMPRESSION_H
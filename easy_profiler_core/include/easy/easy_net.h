@@ -77,8 +77,41 @@ enum class MessageType : uint8_t
 
     Request_MainThread_FPS,
     Reply_MainThread_FPS,
+
+    Request_Start_Streaming,
+    Reply_Streaming_Started,
+    Reply_Stream_Frame,
+    Request_Stop_Streaming,
+    Reply_Streaming_Stopped,
+
+    Change_Compression,
+    Reply_Blocks_Compressed,
+
+    Request_Clock_Sync,
+    Reply_Clock_Sync,
+
+    Change_Triggered_Capture,
+    Reply_Triggered_Capture,
+
+    Change_Block_Sampling,
+    Change_Categories,
 };
 
+/** Wire compression flags.
+
+Supported flags are advertised by the profiled application in EasyProfilerStatus::compression.
+Client enables them by sending CompressionMessage. After that Reply_Blocks is replaced with
+Reply_Blocks_Compressed (see CompressedDataHeader).
+*/
+enum CompressionFlags : uint8_t
+{
+    COMPRESSION_NONE            = 0,
+    COMPRESSION_LZ4             = 1, ///< Payload is split into chunks compressed with LZ4 block format
+    COMPRESSION_TIMESTAMP_DELTA = 2, ///< Block timestamps are delta-encoded before compression (improves compression ratio)
+};
+
+EASY_CONSTEXPR uint8_t COMPRESSION_SUPPORTED = COMPRESSION_LZ4 | COMPRESSION_TIMESTAMP_DELTA;
+
 struct Message
 {
     uint32_t magic_number = EASY_MESSAGE_SIGN;
@@ -114,17 +147,50 @@ struct BlockStatusMessage : public Message
     BlockStatusMessage() = delete;
 };
 
+/** Changes sampling policy of the block descriptor (see profiler::SamplingPolicy).
+
+Ignored while capturing, the same as Change_Block_Status.
+*/
+struct BlockSamplingMessage : public Message
+{
+    uint32_t     id;
+    uint8_t  policy;
+    uint32_t  value;
+
+    explicit BlockSamplingMessage(uint32_t _id, uint8_t _policy, uint32_t _value)
+        : Message(MessageType::Change_Block_Sampling), id(_id), policy(_policy), value(_value) { }
+
+    BlockSamplingMessage() = delete;
+};
+
+/** Enables or disables block categories (see profiler::setCategoriesEnabled).
+
+Unlike Change_Block_Status it is applied immediately, even during capture.
+*/
+struct CategoriesMessage : public Message
+{
+    uint32_t categories;
+    bool           flag;
+
+    explicit CategoriesMessage(uint32_t _categories, bool _flag)
+        : Message(MessageType::Change_Categories), categories(_categories), flag(_flag) { }
+
+    CategoriesMessage() = delete;
+};
+
 struct EasyProfilerStatus : public Message
 {
     bool         isProfilerEnabled;
     bool     isEventTracingEnabled;
     bool isLowPriorityEventTracing;
+    uint8_t            compression; ///< Supported CompressionFlags (0 for older versions)
 
-    explicit EasyProfilerStatus(bool _enabled, bool _ETenabled, bool _ETlowp)
+    explicit EasyProfilerStatus(bool _enabled, bool _ETenabled, bool _ETlowp, uint8_t _compression = COMPRESSION_NONE)
         : Message(MessageType::Connection_Accepted)
         , isProfilerEnabled(_enabled)
         , isEventTracingEnabled(_ETenabled)
         , isLowPriorityEventTracing(_ETlowp)
+        , compression(_compression)
     {
     }
 
@@ -152,6 +218,115 @@ struct TimestampMessage : public Message
     TimestampMessage() = default;
 };
 
+/** Reply to Request_Clock_Sync.
+
+Lets a client map profiled application timestamps to it's own clock:
+the time of the reply corresponds (with an accuracy of half a round trip time)
+to the moment between sending a request and receiving this reply.
+*/
+struct ClockSyncMessage : public Message
+{
+    uint64_t          pid = 0; ///< Profiled process id
+    int64_t  cpuFrequency = 0; ///< The same value as in the .prof file header
+    uint64_t         time = 0; ///< Current time of profiled application (in the same units as blocks timestamps)
+
+    explicit ClockSyncMessage(uint64_t _pid, int64_t _cpuFrequency, uint64_t _time)
+        : Message(MessageType::Reply_Clock_Sync), pid(_pid), cpuFrequency(_cpuFrequency), time(_time) { }
+
+    ClockSyncMessage() = default;
+};
+
+struct StreamingMessage : public Message
+{
+    uint32_t interval = 0; ///< Period (in milliseconds) between two sequential Reply_Stream_Frame messages
+
+    explicit StreamingMessage(uint32_t _interval)
+        : Message(MessageType::Request_Start_Streaming), interval(_interval) { }
+
+    StreamingMessage() = default;
+};
+
+struct StreamingStartedMessage : public Message
+{
+    uint64_t          pid = 0; ///< Profiled process id
+    int64_t  cpuFrequency = 0; ///< The same value as in the .prof file header
+    uint64_t    beginTime = 0; ///< Streaming session begin time
+
+    explicit StreamingStartedMessage(uint64_t _pid, int64_t _cpuFrequency, uint64_t _beginTime)
+        : Message(MessageType::Reply_Streaming_Started), pid(_pid), cpuFrequency(_cpuFrequency), beginTime(_beginTime) { }
+
+    StreamingStartedMessage() = default;
+};
+
+/** Portion of data which has been collected since previous stream frame.
+
+Payload layout (all fields are in the same format as in the .prof file):
+\code
+uint32_t descriptors_count;       // Number of new descriptors (descriptors are sent only once)
+uint64_t descriptors_memory_size; // Total size of new descriptors
+descriptor[descriptors_count];    // uint16_t size + SerializedBlockDescriptor
+uint32_t threads_count;
+{
+    thread_id_t thread_id;
+    uint16_t    name_size;
+    char        name[name_size];
+    uint32_t    blocks_count;
+    uint64_t    blocks_memory_size;
+    block[blocks_count];          // uint16_t size + SerializedBlock
+} [threads_count];
+\endcode
+
+Every thread section contains only closed frames, so frames could be appended to
+previously received ones in the same order as they were received.
+Stream frame is sent every interval even if there is no new data.
+Context switch events are not streamed.
+*/
+struct StreamFrameMessage : public DataMessage
+{
+    uint32_t sequence = 0; ///< Sequential number of the frame, starting from 0. Gaps mean lost data.
+    uint64_t  endTime = 0; ///< Time of the frame creation
+
+    explicit StreamFrameMessage(uint32_t _size, uint32_t _sequence, uint64_t _endTime)
+        : DataMessage(_size, MessageType::Reply_Stream_Frame), sequence(_sequence), endTime(_endTime) { }
+
+    StreamFrameMessage() : DataMessage(MessageType::Reply_Stream_Frame) { }
+
+    const char* data() const { return reinterpret_cast<const char*>(this) + sizeof(StreamFrameMessage); }
+};
+
+struct CompressionMessage : public Message
+{
+    uint8_t flags = COMPRESSION_NONE; ///< Requested CompressionFlags
+
+    explicit CompressionMessage(uint8_t _flags)
+        : Message(MessageType::Change_Compression), flags(_flags) { }
+
+    CompressionMessage() = default;
+};
+
+/** Header of Reply_Blocks_Compressed payload.
+
+Header is followed by chunks:
+\code
+{
+    uint32_t raw_size;    // Size of unpacked chunk (not greater than COMPRESSION_CHUNK_SIZE)
+    uint32_t packed_size; // packed_size == raw_size means that chunk is stored uncompressed
+    char     data[packed_size];
+} [...]
+\endcode
+Use profiler::net::unpackChunks() and profiler::net::decodeTimestampDeltas() to restore original data.
+*/
+struct CompressedDataHeader
+{
+    uint8_t    flags = COMPRESSION_NONE; ///< CompressionFlags which have been applied
+    uint64_t rawSize = 0; ///< Size of original data
+
+    explicit CompressedDataHeader(uint8_t _flags, uint64_t _rawSize) : flags(_flags), rawSize(_rawSize) { }
+    CompressedDataHeader() = default;
+};
+
+EASY_CONSTEXPR uint32_t COMPRESSION_CHUNK_SIZE = 1024 * 1024;
+
 #pragma pack(pop)
 
 }//net
@@ -41,14 +41,6 @@ struct FileHeader                                   //64
     DescriptorsInfo         blocksDescriptorInfo;   //12
 };
 
-struct BlockInfo
-{
-    uint64_t                beginTime;
-    uint64_t                  endTime;
-    const BlockDescriptor* descriptor;
-    uint32_t               blockIndex;
-};
-
 struct ContextSwitchEvent
 {
     uint64_t         beginTime;
@@ -57,6 +49,13 @@ struct ContextSwitchEvent
     std::string  targetProcess; ///< Contains process id and process name
 };
 
+struct ValueEvent
+{
+    uint64_t                     time;
+    const BlockDescriptor* descriptor;
+    double                      value; ///< Scalar arbitrary value converted to double
+};
+
 struct BlockDescriptor
 {
     uint32_t     parentId; ///< This will differ from id if this descriptor was created from runtime named block
@@ -65,8 +64,8 @@ struct BlockDescriptor
     uint32_t    argbColor;
     uint8_t     blockType;
     uint8_t        status;
-    std::string blockName;
-    std::string  fileName;
+    const char* blockName; ///< Points into loaded descriptors or blocks data (it is valid while reader is alive)
+    const char*  fileName; ///< Points into loaded descriptors data (it is valid while reader is alive)
 };
 
 } //namespace reader
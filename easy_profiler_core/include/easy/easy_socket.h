@@ -109,6 +109,22 @@ public:
     int accept();
     int bind(uint16_t portno);
 
+    /** Accept pending connection (if any) without waiting.
+
+    Accepted connection is moved into _client which could be used for send() and receive().
+
+    \returns false if there is no pending connection.
+    */
+    bool acceptConnection(EasySocket& _client);
+
+    /** Returns connection socket if connected or accepted, listening socket otherwise.
+
+    Used by readiness notification (see EasySocketPoller).
+    */
+    socket_t handle() const;
+
+    void setBlocking(bool _blocking);
+
     bool setAddress(const char* serv, uint16_t port);
     int connect();
 
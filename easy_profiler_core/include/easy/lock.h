@@ -0,0 +1,304 @@
+/**
+Lightweight profiler library for c++
+Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+
+Licensed under either of
+    * MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+    * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+at your option.
+
+The MIT License
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights 
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies 
+    of the Software, and to permit persons to whom the Software is furnished 
+    to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all 
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+    PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE 
+    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, 
+    TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE 
+    USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+The Apache License, Version 2.0 (the "License");
+    You may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+**/
+
+#ifndef EASY_PROFILER_LOCK_H
+#define EASY_PROFILER_LOCK_H
+
+#include <easy/profiler.h>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+# include <shared_mutex>
+# define EASY_LOCK_HAS_SHARED_MUTEX
+#endif
+
+/** Suffixes of descriptor names for lock wait and lock hold spans.
+
+Reader groups spans of the same lock by descriptor name without these suffixes (see fillLockStats).
+*/
+#define EASY_LOCK_WAIT_SUFFIX " [wait]"
+#define EASY_LOCK_HOLD_SUFFIX " [hold]"
+
+namespace profiler {
+
+    /** Simple spin lock which could be instrumented by instrumented_mutex.
+
+    Works the same way as the spin lock used internally by the profiler.
+    */
+    class spin_mutex EASY_FINAL
+    {
+        ::std::atomic_flag m_lock;
+
+    public:
+
+        spin_mutex() { m_lock.clear(); }
+        spin_mutex(const spin_mutex&) = delete;
+        spin_mutex& operator = (const spin_mutex&) = delete;
+
+        void lock() {
+            while (m_lock.test_and_set(::std::memory_order_acquire));
+        }
+
+        bool try_lock() {
+            return !m_lock.test_and_set(::std::memory_order_acquire);
+        }
+
+        void unlock() {
+            m_lock.clear(::std::memory_order_release);
+        }
+
+    }; // END of class spin_mutex.
+
+} // END of namespace profiler.
+
+//
+// USING_EASY_PROFILER is defined in details/profiler_in_use.h
+//                     if defined BUILD_WITH_EASY_PROFILER and not defined DISABLE_EASY_PROFILER
+//
+
+#ifdef USING_EASY_PROFILER
+
+/** Macro used to describe an instrumented lock.
+
+Registers two block descriptors of type profiler::BlockType::Lock: one for acquire-wait spans
+and one for hold spans. All locks with the same name are treated as one lock by reader and GUI.
+
+\note Name must be a compile-time string literal.
+
+\code
+    #include <easy/lock.h>
+
+    profiler::instrumented_mutex<std::mutex> g_queueLock(EASY_LOCK_NAME("Queue lock", profiler::colors::Red));
+
+    void push(int value)
+    {
+        std::lock_guard<profiler::instrumented_mutex<std::mutex> > guard(g_queueLock);
+        g_queue.push(value);
+    }
+\endcode
+
+\ingroup profiler
+*/
+# define EASY_LOCK_NAME(name, ...)\
+    ::profiler::LockDescription(name EASY_LOCK_WAIT_SUFFIX, name EASY_LOCK_HOLD_SUFFIX, __FILE__, __LINE__,\
+        ::profiler::extract_color(__VA_ARGS__))
+
+namespace profiler {
+
+    /** Pair of descriptors for wait and hold spans of one lock. */
+    struct LockDescription EASY_FINAL
+    {
+        const BaseBlockDescriptor* wait;
+        const BaseBlockDescriptor* hold;
+
+        LockDescription(const char* _waitName, const char* _holdName, const char* _filename, int _line, color_t _color)
+            : wait(registerDescription(ON, _waitName, _waitName, _filename, _line, BlockType::Lock, _color))
+            , hold(registerDescription(ON, _holdName, _holdName, _filename, _line, BlockType::Lock, _color))
+        {
+        }
+    };
+
+    /** Mutex wrapper which stores acquire-wait and hold spans.
+
+    TMutex must satisfy Lockable requirements (lock, try_lock, unlock).
+    Wait span is stored only if the lock was contended (try_lock failed).
+    Hold span is stored on unlock and covers all blocks which were closed inside critical section.
+
+    \ingroup profiler
+    */
+    template <class TMutex>
+    class instrumented_mutex
+    {
+    protected:
+
+        TMutex                    m_mutex;
+        const LockDescription      m_desc;
+        timestamp_t       m_holdBegin = 0;
+
+    public:
+
+        explicit instrumented_mutex(const LockDescription& _desc) : m_desc(_desc) {}
+        instrumented_mutex(const instrumented_mutex&) = delete;
+        instrumented_mutex& operator = (const instrumented_mutex&) = delete;
+
+        void lock()
+        {
+            if (m_mutex.try_lock())
+            {
+                m_holdBegin = now();
+                return;
+            }
+
+            const auto begin = now();
+            m_mutex.lock();
+            m_holdBegin = now();
+            storeBlock(m_desc.wait, "", begin, m_holdBegin);
+        }
+
+        bool try_lock()
+        {
+            if (!m_mutex.try_lock())
+                return false;
+            m_holdBegin = now();
+            return true;
+        }
+
+        void unlock()
+        {
+            const auto begin = m_holdBegin;
+            const auto end = now();
+            m_mutex.unlock();
+            storeBlock(m_desc.hold, "", begin, end);
+        }
+
+        TMutex& native() { return m_mutex; }
+
+    }; // END of class instrumented_mutex.
+
+    /** Shared mutex wrapper which stores acquire-wait and hold spans for both exclusive and shared ownership.
+
+    TSharedMutex must satisfy SharedLockable requirements (lock_shared, try_lock_shared, unlock_shared).
+    Begin times of shared ownership are kept per thread, so shared lock must be released by the same thread.
+
+    \ingroup profiler
+    */
+    template <class TSharedMutex>
+    class instrumented_shared_mutex : public instrumented_mutex<TSharedMutex>
+    {
+        using Parent = instrumented_mutex<TSharedMutex>;
+        using shared_holds_t = ::std::vector<::std::pair<const void*, timestamp_t> >;
+
+        static shared_holds_t& sharedHolds()
+        {
+            thread_local shared_holds_t holds;
+            return holds;
+        }
+
+    public:
+
+        explicit instrumented_shared_mutex(const LockDescription& _desc) : Parent(_desc) {}
+
+        void lock_shared()
+        {
+            if (this->m_mutex.try_lock_shared())
+            {
+                sharedHolds().emplace_back(this, now());
+                return;
+            }
+
+            const auto begin = now();
+            this->m_mutex.lock_shared();
+            const auto end = now();
+            sharedHolds().emplace_back(this, end);
+            storeBlock(this->m_desc.wait, "", begin, end);
+        }
+
+        bool try_lock_shared()
+        {
+            if (!this->m_mutex.try_lock_shared())
+                return false;
+            sharedHolds().emplace_back(this, now());
+            return true;
+        }
+
+        void unlock_shared()
+        {
+            const auto end = now();
+            this->m_mutex.unlock_shared();
+
+            auto& holds = sharedHolds();
+            for (auto it = holds.rbegin(); it != holds.rend(); ++it)
+            {
+                if (it->first == this)
+                {
+                    const auto begin = it->second;
+                    holds.erase(::std::next(it).base());
+                    storeBlock(this->m_desc.hold, "", begin, end);
+                    break;
+                }
+            }
+        }
+
+    }; // END of class instrumented_shared_mutex.
+
+} // END of namespace profiler.
+
+#else
+
+# define EASY_LOCK_NAME(...) nullptr
+
+namespace profiler {
+
+    template <class TMutex>
+    class instrumented_mutex : public TMutex
+    {
+    public:
+        explicit instrumented_mutex(::std::nullptr_t) {}
+        TMutex& native() { return *this; }
+    };
+
+    template <class TSharedMutex>
+    class instrumented_shared_mutex : public instrumented_mutex<TSharedMutex>
+    {
+    public:
+        explicit instrumented_shared_mutex(::std::nullptr_t) : instrumented_mutex<TSharedMutex>(nullptr) {}
+    };
+
+} // END of namespace profiler.
+
+#endif // USING_EASY_PROFILER
+
+namespace profiler {
+
+    using instrumented_spin_lock = instrumented_mutex<spin_mutex>;
+    using instrumented_std_mutex = instrumented_mutex<::std::mutex>;
+
+#ifdef EASY_LOCK_HAS_SHARED_MUTEX
+    using instrumented_std_shared_mutex = instrumented_shared_mutex<::std::shared_mutex>;
+#endif
+
+} // END of namespace profiler.
+
+#endif // EASY_PROFILER_LOCK_H
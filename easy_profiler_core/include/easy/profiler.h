@@ -43,6 +43,8 @@ The Apache License, Version 2.0 (the "License");
 #ifndef EASY_PROFILER_H
 #define EASY_PROFILER_H
 
+#include <atomic>
+#include <new>
 #include <easy/details/profiler_public_types.h>
 
 #define MAX_DYNAMIC_BLOCK_NAME_SIZE_ESTIMATED MAX_BLOCK_DATA_SIZE
@@ -89,6 +91,15 @@ The Apache License, Version 2.0 (the "License");
         }
         EASY_END_BLOCK; // End of "Check something" block (Even if "Check something" is disabled, this EASY_END_BLOCK will not end any other block).
 
+        EASY_BLOCK("Send request", profiler::categories::Net); // Block of "Net" category (categories could be disabled at run-time, see setCategoriesEnabled)
+        send(request);
+        EASY_END_BLOCK;
+
+        for (auto& header : headers) {
+            EASY_BLOCK("Parse header", profiler::levels::Fine); // Compiled to nothing if EASY_PROFILER_MIN_LEVEL is greater than profiler::levels::Fine
+            parse(header);
+        }
+
         EASY_BLOCK("Some another block", profiler::colors::Blue, profiler::ON_WITHOUT_CHILDREN); // Block with Blue color without
         // some another code...
         EASY_BLOCK("Calculate sum"); // This block will not be profiled because it's parent is ON_WITHOUT_CHILDREN
@@ -101,14 +112,19 @@ The Apache License, Version 2.0 (the "License");
 
 Block will be automatically completed by destructor.
 
+\note Block of level lower than EASY_PROFILER_MIN_LEVEL (see profiler::levels) has zero cost: it's descriptor
+is not registered and no code is generated for it. Blocks without explicit level have profiler::levels::Normal level.
+Such blocks must not be ended with EASY_END_BLOCK because they do not exist at run-time.
+
 \ingroup profiler
 */
 # define EASY_BLOCK(name, ...)\
-    EASY_LOCAL_STATIC_PTR(const ::profiler::BaseBlockDescriptor*, EASY_UNIQUE_DESC(__LINE__), ::profiler::registerDescription(::profiler::extract_enable_flag(__VA_ARGS__),\
+    EASY_LOCAL_STATIC_PTR(const ::profiler::BaseBlockDescriptor*, EASY_UNIQUE_DESC(__LINE__), !EASY_LEVEL_ENABLED(__VA_ARGS__) ? nullptr :\
+        ::profiler::registerDescription(::profiler::extract_enable_flag(__VA_ARGS__),\
         EASY_UNIQUE_LINE_ID, EASY_COMPILETIME_NAME(name), __FILE__, __LINE__, ::profiler::BlockType::Block, ::profiler::extract_color(__VA_ARGS__),\
-        ::std::is_base_of<::profiler::ForceConstStr, decltype(name)>::value));\
-    ::profiler::Block EASY_UNIQUE_BLOCK(__LINE__)(EASY_UNIQUE_DESC(__LINE__), EASY_RUNTIME_NAME(name));\
-    ::profiler::beginBlock(EASY_UNIQUE_BLOCK(__LINE__));
+        ::std::is_base_of<::profiler::ForceConstStr, decltype(name)>::value, ::profiler::extract_category(__VA_ARGS__)));\
+    ::profiler::LevelGate<EASY_LEVEL_ENABLED(__VA_ARGS__)>::block_t EASY_UNIQUE_BLOCK(__LINE__)(EASY_UNIQUE_DESC(__LINE__), EASY_RUNTIME_NAME(name));\
+    ::profiler::LevelGate<EASY_LEVEL_ENABLED(__VA_ARGS__)>::begin(EASY_UNIQUE_BLOCK(__LINE__));
 
 /** Macro for beginning of a non-scoped block with custom name and color.
 
@@ -144,7 +160,7 @@ Block will be automatically completed by destructor.
 #define EASY_NONSCOPED_BLOCK(name, ...)\
     EASY_LOCAL_STATIC_PTR(const ::profiler::BaseBlockDescriptor*, EASY_UNIQUE_DESC(__LINE__), ::profiler::registerDescription(::profiler::extract_enable_flag(__VA_ARGS__),\
         EASY_UNIQUE_LINE_ID, EASY_COMPILETIME_NAME(name), __FILE__, __LINE__, ::profiler::BlockType::Block, ::profiler::extract_color(__VA_ARGS__),\
-        ::std::is_base_of<::profiler::ForceConstStr, decltype(name)>::value));\
+        ::std::is_base_of<::profiler::ForceConstStr, decltype(name)>::value, ::profiler::extract_category(__VA_ARGS__)));\
     ::profiler::beginNonScopedBlock(EASY_UNIQUE_DESC(__LINE__), EASY_RUNTIME_NAME(name));
 
 /** Macro for beginning of a block with function name and custom color.
@@ -194,6 +210,9 @@ int foo()
 }
 \endcode
 
+\warning EASY_BLOCK of disabled category is not opened at all (see profiler::setCategoriesEnabled),
+so EASY_END_BLOCK called for it ends previously opened block.
+
 \ingroup profiler
 */
 # define EASY_END_BLOCK ::profiler::endBlock();
@@ -208,11 +227,76 @@ will end previously opened EASY_BLOCK or EASY_FUNCTION.
 \ingroup profiler
 */
 # define EASY_EVENT(name, ...)\
+    EASY_LOCAL_STATIC_PTR(const ::profiler::BaseBlockDescriptor*, EASY_UNIQUE_DESC(__LINE__), !EASY_LEVEL_ENABLED(__VA_ARGS__) ? nullptr :\
+        ::profiler::registerDescription(::profiler::extract_enable_flag(__VA_ARGS__), EASY_UNIQUE_LINE_ID, EASY_COMPILETIME_NAME(name),\
+            __FILE__, __LINE__, ::profiler::BlockType::Event, ::profiler::extract_color(__VA_ARGS__),\
+            ::std::is_base_of<::profiler::ForceConstStr, decltype(name)>::value, ::profiler::extract_category(__VA_ARGS__)));\
+    ::profiler::LevelGate<EASY_LEVEL_ENABLED(__VA_ARGS__)>::event(EASY_UNIQUE_DESC(__LINE__), EASY_RUNTIME_NAME(name));
+
+/** Macro for starting async span which could be finished in any other thread.
+
+Async span is not a part of thread's call stack: it is used to measure latency of a request which is
+processed by several threads (thread pools, coroutines, asynchronous callbacks and so on).
+Span is finished by EASY_ASYNC_END with the same correlation id.
+
+\code
+    void onRequest(Request& r) {
+        EASY_ASYNC_BEGIN("Request", r.id, profiler::colors::Orange);
+        pool.post([&r] { process(r); EASY_ASYNC_END(r.id); });
+    }
+\endcode
+
+\note Name must be a compile-time string (run-time names are not supported for async spans).
+\note Correlation ids of async spans and flows share the same namespace.
+
+\ingroup profiler
+*/
+# define EASY_ASYNC_BEGIN(name, correlationId, ...)\
     EASY_LOCAL_STATIC_PTR(const ::profiler::BaseBlockDescriptor*, EASY_UNIQUE_DESC(__LINE__), ::profiler::registerDescription(\
         ::profiler::extract_enable_flag(__VA_ARGS__), EASY_UNIQUE_LINE_ID, EASY_COMPILETIME_NAME(name),\
-            __FILE__, __LINE__, ::profiler::BlockType::Event, ::profiler::extract_color(__VA_ARGS__),\
-            ::std::is_base_of<::profiler::ForceConstStr, decltype(name)>::value));\
-    ::profiler::storeEvent(EASY_UNIQUE_DESC(__LINE__), EASY_RUNTIME_NAME(name));
+            __FILE__, __LINE__, ::profiler::BlockType::Async, ::profiler::extract_color(__VA_ARGS__), false, ::profiler::extract_category(__VA_ARGS__)));\
+    ::profiler::beginAsync(EASY_UNIQUE_DESC(__LINE__), static_cast<uint64_t>(correlationId));
+
+/** Macro for finishing async span started by EASY_ASYNC_BEGIN.
+
+\ingroup profiler
+*/
+# define EASY_ASYNC_END(correlationId) ::profiler::endAsync(static_cast<uint64_t>(correlationId));
+
+/** Macro for creating flow link from current block (producer) to the block which will call EASY_FLOW_IN
+with the same correlation id (consumer).
+
+GUI draws an arrow from producer block to consumer block.
+
+\code
+    void produce(Queue& q) {
+        EASY_FUNCTION();
+        Task t = makeTask();
+        EASY_FLOW_OUT("Task queued", t.id);
+        q.push(t);
+    }
+
+    void consume(Queue& q) {
+        EASY_FUNCTION();
+        Task t = q.pop();
+        EASY_FLOW_IN(t.id);
+        t.run();
+    }
+\endcode
+
+\ingroup profiler
+*/
+# define EASY_FLOW_OUT(name, correlationId, ...)\
+    EASY_LOCAL_STATIC_PTR(const ::profiler::BaseBlockDescriptor*, EASY_UNIQUE_DESC(__LINE__), ::profiler::registerDescription(\
+        ::profiler::extract_enable_flag(__VA_ARGS__), EASY_UNIQUE_LINE_ID, EASY_COMPILETIME_NAME(name),\
+            __FILE__, __LINE__, ::profiler::BlockType::Flow, ::profiler::extract_color(__VA_ARGS__), false, ::profiler::extract_category(__VA_ARGS__)));\
+    ::profiler::beginAsync(EASY_UNIQUE_DESC(__LINE__), static_cast<uint64_t>(correlationId));
+
+/** Macro for finishing flow link started by EASY_FLOW_OUT.
+
+\ingroup profiler
+*/
+# define EASY_FLOW_IN(correlationId) ::profiler::endAsync(static_cast<uint64_t>(correlationId));
 
 /** Macro for enabling profiler.
 
@@ -384,6 +468,10 @@ Otherwise, no log messages will be printed.
 # define EASY_PROFILER_ENABLE 
 # define EASY_PROFILER_DISABLE 
 # define EASY_EVENT(...)
+# define EASY_ASYNC_BEGIN(...)
+# define EASY_ASYNC_END(correlationId)
+# define EASY_FLOW_OUT(...)
+# define EASY_FLOW_IN(correlationId)
 # define EASY_THREAD(...)
 # define EASY_THREAD_SCOPE(...)
 # define EASY_MAIN_THREAD 
@@ -447,6 +535,17 @@ Added for clarification.
 namespace profiler {
 
     EASY_CONSTEXPR uint16_t DEFAULT_PORT = EASY_DEFAULT_PORT;
+    EASY_CONSTEXPR const char* ALLOCATIONS_VALUE_NAME = "Heap allocations"; ///< Name of arbitrary value which stores heap allocations of a block (see storeAllocation())
+
+    /** Mask of enabled block categories (see setCategoriesEnabled()).
+
+    Exported to be checked inline by EASY_BLOCK and EASY_EVENT macros. Do not change it directly.
+    */
+    extern PROFILER_API std::atomic<uint32_t> EASY_ENABLED_CATEGORIES;
+
+    inline bool isCategoryEnabled(const BaseBlockDescriptor* _desc) {
+        return (_desc->categories() & EASY_ENABLED_CATEGORIES.load(std::memory_order_relaxed)) != 0;
+    }
 
     //////////////////////////////////////////////////////////////////////
     // Core API
@@ -485,7 +584,7 @@ namespace profiler {
         /** Registers static description of a block.
 
         It is general information which is common for all such blocks.
-        Includes color, block type (see BlockType), file-name, line-number, compile-time name of a block and enable-flag.
+        Includes color, block type (see BlockType), file-name, line-number, compile-time name of a block, enable-flag and categories.
 
         \note This API function is used by EASY_EVENT, EASY_BLOCK, EASY_FUNCTION macros.
         There is no need to invoke this function explicitly.
@@ -494,7 +593,7 @@ namespace profiler {
 
         \ingroup profiler
         */
-        PROFILER_API const BaseBlockDescriptor* registerDescription(EasyBlockStatus _status, const char* _autogenUniqueId, const char* _compiletimeName, const char* _filename, int _line, block_type_t _block_type, color_t _color, bool _copyName = false);
+        PROFILER_API const BaseBlockDescriptor* registerDescription(EasyBlockStatus _status, const char* _autogenUniqueId, const char* _compiletimeName, const char* _filename, int _line, block_type_t _block_type, color_t _color, bool _copyName = false, category_t _categories = categories::Default);
 
         /** Stores event in the blocks list.
 
@@ -526,6 +625,55 @@ namespace profiler {
         */
         PROFILER_API void storeBlock(const BaseBlockDescriptor* _desc, const char* _runtimeName, timestamp_t _beginTime, timestamp_t _endTime);
 
+        /** Starts async span or flow link identified by correlation id.
+
+        \note There is no need to invoke this function explicitly - use EASY_ASYNC_BEGIN or EASY_FLOW_OUT macro instead.
+
+        \param _desc Reference to the previously registered description (BlockType::Async or BlockType::Flow).
+        \param _correlationId User-defined id which must be passed to endAsync() to finish this span.
+
+        \note If there is already started span with the same id then it will be replaced.
+
+        \ingroup profiler
+        */
+        PROFILER_API void beginAsync(const BaseBlockDescriptor* _desc, uint64_t _correlationId);
+
+        /** Finishes async span or flow link previously started by beginAsync().
+
+        Span may be finished in any thread. It is stored in the blocks list of the thread which finishes it.
+
+        \note There is no need to invoke this function explicitly - use EASY_ASYNC_END or EASY_FLOW_IN macro instead.
+
+        \ingroup profiler
+        */
+        PROFILER_API void endAsync(uint64_t _correlationId);
+
+        /** Enables heap allocations tracking.
+
+        Registers ALLOCATIONS_VALUE_NAME arbitrary value description. Until this function is called storeAllocation() has no effect.
+
+        \note This is called by easy_profiler_alloc library on load. There is no need to invoke this function explicitly.
+
+        \ingroup profiler
+        */
+        PROFILER_API void enableAllocationsTracking();
+
+        /** Adds heap allocation to the statistics of current opened block.
+
+        Allocations are accumulated per opened block and stored on block end as an arbitrary value
+        ALLOCATIONS_VALUE_NAME (array of two uint64_t: allocated bytes and allocations count)
+        which becomes the last child of the block. Allocations made outside of blocks are ignored.
+
+        This function does not allocate memory (except rare growth of per-thread counters)
+        and does not lock, so it could be called from malloc hooks.
+
+        \param _bytes Allocated bytes.
+        \param _count Number of allocations (greater than 1 if allocations are sampled).
+
+        \ingroup profiler
+        */
+        PROFILER_API void storeAllocation(uint64_t _bytes, uint32_t _count = 1);
+
         /** Begins scoped block.
 
         \ingroup profiler
@@ -666,6 +814,132 @@ namespace profiler {
         */
         PROFILER_API bool isListening();
 
+        /** Adds a rule which fires triggered capture when main thread frame duration exceeds _thresholdUs.
+
+        Triggered capture dumps data collected since profiler has been enabled (or since previous
+        triggered capture) to the file (see setTriggeredCaptureFilename) and to the network clients
+        which have subscribed to triggered captures. Profiler is enabled again right after dumping,
+        so the application could run unattended and rare hitches would be captured automatically.
+        While there are triggers, only the latest frames are kept (see setTriggeredCaptureBufferSize).
+
+        \note Triggers are checked only while profiler is enabled.
+        \note Triggered capture is skipped while network client is capturing or streaming.
+
+        \retval Trigger id which could be used for removeTrigger().
+
+        \sa addBlockTrigger, addValueTrigger, setTriggeredCaptureDelays
+
+        \ingroup profiler
+        */
+        PROFILER_API uint32_t addFrameTrigger(timestamp_t _thresholdUs);
+
+        /** Adds a rule which fires triggered capture when duration of block named _blockName exceeds _thresholdUs.
+
+        \note _blockName is a compile-time name of the block (the same as in EASY_BLOCK or EASY_FUNCTION).
+
+        \sa addFrameTrigger
+
+        \ingroup profiler
+        */
+        PROFILER_API uint32_t addBlockTrigger(const char* _blockName, timestamp_t _thresholdUs);
+
+        /** Adds a rule which fires triggered capture when value named _valueName becomes greater
+        (or less if _above == false) than _threshold.
+
+        \note Only scalar numeric values are checked (arrays and strings are ignored).
+
+        \sa addFrameTrigger
+
+        \ingroup profiler
+        */
+        PROFILER_API uint32_t addValueTrigger(const char* _valueName, double _threshold, bool _above = true);
+
+        /** Removes previously added trigger rule.
+
+        \ingroup profiler
+        */
+        PROFILER_API void removeTrigger(uint32_t _triggerId);
+
+        /** Set file name prefix for triggered captures.
+
+        Captures are saved as "<prefix>_<number>.prof". Empty prefix means that captures are only sent to network clients.
+
+        \note Default value is "triggered_capture".
+
+        \ingroup profiler
+        */
+        PROFILER_API void setTriggeredCaptureFilename(const char* _filenamePrefix);
+
+        /** Set delay between trigger and dumping (to collect data after the hitch) and cooldown time
+        after dumping while triggers are ignored.
+
+        \note Default values are 500 ms and 5000 ms.
+
+        \ingroup profiler
+        */
+        PROFILER_API void setTriggeredCaptureDelays(uint32_t _afterTriggerMs, uint32_t _cooldownMs);
+
+        /** Set memory limit for blocks of every thread kept for triggered capture.
+
+        When blocks of a thread take a half of the limit, older frames are dropped, so triggered capture
+        contains from a half to the whole limit of the latest data. 0 means that nothing is dropped.
+
+        \note Limit is not applied while network client is capturing or streaming.
+        \note Default value is 64 MB.
+
+        \ingroup profiler
+        */
+        PROFILER_API void setTriggeredCaptureBufferSize(uint32_t _megabytes);
+
+        /** Returns number of triggered captures which have been dumped.
+
+        \ingroup profiler
+        */
+        PROFILER_API uint32_t triggeredCapturesCount();
+
+        /** Sets sampling policy for blocks named _blockName.
+
+        Use this for blocks which run too frequently to record every call:
+        - SamplingPolicy::OneInN stores every _value-th block;
+        - SamplingPolicy::PerFrame stores at most _value blocks per frame (per top-level block of the thread);
+        - SamplingPolicy::Budget stores about _value blocks per second per thread adapting 1-in-N period to the call rate;
+        - SamplingPolicy::None stores every block (default).
+
+        Sampled-out blocks are skipped but their children are stored as usual.
+        Average number of calls represented by one stored block is saved into the block descriptor
+        (see BaseBlockDescriptor::samplingWeight()), so readers could extrapolate calls number and total duration.
+
+        \note _blockName is a compile-time name of the block (the same as in EASY_BLOCK or EASY_FUNCTION).
+        The policy is also applied to blocks which would be registered later.
+
+        \note Sampling counters are restarted when the policy is changed, so it is better to change it before capture.
+
+        \ingroup profiler
+        */
+        PROFILER_API void setBlockSampling(const char* _blockName, SamplingPolicy _policy, uint32_t _value);
+
+        /** Enables or disables block categories (see profiler::categories).
+
+        Blocks, events and values are stored only if at least one of their categories is enabled.
+        EASY_BLOCK, EASY_FUNCTION and EASY_EVENT check categories inline, so a block of disabled category
+        is not even constructed and costs much less than a block with disabled status.
+        All categories are enabled by default.
+
+        \warning Block of disabled category is not opened, so EASY_END_BLOCK called for such block
+        ends its parent block. Use scopes instead of EASY_END_BLOCK for blocks of categories which could be disabled.
+
+        \note Categories could be changed at any time (even during capture) and also over the network.
+
+        \ingroup profiler
+        */
+        PROFILER_API void setCategoriesEnabled(category_t _categories, bool _isEnable);
+
+        /** Returns mask of enabled block categories.
+
+        \ingroup profiler
+        */
+        PROFILER_API category_t enabledCategories();
+
         /** Returns current major version.
         
         \ingroup profiler
@@ -765,17 +1039,83 @@ namespace profiler {
         PROFILER_API timestamp_t main_thread_frameTimeLocalAvg(Duration _durationCast = ::profiler::MICROSECONDS);
 
     }
+
+    /** Compile-time switch for blocks and events of different levels (see EASY_PROFILER_MIN_LEVEL).
+
+    Used by EASY_BLOCK and EASY_EVENT macros: blocks of disabled level are replaced by an empty object
+    which is removed by compiler completely.
+
+    Blocks and events of disabled categories are skipped at run-time before any profiler function is called:
+    Block is not constructed, so it is not started, stored or pushed to the stack of opened blocks.
+    */
+    template <bool IsEnabled>
+    struct LevelGate EASY_FINAL
+    {
+        class block_t EASY_FINAL
+        {
+            friend LevelGate;
+
+            union { Block m_block; };
+            const bool m_enabled;
+
+        public:
+
+            block_t(const block_t&) = delete;
+            block_t& operator = (const block_t&) = delete;
+
+            block_t(const BaseBlockDescriptor* _desc, const char* _runtimeName) EASY_NOEXCEPT
+                : m_enabled(isCategoryEnabled(_desc))
+            {
+                if (m_enabled)
+                    new (&m_block) Block(_desc, _runtimeName);
+            }
+
+            ~block_t()
+            {
+                if (m_enabled)
+                    m_block.~Block();
+            }
+        };
+
+        static void begin(block_t& _block)
+        {
+            if (_block.m_enabled)
+                beginBlock(_block.m_block);
+        }
+
+        static void event(const BaseBlockDescriptor* _desc, const char* _runtimeName)
+        {
+            if (isCategoryEnabled(_desc))
+                storeEvent(_desc, _runtimeName);
+        }
+    };
+
+    template <>
+    struct LevelGate<false> EASY_FINAL
+    {
+        struct block_t EASY_FINAL {
+            EASY_CONSTEXPR_FCN block_t(const BaseBlockDescriptor*, const char*) {}
+        };
+
+        static void begin(block_t&) {}
+        static void event(const BaseBlockDescriptor*, const char*) {}
+    };
+
 #else
     inline EASY_CONSTEXPR_FCN timestamp_t now() { return 0; }
     inline EASY_CONSTEXPR_FCN timestamp_t toNanoseconds(timestamp_t) { return 0; }
     inline EASY_CONSTEXPR_FCN timestamp_t toMicroseconds(timestamp_t) { return 0; }
-    inline const BaseBlockDescriptor* registerDescription(EasyBlockStatus, const char*, const char*, const char*, int, block_type_t, color_t, bool = false)
+    inline const BaseBlockDescriptor* registerDescription(EasyBlockStatus, const char*, const char*, const char*, int, block_type_t, color_t, bool = false, category_t = categories::Default)
     { return reinterpret_cast<const BaseBlockDescriptor*>(0xbad); }
     inline void endBlock() { }
     inline void setEnabled(bool) { }
     inline EASY_CONSTEXPR_FCN bool isEnabled() { return false; }
     inline void storeEvent(const BaseBlockDescriptor*, const char* = "") { }
     inline void storeBlock(const BaseBlockDescriptor*, const char*, timestamp_t, timestamp_t) { }
+    inline void beginAsync(const BaseBlockDescriptor*, uint64_t) { }
+    inline void endAsync(uint64_t) { }
+    inline void enableAllocationsTracking() { }
+    inline void storeAllocation(uint64_t, uint32_t = 1) { }
     inline void beginBlock(Block&) { }
     inline void beginNonScopedBlock(const BaseBlockDescriptor*, const char* = "") { }
     inline uint32_t dumpBlocksToFile(const char*) { return 0; }
@@ -790,6 +1130,17 @@ namespace profiler {
     inline void startListen(uint16_t = ::profiler::DEFAULT_PORT) { }
     inline void stopListen() { }
     inline EASY_CONSTEXPR_FCN bool isListening() { return false; }
+    inline uint32_t addFrameTrigger(timestamp_t) { return 0; }
+    inline uint32_t addBlockTrigger(const char*, timestamp_t) { return 0; }
+    inline uint32_t addValueTrigger(const char*, double, bool = true) { return 0; }
+    inline void removeTrigger(uint32_t) { }
+    inline void setTriggeredCaptureFilename(const char*) { }
+    inline void setTriggeredCaptureDelays(uint32_t, uint32_t) { }
+    inline void setTriggeredCaptureBufferSize(uint32_t) { }
+    inline EASY_CONSTEXPR_FCN uint32_t triggeredCapturesCount() { return 0; }
+    inline void setBlockSampling(const char*, SamplingPolicy, uint32_t) { }
+    inline void setCategoriesEnabled(category_t, bool) { }
+    inline EASY_CONSTEXPR_FCN category_t enabledCategories() { return categories::All; }
     inline EASY_CONSTEXPR_FCN uint8_t versionMajor() { return 0; }
     inline EASY_CONSTEXPR_FCN uint8_t versionMinor() { return 0; }
     inline EASY_CONSTEXPR_FCN uint16_t versionPatch() { return 0; }
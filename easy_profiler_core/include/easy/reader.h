@@ -74,6 +74,10 @@ namespace profiler {
         profiler::block_index_t    max_duration_block; ///< Will be used in GUI to jump to the block with max duration
         profiler::block_index_t          parent_block; ///< Index of block which is "parent" for "per_parent_stats" or "frame" for "per_frame_stats" or thread-id for "per_thread_stats"
         profiler::calls_number_t         calls_number; ///< Block calls number
+        uint64_t                      allocated_bytes; ///< Total heap memory allocated by all block calls excluding children blocks (see profiler::storeAllocation)
+        uint64_t                   allocations_number; ///< Total number of heap allocations made by all block calls excluding children blocks
+        uint64_t                   descendants_number; ///< Total number of nested blocks (on all sublevels) of all block calls
+        profiler::calls_number_t      children_number; ///< Total number of direct children of all block calls
 
         explicit BlockStatistics(profiler::timestamp_t _duration, profiler::block_index_t _block_index, profiler::block_index_t _parent_index)
             : total_duration(_duration)
@@ -83,6 +87,10 @@ namespace profiler {
             , max_duration_block(_block_index)
             , parent_block(_parent_index)
             , calls_number(1)
+            , allocated_bytes(0)
+            , allocations_number(0)
+            , descendants_number(0)
+            , children_number(0)
         {
         }
 
@@ -93,6 +101,47 @@ namespace profiler {
             return total_duration / calls_number;
         }
 
+        /** Calls number extrapolated for sampled blocks.
+
+        \param _samplingWeight Sampling weight of the block descriptor (see BaseBlockDescriptor::samplingWeight()).
+        */
+        inline uint64_t extrapolated_calls_number(float _samplingWeight) const
+        {
+            return static_cast<uint64_t>(calls_number * static_cast<double>(_samplingWeight) + 0.5);
+        }
+
+        /** Total duration extrapolated for sampled blocks.
+
+        \param _samplingWeight Sampling weight of the block descriptor (see BaseBlockDescriptor::samplingWeight()).
+        */
+        inline profiler::timestamp_t extrapolated_total_duration(float _samplingWeight) const
+        {
+            return static_cast<profiler::timestamp_t>(total_duration * static_cast<double>(_samplingWeight) + 0.5);
+        }
+
+        /** Total duration without intrinsic profiler overhead of nested blocks.
+
+        \param _blockOverhead Measured cost of one empty nested block (block_overhead of fillTreesFromStream()).
+        */
+        inline profiler::timestamp_t corrected_total_duration(profiler::timestamp_t _blockOverhead) const
+        {
+            const auto overhead = _blockOverhead * descendants_number;
+            return total_duration > overhead ? total_duration - overhead : 0;
+        }
+
+        /** Total children duration without intrinsic profiler overhead of blocks nested into children.
+
+        Self-time corrected for profiler overhead is corrected_total_duration() - corrected_children_duration().
+
+        \param _blockOverhead Measured cost of one empty nested block (block_overhead of fillTreesFromStream()).
+        */
+        inline profiler::timestamp_t corrected_children_duration(profiler::timestamp_t _blockOverhead) const
+        {
+            const auto nested = descendants_number > children_number ? descendants_number - children_number : 0;
+            const auto overhead = _blockOverhead * nested;
+            return total_children_duration > overhead ? total_children_duration - overhead : 0;
+        }
+
     }; // END of struct BlockStatistics.
 #pragma pack(pop)
 
@@ -115,11 +164,13 @@ namespace profiler {
             profiler::SerializedBlock*    node; ///< Pointer to serialized data for regular block (id, name, begin, end etc.)
             profiler::SerializedCSwitch*    cs; ///< Pointer to serialized data for context switch (thread_id, name, begin, end etc.)
             profiler::ArbitraryValue*    value; ///< Pointer to serialized data for arbitrary value
+            profiler::AsyncEvent*        async; ///< Pointer to serialized data for async span or flow link
         };
 
         profiler::BlockStatistics* per_parent_stats; ///< Pointer to statistics for this block within the parent (may be nullptr for top-level blocks)
         profiler::BlockStatistics*  per_frame_stats; ///< Pointer to statistics for this block within the frame (may be nullptr for top-level blocks)
         profiler::BlockStatistics* per_thread_stats; ///< Pointer to statistics for this block within the bounds of all frames per current thread
+        profiler::block_index_t         descendants; ///< Number of nested blocks on all sublevels
         uint8_t                               depth; ///< Maximum number of sublevels (maximum children depth)
 
         BlocksTree(const This&) = delete;
@@ -130,6 +181,7 @@ namespace profiler {
             , per_parent_stats(nullptr)
             , per_frame_stats(nullptr)
             , per_thread_stats(nullptr)
+            , descendants(0)
             , depth(0)
         {
 
@@ -194,6 +246,7 @@ namespace profiler {
             per_parent_stats = that.per_parent_stats;
             per_frame_stats = that.per_frame_stats;
             per_thread_stats = that.per_thread_stats;
+            descendants = that.descendants;
             depth = that.depth;
 
             that.node = nullptr;
@@ -229,6 +282,7 @@ namespace profiler {
         BlocksTree::children_t       children; ///< List of children indexes
         BlocksTree::children_t           sync; ///< List of context-switch events
         BlocksTree::children_t         events; ///< List of events indexes
+        BlocksTree::children_t         asyncs; ///< List of async spans and flow links finished in this thread
         std::string               thread_name; ///< Name of this thread
         profiler::timestamp_t   profiled_time; ///< Profiled time of this thread (sum of all children duration)
         profiler::timestamp_t       wait_time; ///< Wait time of this thread (sum of all context switches)
@@ -249,6 +303,7 @@ namespace profiler {
             : children(std::move(that.children))
             , sync(std::move(that.sync))
             , events(std::move(that.events))
+            , asyncs(std::move(that.asyncs))
             , thread_name(std::move(that.thread_name))
             , profiled_time(that.profiled_time)
             , wait_time(that.wait_time)
@@ -264,6 +319,7 @@ namespace profiler {
             children = std::move(that.children);
             sync = std::move(that.sync);
             events = std::move(that.events);
+            asyncs = std::move(that.asyncs);
             thread_name = std::move(that.thread_name);
             profiled_time = that.profiled_time;
             wait_time = that.wait_time;
@@ -301,12 +357,104 @@ namespace profiler {
     using thread_blocks_tree_t = std::unordered_map<profiler::thread_id_t, profiler::BlocksTreeRoot, ::estd::hash<profiler::thread_id_t> >;
     using block_getter_fn = std::function<const profiler::BlocksTree&(profiler::block_index_t)>;
 
+    //////////////////////////////////////////////////////////////////////////
+
+    EASY_CONSTEXPR profiler::block_index_t NO_BLOCK = ~0U;
+
+    /** Resolved async span or flow link.
+
+    Source and target blocks are the deepest blocks which were opened in source/target thread
+    at the time of begin/end of the span (NO_BLOCK if there were no opened blocks).
+    */
+    struct AsyncLink EASY_FINAL
+    {
+        profiler::block_index_t        index; ///< Index of the AsyncEvent record in blocks list
+        profiler::block_index_t source_block; ///< Producer block (for flows) or block in which span has been started
+        profiler::block_index_t target_block; ///< Consumer block (for flows) or block in which span has been finished
+        profiler::thread_id_t  source_thread; ///< Thread which has started span
+        profiler::thread_id_t  target_thread; ///< Thread which has finished span
+    };
+
+    using async_links_t = std::vector<AsyncLink>;
+
+    //////////////////////////////////////////////////////////////////////////
+
+    /** Lock contention statistics of one thread for one lock (see easy/lock.h). */
+    struct LockThreadStats EASY_FINAL
+    {
+        profiler::thread_id_t    thread_id; ///< Thread id
+        profiler::timestamp_t    wait_time; ///< Total time this thread has been waiting for the lock (in nanoseconds)
+        profiler::timestamp_t    hold_time; ///< Total time this thread has been holding the lock (in nanoseconds)
+        uint32_t              waits_number; ///< Number of contended acquisitions
+        uint32_t              holds_number; ///< Number of acquisitions
+    };
+
+    /** Lock contention statistics for all instrumented locks with the same name. */
+    struct LockStats EASY_FINAL
+    {
+        std::string                          name; ///< Lock name (descriptor name without EASY_LOCK_WAIT_SUFFIX/EASY_LOCK_HOLD_SUFFIX)
+        profiler::timestamp_t     total_wait_time; ///< Total wait time of all threads (in nanoseconds)
+        profiler::timestamp_t       max_wait_time; ///< Maximum single wait duration (in nanoseconds)
+        profiler::timestamp_t     total_hold_time; ///< Total hold time of all threads (in nanoseconds)
+        uint32_t                     waits_number; ///< Number of contended acquisitions
+        uint32_t                     holds_number; ///< Number of acquisitions
+        std::vector<LockThreadStats>      threads; ///< Per thread statistics sorted by wait time (descending)
+    };
+
+    using lock_stats_t = std::vector<LockStats>;
+
+    //////////////////////////////////////////////////////////////////////////
+
+    /** Block of the compared captures. Blocks are matched by name, file and line because descriptor ids differ between builds. */
+    struct DiffFrame EASY_FINAL
+    {
+        std::string      name; ///< Block name (run-time name if it has been set) or thread name for thread frames
+        std::string      file; ///< Source file (empty for thread frames)
+        int32_t          line; ///< Source line (0 for thread frames)
+        bool           thread; ///< True for root frames of threads (threads are matched by name)
+    };
+
+    /** Duration statistics of one frame or one call path in one capture (in nanoseconds). Percentiles are nearest-rank. */
+    struct DiffStats EASY_FINAL
+    {
+        uint64_t                count; ///< Number of blocks (0 if there are no such blocks in capture)
+        profiler::timestamp_t   total; ///< Total duration
+        profiler::timestamp_t    self; ///< Total duration minus duration of child blocks
+        profiler::timestamp_t     p50;
+        profiler::timestamp_t     p99;
+        profiler::timestamp_t     max;
+    };
+
+    struct DiffEntry EASY_FINAL
+    {
+        std::vector<uint32_t>      path; ///< Indices of frames from the thread frame down to the block (one frame for per-block entries)
+        DiffStats              baseline;
+        DiffStats               current;
+        bool                significant; ///< True if total, self, p50 or p99 has changed by at least both thresholds
+    };
+
+    struct DiffOptions EASY_FINAL
+    {
+        double               relative_threshold = 0.05; ///< Minimum significant change relative to baseline value
+        profiler::timestamp_t absolute_threshold = 1000; ///< Minimum significant change (in nanoseconds)
+        bool                         call_paths = true; ///< Compare call paths (not only blocks aggregated over all paths)
+    };
+
+    struct ProfileDiff EASY_FINAL
+    {
+        std::vector<DiffFrame>       frames; ///< Frames referenced by entries
+        std::vector<DiffEntry>       blocks; ///< Per-block entries aggregated over all threads and call paths
+        std::vector<DiffEntry>   call_paths; ///< Per-call path entries
+    };
+
+
     //////////////////////////////////////////////////////////////////////////
 
     class PROFILER_API SerializedData EASY_FINAL
     {
         uint64_t m_size;
         char*    m_data;
+        char*   m_extra; ///< List of additional memory blocks (see allocate())
 
     public:
 
@@ -323,6 +471,13 @@ namespace profiler {
 
         void extend(uint64_t _size);
 
+        /** Allocates additional memory block which is released with the main data.
+
+        Unlike extend(), pointers to the main data and to previously allocated blocks stay valid.
+        Additional blocks are not counted in size().
+        */
+        char* allocate(uint64_t _size);
+
         SerializedData& operator = (SerializedData&& that);
 
         char* operator [] (uint64_t i);
@@ -351,6 +506,54 @@ namespace profiler {
 
     using descriptors_list_t = std::vector<SerializedBlockDescriptor*>;
 
+    //////////////////////////////////////////////////////////////////////////
+
+    struct ProfFileInfo EASY_FINAL
+    {
+        uint32_t                        version = 0;
+        processid_t                         pid = 0;
+        int64_t                   cpu_frequency = 0; ///< Frequency of timestamps stored in file (0 if they are in nanoseconds)
+        timestamp_t                  begin_time = 0; ///< Begin of the capture (in nanoseconds)
+        timestamp_t                    end_time = 0; ///< End of the capture (in nanoseconds)
+        timestamp_t              block_overhead = 0; ///< Average overhead of one block measurement (in nanoseconds)
+        uint64_t                    memory_size = 0; ///< Size of all block and context switch records
+        uint32_t                   blocks_count = 0; ///< Number of block and context switch records
+        uint32_t              descriptors_count = 0;
+        uint32_t                  threads_count = 0; ///< Number of threads sections (max value for files older than v2.1.0)
+        uint16_t                bookmarks_count = 0;
+    };
+
+    /** Receiver of .prof file contents for readProfFromStream().
+
+    Contents are passed in the order they are stored in file: header, block descriptors, then context switches
+    and blocks of every thread, then bookmarks. Records are passed as they are stored (timestamps are converted
+    into nanoseconds): value streams are not expanded and blocks with runtime names keep their descriptor id.
+    References are valid only during the call. Reading stops if any callback returns false.
+    */
+    class PROFILER_API ProfVisitor
+    {
+    public:
+
+        virtual ~ProfVisitor() {}
+
+        virtual bool onHeader(const ProfFileInfo&) { return true; }
+        virtual bool onDescriptor(const SerializedBlockDescriptor&) { return true; }
+        virtual bool onThreadBegin(thread_id_t /*thread_id*/, const char* /*name*/) { return true; }
+        virtual bool onContextSwitch(thread_id_t, const SerializedCSwitch&) { return true; }
+
+        /** Blocks of a thread are stored in order of their end time, so children are passed before their parent.
+
+        If hierarchy is requested then children_number is the number of direct children of the block, which are
+        the last children_number blocks of the thread passed before it and not yet claimed by other parent.
+        Async spans, flow links and value streams are not a part of the call stack and always have no children.
+        */
+        virtual bool onBlock(thread_id_t, const SerializedBlock&, uint16_t /*size*/, uint32_t /*children_number*/) { return true; }
+
+        virtual bool onThreadEnd(thread_id_t) { return true; }
+        virtual bool onBookmark(const Bookmark&) { return true; }
+
+    }; // END of class ProfVisitor.
+
 } // END of namespace profiler.
 
 extern "C" {
@@ -366,6 +569,7 @@ extern "C" {
                                                            uint32_t& descriptors_count,
                                                            uint32_t& version,
                                                            profiler::processid_t& pid,
+                                                           profiler::timestamp_t& block_overhead,
                                                            bool gather_statistics,
                                                            std::ostream& _log);
 
@@ -380,9 +584,43 @@ extern "C" {
                                                              uint32_t& descriptors_count,
                                                              uint32_t& version,
                                                              profiler::processid_t& pid,
+                                                             profiler::timestamp_t& block_overhead,
                                                              bool gather_statistics,
                                                              std::ostream& _log);
 
+    /** Builds tables of async spans and flow links for loaded blocks trees.
+
+    Links are sorted by begin time of the span.
+    */
+    PROFILER_API void fillAsyncLinks(const profiler::thread_blocks_tree_t& threaded_trees,
+                                     const profiler::descriptors_list_t& descriptors,
+                                     const profiler::block_getter_fn& block_getter,
+                                     profiler::async_links_t& async_spans,
+                                     profiler::async_links_t& flows);
+
+    /** Gathers lock contention statistics from lock wait/hold spans of loaded blocks trees.
+
+    Locks are sorted by total wait time (descending).
+    */
+    PROFILER_API void fillLockStats(const profiler::thread_blocks_tree_t& threaded_trees,
+                                    const profiler::descriptors_list_t& descriptors,
+                                    const profiler::block_getter_fn& block_getter,
+                                    profiler::lock_stats_t& lock_stats);
+
+    /** Compares two loaded captures per block and per call path.
+
+    Only blocks of BlockType::Block and BlockType::Lock are compared. Captures are processed in parallel.
+    Entries are sorted by absolute change of total time (descending).
+    */
+    PROFILER_API void fillProfileDiff(const profiler::thread_blocks_tree_t& baseline_trees,
+                                      const profiler::descriptors_list_t& baseline_descriptors,
+                                      const profiler::block_getter_fn& baseline_block_getter,
+                                      const profiler::thread_blocks_tree_t& current_trees,
+                                      const profiler::descriptors_list_t& current_descriptors,
+                                      const profiler::block_getter_fn& current_block_getter,
+                                      const profiler::DiffOptions& options,
+                                      profiler::ProfileDiff& diff);
+
     PROFILER_API bool readDescriptionsFromStream(std::atomic<int>& progress, std::istream& str,
                                                  profiler::SerializedData& serialized_descriptors,
                                                  profiler::descriptors_list_t& descriptors,
@@ -390,6 +628,22 @@ extern "C" {
 
 }
 
+/** Reads .prof file record by record without building blocks trees and passes records to the visitor.
+
+Only one record is kept in memory at once, so captures of any size are processed in a single pass.
+If hierarchy is true then number of children is calculated for every block, which requires to keep
+begin and end time of blocks whose parent has not been read yet (top-level blocks of the thread so far).
+
+\returns Number of read block and context switch records or 0 on error or if the visitor has stopped reading.
+*/
+PROFILER_API profiler::block_index_t readProfFromFile(std::atomic<int>& progress, const char* filename,
+                                                      profiler::ProfVisitor& visitor, bool hierarchy,
+                                                      std::ostream& _log);
+
+PROFILER_API profiler::block_index_t readProfFromStream(std::atomic<int>& progress, std::istream& str,
+                                                        profiler::ProfVisitor& visitor, bool hierarchy,
+                                                        std::ostream& _log);
+
 inline profiler::block_index_t fillTreesFromFile(const char* filename, profiler::BeginEndTime& begin_end_time,
                                                  profiler::SerializedData& serialized_blocks,
                                                  profiler::SerializedData& serialized_descriptors,
@@ -399,13 +653,14 @@ inline profiler::block_index_t fillTreesFromFile(const char* filename, profiler:
                                                  uint32_t& descriptors_count,
                                                  uint32_t& version,
                                                  profiler::processid_t& pid,
+                                                 profiler::timestamp_t& block_overhead,
                                                  bool gather_statistics,
                                                  std::ostream& _log)
 {
     std::atomic<int> progress(0);
     return fillTreesFromFile(progress, filename, begin_end_time, serialized_blocks, serialized_descriptors,
                              descriptors, _blocks, threaded_trees, bookmarks, descriptors_count, version, pid,
-                             gather_statistics, _log);
+                             block_overhead, gather_statistics, _log);
 }
 
 inline bool readDescriptionsFromStream(std::istream& str,
@@ -417,6 +672,13 @@ inline bool readDescriptionsFromStream(std::istream& str,
     return readDescriptionsFromStream(progress, str, serialized_descriptors, descriptors, _log);
 }
 
+inline profiler::block_index_t readProfFromFile(const char* filename, profiler::ProfVisitor& visitor, bool hierarchy,
+                                                std::ostream& _log)
+{
+    std::atomic<int> progress(0);
+    return readProfFromFile(progress, filename, visitor, hierarchy, _log);
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #endif // EASY_PROFILER_READER_H
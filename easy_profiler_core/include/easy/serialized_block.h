@@ -56,6 +56,8 @@ namespace profiler {
     template <bool isArray>
     struct Value<DataType::TypesCount, isArray>;
 
+    class ValueStream;
+
     //////////////////////////////////////////////////////////////////////////
 
     class PROFILER_API SerializedBlock EASY_FINAL : public BaseBlockData
@@ -152,6 +154,16 @@ namespace profiler {
             m_status = _status;
         }
 
+        inline void setSampling(SamplingPolicy _policy, uint32_t _value, float _weight) EASY_NOEXCEPT {
+            m_samplingPolicy = _policy;
+            m_samplingValue = _value;
+            m_samplingWeight = _weight;
+        }
+
+        inline void setCategories(category_t _categories) EASY_NOEXCEPT {
+            m_categories = _categories;
+        }
+
         // Instances of this class can not be created or destroyed directly
         SerializedBlockDescriptor()                                              = delete;
         SerializedBlockDescriptor(const SerializedBlockDescriptor&)              = delete;
@@ -169,6 +181,7 @@ namespace profiler {
     class PROFILER_API ArbitraryValue : protected BaseBlockData
     {
         friend ::ThreadStorage;
+        friend ValueStream;
 
     protected:
 
@@ -246,6 +259,148 @@ namespace profiler {
 
     //////////////////////////////////////////////////////////////////////////
 
+#pragma pack(push, 1)
+    /** Async span or flow link which has been started in one thread and finished in another.
+
+    It is stored in the blocks list of the finishing thread: begin() is the time of EASY_ASYNC_BEGIN (or EASY_FLOW_OUT)
+    and end() is the time of EASY_ASYNC_END (or EASY_FLOW_IN). Use descriptor type (BlockType::Async or BlockType::Flow)
+    to distinguish them.
+    */
+    class PROFILER_API AsyncEvent EASY_FINAL : protected BaseBlockData
+    {
+        friend ::ThreadStorage;
+
+        char               m_nameStub; ///< Artificial padding which is used to imitate SerializedBlock::name() == 0 behavior
+        char                m_padding; ///< Padding to the bound of 2 bytes
+        uint64_t      m_correlationId; ///< User-defined id which binds begin and end of this span
+        thread_id_t    m_sourceThread; ///< Thread which has started this span
+
+        explicit AsyncEvent(timestamp_t _begin, timestamp_t _end, block_id_t _id, uint64_t _correlationId,
+                            thread_id_t _sourceThread)
+            : BaseBlockData(_begin, _end, _id)
+            , m_nameStub(0)
+            , m_padding(0)
+            , m_correlationId(_correlationId)
+            , m_sourceThread(_sourceThread)
+        {
+        }
+
+    public:
+
+        using BaseBlockData::id;
+        using Event::begin;
+        using Event::end;
+        using Event::duration;
+
+        ~AsyncEvent() = delete;
+
+        uint64_t correlation_id() const {
+            return m_correlationId;
+        }
+
+        thread_id_t source_thread() const {
+            return m_sourceThread;
+        }
+
+    }; // end of class AsyncEvent.
+#pragma pack(pop)
+
+    //////////////////////////////////////////////////////////////////////////
+
+    /** Marker stored instead of ArbitraryValue padding byte to distinguish ValueStream record from ArbitraryValue. */
+    EASY_CONSTEXPR char VALUE_STREAM_MARKER = 1;
+
+#pragma pack(push, 1)
+    /** Compact stream of scalar values with the same descriptor and value id.
+
+    Samples are delta-encoded: timestamps are stored as delta-of-delta and values as delta (integers)
+    or XOR with previous value (floating point) with variable length coding.
+    begin() is the time of the first sample and end() is the time of the last sample.
+    Timestamps of samples are stored relative to begin() and scaled to [begin(), end()] by the reader,
+    so converting begin and end (for example, into nanoseconds) converts all samples.
+
+    It has the same descriptor type (BlockType::Value) as ArbitraryValue and it is expanded into
+    separate ArbitraryValue records when file is loaded (see fillTreesFromStream).
+    */
+    class PROFILER_API ValueStream EASY_FINAL : protected BaseBlockData
+    {
+        friend ::ThreadStorage;
+
+        char     m_nameStub; ///< Artificial padding which is used to imitate SerializedBlock::name() == 0 behavior
+        char       m_marker; ///< Always VALUE_STREAM_MARKER (the same offset as ArbitraryValue padding byte)
+        uint16_t     m_size; ///< Size of encoded samples data in bytes
+        DataType     m_type; ///< Type of all values in this stream
+        uint8_t m_valueSize; ///< Size of one value in bytes
+        uint16_t    m_count; ///< Number of samples
+        vin_t    m_value_id;
+
+        explicit ValueStream(timestamp_t _timestamp, vin_t _vin, block_id_t _id, DataType _type, uint8_t _valueSize)
+            : BaseBlockData(_timestamp, _timestamp, _id)
+            , m_nameStub(0)
+            , m_marker(VALUE_STREAM_MARKER)
+            , m_size(0)
+            , m_type(_type)
+            , m_valueSize(_valueSize)
+            , m_count(0)
+            , m_value_id(_vin)
+        {
+        }
+
+    public:
+
+        using BaseBlockData::id;
+        using Event::begin;
+        using Event::end;
+
+        ~ValueStream() = delete;
+
+        static bool isValueStream(const ArbitraryValue* _value) {
+            return reinterpret_cast<const char*>(_value)[sizeof(BaseBlockData) + 1] == VALUE_STREAM_MARKER;
+        }
+
+        const char* data() const {
+            return reinterpret_cast<const char*>(this) + sizeof(ValueStream);
+        }
+
+        uint16_t data_size() const {
+            return m_size;
+        }
+
+        uint16_t count() const {
+            return m_count;
+        }
+
+        vin_t value_id() const {
+            return m_value_id;
+        }
+
+        DataType type() const {
+            return m_type;
+        }
+
+        uint8_t value_size() const {
+            return m_valueSize;
+        }
+
+        /** Size of memory required by expand(). */
+        uint64_t expanded_size() const {
+            return static_cast<uint64_t>(m_count) * (sizeof(ArbitraryValue) + m_valueSize);
+        }
+
+        /** Decodes samples into separate ArbitraryValue records.
+
+        \param _buffer Memory of expanded_size() bytes for records.
+        \param _values Array of count() pointers which receives decoded records.
+
+        etval Number of decoded samples (less than count() if encoded data is corrupted).
+        */
+        uint16_t expand(char* _buffer, ArbitraryValue** _values) const;
+
+    }; // end of class ValueStream.
+#pragma pack(pop)
+
+    //////////////////////////////////////////////////////////////////////////
+
     template <DataType dataType>
     struct Value<dataType, false> EASY_FINAL : public ArbitraryValue {
         using value_type = typename StdType<dataType>::value_type;
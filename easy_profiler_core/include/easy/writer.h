@@ -43,8 +43,20 @@ The Apache License, Version 2.0 (the "License");
 #ifndef EASY_PROFILER_WRITER_H
 #define EASY_PROFILER_WRITER_H
 
+#include <limits>
 #include <easy/reader.h>
 
+namespace profiler {
+
+    struct MergeOptions EASY_FINAL
+    {
+        profiler::timestamp_t begin_time = 0; ///< Begin of kept time range (in nanoseconds since the begin of merged capture)
+        profiler::timestamp_t   end_time = std::numeric_limits<profiler::timestamp_t>::max(); ///< End of kept time range (in nanoseconds since the begin of merged capture)
+        bool                 align_begin = false; ///< Shift every input in time so that all of them begin together with the first one
+    };
+
+} // END of namespace profiler.
+
 extern "C" {
 
     PROFILER_API profiler::block_index_t writeTreesToFile(std::atomic<int>& progress, const char* filename,
@@ -57,6 +69,7 @@ extern "C" {
                                                           profiler::timestamp_t begin_time,
                                                           profiler::timestamp_t end_time,
                                                           profiler::processid_t pid,
+                                                          profiler::timestamp_t block_overhead,
                                                           std::ostream& log);
 
     PROFILER_API profiler::block_index_t writeTreesToStream(std::atomic<int>& progress, std::ostream& str,
@@ -69,9 +82,61 @@ extern "C" {
                                                             profiler::timestamp_t begin_time,
                                                             profiler::timestamp_t end_time,
                                                             profiler::processid_t pid,
+                                                            profiler::timestamp_t block_overhead,
                                                             std::ostream& log);
+
+    /** Merges several .prof files into one and/or cuts a time range out of them.
+
+    Input files are streamed section by section without building blocks trees, so memory usage does not depend
+    on files size. Block descriptors of all inputs are merged into one list (equal descriptors are stored once)
+    and block ids are remapped accordingly. Timestamps are converted into nanoseconds using CPU frequency of each
+    file. Records which do not intersect [begin_time, end_time] range are dropped, value streams crossing the range
+    bounds are expanded into separate values.
+
+    If inputs were captured by different processes then thread names are prefixed with process id
+    and the same thread id used by several processes is made unique by storing process id in its upper half.
+    Output file must be seekable: counters are patched after all records are written.
+
+    \returns Number of written block records or 0 on error (see log).
+    */
+    PROFILER_API profiler::block_index_t mergeProfFiles(std::atomic<int>& progress,
+                                                        const std::vector<std::string>& input_files,
+                                                        const char* output_file,
+                                                        const profiler::MergeOptions& options,
+                                                        std::ostream& log);
 }
 
+/** The same as writeTreesToFile() above, but blocks are taken directly from blocks list filled by fillTreesFromFile().
+
+Access to blocks is inlined instead of calling block_getter for every block, so it is faster for large captures.
+*/
+PROFILER_API profiler::block_index_t writeTreesToFile(std::atomic<int>& progress, const char* filename,
+                                                      const profiler::SerializedData& serialized_descriptors,
+                                                      const profiler::descriptors_list_t& descriptors,
+                                                      profiler::block_id_t descriptors_count,
+                                                      const profiler::thread_blocks_tree_t& trees,
+                                                      const profiler::bookmarks_t& bookmarks,
+                                                      const profiler::blocks_t& blocks,
+                                                      profiler::timestamp_t begin_time,
+                                                      profiler::timestamp_t end_time,
+                                                      profiler::processid_t pid,
+                                                      profiler::timestamp_t block_overhead,
+                                                      std::ostream& log);
+
+/** The same as writeTreesToStream() above, but blocks are taken directly from blocks list filled by fillTreesFromFile(). */
+PROFILER_API profiler::block_index_t writeTreesToStream(std::atomic<int>& progress, std::ostream& str,
+                                                        const profiler::SerializedData& serialized_descriptors,
+                                                        const profiler::descriptors_list_t& descriptors,
+                                                        profiler::block_id_t descriptors_count,
+                                                        const profiler::thread_blocks_tree_t& trees,
+                                                        const profiler::bookmarks_t& bookmarks,
+                                                        const profiler::blocks_t& blocks,
+                                                        profiler::timestamp_t begin_time,
+                                                        profiler::timestamp_t end_time,
+                                                        profiler::processid_t pid,
+                                                        profiler::timestamp_t block_overhead,
+                                                        std::ostream& log);
+
 inline profiler::block_index_t writeTreesToFile(const char* filename,
                                                 const profiler::SerializedData& serialized_descriptors,
                                                 const profiler::descriptors_list_t& descriptors,
@@ -82,11 +147,12 @@ inline profiler::block_index_t writeTreesToFile(const char* filename,
                                                 profiler::timestamp_t begin_time,
                                                 profiler::timestamp_t end_time,
                                                 profiler::processid_t pid,
+                                                profiler::timestamp_t block_overhead,
                                                 std::ostream& log)
 {
     std::atomic<int> progress(0);
     return writeTreesToFile(progress, filename, serialized_descriptors, descriptors, descriptors_count, trees,
-                            bookmarks, std::move(block_getter), begin_time, end_time, pid, log);
+                            bookmarks, std::move(block_getter), begin_time, end_time, pid, block_overhead, log);
 }
 
 inline profiler::block_index_t writeTreesToStream(std::ostream& str,
@@ -99,11 +165,19 @@ inline profiler::block_index_t writeTreesToStream(std::ostream& str,
                                                   profiler::timestamp_t begin_time,
                                                   profiler::timestamp_t end_time,
                                                   profiler::processid_t pid,
+                                                  profiler::timestamp_t block_overhead,
                                                   std::ostream& log)
 {
     std::atomic<int> progress(0);
     return writeTreesToStream(progress, str, serialized_descriptors, descriptors, descriptors_count, trees,
-                              bookmarks, std::move(block_getter), begin_time, end_time, pid, log);
+                              bookmarks, std::move(block_getter), begin_time, end_time, pid, block_overhead, log);
+}
+
+inline profiler::block_index_t mergeProfFiles(const std::vector<std::string>& input_files, const char* output_file,
+                                             const profiler::MergeOptions& options, std::ostream& log)
+{
+    std::atomic<int> progress(0);
+    return mergeProfFiles(progress, input_files, output_file, options, log);
 }
 
 #endif //EASY_PROFILER_WRITER_H
@@ -0,0 +1,468 @@
+/************************************************************************
+* file name         : profile_diff.cpp
+* ----------------- :
+* creation time     : 2026/10/18
+* authors           : Sergey Yagovtsev, Victor Zarubkin
+* emails            : yse.sey@gmail.com, v.s.zarubkin@gmail.com
+* ----------------- :
+* description       : The file contains implementation of fillProfileDiff function
+*                   : which compares two loaded captures per block and per call path.
+* ----------------- :
+* license           : Lightweight profiler library for c++
+*                   : Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+*                   :
+*                   : Licensed under either of
+*                   :     * MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+*                   :     * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+*                   : at your option.
+*                   :
+*                   : The MIT License
+*                   :
+*                   : Permission is hereby granted, free of charge, to any person obtaining a copy
+*                   : of this software and associated documentation files (the "Software"), to deal
+*                   : in the Software without restriction, including without limitation the rights
+*                   : to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+*                   : of the Software, and to permit persons to whom the Software is furnished
+*                   : to do so, subject to the following conditions:
+*                   :
+*                   : The above copyright notice and this permission notice shall be included in all
+*                   : copies or substantial portions of the Software.
+*                   :
+*                   : THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+*                   : INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+*                   : PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+*                   : LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+*                   : TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+*                   : USE OR OTHER DEALINGS IN THE SOFTWARE.
+*                   :
+*                   : The Apache License, Version 2.0 (the "License")
+*                   :
+*                   : You may not use this file except in compliance with the License.
+*                   : You may obtain a copy of the License at
+*                   :
+*                   : http://www.apache.org/licenses/LICENSE-2.0
+*                   :
+*                   : Unless required by applicable law or agreed to in writing, software
+*                   : distributed under the License is distributed on an "AS IS" BASIS,
+*                   : WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*                   : See the License for the specific language governing permissions and
+*                   : limitations under the License.
+************************************************************************/
+
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+#include <easy/reader.h>
+
+namespace {
+
+EASY_CONSTEXPR uint32_t NoIndex = ~0U;
+
+/** Durations of frames or call paths gathered from one capture.
+
+Durations are stored in one flat list instead of a list per item: there could be millions of distinct call paths.
+*/
+class Durations EASY_FINAL
+{
+    using sample_t = std::pair<uint32_t, profiler::timestamp_t>;
+
+    std::vector<sample_t>             m_samples; ///< (item, duration)
+    std::vector<profiler::timestamp_t>   m_self; ///< Self time of each item
+
+public:
+
+    void addItem()
+    {
+        m_self.push_back(0);
+    }
+
+    void add(uint32_t _item, profiler::timestamp_t _duration, profiler::timestamp_t _self)
+    {
+        m_samples.emplace_back(_item, _duration);
+        m_self[_item] += _self;
+    }
+
+    /** Calculates stats of each item and releases durations. Percentiles are nearest-rank. */
+    std::vector<profiler::DiffStats> stats()
+    {
+        // Group durations by item with counting sort, then sort durations of each item
+        std::vector<size_t> offsets(m_self.size() + 1, 0);
+        for (const auto& sample : m_samples)
+            ++offsets[sample.first + 1];
+        for (size_t i = 1; i < offsets.size(); ++i)
+            offsets[i] += offsets[i - 1];
+
+        std::vector<profiler::timestamp_t> durations(m_samples.size());
+        {
+            auto positions = offsets;
+            for (const auto& sample : m_samples)
+                durations[positions[sample.first]++] = sample.second;
+        }
+
+        decltype(m_samples)().swap(m_samples);
+
+        std::vector<profiler::DiffStats> result(m_self.size(), profiler::DiffStats());
+        for (size_t item = 0; item < m_self.size(); ++item)
+        {
+            const auto begin = durations.begin() + offsets[item];
+            const auto end = durations.begin() + offsets[item + 1];
+            if (begin == end)
+                continue;
+
+            std::sort(begin, end);
+
+            auto& stats = result[item];
+            const auto count = static_cast<uint64_t>(end - begin);
+            const auto percentile = [&](uint64_t _percent) {
+                const auto rank = (_percent * count + 99) / 100;
+                return *(begin + static_cast<ptrdiff_t>(rank != 0 ? rank - 1 : 0));
+            };
+
+            stats.count = count;
+            for (auto it = begin; it != end; ++it)
+                stats.total += *it;
+            stats.self = m_self[item];
+            stats.p50 = percentile(50);
+            stats.p99 = percentile(99);
+            stats.max = *(end - 1);
+        }
+
+        decltype(m_self)().swap(m_self);
+
+        return result;
+    }
+};
+
+/** Tree of call paths. Children are kept in sibling lists: one node usually has a few distinct children. */
+class PathTree EASY_FINAL
+{
+    std::vector<uint32_t>  m_firstChild;
+    std::vector<uint32_t> m_nextSibling;
+    uint32_t                m_firstRoot = NoIndex;
+
+public:
+
+    std::vector<uint32_t> parents;
+    std::vector<uint32_t>  frames;
+
+    uint32_t size() const
+    {
+        return static_cast<uint32_t>(parents.size());
+    }
+
+    /** Returns child node of _parent (NoIndex for root nodes) with _frame, adds it if there is no such node. */
+    uint32_t child(uint32_t _parent, uint32_t _frame)
+    {
+        const auto first = _parent != NoIndex ? m_firstChild[_parent] : m_firstRoot;
+        for (auto node = first; node != NoIndex; node = m_nextSibling[node])
+        {
+            if (frames[node] == _frame)
+                return node;
+        }
+
+        const auto node = size();
+        parents.push_back(_parent);
+        frames.push_back(_frame);
+        m_firstChild.push_back(NoIndex);
+        m_nextSibling.push_back(first);
+
+        if (_parent != NoIndex)
+            m_firstChild[_parent] = node;
+        else
+            m_firstRoot = node;
+
+        return node;
+    }
+
+    /** Releases sibling lists, parents and frames are kept. */
+    void shrink()
+    {
+        decltype(m_firstChild)().swap(m_firstChild);
+        decltype(m_nextSibling)().swap(m_nextSibling);
+        m_firstRoot = NoIndex;
+    }
+};
+
+/** Frames and call paths tree of one capture. Frames are keyed by name, file and line. */
+class CaptureTree EASY_FINAL
+{
+    std::unordered_map<std::string, uint32_t> m_frameByKey;
+    std::vector<uint32_t>               m_frameByDescriptor;
+    Durations                               m_nodeDurations;
+    Durations                              m_frameDurations;
+
+    const profiler::descriptors_list_t& m_descriptors;
+    const profiler::block_getter_fn&    m_blockGetter;
+    const bool                            m_callPaths;
+
+public:
+
+    std::vector<std::string>              frameKeys;
+    std::vector<profiler::DiffFrame>         frames;
+    std::vector<profiler::DiffStats>     frameStats;
+    PathTree                                  paths;
+    std::vector<profiler::DiffStats>      nodeStats;
+
+    CaptureTree(const profiler::descriptors_list_t& _descriptors, const profiler::block_getter_fn& _blockGetter, bool _callPaths)
+        : m_frameByDescriptor(_descriptors.size(), NoIndex)
+        , m_descriptors(_descriptors)
+        , m_blockGetter(_blockGetter)
+        , m_callPaths(_callPaths)
+    {
+    }
+
+    void build(const profiler::thread_blocks_tree_t& _trees)
+    {
+        for (const auto& kv : _trees)
+        {
+            const auto& root = kv.second;
+
+            // Thread ids differ between runs: threads are matched by name
+            std::string key(1, '\1');
+            key += root.thread_name;
+            const auto frame = addFrame(key, root.thread_name, std::string(), 0, true);
+            const auto node = m_callPaths ? child(NoIndex, frame) : NoIndex;
+
+            for (auto i : root.children)
+            {
+                const auto& block = m_blockGetter(i);
+                if (counted(block))
+                    visit(block, node);
+            }
+        }
+
+        paths.shrink();
+        frameStats = m_frameDurations.stats();
+        nodeStats = m_nodeDurations.stats();
+    }
+
+private:
+
+    bool counted(const profiler::BlocksTree& _block) const
+    {
+        const auto type = m_descriptors[_block.node->id()]->type();
+        return type == profiler::BlockType::Block || type == profiler::BlockType::Lock;
+    }
+
+    uint32_t addFrame(const std::string& _key, const std::string& _name, const std::string& _file, int32_t _line, bool _thread)
+    {
+        const auto it = m_frameByKey.find(_key);
+        if (it != m_frameByKey.end())
+            return it->second;
+
+        const auto frame = static_cast<uint32_t>(frames.size());
+        m_frameByKey.emplace(_key, frame);
+        frameKeys.push_back(_key);
+        frames.push_back(profiler::DiffFrame {_name, _file, _line, _thread});
+        m_frameDurations.addItem();
+
+        return frame;
+    }
+
+    uint32_t frame(const profiler::BlocksTree& _block)
+    {
+        // Each run-time name has its own descriptor, so frame could be cached by descriptor id
+        const auto id = _block.node->id();
+        auto& frame = m_frameByDescriptor[id];
+        if (frame != NoIndex)
+            return frame;
+
+        const auto& desc = *m_descriptors[id];
+        const std::string name = *_block.node->name() != 0 ? _block.node->name() : desc.name();
+        const std::string file = desc.file();
+
+        std::string key = name;
+        key += '\0';
+        key += file;
+        key += '\0';
+        key += std::to_string(desc.line());
+
+        frame = addFrame(key, name, file, desc.line(), false);
+        return frame;
+    }
+
+    uint32_t child(uint32_t _parent, uint32_t _frame)
+    {
+        const auto count = paths.size();
+        const auto node = paths.child(_parent, _frame);
+        if (node == count)
+            m_nodeDurations.addItem();
+        return node;
+    }
+
+    void visit(const profiler::BlocksTree& _block, uint32_t _parent)
+    {
+        const auto blockFrame = frame(_block);
+        const auto node = m_callPaths ? child(_parent, blockFrame) : NoIndex;
+
+        profiler::timestamp_t childrenDuration = 0;
+        for (auto i : _block.children)
+        {
+            const auto& child = m_blockGetter(i);
+            if (!counted(child))
+                continue;
+
+            childrenDuration += child.node->duration();
+            visit(child, node);
+        }
+
+        const auto duration = _block.node->duration();
+        const auto self = duration > childrenDuration ? duration - childrenDuration : 0;
+
+        m_frameDurations.add(blockFrame, duration, self);
+        if (node != NoIndex)
+            m_nodeDurations.add(node, duration, self);
+    }
+
+}; // END of class CaptureTree.
+
+profiler::timestamp_t absDelta(profiler::timestamp_t _a, profiler::timestamp_t _b)
+{
+    return _a > _b ? _a - _b : _b - _a;
+}
+
+bool changed(profiler::timestamp_t _baseline, profiler::timestamp_t _current, const profiler::DiffOptions& _options)
+{
+    const auto delta = absDelta(_baseline, _current);
+    return delta != 0 && delta >= _options.absolute_threshold
+        && static_cast<double>(delta) >= _options.relative_threshold * static_cast<double>(_baseline);
+}
+
+void setSignificance(profiler::DiffEntry& _entry, const profiler::DiffOptions& _options)
+{
+    const auto& a = _entry.baseline;
+    const auto& b = _entry.current;
+    _entry.significant = changed(a.total, b.total, _options) || changed(a.self, b.self, _options)
+                         || changed(a.p50, b.p50, _options) || changed(a.p99, b.p99, _options);
+}
+
+void sortEntries(std::vector<profiler::DiffEntry>& _entries)
+{
+    std::sort(_entries.begin(), _entries.end(), [](const profiler::DiffEntry& a, const profiler::DiffEntry& b) {
+        const auto deltaA = absDelta(a.baseline.total, a.current.total);
+        const auto deltaB = absDelta(b.baseline.total, b.current.total);
+        return deltaA > deltaB || (deltaA == deltaB && a.path < b.path);
+    });
+}
+
+} // END of namespace <noname>.
+
+extern "C" PROFILER_API void fillProfileDiff(const profiler::thread_blocks_tree_t& baseline_trees,
+                                             const profiler::descriptors_list_t& baseline_descriptors,
+                                             const profiler::block_getter_fn& baseline_block_getter,
+                                             const profiler::thread_blocks_tree_t& current_trees,
+                                             const profiler::descriptors_list_t& current_descriptors,
+                                             const profiler::block_getter_fn& current_block_getter,
+                                             const profiler::DiffOptions& options,
+                                             profiler::ProfileDiff& diff)
+{
+    diff.frames.clear();
+    diff.blocks.clear();
+    diff.call_paths.clear();
+
+    CaptureTree captures[2] = {
+        CaptureTree(baseline_descriptors, baseline_block_getter, options.call_paths),
+        CaptureTree(current_descriptors, current_block_getter, options.call_paths)
+    };
+
+    std::thread baselineThread([&] { captures[0].build(baseline_trees); });
+    captures[1].build(current_trees);
+    baselineThread.join();
+
+    // Merge frames of both captures
+    std::unordered_map<std::string, uint32_t> frameByKey;
+    std::vector<uint32_t> globalFrames[2];
+    std::vector<uint32_t> localFrames[2];
+    for (int c = 0; c < 2; ++c)
+    {
+        auto& capture = captures[c];
+        globalFrames[c].reserve(capture.frames.size());
+        for (size_t i = 0; i < capture.frames.size(); ++i)
+        {
+            auto it = frameByKey.find(capture.frameKeys[i]);
+            if (it == frameByKey.end())
+            {
+                it = frameByKey.emplace(capture.frameKeys[i], static_cast<uint32_t>(diff.frames.size())).first;
+                diff.frames.push_back(std::move(capture.frames[i]));
+            }
+
+            globalFrames[c].push_back(it->second);
+        }
+    }
+
+    for (int c = 0; c < 2; ++c)
+    {
+        localFrames[c].assign(diff.frames.size(), NoIndex);
+        for (size_t i = 0; i < globalFrames[c].size(); ++i)
+            localFrames[c][globalFrames[c][i]] = static_cast<uint32_t>(i);
+    }
+
+    for (uint32_t frame = 0, n = static_cast<uint32_t>(diff.frames.size()); frame < n; ++frame)
+    {
+        if (diff.frames[frame].thread)
+            continue;
+
+        diff.blocks.emplace_back();
+        auto& entry = diff.blocks.back();
+        entry.path.push_back(frame);
+        entry.baseline = localFrames[0][frame] != NoIndex ? captures[0].frameStats[localFrames[0][frame]] : profiler::DiffStats();
+        entry.current = localFrames[1][frame] != NoIndex ? captures[1].frameStats[localFrames[1][frame]] : profiler::DiffStats();
+        setSignificance(entry, options);
+    }
+
+    sortEntries(diff.blocks);
+
+    if (!options.call_paths)
+        return;
+
+    // Align call paths: nodes of both captures are merged into one tree of global frames
+    PathTree paths;
+    std::vector<uint32_t> localNodes[2];
+    for (int c = 0; c < 2; ++c)
+    {
+        const auto& capture = captures[c];
+        const auto& local = capture.paths;
+        std::vector<uint32_t> globalNodes(local.size(), NoIndex);
+        for (uint32_t i = 0, n = local.size(); i < n; ++i)
+        {
+            // Parent node is always added before its children
+            const auto localParent = local.parents[i];
+            const auto parent = localParent != NoIndex ? globalNodes[localParent] : NoIndex;
+            const auto node = paths.child(parent, globalFrames[c][local.frames[i]]);
+
+            if (localNodes[c].size() <= node)
+                localNodes[c].resize(node + 1, NoIndex);
+            localNodes[c][node] = i;
+            globalNodes[i] = node;
+        }
+    }
+
+    paths.shrink();
+    for (auto& nodes : localNodes)
+        nodes.resize(paths.size(), NoIndex);
+
+    diff.call_paths.reserve(paths.size());
+    for (uint32_t node = 0, n = paths.size(); node < n; ++node)
+    {
+        if (paths.parents[node] == NoIndex)
+            continue; // thread frame
+
+        diff.call_paths.emplace_back();
+        auto& entry = diff.call_paths.back();
+        for (auto i = node; i != NoIndex; i = paths.parents[i])
+            entry.path.push_back(paths.frames[i]);
+
+        std::reverse(entry.path.begin(), entry.path.end());
+
+        const auto baseline = localNodes[0][node];
+        const auto current = localNodes[1][node];
+        entry.baseline = baseline != NoIndex ? captures[0].nodeStats[baseline] : profiler::DiffStats();
+        entry.current = current != NoIndex ? captures[1].nodeStats[current] : profiler::DiffStats();
+        setSignificance(entry, options);
+    }
+
+    sortEntries(diff.call_paths);
+}
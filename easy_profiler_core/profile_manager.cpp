@@ -49,8 +49,13 @@
 ************************************************************************/
 
 #include <algorithm>
+#include <cassert>
+#include <deque>
 #include <future>
 #include <fstream>
+#include <limits>
+#include <list>
+#include <memory>
 #include <ostream>
 #include <sstream>
 #include "profile_manager.h"
@@ -58,6 +63,7 @@
 #include <easy/profiler.h>
 #include <easy/arbitrary_value.h>
 #include <easy/easy_net.h>
+#include <easy/easy_compression.h>
 
 #ifndef _WIN32
 # include <easy/easy_socket.h>
@@ -68,6 +74,7 @@
 #include "block_descriptor.h"
 #include "current_time.h"
 #include "current_thread.h"
+#include "socket_poller.h"
 
 #ifdef __APPLE__
 # include <mach/clock.h>
@@ -156,6 +163,10 @@ EASY_CONSTEXPR uint8_t FORCE_ON_FLAG = profiler::FORCE_ON & ~profiler::ON;
 
 //////////////////////////////////////////////////////////////////////////
 
+std::atomic<uint32_t> profiler::EASY_ENABLED_CATEGORIES(profiler::categories::All);
+
+//////////////////////////////////////////////////////////////////////////
+
 static EASY_THREAD_LOCAL ::ThreadStorage* THIS_THREAD = nullptr;
 static EASY_THREAD_LOCAL bool THIS_THREAD_IS_MAIN = false;
 
@@ -192,11 +203,15 @@ thread_local static profiler::ThreadGuard THIS_THREAD_GUARD; // thread guard for
             __FILE__, __LINE__, profiler::BlockType::Event, profiler::extract_color(__VA_ARGS__)));\
     storeBlockForce2(EASY_UNIQUE_DESC(__LINE__), EASY_RUNTIME_NAME(name), timestamp)
 
-# define EASY_FORCE_EVENT3(ts, timestamp, name, ...)\
-    EASY_LOCAL_STATIC_PTR(const profiler::BaseBlockDescriptor*, EASY_UNIQUE_DESC(__LINE__), addBlockDescriptor(\
+// Descriptor for EASY_FORCE_EVENT3 is registered separately because addBlockDescriptor() locks m_storedSpin
+// and EASY_FORCE_EVENT3 is used while m_storedSpin is already locked.
+# define EASY_FORCE_EVENT_DESCRIPTOR(desc, name, ...)\
+    EASY_LOCAL_STATIC_PTR(const profiler::BaseBlockDescriptor*, desc, addBlockDescriptor(\
         profiler::extract_enable_flag(__VA_ARGS__), EASY_UNIQUE_LINE_ID, EASY_COMPILETIME_NAME(name),\
-            __FILE__, __LINE__, profiler::BlockType::Event, profiler::extract_color(__VA_ARGS__)));\
-    ts.storeBlockForce(profiler::Block(timestamp, timestamp, EASY_UNIQUE_DESC(__LINE__)->id(), EASY_RUNTIME_NAME(name)))
+            __FILE__, __LINE__, profiler::BlockType::Event, profiler::extract_color(__VA_ARGS__)))
+
+# define EASY_FORCE_EVENT3(ts, desc, timestamp)\
+    ts.storeBlockForce(profiler::Block(timestamp, timestamp, desc->id(), ""))
 #else
 # ifndef EASY_PROFILER_API_DISABLED
 #  define EASY_PROFILER_API_DISABLED
@@ -204,7 +219,8 @@ thread_local static profiler::ThreadGuard THIS_THREAD_GUARD; // thread guard for
 # define EASY_EVENT_RES(res, name, ...)
 # define EASY_FORCE_EVENT(timestamp, name, ...)
 # define EASY_FORCE_EVENT2(timestamp, name, ...)
-# define EASY_FORCE_EVENT3(ts, timestamp, name, ...)
+# define EASY_FORCE_EVENT_DESCRIPTOR(desc, name, ...)
+# define EASY_FORCE_EVENT3(ts, desc, timestamp)
 #endif
 
 //////////////////////////////////////////////////////////////////////////
@@ -221,6 +237,22 @@ static void write(std::ostream& _outstream, const T& _data)
     _outstream.write((const char*)&_data, sizeof(T));
 }
 
+static uint16_t descriptor_size(const BlockDescriptor& _descriptor)
+{
+    return static_cast<uint16_t>(sizeof(profiler::SerializedBlockDescriptor) + _descriptor.nameSize()
+                                 + _descriptor.filenameSize());
+}
+
+static void write_descriptor(std::ostream& _outstream, const BlockDescriptor& _descriptor)
+{
+    const auto name_size = _descriptor.nameSize();
+    write(_outstream, descriptor_size(_descriptor));
+    write<profiler::BaseBlockDescriptor>(_outstream, _descriptor);
+    write(_outstream, name_size);
+    write(_outstream, _descriptor.name(), name_size);
+    write(_outstream, _descriptor.filename(), _descriptor.filenameSize());
+}
+
 static void clear_sstream(std::stringstream& _outstream)
 {
 #if defined(__GNUC__) && __GNUC__ < 5
@@ -337,6 +369,22 @@ ProfileManager::ProfileManager() :
     m_stopDumping = false;
     m_stopListen = false;
 
+    m_triggerDelay = 500;
+    m_triggerCooldown = 5000;
+    m_triggerBufferSize = 64ULL << 20;
+    m_networkSession = false;
+    m_triggeredCaptures = 0;
+    m_triggerSubscribers = 0;
+    m_isTriggerThreadStarted = false;
+    m_stopTriggers = false;
+
+    m_allocationsDesc = nullptr;
+
+    m_sampledDescriptors = 0;
+    m_samplingGeneration = 1;
+
+    m_blockOverhead = 0;
+
     m_mainThreadId = 0;
     m_frameMax = 0;
     m_frameAvg = 0;
@@ -363,6 +411,10 @@ ProfileManager::~ProfileManager()
 {
 #ifndef EASY_PROFILER_API_DISABLED
     stopListen();
+
+    m_stopTriggers.store(true, std::memory_order_release);
+    if (m_triggerThread.joinable())
+        m_triggerThread.join();
 #endif
 
     for (auto desc : m_descriptors)
@@ -407,8 +459,9 @@ ThreadStorage* ProfileManager::_findThreadStorage(profiler::thread_id_t _thread_
 
 const profiler::BaseBlockDescriptor* ProfileManager::addBlockDescriptor(profiler::EasyBlockStatus _defaultStatus
     , const char* _autogenUniqueId, const char* _name, const char* _filename, int _line
-    , profiler::block_type_t _block_type, profiler::color_t _color, bool _copyName)
+    , profiler::block_type_t _block_type, profiler::color_t _color, bool _copyName, profiler::category_t _categories)
 {
+    InternalAllocationGuard allocationGuard;
     guard_lock_t lock(m_storedSpin);
 
     const descriptors_map_t::key_type key(_autogenUniqueId);
@@ -442,9 +495,23 @@ const profiler::BaseBlockDescriptor* ProfileManager::addBlockDescriptor(profiler
     (void)_copyName; // unused
 #endif
 
+    desc->m_categories = _categories;
+
     m_descriptors.emplace_back(desc);
     m_descriptorsMap.emplace(key, desc->id());
 
+    if (!m_triggers.empty())
+        m_triggers.onDescriptorAdded(desc->id(), desc->name(), desc->type());
+
+    for (const auto& rule : m_samplingRules)
+    {
+        if (rule.name == desc->name())
+        {
+            setSampling(*desc, rule.policy, rule.value);
+            break;
+        }
+    }
+
     return desc;
 }
 
@@ -453,7 +520,7 @@ const profiler::BaseBlockDescriptor* ProfileManager::addBlockDescriptor(profiler
 void ProfileManager::storeValue(const profiler::BaseBlockDescriptor* _desc, profiler::DataType _type, const void* _data,
                                 uint16_t _size, bool _isArray, profiler::ValueId _vin)
 {
-    if (!isEnabled() || (_desc->m_status & profiler::ON) == 0)
+    if (!isEnabled() || (_desc->m_status & profiler::ON) == 0 || !profiler::isCategoryEnabled(_desc))
         return;
 
     if (THIS_THREAD == nullptr)
@@ -469,13 +536,16 @@ void ProfileManager::storeValue(const profiler::BaseBlockDescriptor* _desc, prof
 #endif
 
     THIS_THREAD->storeValue(profiler::clock::now(), _desc->id(), _type, _data, _size, _isArray, _vin);
+
+    if (!_isArray)
+        m_triggers.checkValue(_desc->id(), _type, _data);
 }
 
 //////////////////////////////////////////////////////////////////////////
 
 bool ProfileManager::storeBlock(const profiler::BaseBlockDescriptor* _desc, const char* _runtimeName)
 {
-    if (!isEnabled() || (_desc->m_status & profiler::ON) == 0)
+    if (!isEnabled() || (_desc->m_status & profiler::ON) == 0 || !profiler::isCategoryEnabled(_desc))
         return false;
 
     if (THIS_THREAD == nullptr)
@@ -500,7 +570,7 @@ bool ProfileManager::storeBlock(const profiler::BaseBlockDescriptor* _desc, cons
 bool ProfileManager::storeBlock(const profiler::BaseBlockDescriptor* _desc, const char* _runtimeName,
                                 profiler::timestamp_t _beginTime, profiler::timestamp_t _endTime)
 {
-    if (!isEnabled() || (_desc->m_status & profiler::ON) == 0)
+    if (!isEnabled() || (_desc->m_status & profiler::ON) == 0 || !profiler::isCategoryEnabled(_desc))
         return false;
 
     if (THIS_THREAD == nullptr)
@@ -519,6 +589,8 @@ bool ProfileManager::storeBlock(const profiler::BaseBlockDescriptor* _desc, cons
     THIS_THREAD->storeBlock(b);
     b.m_end = b.m_begin;
 
+    m_triggers.checkBlock(_desc->id(), _endTime - _beginTime);
+
     THIS_THREAD->putMarkIfEmpty();
 
     return true;
@@ -526,6 +598,76 @@ bool ProfileManager::storeBlock(const profiler::BaseBlockDescriptor* _desc, cons
 
 //////////////////////////////////////////////////////////////////////////
 
+void ProfileManager::beginAsync(const profiler::BaseBlockDescriptor* _desc, uint64_t _correlationId)
+{
+    if (!isEnabled() || (_desc->m_status & profiler::ON) == 0 || !profiler::isCategoryEnabled(_desc))
+        return;
+
+    if (THIS_THREAD == nullptr)
+        registerThread();
+
+    const PendingAsync pending = {profiler::clock::now(), THIS_THREAD->id, _desc->id()};
+
+    guard_lock_t lock(m_asyncSpin);
+    m_pendingAsync[_correlationId] = pending;
+}
+
+void ProfileManager::endAsync(uint64_t _correlationId)
+{
+    const auto time = profiler::clock::now();
+
+    PendingAsync pending;
+    {
+        guard_lock_t lock(m_asyncSpin);
+        auto it = m_pendingAsync.find(_correlationId);
+        if (it == m_pendingAsync.end())
+            return;
+        pending = it->second;
+        m_pendingAsync.erase(it);
+    }
+
+    if (!isEnabled())
+        return;
+
+    if (THIS_THREAD == nullptr)
+        registerThread();
+
+    if (THIS_THREAD->stackSize > 0)
+        // Prevent from store async span until frame, which has been opened when profiler was disabled, finish
+        return;
+
+    // Async span is stored by the thread which finishes it because only this thread knows the whole span duration
+    THIS_THREAD->storeAsync(pending.begin, time, pending.id, _correlationId, pending.thread);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+void ProfileManager::enableAllocationsTracking()
+{
+    if (m_allocationsDesc.load(std::memory_order_acquire) != nullptr)
+        return;
+
+    m_allocationsDesc.store(addBlockDescriptor(profiler::ON, EASY_UNIQUE_LINE_ID, profiler::ALLOCATIONS_VALUE_NAME,
+                                               __FILE__, __LINE__, profiler::BlockType::Value, EASY_COLOR_INTERNAL_EVENT),
+                            std::memory_order_release);
+}
+
+void ProfileManager::storeAllocation(uint64_t _bytes, uint32_t _count)
+{
+    // Called from malloc hooks: must not lock and must not register thread
+    // (profiler's own allocations are marked by InternalAllocationGuard).
+
+    if (InternalAllocationGuard::depth != 0 || THIS_THREAD == nullptr || THIS_THREAD->stackSize > 0 || !isEnabled())
+        return;
+
+    if (m_allocationsDesc.load(std::memory_order_relaxed) == nullptr)
+        return;
+
+    THIS_THREAD->storeAllocation(_bytes, _count);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
 void ProfileManager::storeBlockForce(const profiler::BaseBlockDescriptor* _desc, const char* _runtimeName,
                                      profiler::timestamp_t& _timestamp)
 {
@@ -575,7 +717,7 @@ void ProfileManager::beginBlock(profiler::Block& _block)
         // _block is a sibling of current opened frame and this frame has been opened
         // before profiler was enabled. This _block should be ignored.
         _block.m_status = profiler::OFF;
-        THIS_THREAD->blocks.openedList.emplace_back(_block);
+        THIS_THREAD->pushOpened(_block);
         return;
     }
 
@@ -584,7 +726,7 @@ void ProfileManager::beginBlock(profiler::Block& _block)
         // _block is a top-level block (a.k.a. frame).
         // It should be ignored because profiler is disabled.
         _block.m_status = profiler::OFF;
-        THIS_THREAD->blocks.openedList.emplace_back(_block);
+        THIS_THREAD->pushOpened(_block);
         beginFrame(); // FPS counter
         return;
     }
@@ -599,14 +741,26 @@ void ProfileManager::beginBlock(profiler::Block& _block)
     {
 #endif
         if (blockStatus & profiler::ON)
-            _block.start();
+        {
+            if (sampledOut(_block.id()))
+                _block.m_status = static_cast<profiler::EasyBlockStatus>(blockStatus & profiler::OFF_RECURSIVE);
+            else
+                _block.start();
+        }
 #if EASY_ENABLE_BLOCK_STATUS != 0
         THIS_THREAD->allowChildren = ((blockStatus & profiler::OFF_RECURSIVE) == 0);
     }
     else if (blockStatus & FORCE_ON_FLAG)
     {
-        _block.start();
-        _block.m_status = profiler::FORCE_ON_WITHOUT_CHILDREN;
+        if (sampledOut(_block.id()))
+        {
+            _block.m_status = profiler::OFF_RECURSIVE;
+        }
+        else
+        {
+            _block.start();
+            _block.m_status = profiler::FORCE_ON_WITHOUT_CHILDREN;
+        }
     }
     else
     {
@@ -617,7 +771,81 @@ void ProfileManager::beginBlock(profiler::Block& _block)
     if (THIS_THREAD->blocks.openedList.empty())
         beginFrame(); // FPS counter
 
-    THIS_THREAD->blocks.openedList.emplace_back(_block);
+    THIS_THREAD->pushOpened(_block);
+}
+
+bool ProfileManager::sampledOut(profiler::block_id_t _id)
+{
+    if (m_sampledDescriptors.load(std::memory_order_relaxed) == 0)
+        return false;
+
+    const auto generation = m_samplingGeneration.load(std::memory_order_acquire);
+    if (THIS_THREAD->samplingGeneration != generation)
+        updateSamplers(generation);
+
+    return !THIS_THREAD->sample(_id);
+}
+
+void ProfileManager::updateSamplers(uint32_t _generation)
+{
+    // Copy sampling policies into thread-local samplers and restart sampling counters.
+    // This happens once per capture (or after policy change) for each thread.
+
+    InternalAllocationGuard allocationGuard;
+    guard_lock_t lock(m_storedSpin);
+
+    auto& samplers = THIS_THREAD->samplers;
+    const auto now = profiler::clock::now();
+
+    samplers.resize(m_descriptors.size());
+    for (size_t i = 0; i < samplers.size(); ++i)
+    {
+        const auto& desc = *m_descriptors[i];
+        auto& sampler = samplers[i];
+        sampler = ThreadStorage::Sampler {};
+        sampler.policy = desc.m_samplingPolicy;
+        sampler.value = desc.m_samplingValue;
+        sampler.period = desc.m_samplingPolicy == profiler::SamplingPolicy::OneInN ? desc.m_samplingValue : 1;
+        sampler.windowBegin = now;
+    }
+
+    THIS_THREAD->samplingWindow = std::max(us2ticks(1000000), static_cast<profiler::timestamp_t>(1));
+    THIS_THREAD->samplingGeneration = _generation;
+}
+
+void ProfileManager::updateSamplingWeights()
+{
+    // Must be called under m_spin and m_storedSpin.
+    // Sampling weight is the average number of calls represented by one stored block.
+    //
+    // Sampling counters of other threads are read without synchronization: they are modified by the owning
+    // threads only while profiler is enabled, so this must be called only by dumpBlocksToStream() after
+    // m_profilerStatus has been switched off and all ThreadStorage::storeBlock() have finished (20 ms wait).
+    assert(!m_profilerStatus.load(std::memory_order_acquire));
+
+    if (m_sampledDescriptors.load(std::memory_order_acquire) == 0)
+        return;
+
+    const auto generation = m_samplingGeneration.load(std::memory_order_acquire);
+    for (auto desc : m_descriptors)
+    {
+        if (desc->m_samplingPolicy == profiler::SamplingPolicy::None)
+            continue;
+
+        uint64_t calls = 0, stored = 0;
+        for (const auto& it : m_threads)
+        {
+            const auto& thread = it.second;
+            if (thread.samplingGeneration == generation && desc->id() < thread.samplers.size())
+            {
+                const auto& sampler = thread.samplers[desc->id()];
+                calls += sampler.calls;
+                stored += sampler.stored;
+            }
+        }
+
+        desc->m_samplingWeight = stored != 0 ? static_cast<float>(static_cast<double>(calls) / stored) : 1.f;
+    }
 }
 
 void ProfileManager::beginNonScopedBlock(const profiler::BaseBlockDescriptor* _desc, const char* _runtimeName)
@@ -670,12 +898,17 @@ void ProfileManager::endBlock()
     {
         if (!top.finished())
             top.finish();
+        if (!THIS_THREAD->allocations.empty())
+            THIS_THREAD->storeAllocations(m_allocationsDesc.load(std::memory_order_relaxed), top.m_end);
         THIS_THREAD->storeBlock(top);
+        m_triggers.checkBlock(top.id(), top.duration());
     }
     else
     {
         // This is to restrict endBlock() call inside ~Block()
         top.m_end = top.m_begin;
+        if (!THIS_THREAD->allocations.empty())
+            THIS_THREAD->storeAllocations(nullptr, 0);
     }
 
     if (!top.m_isScoped)
@@ -685,6 +918,8 @@ void ProfileManager::endBlock()
     if (currentThreadStack.empty())
     {
         THIS_THREAD->putMark();
+        if (!m_triggers.empty())
+            retainTriggeredFrames();
         endFrame(); // FPS counter
 #if EASY_ENABLE_BLOCK_STATUS != 0
         THIS_THREAD->allowChildren = true;
@@ -778,6 +1013,9 @@ void ProfileManager::endFrame()
 
         m_frameCur.store(duration, std::memory_order_release);
 
+        if (isEnabled())
+            m_triggers.checkFrame(duration);
+
         return;
     }
 
@@ -835,7 +1073,7 @@ void ProfileManager::setEnabled(bool isEnable)
     {
         EASY_LOGMSG("Enabled profiling\n");
         enableEventTracer();
-        m_beginTime = time;
+        beginCapture(time);
     }
     else
     {
@@ -845,6 +1083,75 @@ void ProfileManager::setEnabled(bool isEnable)
     }
 }
 
+void ProfileManager::beginCapture(profiler::timestamp_t _time)
+{
+    // Must be called under m_dumpSpin right after m_profilerStatus has been switched on
+    // (by setEnabled(), network capture request or streaming session).
+
+    m_beginTime = _time;
+
+    // Restart per-thread sampling counters to calculate sampling weights of this capture only
+    m_samplingGeneration.fetch_add(1, std::memory_order_acq_rel);
+
+    // Drop async spans which were started during previous capture and have never been finished
+    {
+        guard_lock_t asyncLock(m_asyncSpin);
+        m_pendingAsync.clear();
+    }
+
+    // Drop streamed frames which have been kept for network capture whose client has gone
+    dropStreamedCapture();
+
+    calibrateBlockOverhead();
+}
+
+void ProfileManager::calibrateBlockOverhead()
+{
+    // Measure the cost of an empty nested block as it is seen by its parent:
+    // Block construction, beginBlock(), endBlock() and two clock reads.
+    // Blocks are stored into temporary thread storage, so they never get into the capture.
+    // Descriptor is not registered: it must not appear in descriptors list of the capture.
+    // Its id is out of range of registered descriptors, so it is never sampled or checked by triggers.
+
+    EASY_CONSTEXPR int Rounds = 15;
+    EASY_CONSTEXPR int BlocksPerRound = 256;
+
+    InternalAllocationGuard allocationGuard;
+    const BlockDescriptor calibration(std::numeric_limits<profiler::block_id_t>::max(), profiler::ON, "ProfilerCalibration",
+                                      __FILE__, __LINE__, profiler::BlockType::Block, EASY_COLOR_INTERNAL_EVENT);
+    const auto desc = &calibration;
+
+    ThreadStorage storage;
+    auto const currentThread = THIS_THREAD;
+    THIS_THREAD = &storage;
+
+    // Parent is never started or stored. It is needed to make calibration blocks nested (not frames).
+    profiler::Block parent(desc, "", true);
+    parent.m_status = profiler::ON;
+    parent.m_end = parent.m_begin;
+    storage.pushOpened(parent);
+
+    profiler::timestamp_t samples[Rounds];
+    for (auto& sample : samples)
+    {
+        const auto begin = profiler::clock::now();
+        for (int i = 0; i < BlocksPerRound; ++i)
+        {
+            profiler::Block block(desc, "", true);
+            block.m_status = profiler::ON; // Ignore status and categories set by user
+            beginBlock(block);
+        }
+        sample = (profiler::clock::now() - begin) / BlocksPerRound;
+    }
+
+    THIS_THREAD = currentThread;
+
+    std::nth_element(samples, samples + Rounds / 2, samples + Rounds);
+    m_blockOverhead.store(samples[Rounds / 2], std::memory_order_release);
+
+    EASY_LOGMSG("Calibrated block overhead: " << samples[Rounds / 2] << " ticks\n");
+}
+
 void ProfileManager::setEventTracingEnabled(bool _isEnable)
 {
     m_isEventTracingEnabled.store(_isEnable, std::memory_order_release);
@@ -933,6 +1240,8 @@ uint32_t ProfileManager::dumpBlocksToStream(std::ostream& _outputStream, bool _l
     // Note: this means - wait for all ThreadStorage::storeBlock() to finish.
     std::this_thread::sleep_for(std::chrono::milliseconds(20));
 
+    EASY_FORCE_EVENT_DESCRIPTOR(threadExpiredDesc, "ThreadExpired", EASY_COLOR_THREAD_END);
+
     // This is to make sure that no new descriptors or new threads will be
     // added until we finish sending data.
     m_spin.lock();
@@ -1012,6 +1321,14 @@ uint32_t ProfileManager::dumpBlocksToStream(std::ostream& _outputStream, bool _l
 
         auto& thread = thread_it->second;
         uint32_t num = thread.blocks.closedList.markedSize() + thread.sync.closedList.size();
+        uint64_t streamedMemorySize = 0;
+        {
+            // Frames which have been moved out of closedList for streaming belong to this capture too
+            guard_lock_t streamLock(thread.streamSpin);
+            num += thread.retainedBlocksNumber + thread.streamCapturedBlocksNumber + thread.streamBlocksNumber;
+            streamedMemorySize = thread.retainedMemorySize + thread.streamCapturedMemorySize + thread.streamMemorySize;
+        }
+
         const char expired = ProfileManager::checkThreadExpired(thread);
 
 #ifdef _WIN32
@@ -1039,58 +1356,35 @@ uint32_t ProfileManager::dumpBlocksToStream(std::ostream& _outputStream, bool _l
 
         if (expired == 1)
         {
-            EASY_FORCE_EVENT3(thread, endtime, "ThreadExpired", EASY_COLOR_THREAD_END);
+            EASY_FORCE_EVENT3(thread, threadExpiredDesc, endtime);
             ++num;
         }
 
-        usedMemorySize += thread.blocks.usedMemorySize + thread.sync.usedMemorySize;
+        usedMemorySize += thread.blocks.usedMemorySize + thread.sync.usedMemorySize + streamedMemorySize;
         blocks_number += num;
         ++thread_it;
     }
 
-    // Write profiler signature and version
-    write(_outputStream, EASY_PROFILER_SIGNATURE);
-    write(_outputStream, EASY_PROFILER_VERSION);
-    write(_outputStream, m_processId);
-
     // Write CPU frequency to let GUI calculate real time value from CPU clocks
 #if defined(EASY_CHRONO_CLOCK) || defined(_WIN32)
-    write(_outputStream, m_cpuFrequency);
+    const int64_t cpu_frequency = m_cpuFrequency;
+    writeFileHeader(_outputStream, cpu_frequency, m_endTime, usedMemorySize, blocks_number,
+                    static_cast<uint32_t>(m_threads.size()));
 #else
     EASY_LOGMSG("Calculating CPU frequency\n");
     const int64_t cpu_frequency = calculate_cpu_frequency();
-    write(_outputStream, cpu_frequency * 1000LL);
+    writeFileHeader(_outputStream, cpu_frequency * 1000LL, m_endTime, usedMemorySize, blocks_number,
+                    static_cast<uint32_t>(m_threads.size()));
     EASY_LOGMSG("Done calculating CPU frequency\n");
 
     m_cpuFrequency.store(cpu_frequency, std::memory_order_release);
 #endif
 
-    // Write begin and end time
-    write(_outputStream, m_beginTime);
-    write(_outputStream, m_endTime);
-
-    // Write blocks number and used memory size
-    write(_outputStream, usedMemorySize);
-    write(_outputStream, m_descriptorsMemorySize);
-    write(_outputStream, blocks_number);
-    write(_outputStream, static_cast<uint32_t>(m_descriptors.size()));
-    write(_outputStream, static_cast<uint32_t>(m_threads.size()));
-    write(_outputStream, static_cast<uint16_t>(0)); // Bookmarks count (they can be created by user in the UI)
-    write(_outputStream, static_cast<uint16_t>(0)); // padding
+    updateSamplingWeights();
 
     // Write block descriptors
     for (const auto descriptor : m_descriptors)
-    {
-        const auto name_size = descriptor->nameSize();
-        const auto filename_size = descriptor->filenameSize();
-        const auto size = static_cast<uint16_t>(sizeof(profiler::SerializedBlockDescriptor) + name_size + filename_size);
-
-        write(_outputStream, size);
-        write<profiler::BaseBlockDescriptor>(_outputStream, *descriptor);
-        write(_outputStream, name_size);
-        write(_outputStream, descriptor->name(), name_size);
-        write(_outputStream, descriptor->filename(), filename_size);
-    }
+        write_descriptor(_outputStream, *descriptor);
 
     // Write blocks and context switch events for each thread
     for (auto thread_it = m_threads.begin(), end = m_threads.end(); thread_it != end;)
@@ -1116,9 +1410,31 @@ uint32_t ProfileManager::dumpBlocksToStream(std::ostream& _outputStream, bool _l
         if (!thread.sync.closedList.empty())
             thread.sync.closedList.serialize(_outputStream);
 
-        write(_outputStream, thread.blocks.closedList.markedSize());
-        if (!thread.blocks.closedList.markedEmpty())
-            thread.blocks.closedList.serialize(_outputStream);
+        {
+            // Streamed frames are older than frames which are still in closedList, so they are written first
+            guard_lock_t streamLock(thread.streamSpin);
+            write(_outputStream, thread.retainedBlocksNumber + thread.streamCapturedBlocksNumber
+                                 + thread.streamBlocksNumber + thread.blocks.closedList.markedSize());
+
+            write(_outputStream, thread.retainedFrames.data(), thread.retainedFrames.size());
+            std::string().swap(thread.retainedFrames);
+            thread.retainedBlocksNumber = 0;
+            thread.retainedMemorySize = 0;
+
+            write(_outputStream, thread.streamCaptured.data(), thread.streamCaptured.size());
+            std::string().swap(thread.streamCaptured);
+            thread.streamCapturedBlocksNumber = 0;
+            thread.streamCapturedMemorySize = 0;
+
+            const auto streamed = thread.streamData.str();
+            write(_outputStream, streamed.data(), streamed.size());
+            clear_sstream(thread.streamData);
+            thread.streamBlocksNumber = 0;
+            thread.streamMemorySize = 0;
+
+            if (!thread.blocks.closedList.markedEmpty())
+                thread.serializeClosed(_outputStream);
+        }
 
         thread.clearClosed();
         //t.blocks.openedList.clear();
@@ -1152,6 +1468,194 @@ uint32_t ProfileManager::dumpBlocksToStream(std::ostream& _outputStream, bool _l
     return blocks_number;
 }
 
+void ProfileManager::dropStreamedCapture()
+{
+    guard_lock_t lock(m_spin);
+    for (auto& it : m_threads)
+    {
+        auto& thread = it.second;
+        guard_lock_t threadLock(thread.streamSpin);
+        std::string().swap(thread.streamCaptured);
+        thread.streamCapturedBlocksNumber = 0;
+        thread.streamCapturedMemorySize = 0;
+    }
+}
+
+uint32_t ProfileManager::dumpStreamedBlocksToStream(std::ostream& _outputStream, bool _release)
+{
+    // Writes capture of network client which has stopped capturing while other capture or streaming session
+    // keeps profiler enabled. Only frames kept in ThreadStorage::streamCaptured are written, so profiler
+    // is not disabled and closed lists of threads are not touched.
+
+    guard_lock_t lock(m_spin);
+    guard_lock_t storedLock(m_storedSpin);
+
+    uint64_t usedMemorySize = 0;
+    uint32_t blocksNumber = 0, threadsNumber = 0;
+    for (auto& it : m_threads)
+    {
+        auto& thread = it.second;
+        guard_lock_t threadLock(thread.streamSpin);
+        if (thread.streamCapturedBlocksNumber == 0)
+            continue;
+
+        usedMemorySize += thread.streamCapturedMemorySize;
+        blocksNumber += thread.streamCapturedBlocksNumber;
+        ++threadsNumber;
+    }
+
+#if defined(EASY_CHRONO_CLOCK) || defined(_WIN32)
+    const int64_t cpuFrequency = m_cpuFrequency;
+#else
+    const int64_t cpuFrequency = m_cpuFrequency.load(std::memory_order_acquire) * 1000LL;
+#endif
+
+    writeFileHeader(_outputStream, cpuFrequency, profiler::clock::now(), usedMemorySize, blocksNumber, threadsNumber);
+
+    for (const auto descriptor : m_descriptors)
+        write_descriptor(_outputStream, *descriptor);
+
+    for (auto& it : m_threads)
+    {
+        auto& thread = it.second;
+        guard_lock_t threadLock(thread.streamSpin);
+        if (thread.streamCapturedBlocksNumber == 0)
+            continue;
+
+        write(_outputStream, it.first);
+
+        const auto name_size = static_cast<uint16_t>(thread.name.size() + 1);
+        write(_outputStream, name_size);
+        write(_outputStream, name_size > 1 ? thread.name.c_str() : "", name_size);
+
+        write(_outputStream, static_cast<uint32_t>(0)); // Context switches are not streamed
+        write(_outputStream, thread.streamCapturedBlocksNumber);
+        write(_outputStream, thread.streamCaptured.data(), thread.streamCaptured.size());
+
+        if (_release)
+        {
+            std::string().swap(thread.streamCaptured);
+            thread.streamCapturedBlocksNumber = 0;
+            thread.streamCapturedMemorySize = 0;
+        }
+    }
+
+    write(_outputStream, EASY_PROFILER_SIGNATURE);
+
+    return blocksNumber;
+}
+
+void ProfileManager::writeFileHeader(std::ostream& _outputStream, int64_t _cpuFrequency, profiler::timestamp_t _endTime,
+                                     uint64_t _usedMemorySize, uint32_t _blocksNumber, uint32_t _threadsNumber)
+{
+    // Write profiler signature and version
+    write(_outputStream, EASY_PROFILER_SIGNATURE);
+    write(_outputStream, EASY_PROFILER_VERSION);
+    write(_outputStream, m_processId);
+    write(_outputStream, _cpuFrequency);
+
+    // Write begin and end time
+    write(_outputStream, m_beginTime);
+    write(_outputStream, _endTime);
+
+    // Write blocks number and used memory size
+    write(_outputStream, _usedMemorySize);
+    write(_outputStream, m_descriptorsMemorySize);
+    write(_outputStream, _blocksNumber);
+    write(_outputStream, static_cast<uint32_t>(m_descriptors.size()));
+    write(_outputStream, _threadsNumber);
+    write(_outputStream, static_cast<uint16_t>(0)); // Bookmarks count (they can be created by user in the UI)
+    write(_outputStream, static_cast<uint16_t>(0)); // padding
+    write(_outputStream, m_blockOverhead.load(std::memory_order_acquire));
+}
+
+void ProfileManager::writeStreamDescriptors(std::ostream& _outputStream, uint32_t& _descriptorsSent)
+{
+    // Writes descriptors part of profiler::net::StreamFrameMessage payload.
+    // Descriptors are sent only once, so every client has it's own _descriptorsSent counter.
+
+    guard_lock_t lock(m_storedSpin);
+
+    const auto descriptorsNumber = static_cast<uint32_t>(m_descriptors.size());
+    uint64_t descriptorsMemorySize = 0;
+    for (auto i = _descriptorsSent; i < descriptorsNumber; ++i)
+        descriptorsMemorySize += descriptor_size(*m_descriptors[i]);
+
+    write(_outputStream, descriptorsNumber - _descriptorsSent);
+    write(_outputStream, descriptorsMemorySize);
+    for (auto i = _descriptorsSent; i < descriptorsNumber; ++i)
+        write_descriptor(_outputStream, *m_descriptors[i]);
+
+    _descriptorsSent = descriptorsNumber;
+}
+
+uint32_t ProfileManager::streamBlocksToStream(std::ostream& _outputStream, bool _collectAll, bool _keepForCapture)
+{
+    // Writes threads part of profiler::net::StreamFrameMessage payload (the same for all streaming clients).
+    // _collectAll == true means that profiler has been disabled and closed frames which have not been
+    // moved to ThreadStorage::streamData yet can be safely serialized by the listening thread.
+    // _keepForCapture == true means that some network client is capturing, so streamed frames are also
+    // kept in ThreadStorage::streamCaptured to be sent to it when capture stops.
+
+    guard_lock_t lock(m_spin);
+
+    // Threads number is unknown until all threads would be checked
+    const auto threadsNumberPos = _outputStream.tellp();
+    uint32_t threadsNumber = 0, blocksNumber = 0;
+    write(_outputStream, threadsNumber);
+
+    for (auto& it : m_threads)
+    {
+        auto& thread = it.second;
+
+        if (_collectAll)
+            thread.streamFrames();
+
+        guard_lock_t threadLock(thread.streamSpin);
+        if (thread.streamBlocksNumber == 0)
+            continue;
+
+        write(_outputStream, it.first);
+
+        const auto name_size = static_cast<uint16_t>(thread.name.size() + 1);
+        write(_outputStream, name_size);
+        write(_outputStream, name_size > 1 ? thread.name.c_str() : "", name_size);
+
+        write(_outputStream, thread.streamBlocksNumber);
+        write(_outputStream, thread.streamMemorySize);
+
+        const auto data = thread.streamData.str();
+        write(_outputStream, data.data(), data.size());
+
+        if (_keepForCapture)
+        {
+            thread.streamCaptured.append(data);
+            thread.streamCapturedBlocksNumber += thread.streamBlocksNumber;
+            thread.streamCapturedMemorySize += thread.streamMemorySize;
+        }
+
+        clear_sstream(thread.streamData);
+        blocksNumber += thread.streamBlocksNumber;
+        thread.streamBlocksNumber = 0;
+        thread.streamMemorySize = 0;
+        ++threadsNumber;
+    }
+
+    const auto endPos = _outputStream.tellp();
+    _outputStream.seekp(threadsNumberPos);
+    write(_outputStream, threadsNumber);
+    _outputStream.seekp(endPos);
+
+    return blocksNumber;
+}
+
+void ProfileManager::requestStreamFrames()
+{
+    guard_lock_t lock(m_spin);
+    for (auto& it : m_threads)
+        it.second.streamRequested.store(true, std::memory_order_release);
+}
+
 uint32_t ProfileManager::dumpBlocksToFile(const char* _filename)
 {
     EASY_LOGMSG("dumpBlocksToFile(\"" << _filename << "\")...\n");
@@ -1251,18 +1755,85 @@ void ProfileManager::setBlockStatus(profiler::block_id_t _id, profiler::EasyBloc
     }
 }
 
-void ProfileManager::startListen(uint16_t _port)
+void ProfileManager::setSampling(BlockDescriptor& _desc, profiler::SamplingPolicy _policy, uint32_t _value)
 {
-    if (!m_isAlreadyListening.exchange(true, std::memory_order_acq_rel))
-    {
-        m_stopListen.store(false, std::memory_order_release);
-        m_listenThread = std::thread(&ProfileManager::listen, this, _port);
-    }
-}
+    // Must be called under m_storedSpin
 
-void ProfileManager::stopListen()
-{
-    m_stopListen.store(true, std::memory_order_release);
+    if (_policy >= profiler::SamplingPolicy::PoliciesCount || _value == 0)
+        _policy = profiler::SamplingPolicy::None;
+
+    if (_policy == profiler::SamplingPolicy::None)
+        _value = 0;
+
+    if (_desc.m_samplingPolicy == profiler::SamplingPolicy::None && _policy != profiler::SamplingPolicy::None)
+        m_sampledDescriptors.fetch_add(1, std::memory_order_acq_rel);
+    else if (_desc.m_samplingPolicy != profiler::SamplingPolicy::None && _policy == profiler::SamplingPolicy::None)
+        m_sampledDescriptors.fetch_sub(1, std::memory_order_acq_rel);
+
+    _desc.m_samplingPolicy = _policy;
+    _desc.m_samplingValue = _value;
+    _desc.m_samplingWeight = 1.f;
+
+    m_samplingGeneration.fetch_add(1, std::memory_order_acq_rel);
+}
+
+void ProfileManager::setBlockSampling(const char* _name, profiler::SamplingPolicy _policy, uint32_t _value)
+{
+    if (_name == nullptr)
+        return;
+
+    InternalAllocationGuard allocationGuard;
+    guard_lock_t lock(m_storedSpin);
+
+    auto it = std::find_if(m_samplingRules.begin(), m_samplingRules.end(), [_name](const SamplingRule& rule) {
+        return rule.name == _name;
+    });
+
+    if (it == m_samplingRules.end())
+        it = m_samplingRules.insert(m_samplingRules.end(), SamplingRule {_name, _policy, _value});
+    else
+    {
+        it->policy = _policy;
+        it->value = _value;
+    }
+
+    for (auto desc : m_descriptors)
+    {
+        if (strcmp(desc->name(), _name) == 0)
+            setSampling(*desc, _policy, _value);
+    }
+}
+
+void ProfileManager::setCategoriesEnabled(profiler::category_t _categories, bool _isEnable)
+{
+    if (_isEnable)
+        profiler::EASY_ENABLED_CATEGORIES.fetch_or(_categories, std::memory_order_acq_rel);
+    else
+        profiler::EASY_ENABLED_CATEGORIES.fetch_and(~static_cast<uint32_t>(_categories), std::memory_order_acq_rel);
+}
+
+void ProfileManager::setBlockSampling(profiler::block_id_t _id, profiler::SamplingPolicy _policy, uint32_t _value)
+{
+    if (isEnabled())
+        return; // Changing blocks sampling is restricted while profile session is active (the same as blocks statuses)
+
+    guard_lock_t lock(m_storedSpin);
+    if (_id < m_descriptors.size())
+        setSampling(*m_descriptors[_id], _policy, _value);
+}
+
+void ProfileManager::startListen(uint16_t _port)
+{
+    if (!m_isAlreadyListening.exchange(true, std::memory_order_acq_rel))
+    {
+        m_stopListen.store(false, std::memory_order_release);
+        m_listenThread = std::thread(&ProfileManager::listen, this, _port);
+    }
+}
+
+void ProfileManager::stopListen()
+{
+    m_stopListen.store(true, std::memory_order_release);
     if (m_listenThread.joinable())
         m_listenThread.join();
     m_isAlreadyListening.store(false, std::memory_order_release);
@@ -1275,6 +1846,165 @@ bool ProfileManager::isListening() const
 
 //////////////////////////////////////////////////////////////////////////
 
+uint32_t ProfileManager::addTrigger(CaptureTriggers::Type _type, const char* _name, double _threshold)
+{
+    uint32_t id = 0;
+
+    {
+        // Lock descriptors to not miss a new one which is being registered right now
+        guard_lock_t lock(m_storedSpin);
+        id = m_triggers.add(_type, _name, _threshold, m_descriptors);
+    }
+
+    if (!m_isTriggerThreadStarted.exchange(true, std::memory_order_acq_rel))
+        m_triggerThread = std::thread(&ProfileManager::triggersLoop, this);
+
+    return id;
+}
+
+void ProfileManager::removeTrigger(uint32_t _triggerId)
+{
+    m_triggers.remove(_triggerId);
+}
+
+void ProfileManager::setTriggeredCaptureFilename(const char* _filenamePrefix)
+{
+    guard_lock_t lock(m_triggerSpin);
+    m_triggeredCaptureFilename = _filenamePrefix != nullptr ? _filenamePrefix : "";
+}
+
+void ProfileManager::setTriggeredCaptureDelays(uint32_t _afterTriggerMs, uint32_t _cooldownMs)
+{
+    m_triggerDelay.store(_afterTriggerMs, std::memory_order_release);
+    m_triggerCooldown.store(_cooldownMs, std::memory_order_release);
+}
+
+void ProfileManager::setTriggeredCaptureBufferSize(uint32_t _megabytes)
+{
+    m_triggerBufferSize.store(static_cast<uint64_t>(_megabytes) << 20, std::memory_order_release);
+}
+
+uint32_t ProfileManager::triggeredCapturesCount() const
+{
+    return m_triggeredCaptures.load(std::memory_order_acquire);
+}
+
+void ProfileManager::triggersLoop()
+{
+    EASY_THREAD_SCOPE("EasyProfiler.Triggers");
+
+    // Triggers are checked by profiled threads, this thread only waits until one of them fires
+    // and dumps collected data, so profiled threads are not blocked by dumping.
+
+    const auto sleep = [this] (uint32_t _milliseconds)
+    {
+        const auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(_milliseconds);
+        while (!m_stopTriggers.load(std::memory_order_acquire) && std::chrono::steady_clock::now() < until)
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    };
+
+    while (!m_stopTriggers.load(std::memory_order_acquire))
+    {
+        profiler::timestamp_t firedTime = 0;
+        if (m_triggers.fired(firedTime) == 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            continue;
+        }
+
+        EASY_FORCE_EVENT2(firedTime, "CaptureTriggered", EASY_COLOR_END);
+
+        // Collect some data after the trigger too
+        sleep(m_triggerDelay.load(std::memory_order_acquire));
+        if (m_stopTriggers.load(std::memory_order_acquire))
+            break;
+
+        dumpTriggeredCapture();
+
+        sleep(m_triggerCooldown.load(std::memory_order_acquire));
+        m_triggers.rearm();
+    }
+}
+
+void ProfileManager::retainTriggeredFrames()
+{
+    // Triggered capture keeps only the latest frames of every thread to not consume all memory
+    // between rare hitches. Network sessions need all frames, so nothing is dropped for them.
+    const auto bufferSize = m_triggerBufferSize.load(std::memory_order_relaxed);
+    if (bufferSize != 0 && THIS_THREAD->blocks.usedMemorySize > (bufferSize >> 1) &&
+        !m_networkSession.load(std::memory_order_acquire))
+    {
+        THIS_THREAD->retainFrames();
+    }
+}
+
+void ProfileManager::dumpTriggeredCapture()
+{
+    std::string filename;
+
+    {
+        guard_lock_t lock(m_triggerSpin);
+        if (!m_triggeredCaptureFilename.empty())
+        {
+            const auto number = m_triggeredCaptures.load(std::memory_order_acquire) + 1;
+            filename = m_triggeredCaptureFilename + "_" + std::to_string(number) + ".prof";
+        }
+    }
+
+    const bool sendToClients = m_triggerSubscribers.load(std::memory_order_acquire) != 0;
+    if (filename.empty() && !sendToClients)
+        return;
+
+    // Both checks are made under m_dumpSpin: network client could not start capturing
+    // or streaming right before dumping, and profiler could not be disabled by someone else.
+    m_dumpSpin.lock();
+    if (!isEnabled() || m_networkSession.load(std::memory_order_acquire))
+    {
+        m_dumpSpin.unlock();
+        EASY_LOGMSG("Triggered capture skipped: profiler is disabled or used by network client\n");
+        return;
+    }
+
+    EASY_LOGMSG("Dumping triggered capture\n");
+
+    std::stringstream stream(std::ios_base::out | std::ios_base::binary);
+    const auto blocksNumber = dumpBlocksToStream(stream, false, false);
+
+    // Continue collecting data (the same as setEnabled(true) does)
+    const auto time = profiler::clock::now();
+    m_profilerStatus.store(true, std::memory_order_release);
+    enableEventTracer();
+    beginCapture(time);
+    m_dumpSpin.unlock();
+
+    auto data = stream.str();
+    if (!filename.empty())
+    {
+        std::ofstream outputFile(filename, std::fstream::binary);
+        if (outputFile.is_open())
+        {
+            outputFile.write(data.data(), static_cast<std::streamsize>(data.size()));
+        }
+        else
+        {
+            EASY_ERROR("Can not open \"" << filename << "\" for writing\n");
+        }
+    }
+
+    if (sendToClients)
+    {
+        guard_lock_t lock(m_triggerSpin);
+        m_triggeredDumps.emplace_back(std::move(data));
+    }
+
+    m_triggeredCaptures.fetch_add(1, std::memory_order_acq_rel);
+
+    EASY_LOGMSG("Triggered capture done. Dumped " << blocksNumber << " blocks\n");
+    (void)blocksNumber; // unused if logging is disabled
+}
+
+//////////////////////////////////////////////////////////////////////////
+
 void ProfileManager::setContextSwitchLogFilename(const char* name)
 {
     m_csInfoFilename = name;
@@ -1297,6 +2027,11 @@ profiler::timestamp_t ProfileManager::ticks2us(profiler::timestamp_t ticks) cons
 {
     return static_cast<profiler::timestamp_t>(ticks * 1000000LL / m_cpuFrequency);
 }
+
+profiler::timestamp_t ProfileManager::us2ticks(profiler::timestamp_t us) const
+{
+    return static_cast<profiler::timestamp_t>(us * m_cpuFrequency / 1000000LL);
+}
 #else
 profiler::timestamp_t ProfileManager::ticks2ns(profiler::timestamp_t ticks) const
 {
@@ -1307,6 +2042,11 @@ profiler::timestamp_t ProfileManager::ticks2us(profiler::timestamp_t ticks) cons
 {
     return static_cast<profiler::timestamp_t>(ticks * 1000 / m_cpuFrequency.load(std::memory_order_acquire));
 }
+
+profiler::timestamp_t ProfileManager::us2ticks(profiler::timestamp_t us) const
+{
+    return static_cast<profiler::timestamp_t>(us * m_cpuFrequency.load(std::memory_order_acquire) / 1000);
+}
 #endif
 
 //////////////////////////////////////////////////////////////////////////
@@ -1388,301 +2128,947 @@ static void join(std::future<T>& futureResult)
         futureResult.get();
 }
 
+namespace {
+
+using shared_buffer_t = std::shared_ptr<const std::string>;
+
+shared_buffer_t make_buffer(const void* _data, size_t _size)
+{
+    return std::make_shared<const std::string>(static_cast<const char*>(_data), _size);
+}
+
+/// Stream frames are dropped for a client which has more unsent bytes than this (it sees a gap in frames sequence)
+EASY_CONSTEXPR size_t MAX_STREAM_BACKLOG_SIZE = 64 << 20;
+
+/// Client which does not read replies is disconnected when number of its unsent buffers exceeds this value
+EASY_CONSTEXPR size_t MAX_OUTBOX_BUFFERS = 4096;
+
+/// Time given to threads to move their closed frames out when capture is stopped while other sessions are active
+EASY_CONSTEXPR int STREAMED_CAPTURE_DELAY_MS = 100;
+
+size_t message_size(profiler::net::MessageType _type)
+{
+    switch (_type)
+    {
+        case profiler::net::MessageType::Change_Block_Status:
+            return sizeof(profiler::net::BlockStatusMessage);
+
+        case profiler::net::MessageType::Change_Block_Sampling:
+            return sizeof(profiler::net::BlockSamplingMessage);
+
+        case profiler::net::MessageType::Change_Categories:
+            return sizeof(profiler::net::CategoriesMessage);
+
+        case profiler::net::MessageType::Change_Event_Tracing_Status:
+        case profiler::net::MessageType::Change_Event_Tracing_Priority:
+            return sizeof(profiler::net::BoolMessage);
+
+        case profiler::net::MessageType::Request_Start_Streaming:
+            return sizeof(profiler::net::StreamingMessage);
+
+        case profiler::net::MessageType::Change_Compression:
+            return sizeof(profiler::net::CompressionMessage);
+
+        case profiler::net::MessageType::Change_Triggered_Capture:
+            return sizeof(profiler::net::BoolMessage);
+
+        default:
+            return sizeof(profiler::net::Message);
+    }
+}
+
+/** Requests which have to wait until dumping is finished.
+
+Dumping thread holds m_dumpSpin during the whole capture and m_storedSpin while serializing blocks,
+so these requests would block the listening thread (and all other clients).
+*/
+bool waits_for_dump(profiler::net::MessageType _type)
+{
+    switch (_type)
+    {
+        case profiler::net::MessageType::Request_Start_Capture:
+        case profiler::net::MessageType::Request_Start_Streaming:
+        case profiler::net::MessageType::Request_Stop_Streaming:
+        case profiler::net::MessageType::Request_Blocks_Description:
+        case profiler::net::MessageType::Change_Block_Status:
+        case profiler::net::MessageType::Change_Block_Sampling:
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+struct ListenerClient EASY_FINAL
+{
+    EasySocket                       socket;
+    std::string                       inbox; ///< Received bytes which do not form a whole message yet
+    std::deque<shared_buffer_t>      outbox; ///< Data waiting for the socket to become writable
+    size_t                     outboxOffset = 0; ///< Number of already sent bytes of outbox.front()
+    size_t                       outboxSize = 0; ///< Number of unsent bytes in outbox
+    uint32_t                 streamSequence = 0;
+    uint32_t              streamDescriptors = 0;
+    uint32_t                 streamInterval = 0;
+    uint8_t                     compression = profiler::net::COMPRESSION_NONE; ///< Requested CompressionFlags
+    bool                          streaming = false;
+    bool                          capturing = false; ///< Client has started capture and has not stopped it yet
+    bool                     waitingForDump = false;
+    bool           waitingForStreamedCapture = false; ///< Client has stopped capturing while other sessions keep profiler enabled
+    bool                   triggeredCapture = false; ///< Client wants to receive triggered captures
+    bool                          wantWrite = false;
+    bool                             closed = false;
+};
+
+} // end of namespace <noname>.
+
 void ProfileManager::listen(uint16_t _port)
 {
     EASY_THREAD_SCOPE("EasyProfiler.Listen");
 
     EASY_LOGMSG("Listening started\n");
 
+    // Listening thread serves any number of clients.
+    // Sockets are non-blocking: the thread sleeps in EasySocketPoller::wait() until any socket becomes ready,
+    // so idle connections cost nothing and slow clients do not block the others.
+
     std::stringstream os(std::ios_base::out | std::ios_base::binary);
+    std::stringstream dumpStream(std::ios_base::out | std::ios_base::binary);
+    std::string packedDump; // Dumped data packed by dumping thread for the client which has requested dumping
     std::future<uint32_t> dumpingResult;
+    uint8_t dumpCompression = profiler::net::COMPRESSION_NONE;
     bool dumping = false;
 
+    EasySocket server;
+    EasySocketPoller poller;
+    std::list<ListenerClient> clients;
+    std::vector<EasySocketPoller::Event> events;
+
     const auto stopDumping = [&] {
         dumping = false;
         m_stopDumping.store(true, std::memory_order_release);
         join(dumpingResult);
-        clear_sstream(os);
+        clear_sstream(dumpStream);
+        packedDump.clear();
+        for (auto& client : clients)
+            client.waitingForDump = false;
     };
 
-    EasySocket socket;
-    profiler::net::Message replyMessage(profiler::net::MessageType::Reply_Capturing_Started);
+    const auto flushClient = [&] (ListenerClient& client)
+    {
+        while (!client.closed && !client.outbox.empty())
+        {
+            const auto& buffer = *client.outbox.front();
+            const int bytes = client.socket.send(buffer.data() + client.outboxOffset, buffer.size() - client.outboxOffset);
+            if (bytes <= 0)
+            {
+                client.closed = client.socket.isDisconnected();
+                break; // Socket is not ready for writing (or disconnected)
+            }
+
+            client.outboxOffset += static_cast<size_t>(bytes);
+            client.outboxSize -= static_cast<size_t>(bytes);
+            if (client.outboxOffset == buffer.size())
+            {
+                client.outbox.pop_front();
+                client.outboxOffset = 0;
+            }
+        }
 
-    socket.bind(_port);
-    int bytes = 0;
-    while (!m_stopListen.load(std::memory_order_acquire))
+        const bool wantWrite = !client.closed && !client.outbox.empty();
+        if (client.wantWrite != wantWrite)
+        {
+            client.wantWrite = wantWrite;
+            poller.modify(client.socket.handle(), &client, wantWrite);
+        }
+    };
+
+    const auto send = [&] (ListenerClient& client, shared_buffer_t buffer)
     {
-        if (dumping)
-            stopDumping();
+        if (client.closed)
+            return;
+
+        if (client.outbox.size() >= MAX_OUTBOX_BUFFERS)
+        {
+            EASY_WARNING("Client does not receive data: disconnecting\n");
+            client.closed = true;
+            return;
+        }
 
-        socket.listen();
-        socket.accept();
+        client.outboxSize += buffer->size();
+        client.outbox.push_back(std::move(buffer));
+        if (client.outbox.size() == 1)
+            flushClient(client);
+    };
 
-        bool hasConnect = true;
+    const auto sendMessage = [&] (ListenerClient& client, profiler::net::MessageType type)
+    {
+        const profiler::net::Message reply(type);
+        send(client, make_buffer(&reply, sizeof(reply)));
+    };
 
-        // Send reply
+    const auto sendData = [&] (ListenerClient& client, profiler::net::MessageType type, const shared_buffer_t& data)
+    {
+        const profiler::net::DataMessage dm(static_cast<uint32_t>(data->size()), type);
+        send(client, make_buffer(&dm, sizeof(dm)));
+        send(client, data);
+    };
+
+    // Streaming state (common for all streaming clients)
+    using stream_clock = std::chrono::steady_clock;
+    stream_clock::time_point nextStreamFrameTime;
+    uint32_t streamInterval = 0;
+    stream_clock::time_point streamedCaptureTime;
+    bool streamedCapturePending = false; ///< Some clients are waiting for dumpStreamedBlocksToStream()
+    bool listenerOwnsProfiling = false; ///< Profiling has been enabled by network session or captured by client, so the last session disables it
+
+    const auto updateStreamInterval = [&] () -> bool
+    {
+        // Closed frames are moved into stream buffers once per interval and sent to all streaming clients,
+        // so the shortest requested interval is used for everyone.
+        streamInterval = 0;
+        for (const auto& client : clients)
         {
-            const bool wasLowPriorityET =
-#ifdef _WIN32
-                EasyEventTracer::instance().isLowPriority();
-#else
-                false;
-#endif
-            const profiler::net::EasyProfilerStatus connectionReply(isEnabled(), isEventTracingEnabled(), wasLowPriorityET);
+            if (client.streaming && !client.closed && (streamInterval == 0 || client.streamInterval < streamInterval))
+                streamInterval = client.streamInterval;
+        }
+        return streamInterval != 0;
+    };
+
+    const auto hasSessions = [&] (const ListenerClient* except) -> bool
+    {
+        // Capture and streaming sessions of all clients share one profiling session
+        return std::any_of(clients.begin(), clients.end(), [except] (const ListenerClient& c) {
+            return &c != except && !c.closed && (c.capturing || c.streaming);
+        });
+    };
+
+    const auto keepForCapture = [&] () -> bool
+    {
+        return std::any_of(clients.begin(), clients.end(), [] (const ListenerClient& c) {
+            return !c.closed && (c.capturing || c.waitingForStreamedCapture);
+        });
+    };
+
+    const auto disableProfiling = [&]
+    {
+        // The last network session has finished: disable profiling if network sessions own it
+        if (!listenerOwnsProfiling)
+            return;
+
+        listenerOwnsProfiling = false;
 
-            bytes = socket.send(&connectionReply, sizeof(profiler::net::EasyProfilerStatus));
-            hasConnect = bytes > 0;
+        m_dumpSpin.lock();
+        auto time = profiler::clock::now();
+        if (m_profilerStatus.exchange(false, std::memory_order_acq_rel))
+        {
+            disableEventTracer();
+            m_endTime = time;
         }
+        m_dumpSpin.unlock();
+    };
 
-        while (hasConnect && !m_stopListen.load(std::memory_order_acquire))
+    const auto sendStreamFrame = [&] (bool _collectAll)
+    {
+        // Frame is sent even if there is no new data: client uses it as a heartbeat
+        streamBlocksToStream(os, _collectAll, keepForCapture());
+        auto threads = std::make_shared<const std::string>(os.str());
+        clear_sstream(os);
+
+        const auto endTime = profiler::clock::now();
+        for (auto& client : clients)
         {
-            if (dumping)
+            if (!client.streaming || client.closed)
+                continue;
+
+            if (client.outboxSize > MAX_STREAM_BACKLOG_SIZE)
             {
-                if (!dumpingResult.valid())
-                {
-                    dumping = false;
-                    socket.setReceiveTimeout(0);
-                    clear_sstream(os);
-                }
-                else if (dumpingResult.wait_for(std::chrono::milliseconds(0)) == std::future_status::ready)
-                {
-                    dumping = false;
-                    dumpingResult.get();
+                // Client can not keep up with the stream: drop the frame instead of accumulating it in memory
+                ++client.streamSequence;
+                continue;
+            }
 
-                    const auto size = os.tellp();
-                    static const decltype(size) badSize = -1;
-                    if (size != badSize)
-                    {
-                        const profiler::net::DataMessage dm(static_cast<uint32_t>(size),
-                                                            profiler::net::MessageType::Reply_Blocks);
+            writeStreamDescriptors(os, client.streamDescriptors);
+            const auto descriptors = os.str();
+            clear_sstream(os);
 
-                        const size_t packet_size = sizeof(dm) + dm.size;
-                        std::string sendbuf;
-                        sendbuf.reserve(packet_size + 1);
+            const profiler::net::StreamFrameMessage frame(static_cast<uint32_t>(descriptors.size() + threads->size()),
+                                                          client.streamSequence++, endTime);
 
-                        if (sendbuf.capacity() >= packet_size) // check if there is enough memory
-                        {
-                            sendbuf.append((const char*) &dm, sizeof(dm));
-                            sendbuf += os.str(); // TODO: Avoid double-coping data from stringstream!
-                            clear_sstream(os);
-
-                            bytes = socket.send(sendbuf.c_str(), packet_size);
-                            hasConnect = bytes > 0;
-                            if (!hasConnect)
-                                break;
-                        }
-                        else
-                        {
-                            EASY_ERROR("Can not send blocks. Not enough memory for allocating " << packet_size
-                                                                                                << " bytes");
-                            clear_sstream(os);
-                        }
-                    }
-                    else
-                    {
-                        EASY_ERROR("Can not send blocks. Bad std::stringstream.tellp() == -1");
-                        clear_sstream(os);
-                    }
+            auto header = std::make_shared<std::string>();
+            header->reserve(sizeof(frame) + descriptors.size());
+            header->append((const char*)&frame, sizeof(frame));
+            header->append(descriptors);
 
-                    replyMessage.type = profiler::net::MessageType::Reply_Blocks_End;
-                    bytes = socket.send(&replyMessage, sizeof(replyMessage));
-                    hasConnect = bytes > 0;
-                    if (!hasConnect)
-                        break;
+            send(client, std::move(header));
+            send(client, threads);
+        }
+    };
+
+    const auto stopStreamingSession = [&]
+    {
+        // Profiling is disabled only if nobody is capturing
+        const bool capturing = std::any_of(clients.begin(), clients.end(),
+                                           [] (const ListenerClient& c) { return c.capturing && !c.closed; });
+        if (!capturing)
+            disableProfiling();
+
+        // Wait for all ThreadStorage::storeBlock() to finish (the same as dumpBlocksToStream() does)
+        // and send the rest of closed frames. If profiler is still enabled by someone else then
+        // threads keep storing blocks and only frames which they have already moved could be sent.
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        sendStreamFrame(!m_profilerStatus.load(std::memory_order_acquire));
+
+        // The rest of frames has been kept for clients which are waiting for streamed capture: reply them now
+        if (streamedCapturePending)
+            streamedCaptureTime = stream_clock::now();
+    };
 
-                    socket.setReceiveTimeout(0);
+    const auto sendBlocks = [&] (ListenerClient& client, const shared_buffer_t& data, shared_buffer_t* packedData)
+    {
+        // packedData is indexed by compression flags: it is shared between clients which have requested the same compression
+        if (data != nullptr)
+        {
+            if (client.compression == profiler::net::COMPRESSION_NONE)
+            {
+                sendData(client, profiler::net::MessageType::Reply_Blocks, data);
+            }
+            else
+            {
+                auto& packed = packedData[client.compression];
+                if (packed == nullptr)
+                {
+                    std::string raw(*data); // packData() modifies input data
+                    auto output = std::make_shared<std::string>();
+                    profiler::net::packData(&raw[0], raw.size(), client.compression, *output);
+                    packed = std::move(output);
                 }
+
+                sendData(client, profiler::net::MessageType::Reply_Blocks_Compressed, packed);
             }
+        }
+
+        sendMessage(client, profiler::net::MessageType::Reply_Blocks_End);
+    };
 
-            char buffer[256] = {};
-            bytes = socket.receive(buffer, 255);
+    const auto finishDumping = [&]
+    {
+        dumping = false;
+        dumpingResult.get();
 
-            hasConnect = socket.isConnected();
-            if (!hasConnect || bytes < static_cast<int>(sizeof(profiler::net::Message)))
+        const auto size = dumpStream.tellp();
+        static const decltype(size) badSize = -1;
+
+        shared_buffer_t data;
+        if (size != badSize)
+        {
+            data = std::make_shared<const std::string>(dumpStream.str());
+        }
+        else
+        {
+            EASY_ERROR("Can not send blocks. Bad std::stringstream.tellp() == -1");
+        }
+        clear_sstream(dumpStream);
+
+        // Packed data is shared between clients which have requested the same compression
+        shared_buffer_t packedData[profiler::net::COMPRESSION_SUPPORTED + 1];
+        if (!packedDump.empty())
+        {
+            packedData[dumpCompression] = std::make_shared<const std::string>(std::move(packedDump));
+            packedDump.clear();
+        }
+
+        for (auto& client : clients)
+        {
+            if (!client.waitingForDump)
                 continue;
 
-            auto message = (const profiler::net::Message*)buffer;
-            if (!message->isEasyNetMessage())
+            client.waitingForDump = false;
+            sendBlocks(client, data, packedData);
+        }
+    };
+
+    const auto sendStreamedCaptures = [&]
+    {
+        // Replies to clients which have stopped capturing while other sessions keep profiler enabled
+        streamedCapturePending = false;
+
+        if (streamInterval != 0)
+        {
+            sendStreamFrame(false);
+        }
+        else
+        {
+            streamBlocksToStream(os, false, true);
+            clear_sstream(os);
+        }
+
+        // Kept frames are needed until the last capturing client stops
+        const bool release = std::none_of(clients.begin(), clients.end(),
+                                          [] (const ListenerClient& c) { return c.capturing && !c.closed; });
+
+        dumpStreamedBlocksToStream(os, release);
+        const auto data = std::make_shared<const std::string>(os.str());
+        clear_sstream(os);
+
+        shared_buffer_t packedData[profiler::net::COMPRESSION_SUPPORTED + 1];
+        for (auto& client : clients)
+        {
+            if (!client.waitingForStreamedCapture)
                 continue;
 
-            switch (message->type)
+            client.waitingForStreamedCapture = false;
+            sendBlocks(client, data, packedData);
+        }
+    };
+
+    const auto handleMessage = [&] (ListenerClient& client, const profiler::net::Message* message)
+    {
+        switch (message->type)
+        {
+            case profiler::net::MessageType::Ping:
+            {
+                EASY_LOGMSG("receive MessageType::Ping\n");
+                break;
+            }
+
+            case profiler::net::MessageType::Request_MainThread_FPS:
+            {
+                profiler::timestamp_t maxDuration = maxFrameDuration(), avgDuration = avgFrameDuration();
+
+                maxDuration = ticks2us(maxDuration);
+                avgDuration = ticks2us(avgDuration);
+
+                const profiler::net::TimestampMessage reply(profiler::net::MessageType::Reply_MainThread_FPS,
+                                                            (uint32_t)maxDuration, (uint32_t)avgDuration);
+
+                send(client, make_buffer(&reply, sizeof(reply)));
+
+                break;
+            }
+
+            case profiler::net::MessageType::Request_Clock_Sync:
+            {
+#if defined(EASY_CHRONO_CLOCK) || defined(_WIN32)
+                const int64_t cpuFrequency = m_cpuFrequency;
+#else
+                const int64_t cpuFrequency = m_cpuFrequency.load(std::memory_order_acquire) * 1000LL;
+#endif
+
+                const profiler::net::ClockSyncMessage reply(m_processId, cpuFrequency, profiler::clock::now());
+                send(client, make_buffer(&reply, sizeof(reply)));
+
+                break;
+            }
+
+            case profiler::net::MessageType::Request_Start_Capture:
             {
-                case profiler::net::MessageType::Ping:
+                EASY_LOGMSG("receive MessageType::Request_Start_Capture\n");
+
+                profiler::timestamp_t t = profiler::clock::now();
+                EASY_FORCE_EVENT(t, "StartCapture", EASY_COLOR_START, profiler::OFF);
+
+                m_dumpSpin.lock();
+                if (!m_profilerStatus.exchange(true, std::memory_order_acq_rel))
                 {
-                    EASY_LOGMSG("receive MessageType::Ping\n");
-                    break;
+                    enableEventTracer();
+                    beginCapture(t);
                 }
+                m_networkSession.store(true, std::memory_order_release); // Triggered capture must not steal this data
+                m_dumpSpin.unlock();
 
-                case profiler::net::MessageType::Request_MainThread_FPS:
-                {
-                    profiler::timestamp_t maxDuration = maxFrameDuration(), avgDuration = avgFrameDuration();
+                // Stopped capture is dumped and disables profiling even if it has been enabled by user
+                listenerOwnsProfiling = true;
+                client.capturing = true;
 
-                    maxDuration = ticks2us(maxDuration);
-                    avgDuration = ticks2us(avgDuration);
+                sendMessage(client, profiler::net::MessageType::Reply_Capturing_Started);
 
-                    const profiler::net::TimestampMessage reply(profiler::net::MessageType::Reply_MainThread_FPS,
-                                                                (uint32_t)maxDuration, (uint32_t)avgDuration);
+                break;
+            }
 
-                    bytes = socket.send(&reply, sizeof(profiler::net::TimestampMessage));
-                    hasConnect = bytes > 0;
+            case profiler::net::MessageType::Request_Stop_Capture:
+            {
+                EASY_LOGMSG("receive MessageType::Request_Stop_Capture\n");
 
-                    break;
-                }
+                client.capturing = false;
 
-                case profiler::net::MessageType::Request_Start_Capture:
+                if (hasSessions(nullptr))
                 {
-                    EASY_LOGMSG("receive MessageType::Request_Start_Capture\n");
+                    // Other capture or streaming session keeps profiler enabled, so blocks can not be dumped.
+                    // Threads are asked to move their closed frames out (the same way as for streaming)
+                    // and the client receives these frames together with frames kept since capture start.
+                    client.waitingForStreamedCapture = true;
+                    if (!streamedCapturePending)
+                    {
+                        streamedCapturePending = true;
+                        streamedCaptureTime = stream_clock::now() + std::chrono::milliseconds(STREAMED_CAPTURE_DELAY_MS);
+                        requestStreamFrames();
+                    }
+                    break;
+                }
 
-                    profiler::timestamp_t t = 0;
-                    EASY_FORCE_EVENT(t, "StartCapture", EASY_COLOR_START, profiler::OFF);
+                // Dumping disables profiling
+                listenerOwnsProfiling = false;
 
-                    m_dumpSpin.lock();
-                    if (!m_profilerStatus.exchange(true, std::memory_order_acq_rel))
+                if (streamedCapturePending)
+                {
+                    // Dump takes kept frames too, so clients which are waiting for them receive the dump
+                    streamedCapturePending = false;
+                    for (auto& other : clients)
                     {
-                        enableEventTracer();
-                        m_beginTime = t;
+                        if (other.waitingForStreamedCapture)
+                        {
+                            other.waitingForStreamedCapture = false;
+                            other.waitingForDump = true;
+                        }
                     }
-                    m_dumpSpin.unlock();
+                }
 
-                    replyMessage.type = profiler::net::MessageType::Reply_Capturing_Started;
-                    bytes = socket.send(&replyMessage, sizeof(replyMessage));
-                    hasConnect = bytes > 0;
+                client.waitingForDump = true;
+                if (dumping)
+                    break; // Client will receive the same blocks as the one which has started dumping
 
-                    break;
+                m_dumpSpin.lock();
+                auto time = profiler::clock::now();
+                if (m_profilerStatus.exchange(false, std::memory_order_acq_rel))
+                {
+                    disableEventTracer();
+                    m_endTime = time;
                 }
+                EASY_FORCE_EVENT2(m_endTime, "StopCapture", EASY_COLOR_END, profiler::OFF);
 
-                case profiler::net::MessageType::Request_Stop_Capture:
+                dumping = true;
+                dumpCompression = client.compression;
+                m_stopDumping.store(false, std::memory_order_release);
+                dumpingResult = std::async(std::launch::async, [this, &dumpStream, &packedDump, dumpCompression]
                 {
-                    EASY_LOGMSG("receive MessageType::Request_Stop_Capture\n");
-
-                    if (dumping)
-                        break;
+                    auto result = dumpBlocksToStream(dumpStream, false, true);
+                    m_dumpSpin.unlock();
 
-                    m_dumpSpin.lock();
-                    auto time = profiler::clock::now();
-                    if (m_profilerStatus.exchange(false, std::memory_order_acq_rel))
+                    // Compress data here to not block the listening thread
+                    if (dumpCompression != profiler::net::COMPRESSION_NONE && !m_stopDumping.load(std::memory_order_acquire))
                     {
-                        disableEventTracer();
-                        m_endTime = time;
+                        auto raw = dumpStream.str();
+                        profiler::net::packData(&raw[0], raw.size(), dumpCompression, packedDump);
                     }
-                    EASY_FORCE_EVENT2(m_endTime, "StopCapture", EASY_COLOR_END, profiler::OFF);
 
-                    dumping = true;
-                    socket.setReceiveTimeout(500); // We have to check if dumping ready or not
+                    return result;
+                });
 
-                    m_stopDumping.store(false, std::memory_order_release);
-                    dumpingResult = std::async(std::launch::async, [this, &os]
-                    {
-                        auto result = dumpBlocksToStream(os, false, true);
-                        m_dumpSpin.unlock();
-                        return result;
-                    });
+                break;
+            }
 
-                    break;
-                }
+            case profiler::net::MessageType::Request_Start_Streaming:
+            {
+                EASY_LOGMSG("receive MessageType::Request_Start_Streaming\n");
+
+                auto data = reinterpret_cast<const profiler::net::StreamingMessage*>(message);
+                const bool alreadyStreaming = streamInterval != 0;
 
-                case profiler::net::MessageType::Request_Blocks_Description:
+                if (!client.streaming)
                 {
-                    EASY_LOGMSG("receive MessageType::Request_Blocks_Description\n");
+                    client.streaming = true;
+                    client.streamSequence = 0;
+                    client.streamDescriptors = 0;
+                }
 
-                    if (dumping)
-                        stopDumping();
+                client.streamInterval = std::min(std::max(data->interval, 10U), 10000U);
 
-                    // Write profiler signature and version
-                    write(os, EASY_PROFILER_SIGNATURE);
-                    write(os, EASY_PROFILER_VERSION);
+                if (!alreadyStreaming)
+                {
+                    profiler::timestamp_t t = profiler::clock::now();
+                    EASY_FORCE_EVENT(t, "StartStreaming", EASY_COLOR_START, profiler::OFF);
 
-                    // Write block descriptors
-                    m_storedSpin.lock();
-                    write(os, static_cast<uint32_t>(m_descriptors.size()));
-                    write(os, m_descriptorsMemorySize);
-                    for (const auto descriptor : m_descriptors)
+                    m_dumpSpin.lock();
+                    if (!m_profilerStatus.exchange(true, std::memory_order_acq_rel))
                     {
-                        const auto name_size = descriptor->nameSize();
-                        const auto filename_size = descriptor->filenameSize();
-                        const auto size = static_cast<uint16_t>(sizeof(profiler::SerializedBlockDescriptor)
-                                                                + name_size + filename_size);
-
-                        write(os, size);
-                        write<profiler::BaseBlockDescriptor>(os, *descriptor);
-                        write(os, name_size);
-                        write(os, descriptor->name(), name_size);
-                        write(os, descriptor->filename(), filename_size);
+                        beginCapture(t);
+                        listenerOwnsProfiling = true;
                     }
-                    m_storedSpin.unlock();
-                    // END of Write block descriptors.
+                    m_networkSession.store(true, std::memory_order_release); // Triggered capture must not steal this data
+                    m_dumpSpin.unlock();
+                }
 
-                    const auto size = os.tellp();
-                    static const decltype(size) badSize = -1;
-                    if (size != badSize)
-                    {
-                        const profiler::net::DataMessage dm(static_cast<uint32_t>(size),
-                                                            profiler::net::MessageType::Reply_Blocks_Description);
+#if defined(EASY_CHRONO_CLOCK) || defined(_WIN32)
+                const int64_t cpuFrequency = m_cpuFrequency;
+#else
+                const int64_t cpuFrequency = m_cpuFrequency.load(std::memory_order_acquire) * 1000LL;
+#endif
 
-                        const size_t packet_size = sizeof(dm) + dm.size;
-                        std::string sendbuf;
-                        sendbuf.reserve(packet_size + 1);
+                const profiler::net::StreamingStartedMessage reply(m_processId, cpuFrequency, m_beginTime);
+                send(client, make_buffer(&reply, sizeof(reply)));
 
-                        if (sendbuf.capacity() >= packet_size) // check if there is enough memory
-                        {
-                            sendbuf.append((const char*)&dm, sizeof(dm));
-                            sendbuf += os.str(); // TODO: Avoid double-coping data from stringstream!
-                            clear_sstream(os);
+                updateStreamInterval();
+                if (!alreadyStreaming)
+                {
+                    nextStreamFrameTime = stream_clock::now() + std::chrono::milliseconds(streamInterval);
+                    requestStreamFrames();
+                }
 
-                            bytes = socket.send(sendbuf.c_str(), packet_size);
-                            //hasConnect = bytes > 0;
-                        }
-                        else
-                        {
-                            EASY_ERROR("Can not send block descriptions. Not enough memory for allocating " << packet_size << " bytes");
-                        }
-                    }
-                    else
-                    {
-                        EASY_ERROR("Can not send block descriptions. Bad std::stringstream.tellp() == -1");
-                    }
+                break;
+            }
 
-                    replyMessage.type = profiler::net::MessageType::Reply_Blocks_Description_End;
-                    bytes = socket.send(&replyMessage, sizeof(replyMessage));
-                    hasConnect = bytes > 0;
+            case profiler::net::MessageType::Request_Stop_Streaming:
+            {
+                EASY_LOGMSG("receive MessageType::Request_Stop_Streaming\n");
 
+                if (!client.streaming)
                     break;
-                }
 
-                case profiler::net::MessageType::Change_Block_Status:
+                bool lastStreamingClient = true;
+                for (const auto& other : clients)
                 {
-                    auto data = reinterpret_cast<const profiler::net::BlockStatusMessage*>(message);
-                    EASY_LOGMSG("receive MessageType::ChangeBLock_Status id=" << data->id << " status=" << data->status << std::endl);
-                    setBlockStatus(data->id, static_cast<profiler::EasyBlockStatus>(data->status));
-                    break;
+                    if (&other != &client && other.streaming && !other.closed)
+                    {
+                        lastStreamingClient = false;
+                        break;
+                    }
                 }
 
-                case profiler::net::MessageType::Change_Event_Tracing_Status:
+                // Send the rest of collected data to this client (other clients receive it too)
+                if (lastStreamingClient)
+                    stopStreamingSession();
+                else
+                    sendStreamFrame(false);
+
+                client.streaming = false;
+                updateStreamInterval();
+
+                sendMessage(client, profiler::net::MessageType::Reply_Streaming_Stopped);
+
+                break;
+            }
+
+            case profiler::net::MessageType::Request_Blocks_Description:
+            {
+                EASY_LOGMSG("receive MessageType::Request_Blocks_Description\n");
+
+                // Write profiler signature and version
+                write(os, EASY_PROFILER_SIGNATURE);
+                write(os, EASY_PROFILER_VERSION);
+
+                // Write block descriptors
+                m_storedSpin.lock();
+                write(os, static_cast<uint32_t>(m_descriptors.size()));
+                write(os, m_descriptorsMemorySize);
+                for (const auto descriptor : m_descriptors)
+                    write_descriptor(os, *descriptor);
+                m_storedSpin.unlock();
+                // END of Write block descriptors.
+
+                const auto size = os.tellp();
+                static const decltype(size) badSize = -1;
+                if (size != badSize)
                 {
-                    auto data = reinterpret_cast<const profiler::net::BoolMessage*>(message);
-                    EASY_LOGMSG("receive MessageType::Change_Event_Tracing_Status on=" << data->flag << std::endl);
-                    setEventTracingEnabled(data->flag);
-                    break;
+                    sendData(client, profiler::net::MessageType::Reply_Blocks_Description,
+                             std::make_shared<const std::string>(os.str()));
                 }
+                else
+                {
+                    EASY_ERROR("Can not send block descriptions. Bad std::stringstream.tellp() == -1");
+                }
+                clear_sstream(os);
+
+                sendMessage(client, profiler::net::MessageType::Reply_Blocks_Description_End);
+
+                break;
+            }
+
+            case profiler::net::MessageType::Change_Block_Status:
+            {
+                auto data = reinterpret_cast<const profiler::net::BlockStatusMessage*>(message);
+                EASY_LOGMSG("receive MessageType::ChangeBLock_Status id=" << data->id << " status=" << data->status << std::endl);
+                setBlockStatus(data->id, static_cast<profiler::EasyBlockStatus>(data->status));
+                break;
+            }
+
+            case profiler::net::MessageType::Change_Block_Sampling:
+            {
+                auto data = reinterpret_cast<const profiler::net::BlockSamplingMessage*>(message);
+                EASY_LOGMSG("receive MessageType::Change_Block_Sampling id=" << data->id << " policy=" << (int)data->policy << " value=" << data->value << std::endl);
+                setBlockSampling(data->id, static_cast<profiler::SamplingPolicy>(data->policy), data->value);
+                break;
+            }
+
+            case profiler::net::MessageType::Change_Categories:
+            {
+                auto data = reinterpret_cast<const profiler::net::CategoriesMessage*>(message);
+                EASY_LOGMSG("receive MessageType::Change_Categories categories=" << data->categories << " on=" << data->flag << std::endl);
+                setCategoriesEnabled(static_cast<profiler::category_t>(data->categories), data->flag);
+                break;
+            }
+
+            case profiler::net::MessageType::Change_Event_Tracing_Status:
+            {
+                auto data = reinterpret_cast<const profiler::net::BoolMessage*>(message);
+                EASY_LOGMSG("receive MessageType::Change_Event_Tracing_Status on=" << data->flag << std::endl);
+                setEventTracingEnabled(data->flag);
+                break;
+            }
+
+            case profiler::net::MessageType::Change_Compression:
+            {
+                auto data = reinterpret_cast<const profiler::net::CompressionMessage*>(message);
+                EASY_LOGMSG("receive MessageType::Change_Compression flags=" << (int)data->flags << std::endl);
+                client.compression = data->flags & profiler::net::COMPRESSION_SUPPORTED;
+                break;
+            }
+
+            case profiler::net::MessageType::Change_Triggered_Capture:
+            {
+                auto data = reinterpret_cast<const profiler::net::BoolMessage*>(message);
+                EASY_LOGMSG("receive MessageType::Change_Triggered_Capture on=" << data->flag << std::endl);
 
-                case profiler::net::MessageType::Change_Event_Tracing_Priority:
+                if (client.triggeredCapture != data->flag)
                 {
+                    client.triggeredCapture = data->flag;
+                    if (data->flag)
+                        m_triggerSubscribers.fetch_add(1, std::memory_order_acq_rel);
+                    else
+                        m_triggerSubscribers.fetch_sub(1, std::memory_order_acq_rel);
+                }
+
+                break;
+            }
+
+            case profiler::net::MessageType::Change_Event_Tracing_Priority:
+            {
 #if defined(_WIN32) || EASY_OPTION_LOG_ENABLED != 0
-                    auto data = reinterpret_cast<const profiler::net::BoolMessage*>(message);
+                auto data = reinterpret_cast<const profiler::net::BoolMessage*>(message);
 #endif
 
-                    EASY_LOGMSG("receive MessageType::Change_Event_Tracing_Priority low=" << data->flag << std::endl);
+                EASY_LOGMSG("receive MessageType::Change_Event_Tracing_Priority low=" << data->flag << std::endl);
 
 #if defined(_WIN32)
-                    EasyEventTracer::instance().setLowPriority(data->flag);
+                EasyEventTracer::instance().setLowPriority(data->flag);
 #endif
-                    break;
-                }
+                break;
+            }
 
-                default:
-                    break;
+            default:
+                break;
+        }
+    };
+
+    const auto processInbox = [&] (ListenerClient& client)
+    {
+        size_t offset = 0;
+        while (!client.closed && client.inbox.size() - offset >= sizeof(profiler::net::Message))
+        {
+            auto message = reinterpret_cast<const profiler::net::Message*>(client.inbox.data() + offset);
+            if (!message->isEasyNetMessage())
+            {
+                // Can not find the beginning of the next message: drop everything received
+                offset = client.inbox.size();
+                break;
+            }
+
+            const auto size = message_size(message->type);
+            if (client.inbox.size() - offset < size)
+                break; // Wait for the rest of the message
+
+            if (dumping && waits_for_dump(message->type))
+                break; // This and all subsequent messages will be processed after dumping is finished
+
+            handleMessage(client, message);
+            offset += size;
+        }
+
+        client.inbox.erase(0, offset);
+    };
+
+    const auto acceptClient = [&]
+    {
+        clients.emplace_back();
+        auto& client = clients.back();
+        if (!server.acceptConnection(client.socket))
+        {
+            clients.pop_back();
+            return;
+        }
+
+        client.socket.setBlocking(false);
+        if (!poller.add(client.socket.handle(), &client))
+        {
+            EASY_ERROR("Can not add client socket to poller\n");
+            clients.pop_back();
+            return;
+        }
+
+        EASY_LOGMSG("Client connected\n");
+
+        const bool wasLowPriorityET =
+#ifdef _WIN32
+            EasyEventTracer::instance().isLowPriority();
+#else
+            false;
+#endif
+        const profiler::net::EasyProfilerStatus connectionReply(isEnabled(), isEventTracingEnabled(), wasLowPriorityET,
+                                                                profiler::net::COMPRESSION_SUPPORTED);
+        send(client, make_buffer(&connectionReply, sizeof(connectionReply)));
+    };
+
+    const auto receive = [&] (ListenerClient& client)
+    {
+        char buffer[4096];
+        const int bytes = client.socket.receive(buffer, sizeof(buffer));
+        if (bytes > 0)
+        {
+            client.inbox.append(buffer, static_cast<size_t>(bytes));
+            processInbox(client);
+        }
+        else if (client.socket.isDisconnected())
+        {
+            client.closed = true;
+        }
+    };
+
+    const auto removeClosedClients = [&]
+    {
+        bool stopStreaming = false, captureLost = false, dumpRecipientLost = false;
+        for (auto it = clients.begin(); it != clients.end();)
+        {
+            if (!it->closed)
+            {
+                ++it;
+                continue;
+            }
+
+            EASY_LOGMSG("Client disconnected\n");
+
+            stopStreaming |= it->streaming;
+            captureLost |= it->capturing || it->waitingForStreamedCapture;
+            dumpRecipientLost |= it->waitingForDump;
+            if (it->triggeredCapture)
+                m_triggerSubscribers.fetch_sub(1, std::memory_order_acq_rel);
+            poller.remove(it->socket.handle());
+            it = clients.erase(it);
+        }
+
+        if (dumping && dumpRecipientLost)
+        {
+            const bool hasRecipients = std::any_of(clients.begin(), clients.end(),
+                                                   [] (const ListenerClient& c) { return c.waitingForDump; });
+            if (!hasRecipients)
+                stopDumping();
+        }
+
+        if (captureLost && !keepForCapture())
+            dropStreamedCapture();
+
+        if (stopStreaming && !updateStreamInterval())
+        {
+            // The last streaming client has gone: stop profiling (if nobody is capturing) and drop collected data
+            stopStreamingSession();
+        }
+        else if (captureLost && !hasSessions(nullptr) && !streamedCapturePending)
+        {
+            // The last capturing client has gone without stopping capture
+            disableProfiling();
+        }
+    };
+
+    const auto sendTriggeredCaptures = [&]
+    {
+        std::deque<std::string> dumps;
+
+        {
+            guard_lock_t lock(m_triggerSpin);
+            dumps.swap(m_triggeredDumps);
+        }
+
+        for (auto& dump : dumps)
+        {
+            auto data = std::make_shared<const std::string>(std::move(dump));
+            for (auto& client : clients)
+            {
+                if (client.triggeredCapture)
+                    sendData(client, profiler::net::MessageType::Reply_Triggered_Capture, data);
+            }
+        }
+    };
+
+    server.bind(_port);
+    server.listen();
+    server.setBlocking(false);
+    if (!poller.add(server.handle(), &server))
+    {
+        EASY_ERROR("Can not add listening socket to poller\n");
+    }
+
+    while (!m_stopListen.load(std::memory_order_acquire))
+    {
+        // Timeout is used only for checking m_stopListen, dumping result and sending stream frames
+        int timeout = 200;
+        if (dumping)
+        {
+            timeout = 20;
+        }
+        else if (streamInterval != 0 || streamedCapturePending)
+        {
+            const auto now = stream_clock::now();
+            const auto wakeTime = streamInterval == 0 ? streamedCaptureTime : !streamedCapturePending ? nextStreamFrameTime
+                                : std::min(nextStreamFrameTime, streamedCaptureTime);
+            timeout = wakeTime > now ? static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                wakeTime - now).count()) + 1 : 0;
+            timeout = std::min(timeout, 200);
+        }
+
+        if (poller.wait(timeout, events) < 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(timeout));
+            continue;
+        }
+
+        for (const auto& event : events)
+        {
+            if (event.userData == &server)
+            {
+                acceptClient();
+                continue;
             }
+
+            auto& client = *static_cast<ListenerClient*>(event.userData);
+            if (client.closed)
+                continue;
+
+            if (event.writable)
+                flushClient(client);
+
+            if (event.readable && !client.closed)
+                receive(client);
+
+            if (event.error && !client.closed)
+                client.closed = true;
+        }
+
+        if (dumping && dumpingResult.wait_for(std::chrono::milliseconds(0)) == std::future_status::ready)
+        {
+            finishDumping();
+
+            // Process requests which have been waiting for dumping
+            for (auto& client : clients)
+                processInbox(client);
         }
+
+        if (streamInterval != 0 && stream_clock::now() >= nextStreamFrameTime)
+        {
+            nextStreamFrameTime = stream_clock::now() + std::chrono::milliseconds(streamInterval);
+            sendStreamFrame(false);
+
+            // Ask all threads to move their closed frames into stream buffers
+            // to be sent with the next stream frame.
+            requestStreamFrames();
+        }
+
+        if (streamedCapturePending && stream_clock::now() >= streamedCaptureTime)
+            sendStreamedCaptures();
+
+        if (m_triggerSubscribers.load(std::memory_order_acquire) != 0)
+            sendTriggeredCaptures();
+
+        removeClosedClients();
+
+        m_networkSession.store(dumping || streamedCapturePending || hasSessions(nullptr), std::memory_order_release);
     }
 
     if (dumping)
@@ -1691,6 +3077,21 @@ void ProfileManager::listen(uint16_t _port)
         join(dumpingResult);
     }
 
+    m_networkSession.store(false, std::memory_order_release);
+
+    for (auto& client : clients)
+    {
+        if (client.triggeredCapture)
+            m_triggerSubscribers.fetch_sub(1, std::memory_order_acq_rel);
+        poller.remove(client.socket.handle());
+    }
+    poller.remove(server.handle());
+
+    {
+        guard_lock_t lock(m_triggerSpin);
+        m_triggeredDumps.clear();
+    }
+
     EASY_LOGMSG("Listening stopped\n");
 }
 
@@ -54,8 +54,10 @@ The Apache License, Version 2.0 (the "License");
 #include "spin_lock.h"
 #include "hashed_cstr.h"
 #include "thread_storage.h"
+#include "capture_triggers.h"
 
 #include <atomic>
+#include <deque>
 #include <map>
 #include <ostream>
 #include <unordered_map>
@@ -73,6 +75,8 @@ namespace profiler {
     class ValueId;
 }
 
+//////////////////////////////////////////////////////////////////////////
+
 class ProfileManager
 {
 #ifndef EASY_MAGIC_STATIC_AVAILABLE
@@ -87,6 +91,22 @@ class ProfileManager
     using block_descriptors_t   = std::vector<BlockDescriptor*>;
     using descriptors_map_t     = std::unordered_map<profiler::string_with_hash, profiler::block_id_t>;
 
+    struct PendingAsync
+    {
+        profiler::timestamp_t      begin; ///< Time of EASY_ASYNC_BEGIN or EASY_FLOW_OUT
+        profiler::thread_id_t     thread; ///< Thread which has started async span or flow
+        profiler::block_id_t          id; ///< Descriptor id
+    };
+
+    struct SamplingRule
+    {
+        std::string                 name; ///< Compile-time name of sampled blocks
+        profiler::SamplingPolicy  policy;
+        uint32_t                   value;
+    };
+
+    using pending_async_t       = std::unordered_map<uint64_t, PendingAsync>;
+
     const processid_t                     m_processId;
 
 #if defined(EASY_CHRONO_CLOCK) || defined(_WIN32)
@@ -123,6 +143,31 @@ class ProfileManager
     std::thread      m_listenThread;
     std::atomic_bool   m_stopListen;
 
+    CaptureTriggers                         m_triggers;
+    std::string             m_triggeredCaptureFilename = "triggered_capture";
+    std::deque<std::string>          m_triggeredDumps; ///< Triggered captures waiting to be sent by listening thread
+    profiler::spin_lock                 m_triggerSpin; ///< Protects m_triggeredCaptureFilename and m_triggeredDumps
+    std::thread                       m_triggerThread;
+    std::atomic<uint32_t>              m_triggerDelay; ///< Milliseconds between trigger and dump
+    std::atomic<uint32_t>           m_triggerCooldown; ///< Milliseconds after dump while triggers are ignored
+    std::atomic<uint64_t>         m_triggerBufferSize; ///< Bytes of blocks kept for triggered capture by every thread (0 means unlimited)
+    std::atomic_bool                 m_networkSession; ///< Network client is capturing or streaming (set by listening thread)
+    std::atomic<uint32_t>        m_triggeredCaptures;
+    std::atomic<uint32_t>        m_triggerSubscribers; ///< Number of network clients waiting for triggered captures
+    std::atomic_bool           m_isTriggerThreadStarted;
+    std::atomic_bool                  m_stopTriggers;
+
+    pending_async_t                   m_pendingAsync; ///< Async spans and flows which have been started but not finished yet
+    profiler::spin_lock                 m_asyncSpin; ///< Protects m_pendingAsync
+
+    std::atomic<const profiler::BaseBlockDescriptor*> m_allocationsDesc; ///< ALLOCATIONS_VALUE_NAME description (nullptr if allocations tracking is disabled)
+
+    std::vector<SamplingRule>         m_samplingRules; ///< Sampling policies set by name (guarded by m_storedSpin)
+    std::atomic<uint32_t>        m_sampledDescriptors; ///< Number of descriptors with sampling policy (0 means that sampling is skipped in beginBlock)
+    std::atomic<uint32_t>        m_samplingGeneration; ///< Incremented when sampling policies change or capture starts to restart per-thread sampling counters
+
+    atomic_timestamp_t                m_blockOverhead; ///< Median intrinsic cost of an empty nested block (in clock ticks, see calibrateBlockOverhead())
+
 public:
 
     ProfileManager(const ProfileManager&)              = delete;
@@ -140,11 +185,16 @@ public:
                                                             int _line,
                                                             profiler::block_type_t _block_type,
                                                             profiler::color_t _color,
-                                                            bool _copyName = false);
+                                                            bool _copyName = false,
+                                                            profiler::category_t _categories = profiler::categories::Default);
 
     void storeValue(const profiler::BaseBlockDescriptor* _desc, profiler::DataType _type, const void* _data, uint16_t _size, bool _isArray, profiler::ValueId _vin);
     bool storeBlock(const profiler::BaseBlockDescriptor* _desc, const char* _runtimeName);
     bool storeBlock(const profiler::BaseBlockDescriptor* _desc, const char* _runtimeName, profiler::timestamp_t _beginTime, profiler::timestamp_t _endTime);
+    void beginAsync(const profiler::BaseBlockDescriptor* _desc, uint64_t _correlationId);
+    void endAsync(uint64_t _correlationId);
+    void enableAllocationsTracking();
+    void storeAllocation(uint64_t _bytes, uint32_t _count);
     void beginBlock(profiler::Block& _block);
     void beginNonScopedBlock(const profiler::BaseBlockDescriptor* _desc, const char* _runtimeName);
     void endBlock();
@@ -173,8 +223,19 @@ public:
     void stopListen();
     bool isListening() const;
 
+    uint32_t addTrigger(CaptureTriggers::Type _type, const char* _name, double _threshold);
+    void removeTrigger(uint32_t _triggerId);
+    void setTriggeredCaptureFilename(const char* _filenamePrefix);
+    void setTriggeredCaptureDelays(uint32_t _afterTriggerMs, uint32_t _cooldownMs);
+    void setTriggeredCaptureBufferSize(uint32_t _megabytes);
+    uint32_t triggeredCapturesCount() const;
+
+    void setBlockSampling(const char* _name, profiler::SamplingPolicy _policy, uint32_t _value);
+    static void setCategoriesEnabled(profiler::category_t _categories, bool _isEnable);
+
     profiler::timestamp_t ticks2ns(profiler::timestamp_t ticks) const;
     profiler::timestamp_t ticks2us(profiler::timestamp_t ticks) const;
+    profiler::timestamp_t us2ticks(profiler::timestamp_t us) const;
 
     static bool isMainThread();
     static profiler::timestamp_t this_thread_frameTime(profiler::Duration _durationCast);
@@ -187,15 +248,33 @@ public:
 private:
 
     void listen(uint16_t _port);
+    void triggersLoop();
+    void dumpTriggeredCapture();
+    void retainTriggeredFrames();
 
     uint32_t dumpBlocksToStream(std::ostream& _outputStream, bool _lockSpin, bool _async);
+    uint32_t dumpStreamedBlocksToStream(std::ostream& _outputStream, bool _release);
+    void writeFileHeader(std::ostream& _outputStream, int64_t _cpuFrequency, profiler::timestamp_t _endTime,
+                         uint64_t _usedMemorySize, uint32_t _blocksNumber, uint32_t _threadsNumber);
+    void writeStreamDescriptors(std::ostream& _outputStream, uint32_t& _descriptorsSent);
+    uint32_t streamBlocksToStream(std::ostream& _outputStream, bool _collectAll, bool _keepForCapture);
+    void requestStreamFrames();
     void setBlockStatus(profiler::block_id_t _id, profiler::EasyBlockStatus _status);
+    void setBlockSampling(profiler::block_id_t _id, profiler::SamplingPolicy _policy, uint32_t _value);
+    void setSampling(BlockDescriptor& _desc, profiler::SamplingPolicy _policy, uint32_t _value);
+    void updateSamplers(uint32_t _generation);
+    void updateSamplingWeights();
+    bool sampledOut(profiler::block_id_t _id);
 
     void registerThread();
 
     void beginFrame();
     void endFrame();
 
+    void beginCapture(profiler::timestamp_t _time);
+    void dropStreamedCapture();
+    void calibrateBlockOverhead();
+
     void enableEventTracer();
     void disableEventTracer();
 
@@ -145,10 +145,10 @@ PROFILER_API profiler::timestamp_t toMicroseconds(profiler::timestamp_t _ticks)
 PROFILER_API const profiler::BaseBlockDescriptor*
 registerDescription(profiler::EasyBlockStatus _status, const char* _autogenUniqueId, const char* _name,
                     const char* _filename, int _line, profiler::block_type_t _block_type, profiler::color_t _color,
-                    bool _copyName)
+                    bool _copyName, profiler::category_t _categories)
 {
     return ProfileManager::instance().addBlockDescriptor(_status, _autogenUniqueId, _name, _filename, _line,
-                                                         _block_type, _color, _copyName);
+                                                         _block_type, _color, _copyName, _categories);
 }
 
 PROFILER_API void endBlock()
@@ -183,6 +183,26 @@ PROFILER_API void storeBlock(const profiler::BaseBlockDescriptor* _desc, const c
     ProfileManager::instance().storeBlock(_desc, _runtimeName, _beginTime, _endTime);
 }
 
+PROFILER_API void beginAsync(const profiler::BaseBlockDescriptor* _desc, uint64_t _correlationId)
+{
+    ProfileManager::instance().beginAsync(_desc, _correlationId);
+}
+
+PROFILER_API void endAsync(uint64_t _correlationId)
+{
+    ProfileManager::instance().endAsync(_correlationId);
+}
+
+PROFILER_API void enableAllocationsTracking()
+{
+    ProfileManager::instance().enableAllocationsTracking();
+}
+
+PROFILER_API void storeAllocation(uint64_t _bytes, uint32_t _count)
+{
+    ProfileManager::instance().storeAllocation(_bytes, _count);
+}
+
 PROFILER_API void beginBlock(profiler::Block& _block)
 {
     ProfileManager::instance().beginBlock(_block);
@@ -258,6 +278,65 @@ PROFILER_API bool isListening()
     return ProfileManager::instance().isListening();
 }
 
+PROFILER_API uint32_t addFrameTrigger(profiler::timestamp_t _thresholdUs)
+{
+    auto& manager = ProfileManager::instance();
+    return manager.addTrigger(CaptureTriggers::Type::Frame, nullptr, static_cast<double>(manager.us2ticks(_thresholdUs)));
+}
+
+PROFILER_API uint32_t addBlockTrigger(const char* _blockName, profiler::timestamp_t _thresholdUs)
+{
+    auto& manager = ProfileManager::instance();
+    return manager.addTrigger(CaptureTriggers::Type::BlockDuration, _blockName,
+                              static_cast<double>(manager.us2ticks(_thresholdUs)));
+}
+
+PROFILER_API uint32_t addValueTrigger(const char* _valueName, double _threshold, bool _above)
+{
+    return ProfileManager::instance().addTrigger(_above ? CaptureTriggers::Type::ValueAbove
+                                                        : CaptureTriggers::Type::ValueBelow, _valueName, _threshold);
+}
+
+PROFILER_API void removeTrigger(uint32_t _triggerId)
+{
+    ProfileManager::instance().removeTrigger(_triggerId);
+}
+
+PROFILER_API void setTriggeredCaptureFilename(const char* _filenamePrefix)
+{
+    ProfileManager::instance().setTriggeredCaptureFilename(_filenamePrefix);
+}
+
+PROFILER_API void setTriggeredCaptureDelays(uint32_t _afterTriggerMs, uint32_t _cooldownMs)
+{
+    ProfileManager::instance().setTriggeredCaptureDelays(_afterTriggerMs, _cooldownMs);
+}
+
+PROFILER_API void setTriggeredCaptureBufferSize(uint32_t _megabytes)
+{
+    ProfileManager::instance().setTriggeredCaptureBufferSize(_megabytes);
+}
+
+PROFILER_API uint32_t triggeredCapturesCount()
+{
+    return ProfileManager::instance().triggeredCapturesCount();
+}
+
+PROFILER_API void setBlockSampling(const char* _blockName, profiler::SamplingPolicy _policy, uint32_t _value)
+{
+    ProfileManager::instance().setBlockSampling(_blockName, _policy, _value);
+}
+
+PROFILER_API void setCategoriesEnabled(profiler::category_t _categories, bool _isEnable)
+{
+    ProfileManager::setCategoriesEnabled(_categories, _isEnable);
+}
+
+PROFILER_API profiler::category_t enabledCategories()
+{
+    return static_cast<profiler::category_t>(profiler::EASY_ENABLED_CATEGORIES.load(std::memory_order_acquire));
+}
+
 PROFILER_API bool isMainThread()
 {
     return ProfileManager::isMainThread();
@@ -301,7 +380,8 @@ PROFILER_API profiler::timestamp_t toMicroseconds(profiler::timestamp_t) { retur
 
 PROFILER_API const profiler::BaseBlockDescriptor* registerDescription(profiler::EasyBlockStatus, const char*,
                                                                       const char*, const char*, int,
-                                                                      profiler::block_type_t, profiler::color_t, bool)
+                                                                      profiler::block_type_t, profiler::color_t, bool,
+                                                                      profiler::category_t)
 {
     return reinterpret_cast<const profiler::BaseBlockDescriptor*>(0xbad);
 }
@@ -321,6 +401,11 @@ PROFILER_API void storeBlock(const profiler::BaseBlockDescriptor*, const char*,
 {
 }
 
+PROFILER_API void beginAsync(const profiler::BaseBlockDescriptor*, uint64_t) { }
+PROFILER_API void endAsync(uint64_t) { }
+PROFILER_API void enableAllocationsTracking() { }
+PROFILER_API void storeAllocation(uint64_t, uint32_t) { }
+
 PROFILER_API void beginBlock(profiler::Block&) { }
 PROFILER_API void beginNonScopedBlock(const profiler::BaseBlockDescriptor*, const char*) { }
 PROFILER_API uint32_t dumpBlocksToFile(const char*) { return 0; }
@@ -335,6 +420,17 @@ PROFILER_API const char* getContextSwitchLogFilename() { return ""; }
 PROFILER_API void startListen(uint16_t) { }
 PROFILER_API void stopListen() { }
 PROFILER_API bool isListening() { return false; }
+PROFILER_API uint32_t addFrameTrigger(profiler::timestamp_t) { return 0; }
+PROFILER_API uint32_t addBlockTrigger(const char*, profiler::timestamp_t) { return 0; }
+PROFILER_API uint32_t addValueTrigger(const char*, double, bool) { return 0; }
+PROFILER_API void removeTrigger(uint32_t) { }
+PROFILER_API void setTriggeredCaptureFilename(const char*) { }
+PROFILER_API void setTriggeredCaptureDelays(uint32_t, uint32_t) { }
+PROFILER_API void setTriggeredCaptureBufferSize(uint32_t) { }
+PROFILER_API uint32_t triggeredCapturesCount() { return 0; }
+PROFILER_API void setBlockSampling(const char*, profiler::SamplingPolicy, uint32_t) { }
+PROFILER_API void setCategoriesEnabled(profiler::category_t, bool) { }
+PROFILER_API profiler::category_t enabledCategories() { return profiler::categories::All; }
 
 PROFILER_API bool isMainThread() { return false; }
 PROFILER_API profiler::timestamp_t this_thread_frameTime(profiler::Duration) { return 0; }
@@ -64,28 +64,13 @@
 
 #include <easy/reader.h>
 #include <easy/profiler.h>
+#include <easy/lock.h>
 
+#include "file_format.h"
 #include "hashed_cstr.h"
 
 //////////////////////////////////////////////////////////////////////////
 
-extern const uint32_t EASY_PROFILER_SIGNATURE;
-extern const uint32_t EASY_PROFILER_VERSION;
-
-# define EASY_VERSION_INT(v_major, v_minor, v_patch) ((static_cast<uint32_t>(v_major) << 24) | \
-                                                      (static_cast<uint32_t>(v_minor) << 16) | \
-                                                       static_cast<uint32_t>(v_patch))
-
-EASY_CONSTEXPR uint32_t MIN_COMPATIBLE_VERSION = EASY_VERSION_INT(0, 1, 0); ///< minimal compatible version (.prof file format was not changed seriously since this version)
-EASY_CONSTEXPR uint32_t EASY_V_100 = EASY_VERSION_INT(1, 0, 0); ///< in v1.0.0 some additional data were added into .prof file
-EASY_CONSTEXPR uint32_t EASY_V_130 = EASY_VERSION_INT(1, 3, 0); ///< in v1.3.0 changed sizeof(thread_id_t) uint32_t -> uint64_t
-EASY_CONSTEXPR uint32_t EASY_V_200 = EASY_VERSION_INT(2, 0, 0); ///< in v2.0.0 file header was slightly rearranged
-EASY_CONSTEXPR uint32_t EASY_V_210 = EASY_VERSION_INT(2, 1, 0); ///< in v2.1.0 user bookmarks were added
-
-# undef EASY_VERSION_INT
-
-EASY_CONSTEXPR uint64_t TIME_FACTOR = 1000000000ULL;
-
 // TODO: use 128 bit integer operations for better accuracy
 #define EASY_USE_FLOATING_POINT_CONVERSION
 
@@ -114,11 +99,6 @@ EASY_CONSTEXPR uint64_t TIME_FACTOR = 1000000000ULL;
 
 //////////////////////////////////////////////////////////////////////////
 
-static bool isCompatibleVersion(uint32_t _version)
-{
-    return _version >= MIN_COMPATIBLE_VERSION;
-}
-
 //////////////////////////////////////////////////////////////////////////
 
 namespace {
@@ -243,14 +223,15 @@ namespace profiler {
 
     using stats_map_t = std::unordered_map<profiler::block_id_t, Stats, estd::hash<profiler::block_id_t> >;
 
-    SerializedData::SerializedData() : m_size(0), m_data(nullptr)
+    SerializedData::SerializedData() : m_size(0), m_data(nullptr), m_extra(nullptr)
     {
     }
 
-    SerializedData::SerializedData(SerializedData&& that) : m_size(that.m_size), m_data(that.m_data)
+    SerializedData::SerializedData(SerializedData&& that) : m_size(that.m_size), m_data(that.m_data), m_extra(that.m_extra)
     {
         that.m_size = 0;
         that.m_data = nullptr;
+        that.m_extra = nullptr;
     }
 
     SerializedData::~SerializedData()
@@ -267,10 +248,9 @@ namespace profiler {
 
     void SerializedData::set(uint64_t _size)
     {
+        clear();
         if (_size != 0)
             set(new char[_size], _size);
-        else
-            set(nullptr, 0);
     }
 
     void SerializedData::extend(uint64_t _size)
@@ -287,11 +267,23 @@ namespace profiler {
         }
     }
 
+    char* SerializedData::allocate(uint64_t _size)
+    {
+        // Each block starts with pointer to the previous block
+        auto block = new char[sizeof(char*) + _size];
+        memcpy(block, &m_extra, sizeof(char*));
+        m_extra = block;
+        return block + sizeof(char*);
+    }
+
     SerializedData& SerializedData::operator = (SerializedData&& that)
     {
+        clear();
         set(that.m_data, that.m_size);
+        m_extra = that.m_extra;
         that.m_size = 0;
         that.m_data = nullptr;
+        that.m_extra = nullptr;
         return *this;
     }
 
@@ -328,17 +320,27 @@ namespace profiler {
     void SerializedData::clear()
     {
         set(nullptr, 0);
+
+        while (m_extra != nullptr)
+        {
+            auto block = m_extra;
+            memcpy(&m_extra, block, sizeof(char*));
+            delete [] block;
+        }
     }
 
     void SerializedData::swap(SerializedData& other)
     {
         char* d = other.m_data;
+        char* e = other.m_extra;
         const auto sz = other.m_size;
 
         other.m_data = m_data;
+        other.m_extra = m_extra;
         other.m_size = m_size;
 
         m_data = d;
+        m_extra = e;
         m_size = sz;
     }
 
@@ -358,6 +360,19 @@ namespace profiler {
 //////////////////////////////////////////////////////////////////////////
 
 using IdMap = std::unordered_map<profiler::hashed_stdstring, profiler::block_id_t>;
+
+/** Expanded sample of profiler::ValueStream which has not been added into blocks tree yet. */
+struct PendingValue
+{
+    profiler::timestamp_t          time;
+    uint64_t                      order; ///< Samples with equal timestamps are added in order of decoding
+    profiler::ArbitraryValue*     value;
+
+    bool operator > (const PendingValue& _other) const
+    {
+        return time > _other.time || (time == _other.time && order > _other.order);
+    }
+};
 using CsStatsMap = std::unordered_map<profiler::string_with_hash, Stats>;
 
 //////////////////////////////////////////////////////////////////////////
@@ -374,12 +389,35 @@ using CsStatsMap = std::unordered_map<profiler::string_with_hash, Stats>;
 automatically receive statistics update.
 
 */
+EASY_CONSTEXPR profiler::block_id_t NO_ALLOCATIONS = ~0U;
+
+/** Adds heap allocations of the block to its statistics.
+
+Allocations are stored by profiler as the last child value of the block (see profiler::storeAllocation).
+*/
+static void update_allocations(profiler::BlockStatistics* _stats, const profiler::BlocksTree& _current,
+                               profiler::block_id_t _allocations_id, const profiler::blocks_t& _blocks)
+{
+    if (_allocations_id == NO_ALLOCATIONS || _current.children.empty())
+        return;
+
+    const auto& last = _blocks[_current.children.back()];
+    if (last.node->id() != _allocations_id || last.value->data_size() < 2 * sizeof(uint64_t))
+        return;
+
+    uint64_t data[2];
+    memcpy(data, last.value->data(), sizeof(data));
+    _stats->allocated_bytes += data[0];
+    _stats->allocations_number += data[1];
+}
+
 static profiler::BlockStatistics* update_statistics(
     profiler::stats_map_t& _stats_map,
     const profiler::BlocksTree& _current,
     profiler::block_index_t _current_index,
     profiler::block_index_t _parent_index,
     const profiler::blocks_t& _blocks,
+    profiler::block_id_t _allocations_id,
     bool _calculate_children = true
 ) {
     auto duration = _current.node->duration();
@@ -398,8 +436,10 @@ static profiler::BlockStatistics* update_statistics(
         ++stats->calls_number; // update calls number of this block
         stats->total_duration += duration; // update summary duration of all block calls
 
+        stats->descendants_number += _current.descendants;
         if (_calculate_children)
         {
+            stats->children_number += static_cast<profiler::calls_number_t>(_current.children.size());
             for (auto i : _current.children)
                 stats->total_children_duration += _blocks[i].node->duration();
         }
@@ -418,6 +458,8 @@ static profiler::BlockStatistics* update_statistics(
             //stats->min_duration = duration;
         }
 
+        update_allocations(stats, _current, _allocations_id, _blocks);
+
         // average duration is calculated inside average_duration() method by dividing total_duration to the calls_number
 
         return stats;
@@ -429,12 +471,16 @@ static profiler::BlockStatistics* update_statistics(
     //_stats_map.emplace(key, stats);
     _stats_map.emplace(_current.node->id(), Stats {stats, duration});
 
+    stats->descendants_number = _current.descendants;
     if (_calculate_children)
     {
+        stats->children_number = static_cast<profiler::calls_number_t>(_current.children.size());
         for (auto i : _current.children)
             stats->total_children_duration += _blocks[i].node->duration();
     }
 
+    update_allocations(stats, _current, _allocations_id, _blocks);
+
     return stats;
 }
 
@@ -632,13 +678,14 @@ static void calculate_medians_async(ReaderThreadPool& pool, TStatsMap& stats_map
 
 //////////////////////////////////////////////////////////////////////////
 
-static void update_statistics_recursive(profiler::stats_map_t& _stats_map, profiler::BlocksTree& _current, profiler::block_index_t _current_index, profiler::block_index_t _parent_index, profiler::blocks_t& _blocks)
+static void update_statistics_recursive(profiler::stats_map_t& _stats_map, profiler::BlocksTree& _current, profiler::block_index_t _current_index, profiler::block_index_t _parent_index, profiler::blocks_t& _blocks, profiler::block_id_t _allocations_id)
 {
-    _current.per_frame_stats = update_statistics(_stats_map, _current, _current_index, _parent_index, _blocks, false);
+    _current.per_frame_stats = update_statistics(_stats_map, _current, _current_index, _parent_index, _blocks, _allocations_id, false);
     for (auto i : _current.children)
     {
         _current.per_frame_stats->total_children_duration += _blocks[i].node->duration();
-        update_statistics_recursive(_stats_map, _blocks[i], i, _parent_index, _blocks);
+        ++_current.per_frame_stats->children_number;
+        update_statistics_recursive(_stats_map, _blocks[i], i, _parent_index, _blocks, _allocations_id);
     }
 }
 
@@ -658,167 +705,6 @@ static bool update_progress(std::atomic<int>& progress, int new_value, std::ostr
 
 //////////////////////////////////////////////////////////////////////////
 
-static void read(std::istream& inStream, char* value, size_t size)
-{
-    inStream.read(value, size);
-}
-
-template <class T>
-static void read(std::istream& inStream, T& value)
-{
-    read(inStream, (char*)&value, sizeof(T));
-}
-
-static bool tryReadMarker(std::istream& inStream, uint32_t& marker)
-{
-    read(inStream, marker);
-    return marker == EASY_PROFILER_SIGNATURE;
-}
-
-static bool tryReadMarker(std::istream& inStream)
-{
-    uint32_t marker = 0;
-    return tryReadMarker(inStream, marker);
-}
-
-//////////////////////////////////////////////////////////////////////////
-
-struct EasyFileHeader
-{
-    uint32_t signature = 0;
-    uint32_t version = 0;
-    profiler::processid_t pid = 0;
-    int64_t cpu_frequency = 0;
-    profiler::timestamp_t begin_time = 0;
-    profiler::timestamp_t end_time = 0;
-    uint64_t memory_size = 0;
-    uint64_t descriptors_memory_size = 0;
-    uint32_t blocks_count = 0;
-    uint32_t descriptors_count = 0;
-    uint32_t threads_count = 0;
-    uint16_t bookmarks_count = 0;
-    uint16_t padding = 0;
-};
-
-static bool readHeader_v1(EasyFileHeader& _header, std::istream& inStream, std::ostream& _log)
-{
-    // File header before v2.0.0
-
-    if (_header.version > EASY_V_100)
-    {
-        if (_header.version < EASY_V_130)
-        {
-            uint32_t old_pid = 0;
-            read(inStream, old_pid);
-            _header.pid = old_pid;
-        }
-        else
-        {
-            read(inStream, _header.pid);
-        }
-    }
-
-    read(inStream, _header.cpu_frequency);
-    read(inStream, _header.begin_time);
-    read(inStream, _header.end_time);
-
-    read(inStream, _header.blocks_count);
-    if (_header.blocks_count == 0)
-    {
-        _log << "Profiled blocks number == 0";
-        return false;
-    }
-
-    read(inStream, _header.memory_size);
-    if (_header.memory_size == 0)
-    {
-        _log << "Wrong memory size == 0 for " << _header.blocks_count << " blocks";
-        return false;
-    }
-
-    read(inStream, _header.descriptors_count);
-    if (_header.descriptors_count == 0)
-    {
-        _log << "Blocks description number == 0";
-        return false;
-    }
-
-    read(inStream, _header.descriptors_memory_size);
-    if (_header.descriptors_memory_size == 0)
-    {
-        _log << "Wrong memory size == 0 for " << _header.descriptors_count << " blocks descriptions";
-        return false;
-    }
-
-    return true;
-}
-
-static bool readHeader_v2(EasyFileHeader& _header, std::istream& inStream, std::ostream& _log)
-{
-    // File header after v2.0.0
-
-    read(inStream, _header.pid);
-    read(inStream, _header.cpu_frequency);
-    read(inStream, _header.begin_time);
-    read(inStream, _header.end_time);
-
-    read(inStream, _header.memory_size);
-    if (_header.memory_size == 0)
-    {
-        _log << "Wrong memory size == 0 for " << _header.blocks_count << " blocks";
-        return false;
-    }
-
-    read(inStream, _header.descriptors_memory_size);
-    if (_header.descriptors_memory_size == 0)
-    {
-        _log << "Wrong memory size == 0 for " << _header.descriptors_count << " blocks descriptions";
-        return false;
-    }
-
-    read(inStream, _header.blocks_count);
-    if (_header.blocks_count == 0)
-    {
-        _log << "Profiled blocks number == 0";
-        return false;
-    }
-
-    read(inStream, _header.descriptors_count);
-    if (_header.descriptors_count == 0)
-    {
-        _log << "Blocks description number == 0";
-        return false;
-    }
-
-    return true;
-}
-
-static bool readHeader_v2_1(EasyFileHeader& _header, std::istream& inStream, std::ostream& _log)
-{
-    if (!readHeader_v2(_header, inStream, _log))
-        return false;
-
-    read(inStream, _header.threads_count);
-    if (_header.threads_count == 0)
-    {
-        _log << "Threads count == 0.\nNothing to read.";
-        return false;
-    }
-
-    read(inStream, _header.bookmarks_count);
-    read(inStream, _header.padding);
-
-    if (_header.padding != 0)
-    {
-        _log << "Header padding != 0.\nFile corrupted.";
-        return false;
-    }
-
-    return true;
-}
-
-//////////////////////////////////////////////////////////////////////////
-
 extern "C" PROFILER_API profiler::block_index_t fillTreesFromFile(std::atomic<int>& progress, const char* filename,
                                                                   profiler::BeginEndTime& begin_end_time,
                                                                   profiler::SerializedData& serialized_blocks,
@@ -830,6 +716,7 @@ extern "C" PROFILER_API profiler::block_index_t fillTreesFromFile(std::atomic<in
                                                                   uint32_t& descriptors_count,
                                                                   uint32_t& version,
                                                                   profiler::processid_t& pid,
+                                                                  profiler::timestamp_t& block_overhead,
                                                                   bool gather_statistics,
                                                                   std::ostream& _log)
 {
@@ -848,7 +735,7 @@ extern "C" PROFILER_API profiler::block_index_t fillTreesFromFile(std::atomic<in
     // Read data from file
     auto result = fillTreesFromStream(progress, inFile, begin_end_time, serialized_blocks, serialized_descriptors,
                                       descriptors, blocks, threaded_trees, bookmarks, descriptors_count, version, pid,
-                                      gather_statistics, _log);
+                                      block_overhead, gather_statistics, _log);
 
     return result;
 }
@@ -866,6 +753,7 @@ extern "C" PROFILER_API profiler::block_index_t fillTreesFromStream(std::atomic<
                                                                     uint32_t& descriptors_count,
                                                                     uint32_t& version,
                                                                     profiler::processid_t& pid,
+                                                                    profiler::timestamp_t& block_overhead,
                                                                     bool gather_statistics,
                                                                     std::ostream& _log)
 {
@@ -876,45 +764,13 @@ extern "C" PROFILER_API profiler::block_index_t fillTreesFromStream(std::atomic<
         return 0;
     }
 
-    uint32_t signature = 0;
-    if (!tryReadMarker(inStream, signature))
-    {
-        _log << "Wrong signature " << signature << ".\nThis is not EasyProfiler file/stream.";
-        return 0;
-    }
-
-    version = 0;
-    read(inStream, version);
-    if (!isCompatibleVersion(version))
-    {
-        _log << "Incompatible version: v"
-             << (version >> 24) << "." << ((version & 0x00ff0000) >> 16) << "." << (version & 0x0000ffff);
-        return 0;
-    }
-
     EasyFileHeader header;
-    header.signature = signature;
-    header.version = version;
-
-    if (version < EASY_V_200)
-    {
-        if (!readHeader_v1(header, inStream, _log))
-            return 0;
-        header.threads_count = std::numeric_limits<decltype(header.threads_count)>::max();
-    }
-    else if (version < EASY_V_210)
-    {
-        if (!readHeader_v2(header, inStream, _log))
-            return 0;
-        header.threads_count = std::numeric_limits<decltype(header.threads_count)>::max();
-    }
-    else
-    {
-        if (!readHeader_v2_1(header, inStream, _log))
-            return 0;
-    }
+    if (!readHeader(header, inStream, _log))
+        return 0;
 
+    version = header.version;
     pid = header.pid;
+    block_overhead = header.block_overhead;
 
     const uint64_t cpu_frequency = header.cpu_frequency;
     const double conversion_factor = (cpu_frequency != 0 ? static_cast<double>(TIME_FACTOR) / static_cast<double>(cpu_frequency) : 1.);
@@ -931,6 +787,7 @@ extern "C" PROFILER_API profiler::block_index_t fillTreesFromStream(std::atomic<
     {
         EASY_CONVERT_TO_NANO(begin_time, cpu_frequency, conversion_factor);
         EASY_CONVERT_TO_NANO(end_time, cpu_frequency, conversion_factor);
+        EASY_CONVERT_TO_NANO(block_overhead, cpu_frequency, conversion_factor);
     }
 
     begin_end_time.beginTime = begin_time;
@@ -938,7 +795,7 @@ extern "C" PROFILER_API profiler::block_index_t fillTreesFromStream(std::atomic<
 
     descriptors.reserve(descriptors_count);
     //const char* olddata = append_regime ? serialized_descriptors.data() : nullptr;
-    serialized_descriptors.set(descriptors_memory_size);
+    serialized_descriptors.set(descriptorsMemorySize(descriptors_memory_size, descriptors_count, version));
     //validate_pointers(progress, olddata, serialized_descriptors, descriptors, descriptors.size());
 
     uint64_t i = 0;
@@ -958,7 +815,13 @@ extern "C" PROFILER_API profiler::block_index_t fillTreesFromStream(std::atomic<
         //}
 
         char* data = serialized_descriptors[i];
-        read(inStream, data, sz);
+        sz = readDescriptor(inStream, data, sz, version);
+        if (sz == 0)
+        {
+            _log << "Bad block descriptor size.\nFile corrupted.";
+            return 0;
+        }
+
         auto descriptor = reinterpret_cast<profiler::SerializedBlockDescriptor*>(data);
         descriptors.push_back(descriptor);
 
@@ -969,6 +832,17 @@ extern "C" PROFILER_API profiler::block_index_t fillTreesFromStream(std::atomic<
         }
     }
 
+    profiler::block_id_t allocations_id = NO_ALLOCATIONS;
+    for (size_t id = 0; id < descriptors.size(); ++id)
+    {
+        const auto desc = descriptors[id];
+        if (desc != nullptr && desc->type() == profiler::BlockType::Value && strcmp(desc->name(), profiler::ALLOCATIONS_VALUE_NAME) == 0)
+        {
+            allocations_id = static_cast<profiler::block_id_t>(id);
+            break;
+        }
+    }
+
     using PerThreadStats = std::unordered_map<profiler::thread_id_t, profiler::stats_map_t, estd::hash<profiler::thread_id_t> >;
     PerThreadStats parent_statistics, frame_statistics;
     IdMap identification_table;
@@ -981,6 +855,9 @@ extern "C" PROFILER_API profiler::block_index_t fillTreesFromStream(std::atomic<
     i = 0;
     uint32_t read_number = 0, threads_read_number = 0;
     profiler::block_index_t blocks_counter = 0;
+    uint32_t value_streams_number = 0, stream_values_number = 0;
+    uint64_t pending_order = 0;
+    std::vector<profiler::ArbitraryValue*> expanded_values;
     std::vector<char> name;
 
     ReaderThreadPool pool;
@@ -1088,6 +965,154 @@ extern "C" PROFILER_API profiler::block_index_t fillTreesFromStream(std::atomic<
 
         profiler::stats_map_t per_thread_statistics;
 
+        // Blocks are stored in order of their end time, so previous top-level blocks
+        // which have been started later than the added one are its children.
+        auto add_block = [&] (profiler::SerializedBlock* baseData, profiler::SerializedBlockDescriptor* desc) -> bool
+        {
+            auto t_begin = reinterpret_cast<profiler::timestamp_t*>(baseData);
+            if (baseData->end() < begin_time)
+                return true;
+
+            if (*t_begin < begin_time)
+                *t_begin = begin_time;
+
+            blocks.emplace_back();
+            profiler::BlocksTree& tree = blocks.back();
+            tree.node = baseData;
+            const auto block_index = blocks_counter++;
+
+            if (desc->type() == profiler::BlockType::Async || desc->type() == profiler::BlockType::Flow)
+            {
+                // Async spans and flow links are not a part of the thread call stack.
+                // They would be resolved later by fillAsyncLinks().
+                root.asyncs.emplace_back(block_index);
+                return true;
+            }
+
+            if (*tree.node->name() != 0)
+            {
+                // If block has runtime name then generate new id for such block.
+                // Blocks with the same name will have same id.
+
+                IdMap::key_type key(tree.node->name());
+                auto it = identification_table.find(key);
+                if (it != identification_table.end())
+                {
+                    // There is already block with such name, use it's id
+                    baseData->setId(it->second);
+                }
+                else
+                {
+                    // There were no blocks with such name, generate new id and save it in the table for further usage.
+                    auto id = static_cast<profiler::block_id_t>(descriptors.size());
+                    identification_table.emplace(key, id);
+                    if (descriptors.capacity() == descriptors.size())
+                        descriptors.reserve((descriptors.size() * 3) >> 1);
+                    descriptors.push_back(descriptors[baseData->id()]);
+                    baseData->setId(id);
+                }
+            }
+
+            if (!root.children.empty())
+            {
+                auto& back = blocks[root.children.back()];
+                auto t1 = back.node->end();
+                auto mt0 = tree.node->begin();
+                if (mt0 < t1)//parent - starts earlier than last ends
+                {
+                    //auto lower = std::lower_bound(root.children.begin(), root.children.end(), tree);
+                    /**/
+                    EASY_BLOCK("Find children", profiler::colors::Blue);
+                    auto rlower1 = ++root.children.rbegin();
+                    for (; rlower1 != root.children.rend() && mt0 <= blocks[*rlower1].node->begin(); ++rlower1);
+                    auto lower = rlower1.base();
+                    std::move(lower, root.children.end(), std::back_inserter(tree.children));
+
+                    root.children.erase(lower, root.children.end());
+                    EASY_END_BLOCK;
+
+                    if (gather_statistics)
+                    {
+                        EASY_BLOCK("Gather statistic within parent", profiler::colors::Magenta);
+                        auto& per_parent_statistics = parent_statistics[thread_id];
+                        per_parent_statistics.clear();
+
+                        //per_parent_statistics.reserve(tree.children.size());     // this gives slow-down on Windows
+                        //per_parent_statistics.reserve(tree.children.size() * 2); // this gives no speed-up on Windows
+                        // TODO: check this behavior on Linux
+
+                        for (auto child_block_index : tree.children)
+                        {
+                            auto& child = blocks[child_block_index];
+                            child.per_parent_stats = update_statistics(per_parent_statistics, child, child_block_index, block_index, blocks, allocations_id);
+                            if (tree.depth < child.depth)
+                                tree.depth = child.depth;
+                            tree.descendants += 1 + child.descendants;
+                        }
+
+                        // calculate medians for each block
+                        calculate_medians_async(pool, per_parent_statistics);
+                    }
+                    else
+                    {
+                        for (auto child_block_index : tree.children)
+                        {
+                            const auto& child = blocks[child_block_index];
+                            if (tree.depth < child.depth)
+                                tree.depth = child.depth;
+                            tree.descendants += 1 + child.descendants;
+                        }
+                    }
+
+                    if (tree.depth == 254)
+                    {
+                        // 254 because we need 1 additional level for root (thread).
+                        // In other words: real stack depth = 1 root block + 254 children
+
+                        if (*tree.node->name() != 0)
+                            _log << "Stack depth exceeded value of 254\nfor block \"" << desc->name() << "\"";
+                        else
+                            _log << "Stack depth exceeded value of 254\nfor block \"" << desc->name() << "\"\nfrom file \"" << desc->file() << "\":" << desc->line();
+
+                        return false;
+                    }
+
+                    ++tree.depth;
+                }
+            }
+
+            ++root.blocks_number;
+            root.children.emplace_back(block_index);// std::move(tree));
+            if (desc->type() != profiler::BlockType::Block && desc->type() != profiler::BlockType::Lock)
+                root.events.emplace_back(block_index);
+
+
+            if (gather_statistics)
+            {
+                EASY_BLOCK("Gather per thread statistics", profiler::colors::Coral);
+                tree.per_thread_stats = update_statistics(per_thread_statistics, tree, block_index, ~0U, blocks, allocations_id);//, thread_id, blocks);
+            }
+
+            return true;
+        };
+
+        // Samples of value streams are added in order of time together with other blocks
+        std::vector<PendingValue> pending_values;
+        auto add_pending_values = [&] (profiler::timestamp_t _time) -> bool
+        {
+            while (!pending_values.empty() && pending_values.front().time <= _time)
+            {
+                std::pop_heap(pending_values.begin(), pending_values.end(), std::greater<PendingValue>());
+                auto value = pending_values.back().value;
+                pending_values.pop_back();
+
+                if (!add_block(reinterpret_cast<profiler::SerializedBlock*>(value), descriptors[value->id()]))
+                    return false;
+            }
+
+            return true;
+        };
+
         blocks_number_in_thread = 0;
         read(inStream, blocks_number_in_thread);
         threshold = read_number + blocks_number_in_thread;
@@ -1137,128 +1162,43 @@ extern "C" PROFILER_API profiler::block_index_t fillTreesFromStream(std::atomic<
                 EASY_CONVERT_TO_NANO(*t_end, cpu_frequency, conversion_factor);
             }
 
-            if (*t_end >= begin_time)
+            if (desc->type() == profiler::BlockType::Value && version >= EASY_V_220 &&
+                profiler::ValueStream::isValueStream(reinterpret_cast<const profiler::ArbitraryValue*>(data)))
             {
-                if (*t_begin < begin_time)
-                    *t_begin = begin_time;
-
-                blocks.emplace_back();
-                profiler::BlocksTree& tree = blocks.back();
-                tree.node = baseData;
-                const auto block_index = blocks_counter++;
-
-                if (*tree.node->name() != 0)
+                // Expand value stream into separate values: all of them have been stored after this record's position
+                EASY_BLOCK("Expand value stream", profiler::colors::Green);
+                const auto stream = reinterpret_cast<const profiler::ValueStream*>(data);
+                char* values = serialized_blocks.allocate(stream->expanded_size());
+                expanded_values.resize(stream->count());
+                const auto count = stream->expand(values, expanded_values.data());
+
+                for (uint16_t j = 0; j < count; ++j)
                 {
-                    // If block has runtime name then generate new id for such block.
-                    // Blocks with the same name will have same id.
-
-                    IdMap::key_type key(tree.node->name());
-                    auto it = identification_table.find(key);
-                    if (it != identification_table.end())
-                    {
-                        // There is already block with such name, use it's id
-                        baseData->setId(it->second);
-                    }
-                    else
-                    {
-                        // There were no blocks with such name, generate new id and save it in the table for further usage.
-                        auto id = static_cast<profiler::block_id_t>(descriptors.size());
-                        identification_table.emplace(key, id);
-                        if (descriptors.capacity() == descriptors.size())
-                            descriptors.reserve((descriptors.size() * 3) >> 1);
-                        descriptors.push_back(descriptors[baseData->id()]);
-                        baseData->setId(id);
-                    }
+                    pending_values.push_back(PendingValue {expanded_values[j]->begin(), pending_order++, expanded_values[j]});
+                    std::push_heap(pending_values.begin(), pending_values.end(), std::greater<PendingValue>());
                 }
 
-                if (!root.children.empty())
-                {
-                    auto& back = blocks[root.children.back()];
-                    auto t1 = back.node->end();
-                    auto mt0 = tree.node->begin();
-                    if (mt0 < t1)//parent - starts earlier than last ends
-                    {
-                        //auto lower = std::lower_bound(root.children.begin(), root.children.end(), tree);
-                        /**/
-                        EASY_BLOCK("Find children", profiler::colors::Blue);
-                        auto rlower1 = ++root.children.rbegin();
-                        for (; rlower1 != root.children.rend() && mt0 <= blocks[*rlower1].node->begin(); ++rlower1);
-                        auto lower = rlower1.base();
-                        std::move(lower, root.children.end(), std::back_inserter(tree.children));
-
-                        root.children.erase(lower, root.children.end());
-                        EASY_END_BLOCK;
-
-                        if (gather_statistics)
-                        {
-                            EASY_BLOCK("Gather statistic within parent", profiler::colors::Magenta);
-                            auto& per_parent_statistics = parent_statistics[thread_id];
-                            per_parent_statistics.clear();
-
-                            //per_parent_statistics.reserve(tree.children.size());     // this gives slow-down on Windows
-                            //per_parent_statistics.reserve(tree.children.size() * 2); // this gives no speed-up on Windows
-                            // TODO: check this behavior on Linux
-
-                            for (auto child_block_index : tree.children)
-                            {
-                                auto& child = blocks[child_block_index];
-                                child.per_parent_stats = update_statistics(per_parent_statistics, child, child_block_index, block_index, blocks);
-                                if (tree.depth < child.depth)
-                                    tree.depth = child.depth;
-                            }
-
-                            // calculate medians for each block
-                            calculate_medians_async(pool, per_parent_statistics);
-                        }
-                        else
-                        {
-                            for (auto child_block_index : tree.children)
-                            {
-                                const auto& child = blocks[child_block_index];
-                                if (tree.depth < child.depth)
-                                    tree.depth = child.depth;
-                            }
-                        }
-
-                        if (tree.depth == 254)
-                        {
-                            // 254 because we need 1 additional level for root (thread).
-                            // In other words: real stack depth = 1 root block + 254 children
-
-                            if (*tree.node->name() != 0)
-                                _log << "Stack depth exceeded value of 254\nfor block \"" << desc->name() << "\"";
-                            else
-                                _log << "Stack depth exceeded value of 254\nfor block \"" << desc->name() << "\"\nfrom file \"" << desc->file() << "\":" << desc->line();
-
-                            return 0;
-                        }
-
-                        ++tree.depth;
-                    }
-                }
-
-                ++root.blocks_number;
-                root.children.emplace_back(block_index);// std::move(tree));
-                if (desc->type() != profiler::BlockType::Block)
-                    root.events.emplace_back(block_index);
-
-
-                if (gather_statistics)
-                {
-                    EASY_BLOCK("Gather per thread statistics", profiler::colors::Coral);
-                    tree.per_thread_stats = update_statistics(per_thread_statistics, tree, block_index, ~0U, blocks);//, thread_id, blocks);
-                }
+                ++value_streams_number;
+                stream_values_number += count;
+                continue;
             }
 
+            if (!add_pending_values(*t_end) || !add_block(baseData, desc))
+                return 0;
+
             if (!update_progress(progress, 20 + static_cast<int>(67 * i / memory_size), _log))
                 return 0; // Loading interrupted
         }
 
+        if (!add_pending_values(std::numeric_limits<profiler::timestamp_t>::max()))
+            return 0;
+
         // calculate medians for each block
         calculate_medians_async(pool, per_thread_statistics);
     }
 
-    if (total_blocks_count != blocks_counter)
+    // Each value stream record is expanded into several values
+    if (total_blocks_count - value_streams_number + stream_values_number != blocks_counter)
     {
         _log << "Read blocks count: " << blocks_counter
              << "\ndoes not match blocks count\nstored in header: " << total_blocks_count
@@ -1375,10 +1315,10 @@ extern "C" PROFILER_API profiler::block_index_t fillTreesFromStream(std::atomic<
                     if (descriptors[frame.node->id()]->type() == profiler::BlockType::Block)
                         ++root.frames_number;
 
-                    frame.per_parent_stats = update_statistics(per_parent_statistics, frame, child_index, ~0U, blocks);//, root.thread_id, blocks);
+                    frame.per_parent_stats = update_statistics(per_parent_statistics, frame, child_index, ~0U, blocks, allocations_id);//, root.thread_id, blocks);
 
                     per_frame_statistics.clear();
-                    update_statistics_recursive(per_frame_statistics, frame, child_index, child_index, blocks);
+                    update_statistics_recursive(per_frame_statistics, frame, child_index, child_index, blocks, allocations_id);
 
                     calculate_medians(per_parent_statistics.begin(), per_parent_statistics.end());
                     calculate_medians(per_frame_statistics.begin(), per_frame_statistics.end());
@@ -1463,6 +1403,205 @@ extern "C" PROFILER_API profiler::block_index_t fillTreesFromStream(std::atomic<
 
 //////////////////////////////////////////////////////////////////////////
 
+static profiler::block_index_t findDeepestBlock(const profiler::BlocksTree::children_t& _children,
+                                                profiler::timestamp_t _time,
+                                                const profiler::descriptors_list_t& _descriptors,
+                                                const profiler::block_getter_fn& _getter)
+{
+    auto result = profiler::NO_BLOCK;
+
+    const profiler::BlocksTree::children_t* children = &_children;
+    while (!children->empty())
+    {
+        auto it = std::upper_bound(children->begin(), children->end(), _time,
+                                   [&](profiler::timestamp_t value, profiler::block_index_t element)
+        {
+            return value < _getter(element).node->begin();
+        });
+
+        if (it == children->begin())
+            break;
+
+        const auto index = *(--it);
+        const auto& block = _getter(index);
+        if (block.node->end() < _time || _descriptors[block.node->id()]->type() != profiler::BlockType::Block)
+            break;
+
+        result = index;
+        children = &block.children;
+    }
+
+    return result;
+}
+
+extern "C" PROFILER_API void fillAsyncLinks(const profiler::thread_blocks_tree_t& threaded_trees,
+                                            const profiler::descriptors_list_t& descriptors,
+                                            const profiler::block_getter_fn& block_getter,
+                                            profiler::async_links_t& async_spans,
+                                            profiler::async_links_t& flows)
+{
+    async_spans.clear();
+    flows.clear();
+
+    for (const auto& kv : threaded_trees)
+    {
+        const auto& root = kv.second;
+        for (auto index : root.asyncs)
+        {
+            const auto& async = *block_getter(index).async;
+
+            profiler::AsyncLink link;
+            link.index = index;
+            link.source_thread = async.source_thread();
+            link.target_thread = kv.first;
+            link.target_block = findDeepestBlock(root.children, async.end(), descriptors, block_getter);
+
+            auto source = threaded_trees.find(link.source_thread);
+            if (source != threaded_trees.end())
+                link.source_block = findDeepestBlock(source->second.children, async.begin(), descriptors, block_getter);
+            else
+                link.source_block = profiler::NO_BLOCK;
+
+            if (descriptors[async.id()]->type() == profiler::BlockType::Flow)
+                flows.push_back(link);
+            else
+                async_spans.push_back(link);
+        }
+    }
+
+    const auto compare = [&](const profiler::AsyncLink& a, const profiler::AsyncLink& b)
+    {
+        return block_getter(a.index).async->begin() < block_getter(b.index).async->begin();
+    };
+
+    std::sort(async_spans.begin(), async_spans.end(), compare);
+    std::sort(flows.begin(), flows.end(), compare);
+}
+
+static bool endsWith(const char* _str, size_t _len, const char* _suffix, size_t _suffixLen)
+{
+    return _len >= _suffixLen && strcmp(_str + _len - _suffixLen, _suffix) == 0;
+}
+
+extern "C" PROFILER_API void fillLockStats(const profiler::thread_blocks_tree_t& threaded_trees,
+                                           const profiler::descriptors_list_t& descriptors,
+                                           const profiler::block_getter_fn& block_getter,
+                                           profiler::lock_stats_t& lock_stats)
+{
+    EASY_CONSTEXPR size_t WaitSuffixLen = sizeof(EASY_LOCK_WAIT_SUFFIX) - 1;
+    EASY_CONSTEXPR size_t HoldSuffixLen = sizeof(EASY_LOCK_HOLD_SUFFIX) - 1;
+    EASY_CONSTEXPR uint32_t NoLock = ~0U;
+
+    struct LockSpanType { uint32_t lock; bool wait; };
+
+    lock_stats.clear();
+
+    // Map descriptor ids to locks (several descriptors with the same name are the same lock)
+    std::vector<LockSpanType> lockByDescriptor(descriptors.size(), LockSpanType {NoLock, false});
+    std::unordered_map<std::string, uint32_t> lockByName;
+    for (size_t id = 0, n = descriptors.size(); id < n; ++id)
+    {
+        const auto desc = descriptors[id];
+        if (desc == nullptr || desc->type() != profiler::BlockType::Lock)
+            continue;
+
+        const auto len = strlen(desc->name());
+        size_t nameLen = 0;
+        bool wait = false;
+        if (endsWith(desc->name(), len, EASY_LOCK_WAIT_SUFFIX, WaitSuffixLen))
+        {
+            nameLen = len - WaitSuffixLen;
+            wait = true;
+        }
+        else if (endsWith(desc->name(), len, EASY_LOCK_HOLD_SUFFIX, HoldSuffixLen))
+        {
+            nameLen = len - HoldSuffixLen;
+        }
+        else
+        {
+            continue;
+        }
+
+        std::string name(desc->name(), nameLen);
+        auto it = lockByName.find(name);
+        if (it == lockByName.end())
+        {
+            it = lockByName.emplace(name, static_cast<uint32_t>(lock_stats.size())).first;
+            lock_stats.emplace_back();
+            auto& lock = lock_stats.back();
+            lock.name = std::move(name);
+            lock.total_wait_time = lock.max_wait_time = lock.total_hold_time = 0;
+            lock.waits_number = lock.holds_number = 0;
+        }
+
+        lockByDescriptor[id] = LockSpanType {it->second, wait};
+    }
+
+    if (lock_stats.empty())
+        return;
+
+    std::vector<profiler::block_index_t> stack;
+    std::unordered_map<uint32_t, profiler::LockThreadStats> threadStats;
+    for (const auto& kv : threaded_trees)
+    {
+        threadStats.clear();
+
+        stack.assign(kv.second.children.begin(), kv.second.children.end());
+        while (!stack.empty())
+        {
+            const auto& block = block_getter(stack.back());
+            stack.pop_back();
+
+            const auto id = block.node->id();
+            if (id < lockByDescriptor.size() && lockByDescriptor[id].lock != NoLock)
+            {
+                const auto& span = lockByDescriptor[id];
+                auto& lock = lock_stats[span.lock];
+
+                auto it = threadStats.find(span.lock);
+                if (it == threadStats.end())
+                    it = threadStats.emplace(span.lock, profiler::LockThreadStats {kv.first, 0, 0, 0, 0}).first;
+                auto& thread = it->second;
+
+                const auto duration = block.node->duration();
+                if (span.wait)
+                {
+                    lock.total_wait_time += duration;
+                    lock.max_wait_time = std::max(lock.max_wait_time, duration);
+                    ++lock.waits_number;
+                    thread.wait_time += duration;
+                    ++thread.waits_number;
+                }
+                else
+                {
+                    lock.total_hold_time += duration;
+                    ++lock.holds_number;
+                    thread.hold_time += duration;
+                    ++thread.holds_number;
+                }
+            }
+
+            stack.insert(stack.end(), block.children.begin(), block.children.end());
+        }
+
+        for (const auto& thread : threadStats)
+            lock_stats[thread.first].threads.push_back(thread.second);
+    }
+
+    for (auto& lock : lock_stats)
+    {
+        std::sort(lock.threads.begin(), lock.threads.end(), [](const profiler::LockThreadStats& a, const profiler::LockThreadStats& b)
+        {
+            return a.wait_time > b.wait_time || (a.wait_time == b.wait_time && a.hold_time > b.hold_time);
+        });
+    }
+
+    std::sort(lock_stats.begin(), lock_stats.end(), [](const profiler::LockStats& a, const profiler::LockStats& b)
+    {
+        return a.total_wait_time > b.total_wait_time || (a.total_wait_time == b.total_wait_time && a.total_hold_time > b.total_hold_time);
+    });
+}
+
 extern "C" PROFILER_API bool readDescriptionsFromStream(std::atomic<int>& progress, std::istream& inStream,
                                                         profiler::SerializedData& serialized_descriptors,
                                                         profiler::descriptors_list_t& descriptors,
@@ -1505,6 +1644,8 @@ extern "C" PROFILER_API bool readDescriptionsFromStream(std::atomic<int>& progre
         return false;
     }
 
+    descriptors_memory_size = descriptorsMemorySize(descriptors_memory_size, descriptors_count, version);
+
     descriptors.reserve(descriptors_count);
     //const char* olddata = append_regime ? serialized_descriptors.data() : nullptr;
     serialized_descriptors.set(descriptors_memory_size);
@@ -1522,17 +1663,23 @@ extern "C" PROFILER_API bool readDescriptionsFromStream(std::atomic<int>& progre
             return false;
         }
 
-        if (i + sz > descriptors_memory_size)
+        const uint16_t usedSize = version < EASY_V_220 ? static_cast<uint16_t>(sz + V220_DESCRIPTOR_FIELDS_SIZE) : sz;
+        if (i + usedSize > descriptors_memory_size)
         {
-            _log << "Exceeded memory size.\npos: " << i << "\nsize: " << sz
-                 << "\nnext pos: " << i + sz
+            _log << "Exceeded memory size.\npos: " << i << "\nsize: " << usedSize
+                 << "\nnext pos: " << i + usedSize
                  << "\nmax pos: " << descriptors_memory_size
                  << "\nFile/Stream corrupted.";
             return false;
         }
 
         char* data = serialized_descriptors[i];
-        read(inStream, data, sz);
+        sz = readDescriptor(inStream, data, sz, version);
+        if (sz == 0)
+        {
+            _log << "Bad block descriptor size.\nFile/Stream corrupted.";
+            return false;
+        }
         auto descriptor = reinterpret_cast<profiler::SerializedBlockDescriptor*>(data);
         descriptors.push_back(descriptor);
 
@@ -41,8 +41,10 @@ The Apache License, Version 2.0 (the "License");
 **/
 
 #include <string.h>
+#include <cmath>
 #include <easy/serialized_block.h>
 #include "thread_storage.h"
+#include "value_stream.h"
 
 namespace profiler
 {
@@ -65,4 +67,54 @@ namespace profiler
         pName[name_length] = 0;
     }
 
+    uint16_t ValueStream::expand(char* _buffer, ArbitraryValue** _values) const
+    {
+        const bool floatingPoint = value_stream::isFloatingPoint(m_type);
+        const auto recordSize = sizeof(ArbitraryValue) + m_valueSize;
+
+        const char* in = data();
+        const char* const end = in + m_size;
+
+        // Timestamps are decoded as offsets from the first sample and scaled to [m_begin, m_end] later
+        uint64_t offset = 0, value = 0;
+        int64_t delta = 0;
+        uint16_t count = 0;
+        for (; count < m_count && in != nullptr && in != end; ++count)
+        {
+            uint64_t dod = 0;
+            in = value_stream::readVarint(in, end, dod);
+            if (in == nullptr)
+                break;
+
+            delta += value_stream::unzigzag(dod);
+            offset += static_cast<uint64_t>(delta);
+
+            in = value_stream::readValue(in, end, value, m_valueSize, floatingPoint);
+            if (in == nullptr)
+                break;
+
+            auto record = ::new (_buffer) ArbitraryValue(offset, m_value_id, m_id, m_valueSize, m_type, false);
+            value_stream::store(_buffer + sizeof(ArbitraryValue), m_valueSize, value);
+            _values[count] = record;
+            _buffer += recordSize;
+        }
+
+        // Begin and end of the stream could have been converted (into nanoseconds or into another timeline),
+        // so encoded offsets are scaled into the actual duration of the stream
+        const auto duration = m_end - m_begin;
+        const double scale = (offset != 0 && offset != duration) ? static_cast<double>(duration) / static_cast<double>(offset) : 1.;
+        for (uint16_t i = 0; i < count; ++i)
+        {
+            auto record = _values[i];
+            auto time = record->m_begin;
+            if (offset == 0)
+                time = 0;
+            else if (offset != duration)
+                time = static_cast<timestamp_t>(std::llround(static_cast<double>(time) * scale));
+            record->m_begin = record->m_end = m_begin + time;
+        }
+
+        return count;
+    }
+
 } // end of namespace profiler.
@@ -0,0 +1,204 @@
+/**
+Lightweight profiler library for c++
+Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+
+Licensed under either of
+    * MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+    * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+at your option.
+
+The MIT License
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights 
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies 
+    of the Software, and to permit persons to whom the Software is furnished 
+    to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all 
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+    PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE 
+    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, 
+    TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE 
+    USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+The Apache License, Version 2.0 (the "License");
+    You may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+**/
+
+#include "socket_poller.h"
+
+#if EASY_SOCKET_POLLER_EPOLL != 0
+# include <sys/epoll.h>
+# include <unistd.h>
+# include <errno.h>
+#elif !defined(_WIN32)
+# include <sys/select.h>
+# include <errno.h>
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+
+#if EASY_SOCKET_POLLER_EPOLL != 0
+
+EasySocketPoller::EasySocketPoller() : m_epoll(::epoll_create1(EPOLL_CLOEXEC))
+{
+}
+
+EasySocketPoller::~EasySocketPoller()
+{
+    if (m_epoll >= 0)
+        ::close(m_epoll);
+}
+
+static bool epollControl(int _epoll, int _operation, int _socket, void* _userData, bool _wantWrite)
+{
+    struct epoll_event ev;
+    ev.events = EPOLLIN | EPOLLRDHUP;
+    if (_wantWrite)
+        ev.events |= EPOLLOUT;
+    ev.data.ptr = _userData;
+    return ::epoll_ctl(_epoll, _operation, _socket, &ev) == 0;
+}
+
+bool EasySocketPoller::add(socket_t _socket, void* _userData, bool _wantWrite)
+{
+    return m_epoll >= 0 && epollControl(m_epoll, EPOLL_CTL_ADD, _socket, _userData, _wantWrite);
+}
+
+bool EasySocketPoller::modify(socket_t _socket, void* _userData, bool _wantWrite)
+{
+    return m_epoll >= 0 && epollControl(m_epoll, EPOLL_CTL_MOD, _socket, _userData, _wantWrite);
+}
+
+void EasySocketPoller::remove(socket_t _socket)
+{
+    if (m_epoll >= 0)
+    {
+        struct epoll_event ev; // non-null event is required by kernels before 2.6.9
+        ::epoll_ctl(m_epoll, EPOLL_CTL_DEL, _socket, &ev);
+    }
+}
+
+int EasySocketPoller::wait(int _timeoutMs, std::vector<Event>& _events)
+{
+    _events.clear();
+
+    if (m_epoll < 0)
+        return -1;
+
+    struct epoll_event ready[16];
+    const int n = ::epoll_wait(m_epoll, ready, 16, _timeoutMs < 0 ? -1 : _timeoutMs);
+    if (n < 0)
+        return errno == EINTR ? 0 : -1;
+
+    _events.reserve(static_cast<size_t>(n));
+    for (int i = 0; i < n; ++i)
+    {
+        const auto flags = ready[i].events;
+        _events.push_back(Event {
+            ready[i].data.ptr,
+            (flags & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) != 0, // let receive() detect disconnection
+            (flags & EPOLLOUT) != 0,
+            (flags & (EPOLLHUP | EPOLLERR)) != 0
+        });
+    }
+
+    return n;
+}
+
+#else // EASY_SOCKET_POLLER_EPOLL == 0
+
+EasySocketPoller::EasySocketPoller()
+{
+}
+
+EasySocketPoller::~EasySocketPoller()
+{
+}
+
+bool EasySocketPoller::add(socket_t _socket, void* _userData, bool _wantWrite)
+{
+    return m_sockets.emplace(_socket, Entry {_userData, _wantWrite}).second;
+}
+
+bool EasySocketPoller::modify(socket_t _socket, void* _userData, bool _wantWrite)
+{
+    auto it = m_sockets.find(_socket);
+    if (it == m_sockets.end())
+        return false;
+
+    it->second.userData = _userData;
+    it->second.wantWrite = _wantWrite;
+
+    return true;
+}
+
+void EasySocketPoller::remove(socket_t _socket)
+{
+    m_sockets.erase(_socket);
+}
+
+int EasySocketPoller::wait(int _timeoutMs, std::vector<Event>& _events)
+{
+    _events.clear();
+
+    fd_set fdread, fdwrite, fdexcept;
+    FD_ZERO(&fdread);
+    FD_ZERO(&fdwrite);
+    FD_ZERO(&fdexcept);
+
+    socket_t maxSocket = 0;
+    for (const auto& entry : m_sockets)
+    {
+        FD_SET(entry.first, &fdread);
+        FD_SET(entry.first, &fdexcept);
+        if (entry.second.wantWrite)
+            FD_SET(entry.first, &fdwrite);
+        if (entry.first > maxSocket)
+            maxSocket = entry.first;
+    }
+
+    struct timeval tv;
+    tv.tv_sec = _timeoutMs / 1000;
+    tv.tv_usec = (_timeoutMs % 1000) * 1000;
+
+    const int rc = ::select((int)maxSocket + 1, &fdread, &fdwrite, &fdexcept, _timeoutMs < 0 ? nullptr : &tv);
+    if (rc <= 0)
+    {
+#if !defined(_WIN32)
+        if (rc < 0 && errno == EINTR)
+            return 0;
+#endif
+        return rc;
+    }
+
+    for (const auto& entry : m_sockets)
+    {
+        const bool readable = FD_ISSET(entry.first, &fdread) != 0;
+        const bool writable = FD_ISSET(entry.first, &fdwrite) != 0;
+        const bool error = FD_ISSET(entry.first, &fdexcept) != 0;
+        if (readable || writable || error)
+            _events.push_back(Event {entry.second.userData, readable || error, writable, error});
+    }
+
+    return static_cast<int>(_events.size());
+}
+
+#endif // EASY_SOCKET_POLLER_EPOLL
+
+//////////////////////////////////////////////////////////////////////////
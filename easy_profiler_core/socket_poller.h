@@ -0,0 +1,118 @@
+/**
+Lightweight profiler library for c++
+Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+
+Licensed under either of
+    * MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+    * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+at your option.
+
+The MIT License
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights 
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies 
+    of the Software, and to permit persons to whom the Software is furnished 
+    to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all 
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+    PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE 
+    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, 
+    TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE 
+    USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+The Apache License, Version 2.0 (the "License");
+    You may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+**/
+
+#ifndef EASY_PROFILER_SOCKET_POLLER_H
+#define EASY_PROFILER_SOCKET_POLLER_H
+
+#include <stdint.h>
+#include <vector>
+
+#include <easy/easy_socket.h>
+
+#if !defined(_WIN32) && defined(__linux__)
+# define EASY_SOCKET_POLLER_EPOLL 1
+#else
+# define EASY_SOCKET_POLLER_EPOLL 0
+# include <unordered_map>
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+
+/** Readiness notification for a set of sockets.
+
+Uses epoll on Linux and select() on other platforms.
+Sockets are identified by user data pointer which is returned back with every event.
+*/
+class EasySocketPoller EASY_FINAL
+{
+public:
+
+    using socket_t = EasySocket::socket_t;
+
+    struct Event EASY_FINAL
+    {
+        void* userData;
+        bool   readable;
+        bool   writable;
+        bool   error;
+    };
+
+private:
+
+#if EASY_SOCKET_POLLER_EPOLL != 0
+    int m_epoll;
+#else
+    struct Entry EASY_FINAL
+    {
+        void* userData;
+        bool wantWrite;
+    };
+
+    std::unordered_map<socket_t, Entry> m_sockets;
+#endif
+
+public:
+
+    EasySocketPoller(const EasySocketPoller&) = delete;
+    EasySocketPoller(EasySocketPoller&&) = delete;
+
+    EasySocketPoller();
+    ~EasySocketPoller();
+
+    bool add(socket_t _socket, void* _userData, bool _wantWrite = false);
+    bool modify(socket_t _socket, void* _userData, bool _wantWrite);
+    void remove(socket_t _socket);
+
+    /** Waits for at least one socket to become ready or until timeout expires.
+
+    \param _timeoutMs Timeout in milliseconds. Negative value means infinite timeout.
+    \param _events Filled with ready sockets (previous content is erased).
+
+    \returns Number of ready sockets or -1 on error.
+    */
+    int wait(int _timeoutMs, std::vector<Event>& _events);
+
+}; // end of class EasySocketPoller.
+
+//////////////////////////////////////////////////////////////////////////
+
+#endif // EASY_PROFILER_SOCKET_POLLER_H
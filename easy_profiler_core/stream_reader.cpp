@@ -0,0 +1,419 @@
+/************************************************************************
+* file name         : stream_reader.cpp
+* ----------------- :
+* creation time     : 2026/10/18
+* authors           : Sergey Yagovtsev, Victor Zarubkin
+* emails            : yse.sey@gmail.com, v.s.zarubkin@gmail.com
+* ----------------- :
+* description       : The file contains implementation of readProfFromFile and readProfFromStream functions
+*                   : which pass .prof file records to a visitor without building blocks trees.
+* ----------------- :
+* license           : Lightweight profiler library for c++
+*                   : Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+*                   :
+*                   : Licensed under either of
+*                   :     * MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+*                   :     * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+*                   : at your option.
+*                   :
+*                   : The MIT License
+*                   :
+*                   : Permission is hereby granted, free of charge, to any person obtaining a copy
+*                   : of this software and associated documentation files (the "Software"), to deal
+*                   : in the Software without restriction, including without limitation the rights
+*                   : to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+*                   : of the Software, and to permit persons to whom the Software is furnished
+*                   : to do so, subject to the following conditions:
+*                   :
+*                   : The above copyright notice and this permission notice shall be included in all
+*                   : copies or substantial portions of the Software.
+*                   :
+*                   : THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+*                   : INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+*                   : PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+*                   : LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+*                   : TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+*                   : USE OR OTHER DEALINGS IN THE SOFTWARE.
+*                   :
+*                   : The Apache License, Version 2.0 (the "License")
+*                   :
+*                   : You may not use this file except in compliance with the License.
+*                   : You may obtain a copy of the License at
+*                   :
+*                   : http://www.apache.org/licenses/LICENSE-2.0
+*                   :
+*                   : Unless required by applicable law or agreed to in writing, software
+*                   : distributed under the License is distributed on an "AS IS" BASIS,
+*                   : WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*                   : See the License for the specific language governing permissions and
+*                   : limitations under the License.
+************************************************************************/
+
+
+#include <fstream>
+#include <limits>
+#include <vector>
+
+#include <easy/reader.h>
+
+#include "file_format.h"
+
+namespace {
+
+using profiler::timestamp_t;
+
+EASY_CONSTEXPR uint32_t ProgressStep = 0xffff; ///< Number of records between progress updates
+
+bool update_progress_stream(std::atomic<int>& progress, int new_value, std::ostream& _log)
+{
+    auto oldprogress = progress.exchange(new_value, std::memory_order_release);
+    if (oldprogress < 0)
+    {
+        _log << "Reading was interrupted";
+        return false;
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+/** Calculates number of children of every block of a thread.
+
+Blocks are stored in order of their end time, so previous not claimed blocks which have been started
+later than the added one are its children (the same rule as fillTreesFromStream() uses).
+*/
+class HierarchyTracker EASY_FINAL
+{
+    struct Span { timestamp_t begin, end; };
+    std::vector<Span> m_unclaimed;
+
+public:
+
+    uint32_t add(timestamp_t _begin, timestamp_t _end)
+    {
+        uint32_t children_number = 0;
+        if (!m_unclaimed.empty() && _begin < m_unclaimed.back().end)
+        {
+            auto first = m_unclaimed.end() - 1;
+            while (first != m_unclaimed.begin() && _begin <= (first - 1)->begin)
+                --first;
+
+            children_number = static_cast<uint32_t>(m_unclaimed.end() - first);
+            m_unclaimed.erase(first, m_unclaimed.end());
+        }
+
+        m_unclaimed.push_back(Span {_begin, _end});
+
+        return children_number;
+    }
+
+    void clear()
+    {
+        m_unclaimed.clear();
+    }
+
+}; // END of class HierarchyTracker.
+
+//////////////////////////////////////////////////////////////////////////
+
+class StreamReader EASY_FINAL
+{
+    std::istream&                    m_stream;
+    profiler::ProfVisitor&          m_visitor;
+    std::atomic<int>&              m_progress;
+    std::ostream&                       m_log;
+    EasyFileHeader                   m_header;
+    std::vector<profiler::block_type_t> m_types; ///< Block type for every descriptor id (null descriptors are Events)
+    std::vector<bool>             m_validIds; ///< False for null descriptors
+    std::vector<char>               m_buffer; ///< The only record kept in memory
+    HierarchyTracker             m_hierarchy;
+    double             m_conversionFactor = 1; ///< Nanoseconds per tick
+    uint64_t                   m_readSize = 0; ///< Size of read records
+    profiler::block_index_t m_recordsNumber = 0;
+    const bool               m_withHierarchy;
+
+public:
+
+    StreamReader(std::istream& _stream, profiler::ProfVisitor& _visitor, std::atomic<int>& _progress, bool _hierarchy,
+                 std::ostream& _log)
+        : m_stream(_stream)
+        , m_visitor(_visitor)
+        , m_progress(_progress)
+        , m_log(_log)
+        , m_buffer(std::numeric_limits<uint16_t>::max() + static_cast<size_t>(V220_DESCRIPTOR_FIELDS_SIZE) + 1)
+        , m_withHierarchy(_hierarchy)
+    {
+    }
+
+    profiler::block_index_t read()
+    {
+        if (!readHeader() || !readDescriptors() || !readThreads() || !readBookmarks())
+            return 0;
+
+        return update_progress_stream(m_progress, 100, m_log) ? m_recordsNumber : 0;
+    }
+
+private:
+
+    timestamp_t toNanoseconds(timestamp_t _time) const
+    {
+        // The same conversion as fillTreesFromStream() does
+        return m_header.cpu_frequency != 0 ? static_cast<timestamp_t>(_time * m_conversionFactor) : _time;
+    }
+
+    bool stopped()
+    {
+        m_log << "Reading was stopped by visitor";
+        return false;
+    }
+
+    bool readHeader()
+    {
+        if (!update_progress_stream(m_progress, 0, m_log) || !::readHeader(m_header, m_stream, m_log))
+            return false;
+
+        if (m_header.cpu_frequency != 0)
+            m_conversionFactor = static_cast<double>(TIME_FACTOR) / static_cast<double>(m_header.cpu_frequency);
+
+        profiler::ProfFileInfo info;
+        info.version = m_header.version;
+        info.pid = m_header.pid;
+        info.cpu_frequency = m_header.cpu_frequency;
+        info.begin_time = toNanoseconds(m_header.begin_time);
+        info.end_time = toNanoseconds(m_header.end_time);
+        info.block_overhead = toNanoseconds(m_header.block_overhead);
+        info.memory_size = m_header.memory_size;
+        info.blocks_count = m_header.blocks_count;
+        info.descriptors_count = m_header.descriptors_count;
+        info.threads_count = m_header.threads_count;
+        info.bookmarks_count = m_header.bookmarks_count;
+
+        return m_visitor.onHeader(info) || stopped();
+    }
+
+    bool readDescriptors()
+    {
+        m_types.reserve(m_header.descriptors_count);
+        m_validIds.reserve(m_header.descriptors_count);
+
+        for (uint32_t i = 0; i < m_header.descriptors_count; ++i)
+        {
+            uint16_t sz = 0;
+            ::read(m_stream, sz);
+            if (sz == 0)
+            {
+                m_types.push_back(profiler::BlockType::Event);
+                m_validIds.push_back(false);
+                continue;
+            }
+
+            sz = readDescriptor(m_stream, m_buffer.data(), sz, m_header.version);
+            if (sz <= sizeof(profiler::block_id_t) || !m_stream)
+            {
+                m_log << "Bad block descriptor size.\nFile corrupted.";
+                return false;
+            }
+
+            const auto descriptor = reinterpret_cast<const profiler::SerializedBlockDescriptor*>(m_buffer.data());
+            m_types.push_back(descriptor->type());
+            m_validIds.push_back(true);
+
+            if (!m_visitor.onDescriptor(*descriptor))
+                return stopped();
+        }
+
+        return true;
+    }
+
+    bool readRecord(uint16_t& _size, const char* _kind)
+    {
+        ::read(m_stream, _size);
+        if (_size == 0)
+        {
+            m_log << "Bad " << _kind << " size == 0";
+            return false;
+        }
+
+        ::read(m_stream, m_buffer.data(), _size);
+        if (!m_stream)
+        {
+            m_log << "Unexpected end of file";
+            return false;
+        }
+
+        // Every record starts with begin and end timestamps
+        auto t = reinterpret_cast<timestamp_t*>(m_buffer.data());
+        t[0] = toNanoseconds(t[0]);
+        t[1] = toNanoseconds(t[1]);
+
+        m_readSize += _size;
+        if ((++m_recordsNumber & ProgressStep) == 0)
+            return update_progress_stream(m_progress, static_cast<int>(99 * m_readSize / m_header.memory_size), m_log);
+
+        return true;
+    }
+
+    bool readThreads()
+    {
+        std::vector<char> name;
+
+        for (uint32_t threads_read_number = 0; threads_read_number < m_header.threads_count; ++threads_read_number)
+        {
+            profiler::thread_id_t thread_id = 0;
+            if (m_header.version < EASY_V_130)
+            {
+                uint32_t thread_id32 = 0;
+                ::read(m_stream, thread_id32);
+                thread_id = thread_id32;
+            }
+            else
+            {
+                ::read(m_stream, thread_id);
+            }
+
+            if (m_stream.eof())
+            {
+                if (m_header.version < EASY_V_210)
+                    break; // Old files have no threads count in the header
+
+                m_log << "Unexpected end of file";
+                return false;
+            }
+
+            uint16_t name_size = 0;
+            ::read(m_stream, name_size);
+            name.resize(name_size + 1);
+            ::read(m_stream, name.data(), name_size);
+            name.back() = 0;
+
+            if (!m_visitor.onThreadBegin(thread_id, name.data()))
+                return stopped();
+
+            uint32_t count = 0;
+            ::read(m_stream, count);
+            for (uint32_t j = 0; j < count; ++j)
+            {
+                uint16_t sz = 0;
+                if (!readRecord(sz, "CSwitch block"))
+                    return false;
+
+                if (!m_visitor.onContextSwitch(thread_id, *reinterpret_cast<const profiler::SerializedCSwitch*>(m_buffer.data())))
+                    return stopped();
+            }
+
+            m_hierarchy.clear();
+
+            ::read(m_stream, count);
+            for (uint32_t j = 0; j < count; ++j)
+            {
+                uint16_t sz = 0;
+                if (!readRecord(sz, "block"))
+                    return false;
+
+                const auto block = reinterpret_cast<const profiler::SerializedBlock*>(m_buffer.data());
+                const auto id = block->id();
+                if (id >= m_validIds.size() || !m_validIds[id])
+                {
+                    m_log << "Bad block id == " << id;
+                    return false;
+                }
+
+                uint32_t children_number = 0;
+                if (m_withHierarchy && isCallStackRecord(id))
+                    children_number = m_hierarchy.add(block->begin(), block->end());
+
+                if (!m_visitor.onBlock(thread_id, *block, sz, children_number))
+                    return stopped();
+            }
+
+            if (!m_visitor.onThreadEnd(thread_id))
+                return stopped();
+        }
+
+        return true;
+    }
+
+    bool isCallStackRecord(profiler::block_id_t _id) const
+    {
+        switch (m_types[_id])
+        {
+            case profiler::BlockType::Async:
+            case profiler::BlockType::Flow:
+                return false;
+
+            case profiler::BlockType::Value:
+                return m_header.version < EASY_V_220 ||
+                       !profiler::ValueStream::isValueStream(reinterpret_cast<const profiler::ArbitraryValue*>(m_buffer.data()));
+
+            default:
+                return true;
+        }
+    }
+
+    bool readBookmarks()
+    {
+        if (m_header.version < EASY_V_210 || m_stream.eof())
+            return true;
+
+        if (!tryReadMarker(m_stream))
+        {
+            m_log << "Bad threads section end mark.\nFile corrupted.";
+            return false;
+        }
+
+        for (uint16_t i = 0; i < m_header.bookmarks_count; ++i)
+        {
+            profiler::Bookmark bookmark;
+
+            uint16_t usedMemorySize = 0;
+            ::read(m_stream, usedMemorySize);
+            ::read(m_stream, bookmark.pos);
+            ::read(m_stream, bookmark.color);
+
+            if (usedMemorySize < profiler::Bookmark::BaseSize || !m_stream)
+            {
+                m_log << "Bad bookmark size: " << usedMemorySize << ".\nFile corrupted.";
+                return false;
+            }
+
+            // Bookmarks are always stored in nanoseconds
+            const auto textSize = static_cast<size_t>(usedMemorySize - profiler::Bookmark::BaseSize + 1);
+            ::read(m_stream, m_buffer.data(), textSize);
+            m_buffer[textSize] = 0;
+            bookmark.text = m_buffer.data();
+
+            if (!m_visitor.onBookmark(bookmark))
+                return stopped();
+        }
+
+        return true;
+    }
+
+}; // END of class StreamReader.
+
+} // END of namespace <noname>.
+
+//////////////////////////////////////////////////////////////////////////
+
+PROFILER_API profiler::block_index_t readProfFromFile(std::atomic<int>& progress, const char* filename,
+                                                      profiler::ProfVisitor& visitor, bool hierarchy,
+                                                      std::ostream& _log)
+{
+    std::ifstream inFile(filename, std::fstream::binary);
+    if (!inFile.is_open())
+    {
+        _log << "Can not open file " << filename;
+        return 0;
+    }
+
+    return readProfFromStream(progress, inFile, visitor, hierarchy, _log);
+}
+
+PROFILER_API profiler::block_index_t readProfFromStream(std::atomic<int>& progress, std::istream& str,
+                                                        profiler::ProfVisitor& visitor, bool hierarchy,
+                                                        std::ostream& _log)
+{
+    StreamReader reader(str, visitor, progress, hierarchy, _log);
+    return reader.read();
+}
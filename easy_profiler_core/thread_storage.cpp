@@ -44,6 +44,7 @@ The Apache License, Version 2.0 (the "License");
 #include "thread_storage.h"
 #include "current_thread.h"
 #include "current_time.h"
+#include "value_stream.h"
 
 #ifdef min
 #undef min
@@ -78,6 +79,8 @@ profiler::vin_t ptr2vin(const void* ptr)
 
 } // end of namespace <noname>.
 
+EASY_THREAD_LOCAL int32_t InternalAllocationGuard::depth = 0;
+
 ThreadStorage::ThreadStorage()
     : nonscopedBlocks(16)
     , frameStartTime(0)
@@ -87,8 +90,18 @@ ThreadStorage::ThreadStorage()
     , named(false)
     , guarded(false)
     , frameOpened(false)
+    , streamMemorySize(0)
+    , streamBlocksNumber(0)
+    , streamCapturedMemorySize(0)
+    , streamCapturedBlocksNumber(0)
+    , retainedMemorySize(0)
+    , retainedBlocksNumber(0)
+    , samplingWindow(0)
+    , samplingGeneration(0)
+    , framesNumber(0)
 {
     expired = ATOMIC_VAR_INIT(0);
+    streamRequested = ATOMIC_VAR_INIT(false);
 }
 
 void ThreadStorage::storeValue(
@@ -106,6 +119,15 @@ void ThreadStorage::storeValue(
         return;
     }
 #endif
+
+#if EASY_OPTION_VALUE_STREAMS != 0
+    if (!_isArray && storeStreamValue(_timestamp, _id, _type, _data, _size, ptr2vin(_vin.m_id)))
+    {
+        putMarkIfEmpty();
+        return;
+    }
+#endif
+
     const uint16_t serializedDataSize = _size + static_cast<uint16_t>(sizeof(profiler::ArbitraryValue));
 
     void* data = blocks.closedList.allocate(serializedDataSize);
@@ -120,6 +142,97 @@ void ThreadStorage::storeValue(
     putMarkIfEmpty();
 }
 
+bool ThreadStorage::storeStreamValue(
+    profiler::timestamp_t _timestamp,
+    profiler::block_id_t _id,
+    profiler::DataType _type,
+    const void* _data,
+    uint16_t _size,
+    profiler::vin_t _vin
+) {
+    // Samples are encoded right into the record reserved in blocks.closedList at the first sample,
+    // so the record is placed in the same order with other blocks as its first sample.
+    // Returns false if the value should be stored as a separate ArbitraryValue record.
+
+    if (!value_stream::isStreamable(_type, _size))
+        return false;
+
+    if (_id >= valueStreams.size())
+    {
+        InternalAllocationGuard guard;
+        const ValueStreamState empty = {nullptr, 0, 0, 0, 0, value_stream::MIN_CAPACITY};
+        valueStreams.resize(_id + 1, empty);
+    }
+
+    auto& stream = valueStreams[_id];
+    auto record = stream.record;
+
+    if (record != nullptr)
+    {
+        if (stream.vin != _vin || record->m_type != _type || _timestamp < stream.time)
+            return false;
+
+        if (record->m_size + value_stream::MAX_SAMPLE_SIZE > stream.capacity)
+        {
+            // Record is full: every next record of this stream is bigger
+            stream.capacity = std::min(static_cast<uint16_t>(stream.capacity << 1), value_stream::MAX_CAPACITY);
+            record = nullptr;
+        }
+    }
+
+    if (record == nullptr)
+    {
+        const auto serializedDataSize = static_cast<uint16_t>(sizeof(profiler::ValueStream) + stream.capacity);
+        record = ::new (blocks.closedList.allocate(serializedDataSize))
+            profiler::ValueStream(_timestamp, _vin, _id, _type, static_cast<uint8_t>(_size));
+        blocks.frameMemorySize += serializedDataSize;
+
+        {
+            InternalAllocationGuard guard;
+            valueStreamRecords.push_back(record);
+        }
+
+        stream.record = record;
+        stream.vin = _vin;
+        stream.time = _timestamp;
+        stream.delta = 0;
+        stream.value = 0;
+    }
+
+    const auto delta = _timestamp - stream.time;
+    const auto value = value_stream::load(_data, static_cast<uint8_t>(_size), value_stream::isSigned(_type));
+
+    char* const begin = const_cast<char*>(record->data()) + record->m_size;
+    char* end = value_stream::writeVarint(begin, value_stream::zigzag(static_cast<int64_t>(delta - stream.delta)));
+    end = value_stream::writeValue(end, stream.value, value, static_cast<uint8_t>(_size), value_stream::isFloatingPoint(_type));
+
+    record->m_size += static_cast<uint16_t>(end - begin);
+    ++record->m_count;
+    record->m_end = _timestamp;
+
+    stream.time = _timestamp;
+    stream.delta = delta;
+    stream.value = value;
+
+    return true;
+}
+
+void ThreadStorage::storeAsync(
+    profiler::timestamp_t _begin,
+    profiler::timestamp_t _end,
+    profiler::block_id_t _id,
+    uint64_t _correlationId,
+    profiler::thread_id_t _sourceThread
+) {
+    EASY_CONSTEXPR auto serializedDataSize = static_cast<uint16_t>(sizeof(profiler::AsyncEvent));
+
+    void* data = blocks.closedList.allocate(serializedDataSize);
+    ::new (data) profiler::AsyncEvent(_begin, _end, _id, _correlationId, _sourceThread);
+    blocks.frameMemorySize += serializedDataSize;
+
+    putMarkIfEmpty();
+}
+
 void ThreadStorage::storeBlock(const profiler::Block& block)
 {
 #if EASY_OPTION_MEASURE_STORAGE_EXPAND != 0
@@ -194,12 +307,156 @@ void ThreadStorage::clearClosed()
 {
     blocks.clearClosed();
     sync.clearClosed();
+    closeValueStreams();
+}
+
+void ThreadStorage::closeValueStreams()
+{
+    // Records of value streams have been serialized (or dropped) with blocks.closedList.
+    // Capacity is restarted too: it has grown for frequent values of previous frames only.
+    for (auto& stream : valueStreams)
+    {
+        stream.record = nullptr;
+        stream.capacity = value_stream::MIN_CAPACITY;
+    }
+}
+
+void ThreadStorage::serializeClosed(std::ostream& _outputStream)
+{
+    // Value stream record reserves memory for samples of the whole record capacity,
+    // but only encoded samples are written. Records are visited in order of allocation.
+    size_t next = 0;
+    const auto& records = valueStreamRecords;
+    blocks.closedList.serialize(_outputStream, [&next, &records] (const char* _data, uint16_t _size) -> uint16_t
+    {
+        if (next == records.size() || _data != reinterpret_cast<const char*>(records[next]))
+            return _size;
+
+        const auto record = records[next++];
+        const auto usedSize = static_cast<uint16_t>(sizeof(profiler::ValueStream) + record->data_size());
+        return usedSize < _size ? usedSize : _size;
+    });
+
+    valueStreamRecords.clear();
+}
+
+void ThreadStorage::storeAllocation(uint64_t _bytes, uint32_t _count)
+{
+    const auto depth = blocks.openedList.size();
+    if (depth == 0 || (blocks.openedList.back().get().m_status & profiler::ON) == 0)
+        return;
+
+    if (allocations.size() < depth)
+    {
+        InternalAllocationGuard guard;
+        allocations.resize(depth, Allocations {0, 0});
+    }
+
+    auto& top = allocations[depth - 1];
+    top.bytes += _bytes;
+    top.count += _count;
+}
+
+void ThreadStorage::storeAllocations(const profiler::BaseBlockDescriptor* _desc, profiler::timestamp_t _timestamp)
+{
+    // Must be called before closing the top block: counters of its depth are stored
+    // into an arbitrary value which would become the last child of the block and then reset.
+
+    const auto depth = blocks.openedList.size();
+    if (depth == 0 || depth > allocations.size())
+        return;
+
+    auto& top = allocations[depth - 1];
+    if (top.count == 0)
+        return;
+
+    if (_desc != nullptr)
+    {
+        const uint64_t data[2] = {top.bytes, top.count};
+        storeValue(_timestamp, _desc->id(), profiler::DataType::Uint64, data, sizeof(data), true, profiler::ValueId(static_cast<const void*>(_desc)));
+    }
+
+    top.bytes = top.count = 0;
+}
+
+bool ThreadStorage::sample(profiler::block_id_t _id)
+{
+    // Returns true if the block should be stored.
+    // Only thread-local counters are used here: policies are copied into samplers by ProfileManager::updateSamplers().
+
+    if (_id >= samplers.size())
+        return true;
+
+    auto& sampler = samplers[_id];
+    switch (sampler.policy)
+    {
+        case profiler::SamplingPolicy::OneInN:
+        {
+            ++sampler.calls;
+            if (++sampler.counter < sampler.period)
+                return false;
+            sampler.counter = 0;
+            break;
+        }
+
+        case profiler::SamplingPolicy::PerFrame:
+        {
+            ++sampler.calls;
+            if (sampler.frame != framesNumber)
+            {
+                sampler.frame = framesNumber;
+                sampler.counter = 0;
+            }
+
+            if (sampler.counter >= sampler.value)
+                return false;
+            ++sampler.counter;
+            break;
+        }
+
+        case profiler::SamplingPolicy::Budget:
+        {
+            ++sampler.calls;
+            ++sampler.windowCalls;
+
+            // Clock is checked only for blocks which are going to be stored and once per 1024 calls
+            const bool candidate = sampler.counter + 1 >= sampler.period;
+            if (candidate || (sampler.windowCalls & 1023) == 0)
+            {
+                const auto now = profiler::clock::now();
+                const auto elapsed = now - sampler.windowBegin;
+                if (elapsed >= samplingWindow)
+                {
+                    // Adapt period to the call rate of the previous window to spread stored blocks evenly
+                    const double callsPerWindow = static_cast<double>(sampler.windowCalls) * samplingWindow / elapsed;
+                    const double period = callsPerWindow / sampler.value;
+                    sampler.period = period < 1. ? 1U : period > 4e9 ? 4000000000U : static_cast<uint32_t>(period);
+                    sampler.windowBegin = now;
+                    sampler.windowCalls = 0;
+                    sampler.windowStored = 0;
+                }
+            }
+
+            if (++sampler.counter < sampler.period || sampler.windowStored >= sampler.value)
+                return false;
+            sampler.counter = 0;
+            ++sampler.windowStored;
+            break;
+        }
+
+        default:
+            return true;
+    }
+
+    ++sampler.stored;
+    return true;
 }
 
 void ThreadStorage::popSilent()
 {
     if (!blocks.openedList.empty())
     {
+        storeAllocations(nullptr, 0);
         profiler::Block& top = blocks.openedList.back();
         top.m_end = top.m_begin;
         if (!top.m_isScoped)
@@ -214,6 +471,7 @@ void ThreadStorage::beginFrame()
     {
         frameStartTime = profiler::clock::now();
         frameOpened = true;
+        ++framesNumber;
     }
 }
 
@@ -225,9 +483,16 @@ profiler::timestamp_t ThreadStorage::endFrame()
 
 void ThreadStorage::putMark()
 {
-    blocks.closedList.put_mark();
-    blocks.usedMemorySize += blocks.frameMemorySize;
-    blocks.frameMemorySize = 0;
+    {
+        // Listening thread may be moving closed frames into streamData right now (see streamFrames())
+        profiler::guard_lock<profiler::spin_lock> lock(streamSpin);
+        blocks.closedList.put_mark();
+        blocks.usedMemorySize += blocks.frameMemorySize;
+        blocks.frameMemorySize = 0;
+    }
+
+    if (streamRequested.load(std::memory_order_acquire))
+        streamFrames();
 }
 
 void ThreadStorage::putMarkIfEmpty()
@@ -235,3 +500,38 @@ void ThreadStorage::putMarkIfEmpty()
     if (!frameOpened)
         putMark();
 }
+
+void ThreadStorage::streamFrames()
+{
+    // Called by the owning thread right after putMark(), so all stored blocks
+    // are closed frames and the whole closedList could be serialized.
+    // Listening thread calls it too (after profiler has been disabled) to collect the rest of frames,
+    // so closedList is moved under streamSpin: owning thread may reach here via putMark() of a forced event.
+    profiler::guard_lock<profiler::spin_lock> lock(streamSpin);
+    streamRequested.store(false, std::memory_order_release);
+
+    if (blocks.closedList.markedEmpty())
+        return;
+
+    streamBlocksNumber += blocks.closedList.markedSize();
+    streamMemorySize += blocks.usedMemorySize;
+    serializeClosed(streamData);
+    blocks.clearClosed();
+    closeValueStreams();
+}
+
+void ThreadStorage::retainFrames()
+{
+    // Called by the owning thread right after putMark() when closed frames have taken a half of triggered
+    // capture buffer. They replace previously retained frames, so at most two halves of buffer are kept.
+    profiler::guard_lock<profiler::spin_lock> lock(streamSpin);
+
+    std::ostringstream stream(std::ios_base::out | std::ios_base::binary);
+    retainedBlocksNumber = blocks.closedList.markedSize();
+    retainedMemorySize = blocks.usedMemorySize;
+    serializeClosed(stream);
+    retainedFrames = stream.str();
+
+    blocks.clearClosed();
+    closeValueStreams();
+}
@@ -45,6 +45,7 @@ The Apache License, Version 2.0 (the "License");
 
 #include <atomic>
 #include <functional>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -53,6 +54,7 @@ The Apache License, Version 2.0 (the "License");
 #include <easy/serialized_block.h>
 
 #include "chunk_allocator.h"
+#include "spin_lock.h"
 #include "stack_buffer.h"
 
 //////////////////////////////////////////////////////////////////////////
@@ -127,17 +129,87 @@ struct ThreadStorage EASY_FINAL
     bool                         guarded; ///< True if thread has been registered using ThreadGuard
     bool                     frameOpened; ///< Is new frame opened (this does not depend on profiling status) \sa profiledFrameOpened
 
+    std::stringstream         streamData; ///< Closed frames moved out of blocks.closedList for streaming (guarded by streamSpin)
+    uint64_t          streamMemorySize; ///< Used memory size of blocks in streamData
+    uint32_t        streamBlocksNumber; ///< Number of blocks in streamData
+    profiler::spin_lock       streamSpin; ///< Guards streamData, streamMemorySize, streamBlocksNumber and moving of closed frames into them
+    std::atomic_bool     streamRequested; ///< Set by listening thread to ask this thread to move closed frames into streamData
+    std::string           streamCaptured; ///< Frames moved out of streamData which are kept for active network capture (guarded by streamSpin)
+    uint64_t    streamCapturedMemorySize; ///< Used memory size of blocks in streamCaptured
+    uint32_t  streamCapturedBlocksNumber; ///< Number of blocks in streamCaptured
+    std::string           retainedFrames; ///< Older closed frames kept for triggered capture when closedList has exceeded a half of buffer (guarded by streamSpin)
+    uint64_t          retainedMemorySize; ///< Used memory size of blocks in retainedFrames
+    uint32_t        retainedBlocksNumber; ///< Number of blocks in retainedFrames
+
+    struct Allocations { uint64_t bytes; uint64_t count; };
+    std::vector<Allocations>  allocations; ///< Heap allocations made inside opened blocks (index is a depth of the block in blocks.openedList)
+
+    struct Sampler
+    {
+        profiler::SamplingPolicy       policy; ///< Copy of descriptor sampling policy
+        uint32_t                        value; ///< Copy of descriptor sampling value (N)
+        uint32_t                       period; ///< Current 1-in-N period (adaptive for SamplingPolicy::Budget)
+        uint32_t                      counter; ///< Calls since last stored block (stored blocks in current frame for SamplingPolicy::PerFrame)
+        uint32_t                        frame; ///< Frame number of counter (SamplingPolicy::PerFrame)
+        uint32_t                 windowStored; ///< Stored blocks during current budget window
+        uint64_t                  windowCalls; ///< Calls during current budget window
+        profiler::timestamp_t     windowBegin; ///< Current budget window start time
+        uint64_t                        calls; ///< Calls since sampling counters restart
+        uint64_t                       stored; ///< Stored blocks since sampling counters restart
+    };
+
+    std::vector<Sampler>         samplers; ///< Sampling state of blocks (index is a descriptor id)
+
+    struct ValueStreamState
+    {
+        profiler::ValueStream*     record; ///< Currently filled record in blocks.closedList (nullptr if there is no one)
+        profiler::vin_t               vin; ///< Value id of the stream (values with other ids are stored as separate records)
+        profiler::timestamp_t        time; ///< Timestamp of the last sample
+        profiler::timestamp_t       delta; ///< Difference between timestamps of two last samples
+        uint64_t                    value; ///< Bits of the last value
+        uint16_t                 capacity; ///< Capacity of encoded data of the next record
+    };
+
+    std::vector<ValueStreamState> valueStreams; ///< Compact streams of scalar values (index is a descriptor id)
+    std::vector<const profiler::ValueStream*> valueStreamRecords; ///< Value stream records in blocks.closedList in order of allocation
+    profiler::timestamp_t  samplingWindow; ///< Budget window (1 second) in ticks
+    uint32_t           samplingGeneration; ///< ProfileManager::m_samplingGeneration which samplers have been built for
+    uint32_t                 framesNumber; ///< Number of opened frames (used by SamplingPolicy::PerFrame)
+
     void storeValue(profiler::timestamp_t _timestamp, profiler::block_id_t _id, profiler::DataType _type, const void* _data, uint16_t _size, bool _isArray, profiler::ValueId _vin);
+    bool storeStreamValue(profiler::timestamp_t _timestamp, profiler::block_id_t _id, profiler::DataType _type, const void* _data, uint16_t _size, profiler::vin_t _vin);
     void storeBlock(const profiler::Block& _block);
+    void storeAsync(profiler::timestamp_t _begin, profiler::timestamp_t _end, profiler::block_id_t _id, uint64_t _correlationId, profiler::thread_id_t _sourceThread);
     void storeBlockForce(const profiler::Block& _block);
     void storeCSwitch(const CSwitchBlock& _block);
+    void storeAllocation(uint64_t _bytes, uint32_t _count);
+
+    inline void pushOpened(profiler::Block& _block)
+    {
+        if (blocks.openedList.size() == blocks.openedList.capacity())
+        {
+            // Growth of opened blocks stack must not be counted as user's heap allocation
+            InternalAllocationGuard guard;
+            blocks.openedList.emplace_back(_block);
+        }
+        else
+        {
+            blocks.openedList.emplace_back(_block);
+        }
+    }
+    void storeAllocations(const profiler::BaseBlockDescriptor* _desc, profiler::timestamp_t _timestamp);
+    bool sample(profiler::block_id_t _id);
     void clearClosed();
+    void closeValueStreams();
+    void serializeClosed(std::ostream& _outputStream);
     void popSilent();
 
     void beginFrame();
     profiler::timestamp_t endFrame();
     void putMark();
     void putMarkIfEmpty();
+    void streamFrames();
+    void retainFrames();
 
     ThreadStorage();
     ThreadStorage(const ThreadStorage&) = delete;
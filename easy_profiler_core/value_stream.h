@@ -0,0 +1,213 @@
+/**
+Lightweight profiler library for c++
+Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+
+Licensed under either of
+    * MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+    * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+at your option.
+
+The MIT License
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights 
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies 
+    of the Software, and to permit persons to whom the Software is furnished 
+    to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all 
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+    PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE 
+    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, 
+    TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE 
+    USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+The Apache License, Version 2.0 (the "License");
+    You may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+**/
+
+#ifndef EASY_PROFILER_VALUE_STREAM_H
+#define EASY_PROFILER_VALUE_STREAM_H
+
+#include <stdint.h>
+#include <string.h>
+#include <limits>
+
+#include <easy/details/arbitrary_value_public_types.h>
+
+//////////////////////////////////////////////////////////////////////////
+
+/** Encoding of profiler::ValueStream samples.
+
+Each sample is a delta-of-delta of timestamp (zigzag varint) followed by the value:
+* integers and bools: zigzag varint of difference with previous value;
+* float and double: XOR with previous value bits. Zero XOR is one zero byte, otherwise control byte
+  (1 + (leading zero bytes << 4 | trailing zero bytes)) is followed by the remaining bytes of XOR.
+
+Previous timestamp, timestamps delta and value are zeroed at the beginning of each record.
+*/
+namespace value_stream {
+
+EASY_CONSTEXPR uint16_t MAX_VARINT_SIZE = 10;
+EASY_CONSTEXPR uint16_t MAX_SAMPLE_SIZE = MAX_VARINT_SIZE * 2; ///< Maximum size of one encoded sample
+EASY_CONSTEXPR uint16_t MIN_CAPACITY = 32;   ///< Encoded data capacity of the first record of a stream
+EASY_CONSTEXPR uint16_t MAX_CAPACITY = 1024; ///< Encoded data capacity is doubled for every next record up to this value
+
+inline bool isStreamable(profiler::DataType _type, uint16_t _size)
+{
+    return _type != profiler::DataType::String && _type < profiler::DataType::TypesCount &&
+           (_size == 1 || _size == 2 || _size == 4 || _size == 8);
+}
+
+inline bool isFloatingPoint(profiler::DataType _type)
+{
+    return _type == profiler::DataType::Float || _type == profiler::DataType::Double;
+}
+
+inline bool isSigned(profiler::DataType _type)
+{
+    switch (_type)
+    {
+        case profiler::DataType::Char: return std::numeric_limits<char>::is_signed;
+        case profiler::DataType::Int8:
+        case profiler::DataType::Int16:
+        case profiler::DataType::Int32:
+        case profiler::DataType::Int64: return true;
+        default: return false;
+    }
+}
+
+/** Loads value bits. Signed integers are sign-extended, so small negative deltas stay small. */
+inline uint64_t load(const void* _data, uint8_t _size, bool _signed)
+{
+    switch (_size)
+    {
+        case 1: { uint8_t v; memcpy(&v, _data, 1); return _signed ? static_cast<uint64_t>(static_cast<int8_t>(v)) : v; }
+        case 2: { uint16_t v; memcpy(&v, _data, 2); return _signed ? static_cast<uint64_t>(static_cast<int16_t>(v)) : v; }
+        case 4: { uint32_t v; memcpy(&v, _data, 4); return _signed ? static_cast<uint64_t>(static_cast<int32_t>(v)) : v; }
+        default: { uint64_t v; memcpy(&v, _data, 8); return v; }
+    }
+}
+
+/** Stores lower _size bytes of value bits. */
+inline void store(void* _data, uint8_t _size, uint64_t _bits)
+{
+    switch (_size)
+    {
+        case 1: { const auto v = static_cast<uint8_t>(_bits); memcpy(_data, &v, 1); break; }
+        case 2: { const auto v = static_cast<uint16_t>(_bits); memcpy(_data, &v, 2); break; }
+        case 4: { const auto v = static_cast<uint32_t>(_bits); memcpy(_data, &v, 4); break; }
+        default: memcpy(_data, &_bits, 8); break;
+    }
+}
+
+inline uint64_t zigzag(int64_t _value)
+{
+    return (static_cast<uint64_t>(_value) << 1) ^ static_cast<uint64_t>(_value >> 63);
+}
+
+inline int64_t unzigzag(uint64_t _value)
+{
+    return static_cast<int64_t>(_value >> 1) ^ -static_cast<int64_t>(_value & 1);
+}
+
+inline char* writeVarint(char* _out, uint64_t _value)
+{
+    while (_value >= 0x80)
+    {
+        *_out++ = static_cast<char>((_value & 0x7f) | 0x80);
+        _value >>= 7;
+    }
+
+    *_out++ = static_cast<char>(_value);
+    return _out;
+}
+
+/** Returns nullptr if encoded data is corrupted. */
+inline const char* readVarint(const char* _in, const char* _end, uint64_t& _value)
+{
+    _value = 0;
+    for (unsigned shift = 0; _in != _end && shift < 64; shift += 7)
+    {
+        const auto byte = static_cast<uint8_t>(*_in++);
+        _value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+            return _in;
+    }
+
+    return nullptr;
+}
+
+inline char* writeValue(char* _out, uint64_t _previous, uint64_t _value, uint8_t _size, bool _floatingPoint)
+{
+    if (!_floatingPoint)
+        return writeVarint(_out, zigzag(static_cast<int64_t>(_value - _previous)));
+
+    const uint64_t bits = _previous ^ _value;
+    if (bits == 0)
+    {
+        *_out++ = 0;
+        return _out;
+    }
+
+    uint8_t trailing = 0, leading = 0;
+    while (((bits >> (trailing * 8)) & 0xff) == 0)
+        ++trailing;
+    while (((bits >> ((_size - 1 - leading) * 8)) & 0xff) == 0)
+        ++leading;
+
+    *_out++ = static_cast<char>(1 + ((leading << 4) | trailing));
+    for (uint8_t i = trailing, end = static_cast<uint8_t>(_size - leading); i < end; ++i)
+        *_out++ = static_cast<char>((bits >> (i * 8)) & 0xff);
+
+    return _out;
+}
+
+/** Returns nullptr if encoded data is corrupted. */
+inline const char* readValue(const char* _in, const char* _end, uint64_t& _value, uint8_t _size, bool _floatingPoint)
+{
+    if (!_floatingPoint)
+    {
+        uint64_t delta = 0;
+        _in = readVarint(_in, _end, delta);
+        _value += static_cast<uint64_t>(unzigzag(delta));
+        return _in;
+    }
+
+    if (_in == _end)
+        return nullptr;
+
+    const auto control = static_cast<uint8_t>(*_in++);
+    if (control == 0)
+        return _in;
+
+    const uint8_t leading = static_cast<uint8_t>((control - 1) >> 4), trailing = static_cast<uint8_t>((control - 1) & 0x0f);
+    if (leading + trailing >= _size || _end - _in < _size - leading - trailing)
+        return nullptr;
+
+    uint64_t bits = 0;
+    for (uint8_t i = trailing, end = static_cast<uint8_t>(_size - leading); i < end; ++i)
+        bits |= static_cast<uint64_t>(static_cast<uint8_t>(*_in++)) << (i * 8);
+
+    _value ^= bits;
+    return _in;
+}
+
+} // END of namespace value_stream.
+
+//////////////////////////////////////////////////////////////////////////
+
+#endif // EASY_PROFILER_VALUE_STREAM_H
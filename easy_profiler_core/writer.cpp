@@ -52,6 +52,7 @@
 #include <fstream>
 #include <iterator>
 #include <algorithm>
+#include <thread>
 
 #include <easy/writer.h>
 #include <easy/profiler.h>
@@ -98,14 +99,47 @@ struct BlocksMemoryAndCount
     }
 };
 
-struct BlocksAndCSwitchesRange
+enum class ChunkType : uint8_t
 {
-    BlocksMemoryAndCount    blocksMemoryAndCount;
-    BlocksMemoryAndCount cswitchesMemoryAndCount;
-    BlocksRange                           blocks;
-    BlocksRange                        cswitches;
+    ContextSwitches,
+    Blocks,
+    Asyncs
 };
 
+/** Serialized part of a thread section: context switches, a range of top-level blocks or async spans.
+
+Chunks are serialized in parallel into their own buffers and then written into the output stream in order.
+*/
+struct SerializedChunk
+{
+    std::vector<char>                      data;
+    BlocksMemoryAndCount         memoryAndCount;
+    const profiler::BlocksTreeRoot* tree = nullptr;
+    BlocksRange                           range;
+    ChunkType                  type = ChunkType::Blocks;
+};
+
+struct ThreadSection
+{
+    SerializedChunk           cswitches;
+    std::vector<SerializedChunk> blocks; ///< Top-level blocks are split into several chunks
+    SerializedChunk              asyncs;
+};
+
+/** Getter which is inlined into serialization (unlike profiler::block_getter_fn which is called through std::function). */
+struct BlocksListGetter
+{
+    const profiler::blocks_t& blocks;
+
+    inline const profiler::BlocksTree& operator () (profiler::block_index_t i) const
+    {
+        return blocks[i];
+    }
+};
+
+EASY_CONSTEXPR profiler::block_index_t MinChunkBlocksCount = 256; ///< Minimum number of top-level blocks in one chunk
+EASY_CONSTEXPR unsigned int ChunksPerWorker = 4; ///< Number of chunks of one thread per worker thread (for load balancing)
+
 //////////////////////////////////////////////////////////////////////////
 
 template <typename T>
@@ -134,8 +168,38 @@ static bool update_progress_write(std::atomic<int>& progress, int new_value, std
 
 //////////////////////////////////////////////////////////////////////////
 
+static unsigned int workersCount()
+{
+    return std::max(std::thread::hardware_concurrency(), 1U);
+}
+
+/** Calls func(index, isCallingThread) for every index in [0, count) using all CPU cores. */
+template <class TFunc>
+static void parallelFor(size_t count, const TFunc& func)
+{
+    std::atomic<size_t> next(0);
+    auto worker = [&] (bool isCallingThread)
+    {
+        for (auto i = next.fetch_add(1, std::memory_order_relaxed); i < count; i = next.fetch_add(1, std::memory_order_relaxed))
+            func(i, isCallingThread);
+    };
+
+    std::vector<std::thread> threads;
+    const auto threadsCount = std::min(static_cast<size_t>(workersCount()), count);
+    for (size_t i = 1; i < threadsCount; ++i)
+        threads.emplace_back(worker, false);
+
+    worker(true);
+
+    for (auto& thread : threads)
+        thread.join();
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+template <class TGetter>
 static BlocksRange findRange(const profiler::BlocksTree::children_t& children, profiler::timestamp_t beginTime,
-                             profiler::timestamp_t endTime, const profiler::block_getter_fn& getter)
+                             profiler::timestamp_t endTime, const TGetter& getter)
 {
     const auto size = static_cast<profiler::block_index_t>(children.size());
     BlocksRange range(size);
@@ -231,60 +295,24 @@ static BlocksRange findRange(const profiler::bookmarks_t& bookmarks, profiler::t
     return range;
 }
 
-static BlocksMemoryAndCount calculateUsedMemoryAndBlocksCount(const profiler::BlocksTree::children_t& children,
-                                                              const BlocksRange& range,
-                                                              const profiler::block_getter_fn& getter,
-                                                              const profiler::descriptors_list_t& descriptors,
-                                                              bool contextSwitches)
+//////////////////////////////////////////////////////////////////////////
+
+static char* appendRecord(std::vector<char>& buffer, const void* data, uint16_t usedMemorySize)
 {
-    BlocksMemoryAndCount memoryAndCount;
+    const auto offset = buffer.size();
+    buffer.resize(offset + sizeof(uint16_t) + usedMemorySize);
 
-    if (!contextSwitches)
-    {
-        for (auto i = range.begin; i < range.end; ++i)
-        {
-            const auto& child = getter(children[i]);
-
-            // Calculate self memory consumption
-            const auto& desc = *descriptors[child.node->id()];
-            uint64_t usedMemorySize = 0;
-
-            if (desc.type() == profiler::BlockType::Value)
-                usedMemorySize = sizeof(profiler::ArbitraryValue) + child.value->data_size();
-            else
-                usedMemorySize = sizeof(profiler::SerializedBlock) + strlen(child.node->name()) + 1;
-
-            // Calculate children memory consumption
-            const BlocksRange childRange(0, static_cast<profiler::block_index_t>(child.children.size()));
-            const auto childrenMemoryAndCount = calculateUsedMemoryAndBlocksCount(child.children, childRange,
-                                                                                  getter, descriptors,
-                                                                                  false);
-
-            // Accumulate memory and count
-            memoryAndCount += childrenMemoryAndCount;
-            memoryAndCount.usedMemorySize += usedMemorySize;
-            ++memoryAndCount.blocksCount;
-        }
-    }
-    else
-    {
-        for (auto i = range.begin; i < range.end; ++i)
-        {
-            const auto& child = getter(children[i]);
-            const uint64_t usedMemorySize = BaseCSwitchSize + strlen(child.cs->name());
-            memoryAndCount.usedMemorySize += usedMemorySize;
-            ++memoryAndCount.blocksCount;
-        }
-    }
+    char* record = buffer.data() + offset;
+    unaligned_store16(record, usedMemorySize);
+    memcpy(record + sizeof(uint16_t), data, static_cast<size_t>(usedMemorySize));
 
-    return memoryAndCount;
+    return record + sizeof(uint16_t);
 }
 
-//////////////////////////////////////////////////////////////////////////
-
-static void serializeBlocks(std::ostream& output, std::vector<char>& buffer,
-                            const profiler::BlocksTree::children_t& children, const BlocksRange& range,
-                            const profiler::block_getter_fn& getter, const profiler::descriptors_list_t& descriptors)
+template <class TGetter>
+static void serializeBlocks(SerializedChunk& chunk, const profiler::BlocksTree::children_t& children,
+                            const BlocksRange& range, const TGetter& getter,
+                            const profiler::descriptors_list_t& descriptors)
 {
     for (auto i = range.begin; i < range.end; ++i)
     {
@@ -292,7 +320,7 @@ static void serializeBlocks(std::ostream& output, std::vector<char>& buffer,
 
         // Serialize children
         const BlocksRange childRange(0, static_cast<profiler::block_index_t>(child.children.size()));
-        serializeBlocks(output, buffer, child.children, childRange, getter, descriptors);
+        serializeBlocks(chunk, child.children, childRange, getter, descriptors);
 
         // Serialize self
         const auto& desc = *descriptors[child.node->id()];
@@ -301,49 +329,92 @@ static void serializeBlocks(std::ostream& output, std::vector<char>& buffer,
         if (desc.type() == profiler::BlockType::Value)
         {
             usedMemorySize = static_cast<uint16_t>(sizeof(profiler::ArbitraryValue)) + child.value->data_size();
-            buffer.resize(usedMemorySize + sizeof(uint16_t));
-            unaligned_store16(buffer.data(), usedMemorySize);
-            memcpy(buffer.data() + sizeof(uint16_t), child.value, static_cast<size_t>(usedMemorySize));
+            appendRecord(chunk.data, child.value, usedMemorySize);
         }
         else
         {
             usedMemorySize = static_cast<uint16_t>(sizeof(profiler::SerializedBlock)
                                                    + strlen(child.node->name()) + 1);
 
-            buffer.resize(usedMemorySize + sizeof(uint16_t));
-            unaligned_store16(buffer.data(), usedMemorySize);
-            memcpy(buffer.data() + sizeof(uint16_t), child.node, static_cast<size_t>(usedMemorySize));
-
+            auto record = appendRecord(chunk.data, child.node, usedMemorySize);
             if (child.node->id() != desc.id())
             {
                 // This block id is dynamic. Restore it's value like it was before in the input .prof file
-                auto block = reinterpret_cast<profiler::SerializedBlock*>(buffer.data() + sizeof(uint16_t));
-                block->setId(desc.id());
+                reinterpret_cast<profiler::SerializedBlock*>(record)->setId(desc.id());
             }
         }
 
-        write(output, buffer.data(), buffer.size());
+        chunk.memoryAndCount.usedMemorySize += usedMemorySize;
+        ++chunk.memoryAndCount.blocksCount;
+    }
+}
+
+static inline bool isAsyncInRange(const profiler::BlocksTree& async, profiler::timestamp_t beginTime,
+                                  profiler::timestamp_t endTime)
+{
+    return beginTime <= async.async->end() && async.async->begin() <= endTime;
+}
+
+template <class TGetter>
+static void serializeAsyncs(SerializedChunk& chunk, const profiler::BlocksTree::children_t& asyncs,
+                            profiler::timestamp_t beginTime, profiler::timestamp_t endTime, const TGetter& getter)
+{
+    EASY_CONSTEXPR auto usedMemorySize = static_cast<uint16_t>(sizeof(profiler::AsyncEvent));
+
+    for (auto index : asyncs)
+    {
+        const auto& async = getter(index);
+        if (!isAsyncInRange(async, beginTime, endTime))
+            continue;
+
+        appendRecord(chunk.data, async.async, usedMemorySize);
+        chunk.memoryAndCount.usedMemorySize += usedMemorySize;
+        ++chunk.memoryAndCount.blocksCount;
     }
 }
 
-static void serializeContextSwitches(std::ostream& output, std::vector<char>& buffer,
-                                     const profiler::BlocksTree::children_t& children, const BlocksRange& range,
-                                     const profiler::block_getter_fn& getter)
+template <class TGetter>
+static void serializeContextSwitches(SerializedChunk& chunk, const profiler::BlocksTree::children_t& children,
+                                     const BlocksRange& range, const TGetter& getter)
 {
     for (auto i = range.begin; i < range.end; ++i)
     {
         const auto& child = getter(children[i]);
-
         const auto usedMemorySize = static_cast<uint16_t>(BaseCSwitchSize + strlen(child.cs->name()));
 
-        buffer.resize(usedMemorySize + sizeof(uint16_t));
-        unaligned_store16(buffer.data(), usedMemorySize);
-        memcpy(buffer.data() + sizeof(uint16_t), child.cs, static_cast<size_t>(usedMemorySize));
+        appendRecord(chunk.data, child.cs, usedMemorySize);
+        chunk.memoryAndCount.usedMemorySize += usedMemorySize;
+        ++chunk.memoryAndCount.blocksCount;
+    }
+}
 
-        write(output, buffer.data(), buffer.size());
+template <class TGetter>
+static void serializeChunk(SerializedChunk& chunk, const TGetter& getter, const profiler::descriptors_list_t& descriptors,
+                           profiler::timestamp_t beginTime, profiler::timestamp_t endTime)
+{
+    switch (chunk.type)
+    {
+        case ChunkType::ContextSwitches:
+            serializeContextSwitches(chunk, chunk.tree->sync, chunk.range, getter);
+            break;
+
+        case ChunkType::Blocks:
+            serializeBlocks(chunk, chunk.tree->children, chunk.range, getter, descriptors);
+            break;
+
+        case ChunkType::Asyncs:
+            serializeAsyncs(chunk, chunk.tree->asyncs, beginTime, endTime, getter);
+            break;
     }
 }
 
+static void writeChunk(std::ostream& output, SerializedChunk& chunk)
+{
+    // One large write per chunk
+    write(output, chunk.data.data(), chunk.data.size());
+    std::vector<char>().swap(chunk.data); // release memory as soon as possible
+}
+
 static void serializeDescriptors(std::ostream& output, std::vector<char>& buffer,
                                  const profiler::descriptors_list_t& descriptors,
                                  profiler::block_id_t descriptors_count)
@@ -380,50 +451,27 @@ static void serializeBookmarks(std::ostream& output, const profiler::bookmarks_t
     }
 }
 
-//////////////////////////////////////////////////////////////////////////
-
-extern "C" PROFILER_API profiler::block_index_t writeTreesToFile(std::atomic<int>& progress, const char* filename,
-                                                                 const profiler::SerializedData& serialized_descriptors,
-                                                                 const profiler::descriptors_list_t& descriptors,
-                                                                 profiler::block_id_t descriptors_count,
-                                                                 const profiler::thread_blocks_tree_t& trees,
-                                                                 const profiler::bookmarks_t& bookmarks,
-                                                                 profiler::block_getter_fn block_getter,
-                                                                 profiler::timestamp_t begin_time,
-                                                                 profiler::timestamp_t end_time,
-                                                                 profiler::processid_t pid,
-                                                                 std::ostream& log)
-{
-    if (!update_progress_write(progress, 0, log))
-        return 0;
-
-    std::ofstream outFile(filename, std::fstream::binary);
-    if (!outFile.is_open())
-    {
-        log << "Can not open file " << filename;
-        return 0;
-    }
-
-    // Write data to file
-    auto result = writeTreesToStream(progress, outFile, serialized_descriptors, descriptors, descriptors_count, trees,
-                                     bookmarks, std::move(block_getter), begin_time, end_time, pid, log);
-
-    return result;
-}
 
 //////////////////////////////////////////////////////////////////////////
 
-extern "C" PROFILER_API profiler::block_index_t writeTreesToStream(std::atomic<int>& progress, std::ostream& str,
-                                                                   const profiler::SerializedData& serialized_descriptors,
-                                                                   const profiler::descriptors_list_t& descriptors,
-                                                                   profiler::block_id_t descriptors_count,
-                                                                   const profiler::thread_blocks_tree_t& trees,
-                                                                   const profiler::bookmarks_t& bookmarks,
-                                                                   profiler::block_getter_fn block_getter,
-                                                                   profiler::timestamp_t begin_time,
-                                                                   profiler::timestamp_t end_time,
-                                                                   profiler::processid_t pid,
-                                                                   std::ostream& log)
+/** Writes blocks trees into stream.
+
+Thread sections are split into chunks (context switches, ranges of top-level blocks and async spans)
+which are serialized in parallel. Getter is a template parameter, so it could be inlined.
+*/
+template <class TGetter>
+static profiler::block_index_t writeTrees(std::atomic<int>& progress, std::ostream& str,
+                                          const profiler::SerializedData& serialized_descriptors,
+                                          const profiler::descriptors_list_t& descriptors,
+                                          profiler::block_id_t descriptors_count,
+                                          const profiler::thread_blocks_tree_t& trees,
+                                          const profiler::bookmarks_t& bookmarks,
+                                          const TGetter& block_getter,
+                                          profiler::timestamp_t begin_time,
+                                          profiler::timestamp_t end_time,
+                                          profiler::processid_t pid,
+                                          profiler::timestamp_t block_overhead,
+                                          std::ostream& log)
 {
     if (trees.empty() || serialized_descriptors.empty() || descriptors_count == 0)
     {
@@ -431,52 +479,79 @@ extern "C" PROFILER_API profiler::block_index_t writeTreesToStream(std::atomic<i
         return 0;
     }
 
-    BlocksMemoryAndCount total;
+    // Calculate block ranges and split them into chunks
+    std::vector<ThreadSection> sections(trees.size());
+    std::vector<SerializedChunk*> chunks;
+    chunks.reserve(trees.size() * 3);
 
-    using ranges_t = std::unordered_map<profiler::thread_id_t, BlocksAndCSwitchesRange, estd::hash<profiler::thread_id_t> >;
-    ranges_t block_ranges;
+    const auto maxChunksCount = static_cast<profiler::block_index_t>(workersCount() * ChunksPerWorker);
 
-    // Calculate block ranges and used memory (for serialization)
     profiler::timestamp_t beginTime = begin_time, endTime = end_time;
     size_t i = 0;
     for (const auto& kv : trees)
     {
-        const auto id = kv.first;
         const auto& tree = kv.second;
+        auto& section = sections[i++];
 
-        BlocksAndCSwitchesRange range;
+        section.cswitches.tree = &tree;
+        section.cswitches.type = ChunkType::ContextSwitches;
+        section.cswitches.range = findRange(tree.sync, begin_time, end_time, block_getter);
+        chunks.push_back(&section.cswitches);
 
-        range.blocks = findRange(tree.children, begin_time, end_time, block_getter);
-        range.cswitches = findRange(tree.sync, begin_time, end_time, block_getter);
-
-        range.blocksMemoryAndCount = calculateUsedMemoryAndBlocksCount(tree.children, range.blocks, block_getter,
-                                                                       descriptors, false);
-        total += range.blocksMemoryAndCount;
-
-        if (range.blocksMemoryAndCount.blocksCount != 0)
+        const auto& cswitchesRange = section.cswitches.range;
+        if (cswitchesRange.begin < cswitchesRange.end)
         {
-            beginTime = std::min(beginTime, block_getter(tree.children[range.blocks.begin]).node->begin());
-            endTime = std::max(endTime, block_getter(tree.children[range.blocks.end - 1]).node->end());
+            beginTime = std::min(beginTime, block_getter(tree.sync[cswitchesRange.begin]).cs->begin());
+            endTime = std::max(endTime, block_getter(tree.sync[cswitchesRange.end - 1]).cs->end());
         }
 
-        range.cswitchesMemoryAndCount = calculateUsedMemoryAndBlocksCount(tree.sync, range.cswitches, block_getter,
-                                                                          descriptors, true);
-        total += range.cswitchesMemoryAndCount;
-
-        if (range.cswitchesMemoryAndCount.blocksCount != 0)
+        const auto blocksRange = findRange(tree.children, begin_time, end_time, block_getter);
+        if (blocksRange.begin < blocksRange.end)
         {
-            beginTime = std::min(beginTime, block_getter(tree.children[range.cswitches.begin]).cs->begin());
-            endTime = std::max(endTime, block_getter(tree.children[range.cswitches.end - 1]).cs->end());
-        }
+            beginTime = std::min(beginTime, block_getter(tree.children[blocksRange.begin]).node->begin());
+            endTime = std::max(endTime, block_getter(tree.children[blocksRange.end - 1]).node->end());
 
-        block_ranges[id] = range;
+            const auto count = blocksRange.end - blocksRange.begin;
+            const auto chunkSize = std::max(MinChunkBlocksCount, (count + maxChunksCount - 1) / maxChunksCount);
 
-        if (!update_progress_write(progress, 15 / static_cast<int>(trees.size() - i), log))
-            return 0;
+            section.blocks.resize((count + chunkSize - 1) / chunkSize);
+            auto begin = blocksRange.begin;
+            for (auto& chunk : section.blocks)
+            {
+                chunk.tree = &tree;
+                chunk.range = BlocksRange(begin, std::min(begin + chunkSize, blocksRange.end));
+                begin = chunk.range.end;
+                chunks.push_back(&chunk);
+            }
+        }
 
-        ++i;
+        section.asyncs.tree = &tree;
+        section.asyncs.type = ChunkType::Asyncs;
+        chunks.push_back(&section.asyncs);
     }
 
+    // Serialize all chunks in parallel
+    std::atomic<size_t> serialized(0);
+    std::atomic<bool> interrupted(false);
+    parallelFor(chunks.size(), [&] (size_t index, bool isCallingThread)
+    {
+        if (interrupted.load(std::memory_order_relaxed))
+            return;
+
+        serializeChunk(*chunks[index], block_getter, descriptors, begin_time, end_time);
+
+        const auto count = serialized.fetch_add(1, std::memory_order_relaxed) + 1;
+        if (isCallingThread && !update_progress_write(progress, static_cast<int>(80 * count / chunks.size()), log))
+            interrupted.store(true, std::memory_order_relaxed);
+    });
+
+    if (interrupted)
+        return 0;
+
+    BlocksMemoryAndCount total;
+    for (auto chunk : chunks)
+        total += chunk->memoryAndCount;
+
     BlocksRange bookmarksRange;
     uint16_t bookmarksCount = 0;
     if (!bookmarks.empty())
@@ -516,36 +591,42 @@ extern "C" PROFILER_API profiler::block_index_t writeTreesToStream(std::atomic<i
     write(str, static_cast<uint32_t>(trees.size()));
     write(str, bookmarksCount);
     write(str, static_cast<uint16_t>(0)); // padding
+    write(str, block_overhead); // already converted to nanoseconds
 
     std::vector<char> buffer;
 
     // Serialize all descriptors
     serializeDescriptors(str, buffer, descriptors, descriptors_count);
 
-    // Serialize all blocks
+    // Write all thread sections
     i = 0;
     for (const auto& kv : trees)
     {
         const auto id = kv.first;
         const auto& tree = kv.second;
-        const auto& range = block_ranges.at(id);
+        auto& section = sections[i];
 
         const auto nameSize = static_cast<uint16_t>(tree.thread_name.size() + 1);
         write(str, id);
         write(str, nameSize);
         write(str, tree.name(), nameSize);
 
-        // Serialize context switches
-        write(str, range.cswitchesMemoryAndCount.blocksCount);
-        if (range.cswitchesMemoryAndCount.blocksCount != 0)
-            serializeContextSwitches(str, buffer, tree.sync, range.cswitches, block_getter);
+        // Context switches
+        write(str, section.cswitches.memoryAndCount.blocksCount);
+        writeChunk(str, section.cswitches);
 
-        // Serialize blocks
-        write(str, range.blocksMemoryAndCount.blocksCount);
-        if (range.blocksMemoryAndCount.blocksCount != 0)
-            serializeBlocks(str, buffer, tree.children, range.blocks, block_getter, descriptors);
+        // Blocks (async spans and flow links are stored after regular blocks)
+        auto blocksCount = section.asyncs.memoryAndCount.blocksCount;
+        for (const auto& chunk : section.blocks)
+            blocksCount += chunk.memoryAndCount.blocksCount;
 
-        if (!update_progress_write(progress, 40 + 57 / static_cast<int>(trees.size() - i), log))
+        write(str, blocksCount);
+        for (auto& chunk : section.blocks)
+            writeChunk(str, chunk);
+        writeChunk(str, section.asyncs);
+
+        ++i;
+        if (!update_progress_write(progress, 80 + static_cast<int>(17 * i / trees.size()), log))
             return 0;
     }
 
@@ -562,3 +643,100 @@ extern "C" PROFILER_API profiler::block_index_t writeTreesToStream(std::atomic<i
 }
 
 //////////////////////////////////////////////////////////////////////////
+
+extern "C" PROFILER_API profiler::block_index_t writeTreesToFile(std::atomic<int>& progress, const char* filename,
+                                                                 const profiler::SerializedData& serialized_descriptors,
+                                                                 const profiler::descriptors_list_t& descriptors,
+                                                                 profiler::block_id_t descriptors_count,
+                                                                 const profiler::thread_blocks_tree_t& trees,
+                                                                 const profiler::bookmarks_t& bookmarks,
+                                                                 profiler::block_getter_fn block_getter,
+                                                                 profiler::timestamp_t begin_time,
+                                                                 profiler::timestamp_t end_time,
+                                                                 profiler::processid_t pid,
+                                                                 profiler::timestamp_t block_overhead,
+                                                                 std::ostream& log)
+{
+    if (!update_progress_write(progress, 0, log))
+        return 0;
+
+    std::ofstream outFile(filename, std::fstream::binary);
+    if (!outFile.is_open())
+    {
+        log << "Can not open file " << filename;
+        return 0;
+    }
+
+    // Write data to file
+    auto result = writeTreesToStream(progress, outFile, serialized_descriptors, descriptors, descriptors_count, trees,
+                                     bookmarks, std::move(block_getter), begin_time, end_time, pid, block_overhead, log);
+
+    return result;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+extern "C" PROFILER_API profiler::block_index_t writeTreesToStream(std::atomic<int>& progress, std::ostream& str,
+                                                                   const profiler::SerializedData& serialized_descriptors,
+                                                                   const profiler::descriptors_list_t& descriptors,
+                                                                   profiler::block_id_t descriptors_count,
+                                                                   const profiler::thread_blocks_tree_t& trees,
+                                                                   const profiler::bookmarks_t& bookmarks,
+                                                                   profiler::block_getter_fn block_getter,
+                                                                   profiler::timestamp_t begin_time,
+                                                                   profiler::timestamp_t end_time,
+                                                                   profiler::processid_t pid,
+                                                                   profiler::timestamp_t block_overhead,
+                                                                   std::ostream& log)
+{
+    return writeTrees(progress, str, serialized_descriptors, descriptors, descriptors_count, trees, bookmarks,
+                      block_getter, begin_time, end_time, pid, block_overhead, log);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+PROFILER_API profiler::block_index_t writeTreesToFile(std::atomic<int>& progress, const char* filename,
+                                                      const profiler::SerializedData& serialized_descriptors,
+                                                      const profiler::descriptors_list_t& descriptors,
+                                                      profiler::block_id_t descriptors_count,
+                                                      const profiler::thread_blocks_tree_t& trees,
+                                                      const profiler::bookmarks_t& bookmarks,
+                                                      const profiler::blocks_t& blocks,
+                                                      profiler::timestamp_t begin_time,
+                                                      profiler::timestamp_t end_time,
+                                                      profiler::processid_t pid,
+                                                      profiler::timestamp_t block_overhead,
+                                                      std::ostream& log)
+{
+    if (!update_progress_write(progress, 0, log))
+        return 0;
+
+    std::ofstream outFile(filename, std::fstream::binary);
+    if (!outFile.is_open())
+    {
+        log << "Can not open file " << filename;
+        return 0;
+    }
+
+    return writeTreesToStream(progress, outFile, serialized_descriptors, descriptors, descriptors_count, trees,
+                              bookmarks, blocks, begin_time, end_time, pid, block_overhead, log);
+}
+
+PROFILER_API profiler::block_index_t writeTreesToStream(std::atomic<int>& progress, std::ostream& str,
+                                                        const profiler::SerializedData& serialized_descriptors,
+                                                        const profiler::descriptors_list_t& descriptors,
+                                                        profiler::block_id_t descriptors_count,
+                                                        const profiler::thread_blocks_tree_t& trees,
+                                                        const profiler::bookmarks_t& bookmarks,
+                                                        const profiler::blocks_t& blocks,
+                                                        profiler::timestamp_t begin_time,
+                                                        profiler::timestamp_t end_time,
+                                                        profiler::processid_t pid,
+                                                        profiler::timestamp_t block_overhead,
+                                                        std::ostream& log)
+{
+    return writeTrees(progress, str, serialized_descriptors, descriptors, descriptors_count, trees, bookmarks,
+                      BlocksListGetter {blocks}, begin_time, end_time, pid, block_overhead, log);
+}
+
+//////////////////////////////////////////////////////////////////////////
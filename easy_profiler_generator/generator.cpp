@@ -0,0 +1,330 @@
+/**
+Lightweight profiler library for c++
+Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+
+Licensed under either of
+	* MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+    * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+at your option.
+
+The MIT License
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+	of the Software, and to permit persons to whom the Software is furnished
+	to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+	PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+	LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+	USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+The Apache License, Version 2.0 (the "License");
+	You may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+**/
+
+#include "generator.h"
+#include <string>
+#include <easy/profiler.h>
+#include <easy/serialized_block.h>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+const uint32_t PROFILER_SIGNATURE = ('E' << 24) | ('a' << 16) | ('s' << 8) | 'y';
+
+// Serialized records are written field by field, so their layout must match the structures used by the reader
+static_assert(sizeof(profiler::BaseBlockData) == sizeof(uint64_t) * 2 + sizeof(profiler::block_id_t),
+              "Layout of profiler::BaseBlockData has changed, update the generator");
+static_assert(sizeof(profiler::ArbitraryValue) == sizeof(profiler::BaseBlockData) + 2 + sizeof(uint16_t)
+              + sizeof(profiler::DataType) + sizeof(bool) + sizeof(profiler::vin_t),
+              "Layout of profiler::ArbitraryValue has changed, update the generator");
+static_assert(sizeof(profiler::BaseBlockDescriptor) == sizeof(profiler::block_id_t) + sizeof(int32_t)
+              + sizeof(profiler::color_t) + sizeof(profiler::block_type_t) + sizeof(profiler::EasyBlockStatus)
+              + sizeof(profiler::SamplingPolicy) + sizeof(uint32_t) + sizeof(float) + sizeof(profiler::category_t),
+              "Layout of profiler::BaseBlockDescriptor has changed, update the generator");
+
+EASY_CONSTEXPR uint64_t BEGIN_TIME = 1000000000ULL;
+EASY_CONSTEXPR uint32_t VALUE_DESCRIPTORS_COUNT = 8;
+EASY_CONSTEXPR uint32_t RUNTIME_NAMES_COUNT = 256;
+EASY_CONSTEXPR const char* SOURCE_FILENAME = "generated.cpp";
+
+template <class T>
+void write(std::ostream& _stream, const T& _value)
+{
+    _stream.write(reinterpret_cast<const char*>(&_value), sizeof(T));
+}
+
+template <class T>
+char* append(char* _data, const T& _value)
+{
+    memcpy(_data, &_value, sizeof(T));
+    return _data + sizeof(T);
+}
+
+profiler::color_t descriptorColor(uint32_t _id)
+{
+    return 0xff000000 | ((_id * 2654435761U) & 0x00ffffff);
+}
+
+} // END of namespace <noname>.
+
+//////////////////////////////////////////////////////////////////////////
+
+/** SplitMix64 pseudo-random generator.
+
+std::mt19937_64 itself is portable, but std distributions are not: they give different sequences
+for different standard library implementations, so own range mapping is used.
+*/
+class Generator::Random EASY_FINAL
+{
+    uint64_t m_state;
+
+public:
+
+    explicit Random(uint64_t _seed) : m_state(_seed)
+    {
+    }
+
+    uint64_t next()
+    {
+        uint64_t z = (m_state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    /** Returns random number in range [0, _size). */
+    uint64_t uniform(uint64_t _size)
+    {
+        return _size != 0 ? next() % _size : 0;
+    }
+
+    /** Returns true with probability _p. */
+    bool chance(double _p)
+    {
+        return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0) < _p;
+    }
+
+}; // END of class Generator::Random.
+
+//////////////////////////////////////////////////////////////////////////
+
+Generator::Generator(const GeneratorOptions& _options) : m_options(_options)
+{
+    m_buffer.reserve(256);
+}
+
+uint32_t Generator::generate(std::ostream& _output, std::ostream& _log)
+{
+    if (m_options.blocksCount == 0 || m_options.threadsCount == 0 || m_options.descriptorsCount == 0 ||
+        m_options.depth == 0)
+    {
+        _log << "Nothing to generate: blocks, threads, descriptors count and depth must be positive\n";
+        return 0;
+    }
+
+    const auto start = _output.tellp();
+    m_memorySize = 0;
+    m_endTime = BEGIN_TIME;
+
+    const uint32_t descriptorsCount = m_options.descriptorsCount + (m_options.values > 0 ? VALUE_DESCRIPTORS_COUNT : 0);
+
+    // Header is written twice: memory size and end time are known only after all blocks are generated
+    writeHeader(_output, BEGIN_TIME, 0, descriptorsCount);
+    const auto descriptorsMemorySize = writeDescriptors(_output);
+
+    Random random(m_options.seed);
+
+    const uint32_t blocksPerThread = m_options.blocksCount / m_options.threadsCount;
+    const uint32_t extraBlocks = m_options.blocksCount % m_options.threadsCount;
+    for (uint32_t i = 0; i < m_options.threadsCount; ++i)
+    {
+        const auto threadBlocksCount = blocksPerThread + (i < extraBlocks ? 1 : 0);
+        const auto name = std::string("Thread ") + std::to_string(i);
+        const auto nameSize = static_cast<uint16_t>(name.size() + 1);
+
+        write(_output, static_cast<profiler::thread_id_t>(1000 + i));
+        write(_output, nameSize);
+        _output.write(name.c_str(), nameSize);
+
+        write(_output, static_cast<uint32_t>(0)); // Context switches count
+        write(_output, threadBlocksCount);
+
+        // All threads work simultaneously
+        m_time = BEGIN_TIME;
+
+        uint32_t remaining = threadBlocksCount;
+        while (remaining != 0)
+            writeFrame(_output, random, remaining);
+
+        if (m_endTime < m_time)
+            m_endTime = m_time;
+
+        if (!_output.good())
+        {
+            _log << "Can not write output\n";
+            return 0;
+        }
+    }
+
+    // End of threads section
+    write(_output, PROFILER_SIGNATURE);
+
+    const auto end = _output.tellp();
+    _output.seekp(start);
+    writeHeader(_output, BEGIN_TIME, descriptorsMemorySize, descriptorsCount);
+    _output.seekp(end);
+
+    if (!_output.good())
+    {
+        _log << "Can not write output\n";
+        return 0;
+    }
+
+    return m_options.blocksCount;
+}
+
+void Generator::writeHeader(std::ostream& _output, uint64_t _beginTime, uint64_t _descriptorsMemorySize,
+                            uint32_t _descriptorsCount) const
+{
+    write(_output, PROFILER_SIGNATURE);
+    write(_output, profiler::version());
+    write(_output, static_cast<uint64_t>(1)); // pid
+    write(_output, static_cast<int64_t>(0)); // CPU frequency: timestamps are in nanoseconds
+    write(_output, _beginTime);
+    write(_output, m_endTime);
+    write(_output, m_memorySize);
+    write(_output, _descriptorsMemorySize);
+    write(_output, m_options.blocksCount);
+    write(_output, _descriptorsCount);
+    write(_output, m_options.threadsCount);
+    write(_output, static_cast<uint16_t>(0)); // Bookmarks count
+    write(_output, static_cast<uint16_t>(0)); // padding
+    write(_output, static_cast<profiler::timestamp_t>(0)); // Block overhead is not known for generated capture
+}
+
+uint64_t Generator::writeDescriptors(std::ostream& _output) const
+{
+    uint64_t memorySize = 0;
+
+    const uint32_t valuesBegin = m_options.descriptorsCount;
+    const uint32_t descriptorsCount = valuesBegin + (m_options.values > 0 ? VALUE_DESCRIPTORS_COUNT : 0);
+    const auto filenameSize = static_cast<uint16_t>(strlen(SOURCE_FILENAME) + 1);
+
+    for (uint32_t id = 0; id < descriptorsCount; ++id)
+    {
+        const bool isValue = id >= valuesBegin;
+        const auto name = isValue ? std::string("Value ") + std::to_string(id - valuesBegin)
+                                  : std::string("Block ") + std::to_string(id);
+        const auto nameSize = static_cast<uint16_t>(name.size() + 1);
+        const auto size = static_cast<uint16_t>(sizeof(profiler::SerializedBlockDescriptor) + nameSize + filenameSize);
+
+        write(_output, size);
+        write(_output, id);
+        write(_output, static_cast<int32_t>(id + 1)); // line
+        write(_output, descriptorColor(id));
+        write(_output, isValue ? profiler::BlockType::Value : profiler::BlockType::Block);
+        write(_output, profiler::ON);
+        write(_output, profiler::SamplingPolicy::None);
+        write(_output, static_cast<uint32_t>(0)); // sampling value
+        write(_output, 1.f); // sampling weight
+        write(_output, profiler::categories::Default);
+        write(_output, nameSize);
+        _output.write(name.c_str(), nameSize);
+        _output.write(SOURCE_FILENAME, filenameSize);
+
+        memorySize += size;
+    }
+
+    return memorySize;
+}
+
+void Generator::writeFrame(std::ostream& _output, Random& _random, uint32_t& _remaining)
+{
+    --_remaining;
+    writeBlock(_output, _random, 1, _remaining);
+    m_time += 100 + _random.uniform(1000); // Gap between frames
+}
+
+void Generator::writeBlock(std::ostream& _output, Random& _random, uint16_t _depth, uint32_t& _remaining)
+{
+    // Self record has already been reserved in _remaining. Children are written before their parent
+    // like profiler does: blocks are stored in the order of their completion.
+
+    const auto id = static_cast<profiler::block_id_t>(_random.uniform(m_options.descriptorsCount));
+    std::string name;
+    if (m_options.runtimeNames > 0 && _random.chance(m_options.runtimeNames))
+        name = std::string("Runtime name ") + std::to_string(_random.uniform(RUNTIME_NAMES_COUNT));
+
+    const auto begin = m_time;
+    m_time += 1 + _random.uniform(50);
+
+    const auto childrenCount = _depth < m_options.depth ? _random.uniform(m_options.fanout + 1ULL) : 0;
+    for (uint64_t i = 0; i < childrenCount && _remaining != 0; ++i)
+    {
+        --_remaining;
+        if (m_options.values > 0 && _random.chance(m_options.values))
+            writeValue(_output, _random);
+        else
+            writeBlock(_output, _random, static_cast<uint16_t>(_depth + 1), _remaining);
+        m_time += _random.uniform(20);
+    }
+
+    m_time += 1 + _random.uniform(50);
+
+    const auto size = static_cast<uint16_t>(sizeof(profiler::BaseBlockData) + name.size() + 1);
+    m_buffer.resize(sizeof(uint16_t) + size);
+
+    auto data = append(m_buffer.data(), size);
+    data = append(data, begin);
+    data = append(data, m_time);
+    data = append(data, id);
+    memcpy(data, name.c_str(), name.size() + 1);
+
+    _output.write(m_buffer.data(), m_buffer.size());
+    m_memorySize += size;
+}
+
+void Generator::writeValue(std::ostream& _output, Random& _random)
+{
+    const auto index = static_cast<uint32_t>(_random.uniform(VALUE_DESCRIPTORS_COUNT));
+    const auto id = static_cast<profiler::block_id_t>(m_options.descriptorsCount + index);
+    const auto value = static_cast<int64_t>(_random.uniform(1000000));
+    const auto size = static_cast<uint16_t>(sizeof(profiler::ArbitraryValue) + sizeof(value));
+
+    m_buffer.resize(sizeof(uint16_t) + size);
+
+    auto data = append(m_buffer.data(), size);
+    data = append(data, m_time); // begin
+    data = append(data, m_time); // end
+    data = append(data, id);
+    data = append(data, '\0'); // name stub
+    data = append(data, '\0'); // padding
+    data = append(data, static_cast<uint16_t>(sizeof(value)));
+    data = append(data, profiler::DataType::Int64);
+    data = append(data, false); // is array
+    data = append(data, static_cast<profiler::vin_t>(index + 1));
+    append(data, value);
+
+    _output.write(m_buffer.data(), m_buffer.size());
+    m_memorySize += size;
+}
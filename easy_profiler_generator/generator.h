@@ -0,0 +1,101 @@
+/**
+Lightweight profiler library for c++
+Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+
+Licensed under either of
+	* MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+    * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+at your option.
+
+The MIT License
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+	of the Software, and to permit persons to whom the Software is furnished
+	to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+	PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+	LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+	USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+The Apache License, Version 2.0 (the "License");
+	You may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+**/
+
+#ifndef EASY_PROFILER_GENERATOR_H
+#define EASY_PROFILER_GENERATOR_H
+
+#include <stdint.h>
+#include <ostream>
+#include <vector>
+#include <easy/details/easy_compiler_support.h>
+
+/** Parameters of generated capture. */
+struct GeneratorOptions EASY_FINAL
+{
+    uint64_t                 seed = 1; ///< Seed of pseudo-random generator (the same seed gives the same file on any platform)
+    uint32_t        blocksCount = 1000000; ///< Total number of records (blocks and values) in all threads
+    uint32_t           threadsCount = 4; ///< Number of threads
+    uint32_t      descriptorsCount = 64; ///< Number of distinct blocks (compile-time names)
+    uint16_t                  depth = 8; ///< Maximum stack depth (number of levels including frame level)
+    uint16_t                 fanout = 8; ///< Maximum number of children of one block (actual number is random from 0 to fanout)
+    double           runtimeNames = 0.0; ///< Ratio of blocks with run-time names [0, 1]
+    double                 values = 0.0; ///< Probability of arbitrary value instead of a child block [0, 1]
+};
+
+/** Writes synthetic .prof files with the same layout as ProfileManager::dumpBlocksToStream() output.
+
+Blocks are generated thread by thread, frame by frame, directly into the output stream, so memory consumption
+does not depend on blocks count. Timestamps are in nanoseconds (CPU frequency in the header is 0).
+Output stream must be seekable: header is rewritten with actual memory size and end time in the end.
+*/
+class Generator EASY_FINAL
+{
+    class Random;
+
+    std::vector<char>       m_buffer; ///< Buffer for one serialized record
+    GeneratorOptions       m_options; ///<
+    uint64_t        m_memorySize = 0; ///< Memory size of all written records (without record size prefix)
+    uint64_t              m_time = 0; ///< Current timestamp of generated thread
+    uint64_t           m_endTime = 0; ///< The latest timestamp of all threads
+
+public:
+
+    explicit Generator(const GeneratorOptions& _options);
+
+    /** Generates capture into _output.
+
+    \returns Number of written records (0 in case of error).
+    */
+    uint32_t generate(std::ostream& _output, std::ostream& _log);
+
+private:
+
+    void writeHeader(std::ostream& _output, uint64_t _beginTime, uint64_t _descriptorsMemorySize,
+                     uint32_t _descriptorsCount) const;
+    uint64_t writeDescriptors(std::ostream& _output) const;
+    void writeFrame(std::ostream& _output, Random& _random, uint32_t& _remaining);
+    void writeBlock(std::ostream& _output, Random& _random, uint16_t _depth, uint32_t& _remaining);
+    void writeValue(std::ostream& _output, Random& _random);
+
+}; // END of class Generator.
+
+#endif // EASY_PROFILER_GENERATOR_H
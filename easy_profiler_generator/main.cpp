@@ -0,0 +1,86 @@
+///std
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+#include "generator.h"
+
+void printUsage(const char* _program)
+{
+    std::cout << "Usage: " << _program << " [-o OUTPUT_PROF_FILE] [-n BLOCKS] [-t THREADS] [-d DEPTH] [-f FANOUT]"
+                                          " [-r RUNTIME_NAMES_RATIO] [-v VALUES_RATIO] [-k DESCRIPTORS] [-s SEED]\n"
+                                          "where:\n"
+                                          "OUTPUT_PROF_FILE (generated.prof by default) // Optional\n"
+                                          "BLOCKS total number of blocks and values, up to 4294967295 (1000000 by default) // Optional\n"
+                                          "THREADS number of threads (4 by default) // Optional\n"
+                                          "DEPTH maximum stack depth, up to 250 (8 by default) // Optional\n"
+                                          "FANOUT maximum number of children of one block (8 by default) // Optional\n"
+                                          "RUNTIME_NAMES_RATIO ratio of blocks with run-time names from 0 to 1 (0 by default) // Optional\n"
+                                          "VALUES_RATIO probability of arbitrary value instead of child block from 0 to 1 (0 by default) // Optional\n"
+                                          "DESCRIPTORS number of distinct blocks (64 by default) // Optional\n"
+                                          "SEED seed of pseudo-random generator (1 by default) // Optional\n";
+}
+
+int main(int argc, char* argv[])
+{
+    std::string output_filename = "generated.prof";
+    GeneratorOptions options;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (i + 1 >= argc || arg.size() != 2 || arg[0] != '-')
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+
+        const char* value = argv[++i];
+        switch (arg[1])
+        {
+            case 'o': output_filename = value; break;
+            case 'n': options.blocksCount = static_cast<uint32_t>(std::min(std::strtoull(value, nullptr, 10), 0xffffffffULL)); break;
+            case 't': options.threadsCount = static_cast<uint32_t>(std::strtoul(value, nullptr, 10)); break;
+            case 'd': options.depth = static_cast<uint16_t>(std::min(std::strtoul(value, nullptr, 10), 250UL)); break;
+            case 'f': options.fanout = static_cast<uint16_t>(std::min(std::strtoul(value, nullptr, 10), 0xffffUL)); break;
+            case 'r': options.runtimeNames = std::atof(value); break;
+            case 'v': options.values = std::atof(value); break;
+            case 'k': options.descriptorsCount = static_cast<uint32_t>(std::strtoul(value, nullptr, 10)); break;
+            case 's': options.seed = std::strtoull(value, nullptr, 10); break;
+
+            default:
+            {
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+    }
+
+    // Large output buffer: records are small and there may be billions of them
+    std::vector<char> buffer(1 << 20);
+    std::ofstream output;
+    output.rdbuf()->pubsetbuf(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    output.open(output_filename, std::fstream::binary);
+    if (!output.is_open())
+    {
+        std::cout << "Can not open " << output_filename << " for writing\n";
+        return 1;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+
+    Generator generator(options);
+    const auto blocks_count = generator.generate(output, std::cout);
+    output.close();
+
+    if (blocks_count == 0)
+        return 1;
+
+    const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Generated " << blocks_count << " blocks into " << output_filename << " in " << ms << " ms\n";
+
+    return 0;
+}
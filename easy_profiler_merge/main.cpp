@@ -0,0 +1,94 @@
+///std
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <easy/writer.h>
+
+void printUsage(const char* _program)
+{
+    std::cout << "Usage: " << _program << " -o OUTPUT_PROF_FILE [-b BEGIN_MS] [-e END_MS] [-a] INPUT_PROF_FILE...\n"
+                                          "where:\n"
+                                          "OUTPUT_PROF_FILE merged file, must differ from input files // Required\n"
+                                          "BEGIN_MS begin of kept time range in milliseconds since the begin of merged capture (0 by default) // Optional\n"
+                                          "END_MS end of kept time range in milliseconds since the begin of merged capture (end of capture by default) // Optional\n"
+                                          "-a shift every input so that all of them begin together with the first one // Optional\n"
+                                          "INPUT_PROF_FILE one or more .prof files // Required\n";
+}
+
+static profiler::timestamp_t milliseconds(const char* _value)
+{
+    const auto ms = std::atof(_value);
+    return ms > 0 ? static_cast<profiler::timestamp_t>(ms * 1e6) : 0;
+}
+
+int main(int argc, char* argv[])
+{
+    std::string output_filename;
+    std::vector<std::string> input_filenames;
+    profiler::MergeOptions options;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg.size() != 2 || arg[0] != '-')
+        {
+            input_filenames.push_back(arg);
+            continue;
+        }
+
+        if (arg[1] == 'a')
+        {
+            options.align_begin = true;
+            continue;
+        }
+
+        if (i + 1 >= argc)
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+
+        const char* value = argv[++i];
+        switch (arg[1])
+        {
+            case 'o': output_filename = value; break;
+            case 'b': options.begin_time = milliseconds(value); break;
+            case 'e': options.end_time = milliseconds(value); break;
+
+            default:
+            {
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+    }
+
+    if (output_filename.empty() || input_filenames.empty())
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+
+    std::stringstream errorMessage;
+    const auto blocks_count = mergeProfFiles(input_filenames, output_filename.c_str(), options, errorMessage);
+    if (blocks_count == 0)
+    {
+        std::cerr << "Can not merge files\nReason: " << errorMessage.str() << std::endl;
+        return 1;
+    }
+
+    if (errorMessage.rdbuf()->in_avail() != 0)
+        std::cerr << errorMessage.str();
+
+    const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Merged " << blocks_count << " blocks from " << input_filenames.size() << " file(s) into "
+              << output_filename << " in " << ms << " ms\n";
+
+    return 0;
+}
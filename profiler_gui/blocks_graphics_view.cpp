@@ -659,9 +659,87 @@ void ForegroundItem::paint(QPainter* _painter, const QStyleOptionGraphicsItem*,
         _painter->drawLine(QPointF(pos, 0), QPointF(pos, visibleSceneRect.height()));
     }
 
+    paintAsyncLinks(_painter, sceneView, EASY_GLOBALS.async_spans, false);
+    paintAsyncLinks(_painter, sceneView, EASY_GLOBALS.flows, true);
+
     _painter->restore();
 }
 
+void ForegroundItem::paintAsyncLinks(QPainter* _painter, const BlocksGraphicsView* _sceneView,
+                                     const profiler::async_links_t& _links, bool _flows) const
+{
+    if (_links.empty())
+        return;
+
+    const auto visibleSceneRect = _sceneView->visibleSceneRect();
+    const auto currentScale = _sceneView->scale();
+    const auto offset = _sceneView->offset();
+    const qreal arrowSize = px(7);
+    const qreal arrowAngle = 0.45; // ~26 degrees
+
+    QPen pen;
+    pen.setWidth(px(_flows ? 2 : 1));
+    pen.setStyle(_flows ? Qt::SolidLine : Qt::DashLine);
+
+    _painter->setFont(EASY_GLOBALS.font.background);
+
+    for (const auto& link : _links)
+    {
+        const auto& async = *easyBlocksTree(link.index).async;
+
+        const auto x0 = (_sceneView->time2position(async.begin()) - offset) * currentScale;
+        if (x0 > visibleSceneRect.width())
+            break; // links are sorted by begin time
+
+        const auto x1 = (_sceneView->time2position(async.end()) - offset) * currentScale;
+        if (x1 < 0)
+            continue;
+
+        qreal y0 = 0, y1 = 0;
+        if (!_sceneView->asyncLinkY(link.source_thread, link.source_block, y0) ||
+            !_sceneView->asyncLinkY(link.target_thread, link.target_block, y1))
+        {
+            continue;
+        }
+
+        y0 -= visibleSceneRect.top();
+        y1 -= visibleSceneRect.top();
+        if ((y0 < 0 && y1 < 0) || (y0 > visibleSceneRect.height() && y1 > visibleSceneRect.height()))
+            continue;
+
+        const auto& desc = easyDescriptor(async.id());
+        pen.setColor(QColor::fromRgba(desc.color()));
+        _painter->setPen(pen);
+        _painter->setBrush(QColor::fromRgba(desc.color()));
+
+        const QLineF line(x0, y0, x1, y1);
+        _painter->drawLine(line);
+
+        if (line.length() > arrowSize * 2)
+        {
+            const auto angle = atan2(y0 - y1, x0 - x1);
+            const QPointF arrow[3] = {
+                line.p2(),
+                line.p2() + QPointF(cos(angle + arrowAngle) * arrowSize, sin(angle + arrowAngle) * arrowSize),
+                line.p2() + QPointF(cos(angle - arrowAngle) * arrowSize, sin(angle - arrowAngle) * arrowSize)
+            };
+
+            _painter->setPen(Qt::NoPen);
+            _painter->drawPolygon(arrow, 3);
+        }
+
+        if (!_flows && line.length() > px(100))
+        {
+            // Display span name and duration near the middle of the line
+            const auto text = QString("%1 %2").arg(profiler_gui::toUnicode(desc.name()))
+                .arg(profiler_gui::autoTimeStringRealNs(async.duration(), 3));
+
+            _painter->setPen(Qt::black);
+            _painter->drawText((line.p1() + line.p2()) * 0.5 + QPointF(px(3), -px(3)), text);
+        }
+    }
+}
+
 void ForegroundItem::onBookmarkChanged(size_t index)
 {
     m_bookmark = index;
@@ -1061,6 +1139,32 @@ void BlocksGraphicsView::setTree(const profiler::thread_blocks_tree_t& _blocksTr
     QTimer::singleShot(0, this, &This::revalidateOffset);
 }
 
+bool BlocksGraphicsView::asyncLinkY(profiler::thread_id_t _thread, profiler::block_index_t _block, qreal& _y) const
+{
+    if (_block != profiler::NO_BLOCK)
+    {
+        const auto& guiblock = easyBlock(_block);
+        if (guiblock.graphics_item < m_items.size())
+        {
+            const auto thread_item = m_items[guiblock.graphics_item];
+            _y = thread_item->levelY(guiblock.graphics_item_level) + EASY_GLOBALS.size.graphics_row_height * 0.5;
+            return true;
+        }
+    }
+
+    // There were no opened blocks at that time: attach link to the thread's top level
+    for (auto item : m_items)
+    {
+        if (item->threadId() == _thread)
+        {
+            _y = item->y() + EASY_GLOBALS.size.graphics_row_height * 0.5;
+            return true;
+        }
+    }
+
+    return false;
+}
+
 void BlocksGraphicsView::revalidateOffset()
 {
     notifyVisibleRegionPosChange(m_offset);
@@ -2435,6 +2539,7 @@ void BlocksGraphicsView::onIdleTimeout()
             switch (itemDesc.type())
             {
                 case profiler::BlockType::Block:
+                case profiler::BlockType::Lock:
                 {
                     const auto name = *itemBlock.node->name() != 0 ? itemBlock.node->name() : itemDesc.name();
 
@@ -2510,7 +2615,7 @@ void BlocksGraphicsView::onIdleTimeout()
 
             if (itemBlock.per_thread_stats != nullptr)
             {
-                if (itemDesc.type() == profiler::BlockType::Block)
+                if (itemDesc.type() == profiler::BlockType::Block || itemDesc.type() == profiler::BlockType::Lock)
                 {
                     const auto duration = itemBlock.node->duration();
 
@@ -2522,6 +2627,28 @@ void BlocksGraphicsView::onIdleTimeout()
                     lay->addWidget(new QLabel(profiler_gui::timeStringRealNs(EASY_GLOBALS.time_units, itemBlock.per_thread_stats->median_duration, 3), widget), row, 1, 1, 3, Qt::AlignLeft);
                     ++row;
 
+                    if (itemBlock.per_thread_stats->allocations_number != 0)
+                    {
+                        lay->addWidget(new QLabel("Heap:", widget), row, 0, Qt::AlignRight);
+                        lay->addWidget(new QLabel(QString("%1 B in %2 allocations")
+                                                      .arg(itemBlock.per_thread_stats->allocated_bytes)
+                                                      .arg(itemBlock.per_thread_stats->allocations_number), widget),
+                                       row, 1, 1, 3, Qt::AlignLeft);
+                        ++row;
+                    }
+
+                    if (itemDesc.samplingPolicy() != profiler::SamplingPolicy::None)
+                    {
+                        const auto weight = itemDesc.samplingWeight();
+                        lay->addWidget(new QLabel("Sampled:", widget), row, 0, Qt::AlignRight);
+                        lay->addWidget(new QLabel(QString("~%1 calls, ~%2 total (1 of %3 calls stored)")
+                                                      .arg(itemBlock.per_thread_stats->extrapolated_calls_number(weight))
+                                                      .arg(profiler_gui::timeStringRealNs(EASY_GLOBALS.time_units, itemBlock.per_thread_stats->extrapolated_total_duration(weight), 3))
+                                                      .arg(weight, 0, 'f', 1), widget),
+                                       row, 1, 1, 3, Qt::AlignLeft);
+                        ++row;
+                    }
+
                     // Calculate idle/active time
                     {
                         const auto& threadRoot = item->root();
@@ -166,6 +166,10 @@ public:
 
     void paint(QPainter* _painter, const QStyleOptionGraphicsItem* _option, QWidget* _widget = nullptr) override;
 
+private:
+
+    void paintAsyncLinks(QPainter* _painter, const BlocksGraphicsView* _sceneView, const profiler::async_links_t& _links, bool _flows) const;
+
 public slots:
 
     void onBookmarkChanged(size_t index);
@@ -258,6 +262,7 @@ public:
     const Items& getItems() const;
 
     bool getSelectionRegionForSaving(profiler::timestamp_t& _beginTime, profiler::timestamp_t& _endTime) const;
+    bool asyncLinkY(profiler::thread_id_t _thread, profiler::block_index_t _block, qreal& _y) const;
 
     void inspectCurrentView(bool _strict) {
         onInspectCurrentView(_strict);
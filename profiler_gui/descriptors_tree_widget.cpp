@@ -215,6 +215,9 @@ QVariant DescriptorsTreeItem::data(int _column, int _role) const
                     case Type::Event: return QStringLiteral("Event");
                     case Type::Block: return QStringLiteral("Block");
                     case Type::Value: return QStringLiteral("Arbitrary Value");
+                    case Type::Async: return QStringLiteral("Async Span");
+                    case Type::Flow:  return QStringLiteral("Flow");
+                    case Type::Lock:  return QStringLiteral("Lock");
                 }
             }
             else if (_role == Qt::DisplayRole)
@@ -225,6 +228,9 @@ QVariant DescriptorsTreeItem::data(int _column, int _role) const
                     case Type::Event: return QStringLiteral("E");
                     case Type::Block: return QStringLiteral("B");
                     case Type::Value: return QStringLiteral("V");
+                    case Type::Async: return QStringLiteral("A");
+                    case Type::Flow:  return QStringLiteral("L");
+                    case Type::Lock:  return QStringLiteral("M");
                 }
             }
 
@@ -605,6 +611,18 @@ void DescriptorsTreeWidget::build()
                         item->setType(DescriptorsTreeItem::Type::Value);
                         break;
 
+                    case ::profiler::BlockType::Async:
+                        item->setType(DescriptorsTreeItem::Type::Async);
+                        break;
+
+                    case ::profiler::BlockType::Flow:
+                        item->setType(DescriptorsTreeItem::Type::Flow);
+                        break;
+
+                    case ::profiler::BlockType::Lock:
+                        item->setType(DescriptorsTreeItem::Type::Lock);
+                        break;
+
                     case ::profiler::BlockType::TypesCount: break;
                 }
 
@@ -91,7 +91,10 @@ public:
         File,
         Event,
         Block,
-        Value
+        Value,
+        Async,
+        Flow,
+        Lock
     };
 
 private:
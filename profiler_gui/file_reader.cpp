@@ -122,7 +122,7 @@ void FileReader::load(const QString& _filename)
         const auto size = fillTreesFromFile(m_progress, m_filename.toStdString().c_str(), m_beginEndTime, m_serializedBlocks,
                                             m_serializedDescriptors, m_descriptors, m_blocks, m_blocksTree,
                                             m_bookmarks, m_descriptorsNumberInFile, m_version, m_pid,
-                                            _enableStatistics, m_errorMessage);
+                                            m_blockOverhead, _enableStatistics, m_errorMessage);
 
         m_size.store(size, std::memory_order_release);
         m_progress.store(100, std::memory_order_release);
@@ -161,7 +161,7 @@ void FileReader::load(std::stringstream& _stream)
 
         const auto size = fillTreesFromStream(m_progress, m_stream, m_beginEndTime, m_serializedBlocks, m_serializedDescriptors,
                                               m_descriptors, m_blocks, m_blocksTree, m_bookmarks, m_descriptorsNumberInFile,
-                                              m_version, m_pid, _enableStatistics, m_errorMessage);
+                                              m_version, m_pid, m_blockOverhead, _enableStatistics, m_errorMessage);
 
         m_size.store(size, std::memory_order_release);
         m_progress.store(100, std::memory_order_release);
@@ -174,7 +174,8 @@ void FileReader::save(const QString& _filename, profiler::timestamp_t _beginTime
                       const profiler::SerializedData& _serializedDescriptors,
                       const profiler::descriptors_list_t& _descriptors, profiler::block_id_t descriptors_count,
                       const profiler::thread_blocks_tree_t& _trees, const profiler::bookmarks_t& bookmarks,
-                      profiler::block_getter_fn block_getter, profiler::processid_t _pid, bool snapshotMode)
+                      profiler::block_getter_fn block_getter, profiler::processid_t _pid,
+                      profiler::timestamp_t _blockOverhead, bool snapshotMode)
 {
     interrupt();
 
@@ -194,7 +195,7 @@ void FileReader::save(const QString& _filename, profiler::timestamp_t _beginTime
 
         const auto result = writeTreesToFile(m_progress, tmpFile.toStdString().c_str(), serializedDescriptors,
                                              descriptors, descriptors_count, trees, bookmarksRef, getter,
-                                             _beginTime, _endTime, _pid, m_errorMessage);
+                                             _beginTime, _endTime, _pid, _blockOverhead, m_errorMessage);
 
         if (result == 0 || !m_errorMessage.str().empty())
         {
@@ -234,6 +235,7 @@ void FileReader::interrupt()
     m_descriptorsNumberInFile = 0;
     m_version = 0;
     m_pid = 0;
+    m_blockOverhead = 0;
     m_jobType = JobType::Idle;
     m_isSnapshot = false;
 
@@ -245,7 +247,7 @@ void FileReader::get(profiler::SerializedData& _serializedBlocks, profiler::Seri
                      profiler::descriptors_list_t& _descriptors, profiler::blocks_t& _blocks,
                      profiler::thread_blocks_tree_t& _trees, profiler::bookmarks_t& bookmarks,
                      profiler::BeginEndTime& beginEndTime, uint32_t& _descriptorsNumberInFile, uint32_t& _version,
-                     profiler::processid_t& _pid, QString& _filename)
+                     profiler::processid_t& _pid, profiler::timestamp_t& _blockOverhead, QString& _filename)
 {
     if (done())
     {
@@ -260,6 +262,7 @@ void FileReader::get(profiler::SerializedData& _serializedBlocks, profiler::Seri
         _descriptorsNumberInFile = m_descriptorsNumberInFile;
         _version = m_version;
         _pid = m_pid;
+        _blockOverhead = m_blockOverhead;
     }
 }
 
@@ -74,6 +74,7 @@ class FileReader Q_DECL_FINAL
     std::stringstream                 m_errorMessage; ///<
     QString                               m_filename; ///<
     profiler::processid_t                  m_pid = 0; ///<
+    profiler::timestamp_t        m_blockOverhead = 0; ///<
     uint32_t           m_descriptorsNumberInFile = 0; ///<
     uint32_t                           m_version = 0; ///<
     std::thread                             m_thread; ///<
@@ -108,14 +109,15 @@ public:
               const profiler::SerializedData& _serializedDescriptors, const profiler::descriptors_list_t& _descriptors,
               profiler::block_id_t descriptors_count, const profiler::thread_blocks_tree_t& _trees,
               const profiler::bookmarks_t& bookmarks, profiler::block_getter_fn block_getter,
-              profiler::processid_t _pid, bool snapshotMode);
+              profiler::processid_t _pid, profiler::timestamp_t _blockOverhead, bool snapshotMode);
 
     void interrupt();
 
     void get(profiler::SerializedData& _serializedBlocks, profiler::SerializedData& _serializedDescriptors,
              profiler::descriptors_list_t& _descriptors, profiler::blocks_t& _blocks, profiler::thread_blocks_tree_t& _trees,
              profiler::bookmarks_t& bookmarks, profiler::BeginEndTime& beginEndTime, uint32_t& _descriptorsNumberInFile,
-             uint32_t& _version, profiler::processid_t& _pid, QString& _filename);
+             uint32_t& _version, profiler::processid_t& _pid, profiler::timestamp_t& _blockOverhead,
+             QString& _filename);
 
     void join();
 
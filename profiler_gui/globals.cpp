@@ -81,6 +81,7 @@ Globals::Globals()
     : theme("default")
     , pid(0)
     , begin_time(0)
+    , block_overhead(0)
     , selected_thread(0U)
     , selected_block(::profiler_gui::numeric_max<decltype(selected_block)>())
     , selected_block_id(::profiler_gui::numeric_max<decltype(selected_block_id)>())
@@ -102,12 +103,14 @@ Globals::Globals()
     , use_custom_window_header(true)
     , is_right_window_header_controls(true)
     , fps_enabled(true)
+    , network_compression(false)
     , use_decorated_thread_name(false)
     , hex_thread_id(false)
     , enable_event_markers(true)
     , enable_statistics(true)
     , enable_zero_length(true)
     , add_zero_blocks_to_hierarchy(false)
+    , compensate_block_overhead(false)
     , draw_graphics_items_borders(true)
     , draw_histogram_borders(true)
     , hide_narrow_children(false)
@@ -201,6 +201,8 @@ namespace profiler_gui {
         ::profiler::descriptors_list_t       descriptors; ///< Profiler block descriptors list
         ::profiler::bookmarks_t                bookmarks; ///< User bookmarks
         EasyBlocks                            gui_blocks; ///< Profiler graphics blocks builded by GUI
+        ::profiler::async_links_t            async_spans; ///< Async spans resolved for gui_blocks
+        ::profiler::async_links_t                  flows; ///< Flow links resolved for gui_blocks
 
         QString                                    theme; ///< Current UI theme name
         QString                              lastFileDir;
@@ -210,6 +212,7 @@ namespace profiler_gui {
         SizeGuide                                   size; ///< Various widgets and font sizes adapted to current device pixel ratio
         ::profiler::processid_t                      pid; ///< Profiled process ID
         ::profiler::timestamp_t               begin_time; ///< Timestamp of the most left diagram scene point (x=0)
+        ::profiler::timestamp_t           block_overhead; ///< Measured cost of one empty nested block (0 if the file has no calibration)
         ::profiler::thread_id_t          selected_thread; ///< Current selected thread id
         ::profiler::block_index_t         selected_block; ///< Current selected profiler block index
         ::profiler::block_id_t         selected_block_id; ///< Current selected profiler block id
@@ -236,12 +239,14 @@ namespace profiler_gui {
         bool                    use_custom_window_header; ///<
         bool             is_right_window_header_controls; ///<
         bool                                 fps_enabled; ///< Is FPS Monitor enabled
+        bool                         network_compression; ///< Request compressed captures from profiled application (saves bandwidth, but halves throughput on fast networks)
         bool                   use_decorated_thread_name; ///< Add "Thread" to the name of each thread (if there is no one)
         bool                               hex_thread_id; ///< Use hex view for thread-id instead of decimal
         bool                        enable_event_markers; ///< Enable event indicators painting (These are narrow rectangles at the bottom of each thread)
         bool                           enable_statistics; ///< Enable gathering and using statistics (Disable if you want to consume less memory)
         bool                          enable_zero_length; ///< Enable zero length blocks (if true, then such blocks will have width == 1 pixel on each scale)
         bool                add_zero_blocks_to_hierarchy; ///< Enable adding zero blocks into hierarchy tree
+        bool                   compensate_block_overhead; ///< Subtract profiler overhead of nested blocks from durations in hierarchy tree (see block_overhead)
         bool                 draw_graphics_items_borders; ///< Draw borders for graphics blocks or not
         bool                      draw_histogram_borders; ///< Draw borders for histogram columns or not
         bool                        hide_narrow_children; ///< Hide children for narrow graphics blocks (See blocks_narrow_size)
@@ -687,6 +687,24 @@ void GraphicsHistogramItem::setSource(profiler::thread_id_t _thread_id, profiler
                 break;
             }
 
+            case profiler::BlockType::Async:
+            {
+                m_blockType = QStringLiteral("Async Span");
+                break;
+            }
+
+            case profiler::BlockType::Flow:
+            {
+                m_blockType = QStringLiteral("Flow");
+                break;
+            }
+
+            case profiler::BlockType::Lock:
+            {
+                m_blockType = QStringLiteral("Lock");
+                break;
+            }
+
             default: break;
         }
 
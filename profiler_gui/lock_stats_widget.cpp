@@ -0,0 +1,168 @@
+/************************************************************************
+* file name         : lock_stats_widget.cpp
+* ----------------- :
+* creation time     : 2026/10/18
+* ----------------- :
+* description       : This file contains implementation of LockStatsWidget widget.
+* ----------------- :
+* change log        : * 2026/10/18: Initial commit.
+*                   :
+*                   : *
+* ----------------- : 
+* license           : Lightweight profiler library for c++
+*                   : Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+*                   :
+*                   : Licensed under either of
+*                   :     * MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+*                   :     * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+*                   : at your option.
+*                   :
+*                   : The MIT License
+*                   :
+*                   : Permission is hereby granted, free of charge, to any person obtaining a copy
+*                   : of this software and associated documentation files (the "Software"), to deal
+*                   : in the Software without restriction, including without limitation the rights 
+*                   : to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies 
+*                   : of the Software, and to permit persons to whom the Software is furnished 
+*                   : to do so, subject to the following conditions:
+*                   : 
+*                   : The above copyright notice and this permission notice shall be included in all 
+*                   : copies or substantial portions of the Software.
+*                   : 
+*                   : THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+*                   : INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+*                   : PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE 
+*                   : LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, 
+*                   : TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE 
+*                   : USE OR OTHER DEALINGS IN THE SOFTWARE.
+*                   : 
+*                   : The Apache License, Version 2.0 (the "License")
+*                   :
+*                   : You may not use this file except in compliance with the License.
+*                   : You may obtain a copy of the License at
+*                   :
+*                   : http://www.apache.org/licenses/LICENSE-2.0
+*                   :
+*                   : Unless required by applicable law or agreed to in writing, software
+*                   : distributed under the License is distributed on an "AS IS" BASIS,
+*                   : WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*                   : See the License for the specific language governing permissions and
+*                   : limitations under the License.
+************************************************************************/
+
+#include <QContextMenuEvent>
+#include <QMenu>
+#include "lock_stats_widget.h"
+#include "globals.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+enum LockStatsColumns : int8_t
+{
+    LOCK_COL_NAME = 0,
+    LOCK_COL_TOTAL_WAIT,
+    LOCK_COL_MAX_WAIT,
+    LOCK_COL_WAITS,
+    LOCK_COL_TOTAL_HOLD,
+    LOCK_COL_HOLDS,
+
+    LOCK_COL_COLUMNS_NUMBER
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+LockStatsWidget::LockStatsWidget(QWidget* _parent) : Parent(_parent)
+{
+    setAutoFillBackground(false);
+    setAlternatingRowColors(true);
+    setItemsExpandable(true);
+    setAnimated(true);
+    setSortingEnabled(false);
+    setColumnCount(LOCK_COL_COLUMNS_NUMBER);
+
+    auto header_item = new QTreeWidgetItem();
+    header_item->setText(LOCK_COL_NAME, "Lock / Thread");
+    header_item->setText(LOCK_COL_TOTAL_WAIT, "Total wait");
+    header_item->setText(LOCK_COL_MAX_WAIT, "Max wait");
+    header_item->setText(LOCK_COL_WAITS, "Waits");
+    header_item->setText(LOCK_COL_TOTAL_HOLD, "Total hold");
+    header_item->setText(LOCK_COL_HOLDS, "Holds");
+    setHeaderItem(header_item);
+
+    connect(&EASY_GLOBALS.events, &profiler_gui::GlobalSignals::allDataGoingToBeDeleted, this, &This::clear);
+    connect(&EASY_GLOBALS.events, &profiler_gui::GlobalSignals::fileOpened, this, &This::build);
+    connect(&EASY_GLOBALS.events, &profiler_gui::GlobalSignals::threadNameDecorationChanged, this, &This::onThreadNameDecorationChanged);
+    connect(&EASY_GLOBALS.events, &profiler_gui::GlobalSignals::hexThreadIdChanged, this, &This::onThreadNameDecorationChanged);
+}
+
+LockStatsWidget::~LockStatsWidget()
+{
+
+}
+
+void LockStatsWidget::contextMenuEvent(QContextMenuEvent* _event)
+{
+    _event->accept();
+
+    QMenu menu;
+    menu.addAction("Expand all", this, SLOT(expandAll()));
+    menu.addAction("Collapse all", this, SLOT(collapseAll()));
+    menu.exec(QCursor::pos());
+}
+
+void LockStatsWidget::clear()
+{
+    m_stats.clear();
+    Parent::clear();
+}
+
+void LockStatsWidget::build()
+{
+    clear();
+
+    fillLockStats(EASY_GLOBALS.profiler_blocks, EASY_GLOBALS.descriptors,
+                  [](profiler::block_index_t i) -> const profiler::BlocksTree& { return easyBlocksTree(i); },
+                  m_stats);
+
+    fill();
+}
+
+void LockStatsWidget::onThreadNameDecorationChanged()
+{
+    Parent::clear();
+    fill();
+}
+
+void LockStatsWidget::fill()
+{
+    const auto units = EASY_GLOBALS.time_units;
+
+    for (const auto& lock : m_stats)
+    {
+        auto item = new QTreeWidgetItem(this);
+        item->setText(LOCK_COL_NAME, profiler_gui::toUnicode(lock.name.c_str()));
+        item->setText(LOCK_COL_TOTAL_WAIT, profiler_gui::timeStringRealNs(units, lock.total_wait_time, 3));
+        item->setText(LOCK_COL_MAX_WAIT, profiler_gui::timeStringRealNs(units, lock.max_wait_time, 3));
+        item->setText(LOCK_COL_WAITS, QString::number(lock.waits_number));
+        item->setText(LOCK_COL_TOTAL_HOLD, profiler_gui::timeStringRealNs(units, lock.total_hold_time, 3));
+        item->setText(LOCK_COL_HOLDS, QString::number(lock.holds_number));
+
+        for (const auto& thread : lock.threads)
+        {
+            auto it = EASY_GLOBALS.profiler_blocks.find(thread.thread_id);
+            if (it == EASY_GLOBALS.profiler_blocks.end())
+                continue;
+
+            auto child = new QTreeWidgetItem(item);
+            child->setText(LOCK_COL_NAME, profiler_gui::decoratedThreadName(EASY_GLOBALS.use_decorated_thread_name,
+                                                                            it->second, EASY_GLOBALS.hex_thread_id));
+            child->setText(LOCK_COL_TOTAL_WAIT, profiler_gui::timeStringRealNs(units, thread.wait_time, 3));
+            child->setText(LOCK_COL_WAITS, QString::number(thread.waits_number));
+            child->setText(LOCK_COL_TOTAL_HOLD, profiler_gui::timeStringRealNs(units, thread.hold_time, 3));
+            child->setText(LOCK_COL_HOLDS, QString::number(thread.holds_number));
+        }
+    }
+
+    for (int i = 0; i < LOCK_COL_COLUMNS_NUMBER; ++i)
+        resizeColumnToContents(i);
+}
@@ -107,6 +107,7 @@
 #include "dialog.h"
 #include "globals.h"
 #include "fps_widget.h"
+#include "lock_stats_widget.h"
 #include "round_progress_widget.h"
 
 #include "main_window.h"
@@ -124,6 +125,8 @@
 namespace {
 
 const int LOADER_TIMER_INTERVAL = 40;
+const int STREAM_FRAME_INTERVAL = 100; ///< How often profiled application sends stream frames (in milliseconds)
+const int STREAM_RELOAD_INTERVAL = 1000; ///< How often the view is updated with received stream frames (in milliseconds)
 
 } // end of namespace <noname>.
 
@@ -369,9 +372,17 @@ MainWindow::MainWindow() : Parent(), m_theme("default"), m_lastAddress("localhos
     m_fpsViewer->setWidget(new FpsWidget(this));
     m_fpsViewer->setAllowedAreas(Qt::TopDockWidgetArea | Qt::BottomDockWidgetArea);
 
+    m_lockStatsViewer = new DockWidget("Lock Contention", this);
+    m_lockStatsViewer->setObjectName("ProfilerGUI_LockContention");
+    m_lockStatsViewer->setMinimumHeight(px(50));
+    m_lockStatsViewer->setAllowedAreas(Qt::AllDockWidgetAreas);
+    m_lockStatsViewer->setWidget(new LockStatsWidget(this));
+
     addDockWidget(Qt::TopDockWidgetArea, m_graphicsView);
     addDockWidget(Qt::BottomDockWidgetArea, m_treeWidget);
     addDockWidget(Qt::TopDockWidgetArea, m_fpsViewer);
+    tabifyDockWidget(m_treeWidget, m_lockStatsViewer);
+    m_treeWidget->raise();
 
 #if EASY_GUI_USE_DESCRIPTORS_DOCK_WINDOW != 0
     auto descTree = new BlockDescriptorsWidget();
@@ -417,6 +428,9 @@ MainWindow::MainWindow() : Parent(), m_theme("default"), m_lastAddress("localhos
     toolbar->addAction(QIcon(imagePath("list")), tr("Blocks"), this, SLOT(onEditBlocksClicked(bool)));
     m_captureAction = toolbar->addAction(QIcon(imagePath("start")), tr("Capture"), this, SLOT(onCaptureClicked(bool)));
     m_captureAction->setEnabled(false);
+    m_streamAction = toolbar->addAction(QIcon(imagePath("wifi")), tr("Stream"), this, SLOT(onStreamClicked(bool)));
+    m_streamAction->setToolTip("Start live streaming.\nReceived frames are shown\nwhile application is running.");
+    m_streamAction->setEnabled(false);
 
     toolbar->addSeparator();
     m_connectAction = toolbar->addAction(QIcon(imagePath("connect")), tr("Connect"), this, SLOT(onConnectClicked(bool)));
@@ -713,6 +727,16 @@ MainWindow::MainWindow() : Parent(), m_theme("default"), m_lastAddress("localhos
         emit EASY_GLOBALS.events.hierarchyFlagChanged(_checked);
     });
 
+    action = submenu->addAction("Compensate profiler overhead in the tree");
+    action->setToolTip("Measured cost of nested blocks (stored in the file)\nwill be subtracted from durations in the hierarchy tree.\nStatistics columns remain unchanged.");
+    action->setCheckable(true);
+    action->setChecked(EASY_GLOBALS.compensate_block_overhead);
+    connect(action, &QAction::triggered, [this](bool _checked)
+    {
+        EASY_GLOBALS.compensate_block_overhead = _checked;
+        emit EASY_GLOBALS.events.hierarchyFlagChanged(_checked);
+    });
+
     action = submenu->addAction("Hide stats for single blocks in tree");
     action->setToolTip("If checked then such stats like Min,Max,Avg etc.\nwill not be displayed in stats tree for blocks\nwith number of calls == 1");
     action->setCheckable(true);
@@ -866,6 +890,39 @@ MainWindow::MainWindow() : Parent(), m_theme("default"), m_lastAddress("localhos
     m_eventTracingPriorityAction->setEnabled(false);
     connect(m_eventTracingPriorityAction, &QAction::triggered, this, &This::onEventTracingPriorityChange);
 
+    action = submenu->addAction("Compress captured data");
+    action->setToolTip("Captured blocks will be compressed before sending.\nUse it for slow networks only: on fast networks\ncompression takes longer than sending raw data.\nTakes effect on next connection.");
+    action->setCheckable(true);
+    action->setChecked(EASY_GLOBALS.network_compression);
+    connect(action, &QAction::triggered, [](bool _checked)
+    {
+        EASY_GLOBALS.network_compression = _checked;
+    });
+
+    m_categoriesMenu = submenu->addMenu("Categories");
+    m_categoriesMenu->setEnabled(false);
+    {
+        const std::pair<const char*, profiler::category_t> categories[] = {
+            {"Default", profiler::categories::Default},
+            {"Net", profiler::categories::Net},
+            {"Db", profiler::categories::Db},
+            {"IO", profiler::categories::IO},
+            {"Render", profiler::categories::Render},
+            {"Physics", profiler::categories::Physics},
+            {"Audio", profiler::categories::Audio},
+            {"Alloc", profiler::categories::Alloc}
+        };
+
+        for (const auto& category : categories)
+        {
+            action = m_categoriesMenu->addAction(category.first);
+            action->setCheckable(true);
+            action->setChecked(true);
+            action->setData(static_cast<quint32>(category.second));
+            connect(action, &QAction::triggered, this, &This::onCategoryEnableChange);
+        }
+    }
+
 
     submenu = menu->addMenu("Encoding");
     actionGroup = new QActionGroup(this);
@@ -979,6 +1036,7 @@ MainWindow::MainWindow() : Parent(), m_theme("default"), m_lastAddress("localhos
     connect(&m_readerTimer, &QTimer::timeout, this, &This::onFileReaderTimeout);
     connect(&m_listenerTimer, &QTimer::timeout, this, &This::onListenerTimerTimeout);
     connect(&m_fpsRequestTimer, &QTimer::timeout, this, &This::onFrameTimeRequestTimeout);
+    connect(&m_streamTimer, &QTimer::timeout, this, &This::onStreamTimerTimeout);
     
 
     loadGeometry();
@@ -1186,9 +1244,10 @@ void MainWindow::loadFile(const QString& filename)
     m_reader.load(filename);
 }
 
-void MainWindow::readStream(std::stringstream& _data)
+void MainWindow::readStream(std::stringstream& _data, bool _showProgress)
 {
-    createProgressDialog(tr("Reading from stream..."));
+    if (_showProgress)
+        createProgressDialog(tr("Reading from stream..."));
     m_readerTimer.start();
     m_reader.load(_data);
 }
@@ -1259,7 +1318,7 @@ void MainWindow::onSaveFileClicked(bool)
         m_readerTimer.start();
         m_reader.save(filename, m_beginEndTime.beginTime, m_beginEndTime.endTime, m_serializedDescriptors,
                       EASY_GLOBALS.descriptors, m_descriptorsNumberInFile, EASY_GLOBALS.profiler_blocks,
-                      EASY_GLOBALS.bookmarks, easyBlocksTree, EASY_GLOBALS.pid, false);
+                      EASY_GLOBALS.bookmarks, easyBlocksTree, EASY_GLOBALS.pid, EASY_GLOBALS.block_overhead, false);
         return;
     }
 
@@ -1356,6 +1415,8 @@ void MainWindow::clear()
     EASY_GLOBALS.profiler_blocks.clear();
     EASY_GLOBALS.descriptors.clear();
     EASY_GLOBALS.gui_blocks.clear();
+    EASY_GLOBALS.async_spans.clear();
+    EASY_GLOBALS.flows.clear();
 
     m_serializedBlocks.clear();
     m_serializedDescriptors.clear();
@@ -1800,6 +1861,14 @@ void MainWindow::loadSettings()
     if (!flag.isNull())
         EASY_GLOBALS.add_zero_blocks_to_hierarchy = flag.toBool();
 
+    flag = settings.value("compensate_block_overhead");
+    if (!flag.isNull())
+        EASY_GLOBALS.compensate_block_overhead = flag.toBool();
+
+    flag = settings.value("network_compression");
+    if (!flag.isNull())
+        EASY_GLOBALS.network_compression = flag.toBool();
+
 
     flag = settings.value("highlight_blocks_with_same_id");
     if (!flag.isNull())
@@ -1946,6 +2015,8 @@ void MainWindow::saveSettingsAndGeometry()
     settings.setValue("only_current_thread_hierarchy", EASY_GLOBALS.only_current_thread_hierarchy);
     settings.setValue("enable_zero_length", EASY_GLOBALS.enable_zero_length);
     settings.setValue("add_zero_blocks_to_hierarchy", EASY_GLOBALS.add_zero_blocks_to_hierarchy);
+    settings.setValue("compensate_block_overhead", EASY_GLOBALS.compensate_block_overhead);
+    settings.setValue("network_compression", EASY_GLOBALS.network_compression);
     settings.setValue("highlight_blocks_with_same_id", EASY_GLOBALS.highlight_blocks_with_same_id);
     settings.setValue("bind_scene_and_tree_expand_status", EASY_GLOBALS.bind_scene_and_tree_expand_status);
     settings.setValue("hide_stats_for_single_blocks", EASY_GLOBALS.hide_stats_for_single_blocks);
@@ -2004,11 +2075,13 @@ void MainWindow::setDisconnected(bool _showMessage)
 
     EASY_GLOBALS.connected = false;
     m_captureAction->setEnabled(false);
+    m_streamAction->setEnabled(false);
     m_connectAction->setIcon(QIcon(imagePath("connect")));
     m_connectAction->setText(tr("Connect"));
 
     m_eventTracingEnableAction->setEnabled(false);
     m_eventTracingPriorityAction->setEnabled(false);
+    m_categoriesMenu->setEnabled(false);
 
     m_addressEdit->setEnabled(true);
     m_portEdit->setEnabled(true);
@@ -2266,9 +2339,10 @@ void MainWindow::onLoadingFinish(profiler::block_index_t& _nblocks)
         uint32_t descriptorsNumberInFile = 0;
         uint32_t version = 0;
         profiler::processid_t pid = 0;
+        profiler::timestamp_t blockOverhead = 0;
 
         m_reader.get(serialized_blocks, serialized_descriptors, descriptors, blocks, threads_map,
-                     bookmarks, beginEndTime, descriptorsNumberInFile, version, pid, filename);
+                     bookmarks, beginEndTime, descriptorsNumberInFile, version, pid, blockOverhead, filename);
 
         if (threads_map.size() > 0xff)
         {
@@ -2302,6 +2376,7 @@ void MainWindow::onLoadingFinish(profiler::block_index_t& _nblocks)
         EASY_GLOBALS.selected_thread = 0;
         EASY_GLOBALS.version = version;
         EASY_GLOBALS.pid = pid;
+        EASY_GLOBALS.block_overhead = blockOverhead;
         profiler_gui::set_max(EASY_GLOBALS.selected_block);
         profiler_gui::set_max(EASY_GLOBALS.selected_block_id);
         EASY_GLOBALS.profiler_blocks.swap(threads_map);
@@ -2318,6 +2393,10 @@ void MainWindow::onLoadingFinish(profiler::block_index_t& _nblocks)
             guiblock.tree = std::move(blocks[i]);
         }
 
+        fillAsyncLinks(EASY_GLOBALS.profiler_blocks, EASY_GLOBALS.descriptors,
+                       [](profiler::block_index_t i) -> const profiler::BlocksTree& { return easyBlocksTree(i); },
+                       EASY_GLOBALS.async_spans, EASY_GLOBALS.flows);
+
         m_saveAction->setEnabled(true);
         m_deleteAction->setEnabled(true);
     }
@@ -2418,6 +2497,13 @@ void MainWindow::onEventTracingEnableChange(bool _checked)
         m_listener.send(profiler::net::BoolMessage(profiler::net::MessageType::Change_Event_Tracing_Status, _checked));
 }
 
+void MainWindow::onCategoryEnableChange(bool _checked)
+{
+    auto action = qobject_cast<QAction*>(sender());
+    if (action != nullptr && EASY_GLOBALS.connected)
+        m_listener.send(profiler::net::CategoriesMessage(action->data().toUInt(), _checked));
+}
+
 //////////////////////////////////////////////////////////////////////////
 
 void MainWindow::onFrameTimeEditFinish()
@@ -2467,7 +2553,7 @@ void MainWindow::onSnapshotClicked(bool)
 
     m_reader.save(filename, beginTime, endTime, m_serializedDescriptors, EASY_GLOBALS.descriptors,
                   m_descriptorsNumberInFile, EASY_GLOBALS.profiler_blocks, EASY_GLOBALS.bookmarks,
-                  easyBlocksTree, EASY_GLOBALS.pid, true);
+                  easyBlocksTree, EASY_GLOBALS.pid, EASY_GLOBALS.block_overhead, true);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -2515,6 +2601,7 @@ void MainWindow::onConnectClicked(bool)
         address.toStdString() == m_listener.address());
 
     profiler::net::EasyProfilerStatus reply(false, false, false);
+    m_listener.setCompressionEnabled(EASY_GLOBALS.network_compression);
     if (!m_listener.connect(address.toStdString().c_str(), port, reply))
     {
         Dialog::warning(this, "Warning", QString("Cannot connect to %1").arg(address), QMessageBox::Close);
@@ -2537,6 +2624,7 @@ void MainWindow::onConnectClicked(bool)
     qInfo() << "Connected successfully";
     EASY_GLOBALS.connected = true;
     m_captureAction->setEnabled(true);
+    m_streamAction->setEnabled(true);
     m_connectAction->setIcon(QIcon(imagePath("connected")));
     m_connectAction->setText(tr("Disconnect"));
 
@@ -2558,6 +2646,16 @@ void MainWindow::onConnectClicked(bool)
     connect(m_eventTracingEnableAction, &QAction::triggered, this, &This::onEventTracingEnableChange);
     connect(m_eventTracingPriorityAction, &QAction::triggered, this, &This::onEventTracingPriorityChange);
 
+    // Categories mask is not reported by the profiler, so reset it to "all enabled" on connect
+    uint32_t categories = 0;
+    m_categoriesMenu->setEnabled(true);
+    for (auto action : m_categoriesMenu->actions())
+    {
+        action->setChecked(true);
+        categories |= action->data().toUInt();
+    }
+    m_listener.send(profiler::net::CategoriesMessage(categories, true));
+
     m_addressEdit->setEnabled(false);
     m_portEdit->setEnabled(false);
 
@@ -2586,6 +2684,11 @@ void MainWindow::onCaptureClicked(bool)
             Dialog::warning(this, "Warning",
                 "Already capturing frames.\nFinish old capturing session first.", QMessageBox::Close);
         }
+        else if (m_listener.regime() == ListenerRegime::Streaming)
+        {
+            Dialog::warning(this, "Warning",
+                "Streaming frames.\nStop streaming session first.", QMessageBox::Close);
+        }
         else
         {
             Dialog::warning(this, "Warning",
@@ -2632,6 +2735,80 @@ void MainWindow::onCaptureClicked(bool)
     centerDialogs();
 }
 
+void MainWindow::onStreamClicked(bool)
+{
+    if (!EASY_GLOBALS.connected)
+    {
+        Dialog::warning(this, "Warning", "No connection with profiling app", QMessageBox::Close);
+        return;
+    }
+
+    if (m_listener.regime() == ListenerRegime::Streaming)
+    {
+        // The rest of frames would be loaded by onStreamTimerTimeout() after streaming finish
+        m_listener.stopStreaming();
+        m_streamAction->setEnabled(false);
+        return;
+    }
+
+    if (m_listener.regime() != ListenerRegime::Idle)
+    {
+        Dialog::warning(this, "Warning",
+            "Already capturing frames.\nFinish old capturing session first.", QMessageBox::Close);
+        return;
+    }
+
+    if (!m_listener.startStreaming(STREAM_FRAME_INTERVAL))
+    {
+        m_listener.closeSocket();
+        setDisconnected();
+        return;
+    }
+
+    m_captureAction->setEnabled(false);
+    m_streamAction->setIcon(QIcon(imagePath("wifi-on")));
+    m_streamAction->setText(tr("Stop stream"));
+    m_streamTimer.start(STREAM_RELOAD_INTERVAL);
+}
+
+void MainWindow::onStreamTimerTimeout()
+{
+    if (m_listener.streamStopped())
+    {
+        m_streamTimer.stop();
+        m_listener.finalizeStreaming();
+
+        m_streamAction->setIcon(QIcon(imagePath("wifi")));
+        m_streamAction->setText(tr("Stream"));
+
+        if (!m_listener.connected())
+        {
+            m_listener.closeSocket();
+            setDisconnected();
+        }
+        else
+        {
+            m_captureAction->setEnabled(true);
+            m_streamAction->setEnabled(true);
+        }
+
+        // Load all received frames
+        m_listener.clearData();
+        if (m_listener.streamSnapshot(m_listener.data()))
+            readStream(m_listener.data());
+
+        return;
+    }
+
+    // Do not interrupt loading of previous frames: new frames would be loaded on the next timeout
+    if (m_readerTimer.isActive() || !m_listener.streamUpdated())
+        return;
+
+    m_listener.clearData();
+    if (m_listener.streamSnapshot(m_listener.data()))
+        readStream(m_listener.data(), false);
+}
+
 void MainWindow::onGetBlockDescriptionsClicked(bool)
 {
     if (!EASY_GLOBALS.connected)
@@ -127,6 +127,7 @@ protected:
     QDockWidget*                m_treeWidget = nullptr;
     QDockWidget*              m_graphicsView = nullptr;
     QDockWidget*                 m_fpsViewer = nullptr;
+    QDockWidget*           m_lockStatsViewer = nullptr;
 
 #if EASY_GUI_USE_DESCRIPTORS_DOCK_WINDOW != 0
     QDockWidget*                      m_descTreeWidget = nullptr;
@@ -138,6 +139,7 @@ protected:
     QTimer                               m_readerTimer;
     QTimer                             m_listenerTimer;
     QTimer                           m_fpsRequestTimer;
+    QTimer                               m_streamTimer;
     profiler::SerializedData        m_serializedBlocks;
     profiler::SerializedData   m_serializedDescriptors;
     profiler::BeginEndTime              m_beginEndTime;
@@ -154,9 +156,11 @@ protected:
     class QAction*   m_deleteAction = nullptr;
 
     class QAction*              m_captureAction = nullptr;
+    class QAction*               m_streamAction = nullptr;
     class QAction*              m_connectAction = nullptr;
     class QAction*   m_eventTracingEnableAction = nullptr;
     class QAction* m_eventTracingPriorityAction = nullptr;
+    class QMenu*             m_categoriesMenu = nullptr;
 
     uint32_t m_descriptorsNumberInFile = 0;
     uint16_t                m_lastPort = 0;
@@ -219,10 +223,13 @@ protected slots:
     void onDescTreeDialogClose(int);
     void onListenerDialogClose(int);
     void onCaptureClicked(bool);
+    void onStreamClicked(bool);
+    void onStreamTimerTimeout();
     void onGetBlockDescriptionsClicked(bool);
     void onConnectClicked(bool);
     void onEventTracingPriorityChange(bool _checked);
     void onEventTracingEnableChange(bool _checked);
+    void onCategoryEnableChange(bool _checked);
     void onFrameTimeEditFinish();
     void onFrameTimeChanged();
     void onSnapshotClicked(bool);
@@ -257,7 +264,7 @@ private:
 
     void addFileToList(const QString& filename, bool changeWindowTitle = true);
     void loadFile(const QString& filename);
-    void readStream(std::stringstream& data);
+    void readStream(std::stringstream& data, bool _showProgress = true);
 
     void loadSettings();
     void loadGeometry();
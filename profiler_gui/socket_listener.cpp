@@ -40,9 +40,14 @@ The Apache License, Version 2.0 (the "License");
 
 **/
 
+#include <cstring>
+#include <vector>
+
 #include <QDebug>
 
+#include <easy/easy_compression.h>
 #include <easy/easy_net.h>
+#include <easy/profiler.h>
 
 #include "common_functions.h"
 #include "socket_listener.h"
@@ -62,6 +67,8 @@ SocketListener::SocketListener() : m_receivedSize(0), m_port(0), m_regime(Listen
     m_bStopReceive = false;
     m_bFrameTimeReady = false;
     m_bCaptureReady = false;
+    m_bStreamUpdated = false;
+    m_bStreamStopped = false;
     m_frameMax = 0;
     m_frameAvg = 0;
 }
@@ -116,6 +123,55 @@ void SocketListener::clearData()
     m_receivedSize = 0;
 }
 
+void SocketListener::clearPackedData()
+{
+    m_packedData.clear();
+    m_unpackedData.clear();
+    m_packedData.shrink_to_fit();
+    m_unpackedData.shrink_to_fit();
+    m_bPackedHeaderReady = false;
+}
+
+bool SocketListener::appendPackedData(const char* _data, size_t _size)
+{
+    m_packedData.append(_data, _size);
+
+    size_t offset = 0;
+    if (!m_bPackedHeaderReady)
+    {
+        if (m_packedData.size() < sizeof(profiler::net::CompressedDataHeader))
+            return true;
+
+        memcpy(&m_packedHeader, m_packedData.data(), sizeof(profiler::net::CompressedDataHeader));
+        m_bPackedHeaderReady = true;
+        offset = sizeof(profiler::net::CompressedDataHeader);
+        m_unpackedData.reserve(m_packedHeader.rawSize);
+    }
+
+    // Unpack all complete chunks, incomplete one is left until the rest of it would be received
+    size_t consumed = 0;
+    const bool result = profiler::net::unpackChunks(m_packedData.data() + offset, m_packedData.size() - offset,
+                                                    consumed, m_unpackedData);
+    m_packedData.erase(0, offset + consumed);
+
+    return result;
+}
+
+bool SocketListener::finishPackedData()
+{
+    bool result = m_bPackedHeaderReady && m_packedData.empty() && m_unpackedData.size() == m_packedHeader.rawSize;
+
+    if (result && (m_packedHeader.flags & profiler::net::COMPRESSION_TIMESTAMP_DELTA) != 0)
+        result = profiler::net::decodeTimestampDeltas(&m_unpackedData[0], m_unpackedData.size());
+
+    if (result)
+        m_receivedData.write(m_unpackedData.data(), m_unpackedData.size());
+
+    clearPackedData();
+
+    return result;
+}
+
 void SocketListener::disconnect()
 {
     if (connected())
@@ -231,6 +287,14 @@ bool SocketListener::connect(
         if (message->isEasyNetMessage() && message->type == profiler::net::MessageType::Connection_Accepted)
         {
             _reply = *message;
+
+            // Older versions do not send compression flags (buffer is zero-initialized)
+            const uint8_t compression = m_bCompression ? (_reply.compression & profiler::net::COMPRESSION_SUPPORTED) : 0;
+            if (compression != profiler::net::COMPRESSION_NONE)
+            {
+                const profiler::net::CompressionMessage request(compression);
+                m_easySocket.send(&request, sizeof(request));
+            }
         }
 
         m_address = _ipaddress;
@@ -247,6 +311,11 @@ bool SocketListener::reconnect(const char* _ipaddress, uint16_t _port, profiler:
       return connect(_ipaddress, _port, _reply, true);
 }
 
+void SocketListener::setCompressionEnabled(bool _enabled)
+{
+    m_bCompression = _enabled;
+}
+
 bool SocketListener::startCapture()
 {
     //if (m_thread.joinable())
@@ -392,6 +461,138 @@ bool SocketListener::requestFrameTime()
     return true;
 }
 
+bool SocketListener::startStreaming(uint32_t _intervalMs)
+{
+    if (m_thread.joinable())
+    {
+        m_bInterrupt.store(true, std::memory_order_release);
+        m_thread.join();
+        m_bInterrupt.store(false, std::memory_order_release);
+    }
+
+    clearData();
+    clearStream();
+
+    profiler::net::StreamingMessage request(_intervalMs);
+    m_easySocket.send(&request, sizeof(request));
+
+    if (m_easySocket.isDisconnected())
+    {
+        m_bConnected.store(false, std::memory_order_release);
+        return false;
+    }
+
+    m_regime = ListenerRegime::Streaming;
+    m_bStreamStopped.store(false, std::memory_order_release);
+    m_thread = std::thread(&SocketListener::listenStream, this);
+
+    return true;
+}
+
+void SocketListener::stopStreaming()
+{
+    if (m_regime != ListenerRegime::Streaming)
+    {
+        return;
+    }
+
+    // Stream listening thread would finish after receiving Reply_Streaming_Stopped
+    profiler::net::Message request(profiler::net::MessageType::Request_Stop_Streaming);
+    m_easySocket.send(&request, sizeof(request));
+
+    if (m_easySocket.isDisconnected())
+    {
+        m_bConnected.store(false, std::memory_order_release);
+        m_bStreamStopped.store(true, std::memory_order_release);
+    }
+}
+
+void SocketListener::finalizeStreaming()
+{
+    if (m_thread.joinable())
+    {
+        m_bInterrupt.store(true, std::memory_order_release);
+        m_thread.join();
+        m_bInterrupt.store(false, std::memory_order_release);
+    }
+
+    m_regime = ListenerRegime::Idle;
+    m_bStreamStopped.store(false, std::memory_order_release);
+}
+
+bool SocketListener::streamUpdated()
+{
+    return m_bStreamUpdated.exchange(false, std::memory_order_acq_rel);
+}
+
+bool SocketListener::streamStopped() const
+{
+    return m_bStreamStopped.load(std::memory_order_acquire);
+}
+
+bool SocketListener::streamSnapshot(std::stringstream& _data)
+{
+    // Build the same stream as ProfileManager::dumpBlocksToStream() does
+    // to be able to read it using fillTreesFromStream().
+
+    EASY_CONSTEXPR uint32_t Signature = ('E' << 24) | ('a' << 16) | ('s' << 8) | 'y';
+    const uint32_t Version = profiler::version();
+
+    std::lock_guard<std::mutex> lock(m_streamMutex);
+
+    uint64_t memorySize = 0;
+    uint32_t blocksNumber = 0;
+    for (const auto& it : m_streamThreads)
+    {
+        memorySize += it.second.memorySize;
+        blocksNumber += it.second.blocksNumber;
+    }
+
+    if (blocksNumber == 0)
+    {
+        return false;
+    }
+
+    const auto threadsNumber = static_cast<uint32_t>(m_streamThreads.size());
+    const uint16_t bookmarksNumber = 0, padding = 0;
+    const profiler::timestamp_t blockOverhead = 0; // block overhead is not calibrated for streaming capture
+
+    _data.write((const char*)&Signature, sizeof(Signature));
+    _data.write((const char*)&Version, sizeof(Version));
+    _data.write((const char*)&m_streamPid, sizeof(m_streamPid));
+    _data.write((const char*)&m_streamCpuFrequency, sizeof(m_streamCpuFrequency));
+    _data.write((const char*)&m_streamBeginTime, sizeof(m_streamBeginTime));
+    _data.write((const char*)&m_streamEndTime, sizeof(m_streamEndTime));
+    _data.write((const char*)&memorySize, sizeof(memorySize));
+    _data.write((const char*)&m_streamDescriptorsMemorySize, sizeof(m_streamDescriptorsMemorySize));
+    _data.write((const char*)&blocksNumber, sizeof(blocksNumber));
+    _data.write((const char*)&m_streamDescriptorsNumber, sizeof(m_streamDescriptorsNumber));
+    _data.write((const char*)&threadsNumber, sizeof(threadsNumber));
+    _data.write((const char*)&bookmarksNumber, sizeof(bookmarksNumber));
+    _data.write((const char*)&padding, sizeof(padding));
+    _data.write((const char*)&blockOverhead, sizeof(blockOverhead));
+
+    _data.write(m_streamDescriptors.data(), m_streamDescriptors.size());
+
+    for (const auto& it : m_streamThreads)
+    {
+        const auto& thread = it.second;
+        const uint32_t csNumber = 0;
+        const auto nameSize = static_cast<uint16_t>(thread.name.size() + 1);
+
+        _data.write((const char*)&it.first, sizeof(it.first));
+        _data.write((const char*)&nameSize, sizeof(nameSize));
+        _data.write(thread.name.c_str(), nameSize);
+        _data.write((const char*)&csNumber, sizeof(csNumber));
+        _data.write((const char*)&thread.blocksNumber, sizeof(thread.blocksNumber));
+        _data.write(thread.data.data(), thread.data.size());
+    }
+
+    _data.write((const char*)&Signature, sizeof(Signature));
+
+    return true;
+}
+
 //////////////////////////////////////////////////////////////////////////
 
 void SocketListener::listenCapture()
@@ -532,8 +733,28 @@ void SocketListener::listenCapture()
             }
 
             case profiler::net::MessageType::Reply_Blocks:
+            case profiler::net::MessageType::Reply_Blocks_Compressed:
             {
-                qInfo() << "Receive MessageType::Reply_Blocks";
+                const bool packed = message->type == profiler::net::MessageType::Reply_Blocks_Compressed;
+                if (packed)
+                {
+                    qInfo() << "Receive MessageType::Reply_Blocks_Compressed";
+                    clearPackedData();
+                }
+                else
+                {
+                    qInfo() << "Receive MessageType::Reply_Blocks";
+                }
+
+                bool unpacked = true;
+                const auto receiveData = [&] (const char* _data, int _size)
+                {
+                    m_receivedSize += _size;
+                    if (!packed)
+                        m_receivedData.write(_data, _size);
+                    else if (unpacked)
+                        unpacked = appendPackedData(_data, static_cast<size_t>(_size));
+                };
 
                 while (bytes < sizeof(profiler::net::DataMessage))
                 {
@@ -579,8 +800,7 @@ void SocketListener::listenCapture()
                 if (bytesNumber > 0)
                 {
                     char* buf = buffer + seek;
-                    m_receivedSize += bytesNumber;
-                    m_receivedData.write(buf, bytesNumber);
+                    receiveData(buf, bytesNumber);
 
                     neededSize -= bytesNumber;
                     bytes -= bytesNumber;
@@ -604,8 +824,7 @@ void SocketListener::listenCapture()
                     }
 
                     const int toWrite = std::min(bytes, neededSize);
-                    m_receivedSize += toWrite;
-                    m_receivedData.write(buffer, toWrite);
+                    receiveData(buffer, toWrite);
 
                     neededSize -= toWrite;
                     bytes -= toWrite;
@@ -635,6 +854,12 @@ void SocketListener::listenCapture()
                     continue;
                 }
 
+                if (packed && !(unpacked && finishPackedData()))
+                {
+                    qWarning() << "Can not unpack compressed blocks";
+                    profiler_gui::clear_stream(m_receivedData);
+                }
+
                 if (m_bStopReceive.load(std::memory_order_acquire))
                 {
                     profiler::net::Message request(profiler::net::MessageType::Request_Stop_Capture);
@@ -1027,3 +1252,261 @@ void SocketListener::listenFrameTime()
         }
     }
 }
+
+bool SocketListener::receiveExactly(char* _buffer, size_t _size)
+{
+    size_t seek = 0;
+    while (seek < _size)
+    {
+        if (m_bInterrupt.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        const int bytes = m_easySocket.receive(_buffer + seek, _size - seek);
+        if (bytes < 1)
+        {
+            if (bytes == 0 || m_easySocket.isDisconnected())
+            {
+                m_bConnected.store(false, std::memory_order_release);
+                return false;
+            }
+
+            continue;
+        }
+
+        seek += static_cast<size_t>(bytes);
+    }
+
+    return true;
+}
+
+void SocketListener::listenStream()
+{
+    std::vector<char> buffer(std::max(sizeof(profiler::net::StreamFrameMessage),
+                                      sizeof(profiler::net::StreamingStartedMessage)));
+
+    bool isListen = true;
+    while (isListen && !m_bInterrupt.load(std::memory_order_acquire))
+    {
+        // There is no way to resynchronize with the stream of variable-length messages,
+        // so any receive error or unexpected message finishes streaming.
+
+        if (!receiveExactly(buffer.data(), sizeof(profiler::net::Message)))
+        {
+            break;
+        }
+
+        auto message = reinterpret_cast<const profiler::net::Message*>(buffer.data());
+        if (!message->isEasyNetMessage())
+        {
+            qWarning() << "Bad message in stream. Streaming stopped.";
+            break;
+        }
+
+        switch (message->type)
+        {
+            case profiler::net::MessageType::Reply_Streaming_Started:
+            {
+                qInfo() << "Receive MessageType::Reply_Streaming_Started";
+
+                EASY_CONSTEXPR auto size = sizeof(profiler::net::StreamingStartedMessage);
+                if (!receiveExactly(buffer.data() + sizeof(profiler::net::Message), size - sizeof(profiler::net::Message)))
+                {
+                    isListen = false;
+                    break;
+                }
+
+                auto reply = reinterpret_cast<const profiler::net::StreamingStartedMessage*>(buffer.data());
+
+                std::lock_guard<std::mutex> lock(m_streamMutex);
+                m_streamPid = reply->pid;
+                m_streamCpuFrequency = reply->cpuFrequency;
+                m_streamBeginTime = reply->beginTime;
+                m_streamEndTime = reply->beginTime;
+
+                break;
+            }
+
+            case profiler::net::MessageType::Reply_Stream_Frame:
+            {
+                EASY_CONSTEXPR auto size = sizeof(profiler::net::StreamFrameMessage);
+                if (!receiveExactly(buffer.data() + sizeof(profiler::net::Message), size - sizeof(profiler::net::Message)))
+                {
+                    isListen = false;
+                    break;
+                }
+
+                const auto frame = *reinterpret_cast<const profiler::net::StreamFrameMessage*>(buffer.data());
+                if (frame.sequence != m_streamSequence)
+                {
+                    qWarning() << "Stream frame" << frame.sequence << "received, expected" << m_streamSequence;
+                }
+
+                m_streamSequence = frame.sequence + 1;
+
+                std::vector<char> payload(frame.size);
+                if (!receiveExactly(payload.data(), payload.size()))
+                {
+                    isListen = false;
+                    break;
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(m_streamMutex);
+                    if (m_streamEndTime < frame.endTime)
+                    {
+                        m_streamEndTime = frame.endTime;
+                    }
+                }
+
+                if (!appendStreamFrame(payload.data(), payload.size()))
+                {
+                    qWarning() << "Bad stream frame" << frame.sequence << ". Streaming stopped.";
+                    isListen = false;
+                }
+
+                break;
+            }
+
+            case profiler::net::MessageType::Reply_Streaming_Stopped:
+            {
+                qInfo() << "Receive MessageType::Reply_Streaming_Stopped";
+                isListen = false;
+                break;
+            }
+
+            default:
+            {
+                qWarning() << "Unexpected message in stream. Streaming stopped.";
+                isListen = false;
+                break;
+            }
+        }
+    }
+
+    m_bStreamStopped.store(true, std::memory_order_release);
+}
+
+bool SocketListener::appendStreamFrame(const char* _data, size_t _size)
+{
+    // Payload format is described in profiler::net::StreamFrameMessage
+
+    size_t seek = 0;
+    const auto read = [&] (void* _dst, size_t _bytes) -> bool
+    {
+        if (seek + _bytes > _size)
+        {
+            return false;
+        }
+
+        memcpy(_dst, _data + seek, _bytes);
+        seek += _bytes;
+        return true;
+    };
+
+    // Returns size of a list of serialized elements each of which is: uint16_t size + data
+    const auto skipElements = [&] (uint32_t _number, size_t& _bytes) -> bool
+    {
+        const auto begin = seek;
+        for (uint32_t i = 0; i < _number; ++i)
+        {
+            uint16_t elementSize = 0;
+            if (!read(&elementSize, sizeof(elementSize)) || seek + elementSize > _size)
+            {
+                return false;
+            }
+
+            seek += elementSize;
+        }
+
+        _bytes = seek - begin;
+        return true;
+    };
+
+    std::lock_guard<std::mutex> lock(m_streamMutex);
+
+    uint32_t descriptorsNumber = 0;
+    uint64_t descriptorsMemorySize = 0;
+    size_t bytes = 0;
+
+    if (!read(&descriptorsNumber, sizeof(descriptorsNumber)) || !read(&descriptorsMemorySize, sizeof(descriptorsMemorySize)))
+    {
+        return false;
+    }
+
+    const auto descriptorsBegin = seek;
+    if (!skipElements(descriptorsNumber, bytes))
+    {
+        return false;
+    }
+
+    m_streamDescriptors.append(_data + descriptorsBegin, bytes);
+    m_streamDescriptorsNumber += descriptorsNumber;
+    m_streamDescriptorsMemorySize += descriptorsMemorySize;
+
+    uint32_t threadsNumber = 0;
+    if (!read(&threadsNumber, sizeof(threadsNumber)))
+    {
+        return false;
+    }
+
+    bool updated = false;
+    for (uint32_t i = 0; i < threadsNumber; ++i)
+    {
+        profiler::thread_id_t threadId = 0;
+        uint16_t nameSize = 0;
+        if (!read(&threadId, sizeof(threadId)) || !read(&nameSize, sizeof(nameSize)) || seek + nameSize > _size)
+        {
+            return false;
+        }
+
+        auto& thread = m_streamThreads[threadId];
+        if (nameSize > 1)
+        {
+            thread.name.assign(_data + seek, nameSize - 1);
+        }
+
+        seek += nameSize;
+
+        uint32_t blocksNumber = 0;
+        uint64_t memorySize = 0;
+        if (!read(&blocksNumber, sizeof(blocksNumber)) || !read(&memorySize, sizeof(memorySize)))
+        {
+            return false;
+        }
+
+        const auto blocksBegin = seek;
+        if (!skipElements(blocksNumber, bytes))
+        {
+            return false;
+        }
+
+        thread.data.append(_data + blocksBegin, bytes);
+        thread.blocksNumber += blocksNumber;
+        thread.memorySize += memorySize;
+        updated = updated || blocksNumber != 0;
+    }
+
+    if (updated)
+    {
+        m_bStreamUpdated.store(true, std::memory_order_release);
+    }
+
+    return true;
+}
+
+void SocketListener::clearStream()
+{
+    std::lock_guard<std::mutex> lock(m_streamMutex);
+    m_streamThreads.clear();
+    m_streamDescriptors.clear();
+    m_streamDescriptorsMemorySize = 0;
+    m_streamDescriptorsNumber = 0;
+    m_streamPid = 0;
+    m_streamCpuFrequency = 0;
+    m_streamBeginTime = 0;
+    m_streamEndTime = 0;
+    m_streamSequence = 0;
+    m_bStreamUpdated.store(false, std::memory_order_release);
+}
@@ -44,15 +44,17 @@ The Apache License, Version 2.0 (the "License");
 #define EASY_PROFILER_SOCKET_LISTENER_H
 
 #include <atomic>
+#include <map>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <thread>
 
 #include <QObject>
 
+#include <easy/easy_net.h>
 #include <easy/easy_socket.h>
-
-namespace profiler { namespace net { struct EasyProfilerStatus; } }
+#include <easy/details/profiler_public_types.h>
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -61,7 +63,16 @@ enum class ListenerRegime : uint8_t
     Idle = 0,
     Capture,
     Capture_Receive,
-    Descriptors
+    Descriptors,
+    Streaming
+};
+
+struct StreamedThread
+{
+    std::string        name; ///< Thread name
+    std::string        data; ///< Serialized blocks of all received frames
+    uint64_t memorySize = 0; ///< Used memory size of blocks (as in .prof file header)
+    uint32_t blocksNumber = 0; ///< Number of blocks in data
 };
 
 class SocketListener Q_DECL_FINAL
@@ -81,6 +92,25 @@ class SocketListener Q_DECL_FINAL
     std::atomic_bool m_bFrameTimeReady; ///<
     ListenerRegime            m_regime; ///<
 
+    std::map<profiler::thread_id_t, StreamedThread> m_streamThreads; ///< Streamed blocks of each thread
+    std::string                               m_streamDescriptors; ///< Serialized descriptors received during streaming
+    std::mutex                                    m_streamMutex; ///< Guards all m_stream* members
+    uint64_t                   m_streamDescriptorsMemorySize = 0; ///<
+    uint64_t                                   m_streamPid = 0; ///<
+    int64_t                           m_streamCpuFrequency = 0; ///<
+    profiler::timestamp_t               m_streamBeginTime = 0; ///<
+    profiler::timestamp_t                 m_streamEndTime = 0; ///<
+    uint32_t                  m_streamDescriptorsNumber = 0; ///<
+    uint32_t                              m_streamSequence = 0; ///< Expected sequence number of the next stream frame
+    std::atomic_bool                          m_bStreamUpdated; ///< New stream frames with blocks have been received
+    std::atomic_bool                          m_bStreamStopped; ///< Reply_Streaming_Stopped has been received (or connection has been lost)
+
+    std::string                                      m_packedData; ///< Received part of Reply_Blocks_Compressed payload which is not unpacked yet
+    std::string                                    m_unpackedData; ///< Unpacked Reply_Blocks_Compressed payload
+    profiler::net::CompressedDataHeader            m_packedHeader; ///<
+    bool                                 m_bPackedHeaderReady = false; ///<
+    bool                                       m_bCompression = false; ///< Request compressed captures on connect
+
 public:
 
     SocketListener();
@@ -100,6 +130,7 @@ public:
     void closeSocket();
     bool connect(const char* _ipaddress, uint16_t _port, profiler::net::EasyProfilerStatus& _reply, bool _disconnectFirst = false);
     bool reconnect(const char* _ipaddress, uint16_t _port, profiler::net::EasyProfilerStatus& _reply);
+    void setCompressionEnabled(bool _enabled);
 
     bool startCapture();
     void stopCapture();
@@ -109,6 +140,13 @@ public:
     bool frameTime(uint32_t& _maxTime, uint32_t& _avgTime);
     bool requestFrameTime();
 
+    bool startStreaming(uint32_t _intervalMs);
+    void stopStreaming();
+    void finalizeStreaming();
+    bool streamUpdated();
+    bool streamStopped() const;
+    bool streamSnapshot(std::stringstream& _data);
+
     template <class T>
     void send(const T& _message) {
         m_easySocket.send(&_message, sizeof(T));
@@ -119,6 +157,15 @@ private:
     void listenCapture();
     void listenDescription();
     void listenFrameTime();
+    void listenStream();
+
+    bool receiveExactly(char* _buffer, size_t _size);
+    bool appendStreamFrame(const char* _data, size_t _size);
+    void clearStream();
+
+    void clearPackedData();
+    bool appendPackedData(const char* _data, size_t _size);
+    bool finishPackedData();
 
 }; // END of class SocketListener.
 
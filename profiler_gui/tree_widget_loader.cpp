@@ -224,6 +224,7 @@ TreeWidgetLoader::TreeWidgetLoader()
     , m_bInterrupt(EASY_INIT_ATOMIC(false))
     , m_progress(EASY_INIT_ATOMIC(0))
     , m_mode(TreeMode::Full)
+    , m_blockOverhead(0)
 {
 }
 
@@ -248,6 +249,12 @@ void TreeWidgetLoader::setProgress(int _progress)
     m_progress.store(_progress, std::memory_order_release);
 }
 
+profiler::timestamp_t TreeWidgetLoader::correctedDuration(const profiler::BlocksTree& _tree, profiler::timestamp_t _duration) const
+{
+    const auto overhead = m_blockOverhead * _tree.descendants;
+    return _duration > overhead ? _duration - overhead : 0;
+}
+
 bool TreeWidgetLoader::interrupted() const volatile
 {
     return m_bInterrupt.load(std::memory_order_acquire);
@@ -325,6 +332,7 @@ void TreeWidgetLoader::fillTreeBlocks(
 ) {
     interrupt();
     m_mode = _mode;
+    m_blockOverhead = EASY_GLOBALS.compensate_block_overhead ? EASY_GLOBALS.block_overhead : 0;
 
     const auto zeroBlocks = EASY_GLOBALS.add_zero_blocks_to_hierarchy;
     const auto decoratedNames = EASY_GLOBALS.use_decorated_thread_name;
@@ -476,10 +484,10 @@ void TreeWidgetLoader::setTreeInternalTop(
             continue;
         }
 
-        const profiler::timestamp_t duration = endTime - startTime;
+        const profiler::timestamp_t duration = correctedDuration(tree, endTime - startTime);
 
         const bool partial = _strict && (startTime < _left || endTime > _right);
-        if (partial && duration != 0 && (startTime == _right || endTime == _left))
+        if (partial && startTime != endTime && (startTime == _right || endTime == _left))
         {
             setProgress(3 + (92 * ++i) / total);
             continue;
@@ -676,10 +684,10 @@ void TreeWidgetLoader::setTreeInternalPlainTop(
             continue;
         }
 
-        const profiler::timestamp_t duration = endTime - startTime;
+        const profiler::timestamp_t duration = correctedDuration(tree, endTime - startTime);
 
         const bool partial = _strict && (startTime < _left || endTime > _right);
-        if (partial && duration != 0 && (startTime == _right || endTime == _left))
+        if (partial && startTime != endTime && (startTime == _right || endTime == _left))
         {
             setProgress((95 * ++i) / total);
             continue;
@@ -939,10 +947,10 @@ void TreeWidgetLoader::setTreeInternalAggregateTop(
             continue;
         }
 
-        const profiler::timestamp_t duration = endTime - startTime;
+        const profiler::timestamp_t duration = correctedDuration(tree, endTime - startTime);
 
         const bool partial = _strict && (startTime < _left || endTime > _right);
-        if (partial && duration != 0 && (startTime == _right || endTime == _left))
+        if (partial && startTime != endTime && (startTime == _right || endTime == _left))
         {
             setProgress((95 * ++i) / total);
             continue;
@@ -1177,13 +1185,13 @@ size_t TreeWidgetLoader::setTreeInternal(
         const auto& child = gui_block.tree;
         const auto startTime = child.node->begin();
         const auto endTime = child.node->end();
-        const auto duration = endTime - startTime;
+        const auto duration = correctedDuration(child, endTime - startTime);
 
         if (startTime > right || endTime < left)
             continue;
 
         const bool partial = strict && (startTime < left || endTime > right);
-        if (partial && partial_parent && duration != 0 && (startTime == right || endTime == left))
+        if (partial && partial_parent && startTime != endTime && (startTime == right || endTime == left))
             continue;
 
         const auto& desc = easyDescriptor(child.node->id());
@@ -1409,13 +1417,13 @@ size_t TreeWidgetLoader::setTreeInternalPlain(
         const auto& child = gui_block.tree;
         const auto startTime = child.node->begin();
         const auto endTime = child.node->end();
-        const auto duration = endTime - startTime;
+        const auto duration = correctedDuration(child, endTime - startTime);
 
         if (startTime > right || endTime < left)
             continue;
 
         const bool partial = strict && (startTime < left || endTime > right);
-        if (partial && partial_parent && duration != 0 && (startTime == right || endTime == left))
+        if (partial && partial_parent && startTime != endTime && (startTime == right || endTime == left))
             continue;
 
         const auto& desc = easyDescriptor(child.node->id());
@@ -1590,13 +1598,13 @@ size_t TreeWidgetLoader::setTreeInternalAggregate(
         const auto& child = gui_block.tree;
         const auto startTime = child.node->begin();
         const auto endTime = child.node->end();
-        const auto duration = endTime - startTime;
+        const auto duration = correctedDuration(child, endTime - startTime);
 
         if (startTime > right || endTime < left)
             continue;
 
         const bool partial = strict && (startTime < left || endTime > right);
-        if (partial && partial_parent && duration != 0 && (startTime == right || endTime == left))
+        if (partial && partial_parent && startTime != endTime && (startTime == right || endTime == left))
             continue;
 
         const auto& desc = easyDescriptor(child.node->id());
@@ -111,6 +111,7 @@ class TreeWidgetLoader Q_DECL_FINAL
     std::atomic_bool   m_bInterrupt; ///<
     std::atomic<int>     m_progress; ///<
     TreeMode                 m_mode; ///<
+    profiler::timestamp_t m_blockOverhead; ///< Overhead of one nested block subtracted from durations (0 if compensation is disabled)
 
 public:
 
@@ -139,6 +140,7 @@ private:
     bool interrupted() const volatile;
     void setDone();
     void setProgress(int _progress);
+    profiler::timestamp_t correctedDuration(const profiler::BlocksTree& _tree, profiler::timestamp_t _duration) const;
 
     void setTreeInternalTop(
         const profiler::timestamp_t& _beginTime,
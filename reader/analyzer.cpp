@@ -0,0 +1,375 @@
+/**
+Lightweight profiler library for c++
+Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+
+Licensed under either of
+	* MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+    * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+at your option.
+
+The MIT License
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+	of the Software, and to permit persons to whom the Software is furnished
+	to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+	PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+	LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+	USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+The Apache License, Version 2.0 (the "License");
+	You may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+**/
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <regex>
+#include <thread>
+#include <unordered_map>
+#include <easy/serialized_block.h>
+#include "analyzer.h"
+
+namespace {
+
+/** Matches thread by id (if filter is a number) or by name regular expression. */
+class ThreadMatcher EASY_FINAL
+{
+    std::regex           m_regex;
+    profiler::thread_id_t   m_id;
+    bool                 m_empty;
+    bool                  m_byId;
+
+public:
+
+    explicit ThreadMatcher(const std::string& _filter)
+        : m_id(0)
+        , m_empty(_filter.empty())
+        , m_byId(!_filter.empty() && std::all_of(_filter.begin(), _filter.end(), [](char c) { return c >= '0' && c <= '9'; }))
+    {
+        if (m_byId)
+            m_id = std::stoull(_filter);
+        else if (!m_empty)
+            m_regex = std::regex(_filter);
+    }
+
+    bool empty() const
+    {
+        return m_empty;
+    }
+
+    bool matches(const profiler::BlocksTreeRoot& _thread) const
+    {
+        if (m_empty)
+            return true;
+        if (m_byId)
+            return _thread.thread_id == m_id;
+        return std::regex_search(_thread.thread_name, m_regex);
+    }
+};
+
+struct DescriptorDurations EASY_FINAL
+{
+    std::vector<uint64_t> durations;
+    const char*                name = nullptr;
+    uint64_t               selfTime = 0;
+};
+
+using descriptor_durations_t = std::unordered_map<profiler::block_id_t, DescriptorDurations>;
+
+class ThreadAnalyzer EASY_FINAL
+{
+    const profiler::blocks_t&               m_blocks;
+    const profiler::descriptors_list_t& m_descriptors;
+    const AnalyzerOptions&                  m_options;
+    const std::regex*                     m_nameRegex;
+    std::vector<char>                     m_nameMatch; ///< For each descriptor: 0 - not checked yet, 1 - matches, 2 - does not match
+
+public:
+
+    ThreadSummary                  summary;
+    descriptor_durations_t     descriptors;
+    std::vector<uint64_t>           frames;
+
+    ThreadAnalyzer(const profiler::blocks_t& _blocks, const profiler::descriptors_list_t& _descriptors,
+                   const AnalyzerOptions& _options, const std::regex* _nameRegex)
+        : m_blocks(_blocks)
+        , m_descriptors(_descriptors)
+        , m_options(_options)
+        , m_nameRegex(_nameRegex)
+        , m_nameMatch(_nameRegex != nullptr ? _descriptors.size() : 0, 0)
+    {
+    }
+
+    void analyze(const profiler::BlocksTreeRoot& _thread, bool _frames)
+    {
+        summary.name = _thread.thread_name;
+        summary.id = _thread.thread_id;
+
+        bool first = true;
+        for (auto i : _thread.children)
+        {
+            const auto& block = m_blocks[i];
+            if (!counted(block) || !overlapsWindow(block))
+                continue;
+
+            // Thread activity is clipped by the time window
+            const auto begin = std::max(block.node->begin(), m_options.beginTime);
+            const auto end = std::min(block.node->end(), m_options.endTime);
+            if (first)
+            {
+                summary.begin = begin;
+                first = false;
+            }
+
+            summary.end = std::max(summary.end, end);
+            summary.blockTime += end - begin;
+            if (_frames && beginsInWindow(block))
+                frames.push_back(block.node->duration());
+
+            collect(block);
+        }
+
+        if (first)
+            return;
+
+        // Wait time is counted only within the active span of the thread
+        for (auto i : _thread.sync)
+        {
+            const auto cs = m_blocks[i].cs;
+            const auto begin = std::max(cs->begin(), summary.begin);
+            const auto end = std::min(cs->end(), summary.end);
+            if (begin < end)
+            {
+                summary.waitTime += end - begin;
+                ++summary.contextSwitches;
+            }
+        }
+    }
+
+private:
+
+    bool counted(const profiler::BlocksTree& _block) const
+    {
+        const auto type = m_descriptors[_block.node->id()]->type();
+        return type == profiler::BlockType::Block || type == profiler::BlockType::Lock;
+    }
+
+    bool beginsInWindow(const profiler::BlocksTree& _block) const
+    {
+        const auto begin = _block.node->begin();
+        return begin >= m_options.beginTime && begin <= m_options.endTime;
+    }
+
+    bool overlapsWindow(const profiler::BlocksTree& _block) const
+    {
+        return _block.node->begin() <= m_options.endTime && _block.node->end() >= m_options.beginTime;
+    }
+
+    const char* name(const profiler::BlocksTree& _block) const
+    {
+        const char* name = _block.node->name();
+        return *name != 0 ? name : m_descriptors[_block.node->id()]->name();
+    }
+
+    bool nameMatches(const profiler::BlocksTree& _block)
+    {
+        if (m_nameRegex == nullptr)
+            return true;
+
+        // Blocks with different names always have different descriptor ids
+        auto& match = m_nameMatch[_block.node->id()];
+        if (match == 0)
+            match = std::regex_search(name(_block), *m_nameRegex) ? 1 : 2;
+
+        return match == 1;
+    }
+
+    void collect(const profiler::BlocksTree& _block)
+    {
+        const auto duration = _block.node->duration();
+
+        uint64_t childrenDuration = 0;
+        for (auto i : _block.children)
+        {
+            const auto& child = m_blocks[i];
+            if (!counted(child))
+                continue;
+
+            childrenDuration += child.node->duration();
+            if (overlapsWindow(child))
+                collect(child);
+        }
+
+        if (!beginsInWindow(_block))
+            return;
+
+        ++summary.blocks;
+        if (!nameMatches(_block))
+            return;
+
+        auto& stats = descriptors[_block.node->id()];
+        if (stats.name == nullptr)
+            stats.name = name(_block);
+
+        stats.durations.push_back(duration);
+        stats.selfTime += duration > childrenDuration ? duration - childrenDuration : 0;
+    }
+
+}; // end of class ThreadAnalyzer.
+
+uint64_t percentile(const std::vector<uint64_t>& _sorted, uint64_t _percent)
+{
+    const auto n = static_cast<uint64_t>(_sorted.size());
+    const auto rank = (_percent * n + 99) / 100;
+    return _sorted[static_cast<size_t>(rank != 0 ? rank - 1 : 0)];
+}
+
+/** Calls _job for every index in [0, _count) using all hardware threads. */
+void parallelFor(size_t _count, const std::function<void(size_t)>& _job)
+{
+    std::atomic<size_t> next(0);
+    auto work = [&]
+    {
+        for (auto i = next++; i < _count; i = next++)
+            _job(i);
+    };
+
+    std::vector<std::thread> workers;
+    const size_t workersNumber = std::min(static_cast<size_t>(std::thread::hardware_concurrency()), _count);
+    for (size_t i = 1; i < workersNumber; ++i)
+        workers.emplace_back(work);
+    work();
+    for (auto& worker : workers)
+        worker.join();
+}
+
+} // END of namespace <noname>.
+
+void DurationStats::fill(std::vector<uint64_t>& _durations)
+{
+    *this = DurationStats();
+    if (_durations.empty())
+        return;
+
+    std::sort(_durations.begin(), _durations.end());
+
+    count = _durations.size();
+    for (auto duration : _durations)
+        total += duration;
+
+    min = _durations.front();
+    max = _durations.back();
+    p50 = percentile(_durations, 50);
+    p90 = percentile(_durations, 90);
+    p99 = percentile(_durations, 99);
+}
+
+AnalysisResult analyze(const profiler::blocks_t& _blocks, const profiler::thread_blocks_tree_t& _trees,
+                       const profiler::descriptors_list_t& _descriptors, const AnalyzerOptions& _options)
+{
+    const ThreadMatcher threadMatcher(_options.threadFilter);
+    const ThreadMatcher frameMatcher(_options.frameThread.empty() ? std::string("^Main$") : _options.frameThread);
+
+    std::regex nameRegex;
+    if (!_options.nameFilter.empty())
+        nameRegex = std::regex(_options.nameFilter);
+
+    std::vector<const profiler::BlocksTreeRoot*> threads;
+    for (const auto& kv : _trees)
+    {
+        if (threadMatcher.matches(kv.second))
+            threads.push_back(&kv.second);
+    }
+
+    std::sort(threads.begin(), threads.end(), [](const profiler::BlocksTreeRoot* a, const profiler::BlocksTreeRoot* b) {
+        return a->thread_id < b->thread_id;
+    });
+
+    const auto frameThread = std::find_if(threads.begin(), threads.end(), [&](const profiler::BlocksTreeRoot* thread) {
+        return frameMatcher.matches(*thread);
+    });
+
+    std::vector<ThreadAnalyzer> analyzers;
+    analyzers.reserve(threads.size());
+    for (size_t i = 0; i < threads.size(); ++i)
+        analyzers.emplace_back(_blocks, _descriptors, _options, _options.nameFilter.empty() ? nullptr : &nameRegex);
+
+    parallelFor(threads.size(), [&](size_t i) {
+        analyzers[i].analyze(*threads[i], threads.begin() + i == frameThread);
+    });
+
+    AnalysisResult result;
+
+    descriptor_durations_t descriptors;
+    for (auto& analyzer : analyzers)
+    {
+        result.threads.push_back(std::move(analyzer.summary));
+
+        for (auto& kv : analyzer.descriptors)
+        {
+            auto& stats = descriptors[kv.first];
+            if (stats.name == nullptr)
+                stats.name = kv.second.name;
+            stats.selfTime += kv.second.selfTime;
+            stats.durations.insert(stats.durations.end(), kv.second.durations.begin(), kv.second.durations.end());
+            std::vector<uint64_t>().swap(kv.second.durations);
+        }
+
+        if (!analyzer.frames.empty())
+        {
+            auto& frames = result.frames;
+            frames.thread = result.threads.back().name;
+            frames.durations.fill(analyzer.frames);
+
+            if (_options.histogramBins != 0)
+            {
+                frames.binWidth = (frames.durations.max - frames.durations.min) / _options.histogramBins + 1;
+                frames.histogram.assign(_options.histogramBins, 0);
+                for (auto duration : analyzer.frames)
+                    ++frames.histogram[static_cast<size_t>((duration - frames.durations.min) / frames.binWidth)];
+            }
+        }
+    }
+
+    std::vector<DescriptorDurations*> merged;
+    merged.reserve(descriptors.size());
+    result.descriptors.resize(descriptors.size());
+    for (auto& kv : descriptors)
+    {
+        auto& summary = result.descriptors[merged.size()];
+        summary.name = kv.second.name;
+        summary.id = kv.first;
+        summary.selfTime = kv.second.selfTime;
+        merged.push_back(&kv.second);
+    }
+
+    parallelFor(merged.size(), [&](size_t i) {
+        result.descriptors[i].durations.fill(merged[i]->durations);
+    });
+
+    std::sort(result.descriptors.begin(), result.descriptors.end(), [](const DescriptorSummary& a, const DescriptorSummary& b) {
+        return a.durations.total > b.durations.total || (a.durations.total == b.durations.total && a.id < b.id);
+    });
+
+    return result;
+}
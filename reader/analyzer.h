@@ -0,0 +1,134 @@
+/**
+Lightweight profiler library for c++
+Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+
+Licensed under either of
+	* MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+    * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+at your option.
+
+The MIT License
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+	of the Software, and to permit persons to whom the Software is furnished
+	to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+	PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+	LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+	USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+The Apache License, Version 2.0 (the "License");
+	You may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+**/
+
+#ifndef EASY_PROFILER_READER_ANALYZER_H
+#define EASY_PROFILER_READER_ANALYZER_H
+
+#include <stdint.h>
+#include <limits>
+#include <string>
+#include <vector>
+#include <easy/reader.h>
+
+/** Filters of analyzed data. Empty filter matches everything. */
+struct AnalyzerOptions EASY_FINAL
+{
+    std::string          threadFilter; ///< Thread id or regular expression matched against thread name
+    std::string            nameFilter; ///< Regular expression matched against block name (top-N list only)
+    std::string           frameThread; ///< Thread id or name regex of frames thread ("Main" thread by default)
+    profiler::timestamp_t   beginTime = 0; ///< Blocks which begin before this time (ns) are not counted
+    profiler::timestamp_t endTime = std::numeric_limits<profiler::timestamp_t>::max(); ///< Blocks which begin after this time (ns) are not counted
+    uint32_t         histogramBins = 10; ///< Number of bins in frame time histogram
+};
+
+/** Distribution of durations (ns). Percentiles are nearest-rank. */
+struct DurationStats EASY_FINAL
+{
+    uint64_t  count = 0;
+    uint64_t  total = 0;
+    uint64_t    min = 0;
+    uint64_t    max = 0;
+    uint64_t    p50 = 0;
+    uint64_t    p90 = 0;
+    uint64_t    p99 = 0;
+
+    uint64_t average() const {
+        return count != 0 ? total / count : 0;
+    }
+
+    /** Fills stats from durations (durations are sorted). */
+    void fill(std::vector<uint64_t>& _durations);
+};
+
+struct DescriptorSummary EASY_FINAL
+{
+    std::string            name;
+    profiler::block_id_t     id = 0; ///< Descriptor id (blocks with the same run-time name have the same id)
+    uint64_t           selfTime = 0; ///< Total duration minus duration of children (ns)
+    DurationStats     durations;
+};
+
+/** Thread activity within the time window. Wait time is the time when thread has been switched out. */
+struct ThreadSummary EASY_FINAL
+{
+    std::string                name;
+    profiler::thread_id_t        id = 0;
+    uint64_t                 blocks = 0; ///< Number of analyzed blocks (all levels)
+    profiler::timestamp_t     begin = 0; ///< Begin of the first top-level block (clipped by time window)
+    profiler::timestamp_t       end = 0; ///< End of the last top-level block (clipped by time window)
+    uint64_t              blockTime = 0; ///< Total duration of top-level blocks within time window
+    uint64_t               waitTime = 0; ///< Duration of context switches within [begin, end]
+    uint64_t       contextSwitches = 0; ///< Number of context switches within [begin, end]
+
+    uint64_t span() const {
+        return end - begin;
+    }
+
+    uint64_t busyTime() const {
+        return span() > waitTime ? span() - waitTime : 0;
+    }
+};
+
+struct FrameSummary EASY_FINAL
+{
+    std::string                  thread; ///< Name of frames thread (empty if there is no such thread)
+    DurationStats             durations;
+    uint64_t                   binWidth = 0; ///< Width of histogram bin (ns), the first bin begins at durations.min
+    std::vector<uint64_t>     histogram; ///< Number of frames in each bin
+};
+
+struct AnalysisResult EASY_FINAL
+{
+    std::vector<ThreadSummary>         threads; ///< Threads sorted by id
+    std::vector<DescriptorSummary> descriptors; ///< Descriptors sorted by total time (descending)
+    FrameSummary                        frames;
+};
+
+/** Gathers per-descriptor, per-thread and frame statistics from loaded blocks.
+
+Threads are analyzed in parallel. Only blocks of BlockType::Block and BlockType::Lock are counted.
+\throws std::regex_error if filter is not a valid regular expression.
+*/
+AnalysisResult analyze(const profiler::blocks_t& _blocks, const profiler::thread_blocks_tree_t& _trees,
+                       const profiler::descriptors_list_t& _descriptors, const AnalyzerOptions& _options);
+
+#endif // EASY_PROFILER_READER_ANALYZER_H
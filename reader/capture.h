@@ -0,0 +1,83 @@
+/**
+Lightweight profiler library for c++
+Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+
+Licensed under either of
+	* MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+    * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+at your option.
+
+The MIT License
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+	of the Software, and to permit persons to whom the Software is furnished
+	to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+	PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+	LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+	USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+The Apache License, Version 2.0 (the "License");
+	You may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+**/
+
+#ifndef EASY_PROFILER_READER_CAPTURE_H
+#define EASY_PROFILER_READER_CAPTURE_H
+
+#include <ostream>
+#include <string>
+#include <easy/reader.h>
+
+/** Loaded .prof file. */
+struct Capture EASY_FINAL
+{
+    profiler::SerializedData      serializedBlocks;
+    profiler::SerializedData serializedDescriptors;
+    profiler::descriptors_list_t       descriptors;
+    profiler::blocks_t                      blocks;
+    profiler::thread_blocks_tree_t           trees;
+    profiler::bookmarks_t                bookmarks;
+    profiler::BeginEndTime            beginEndTime;
+    profiler::block_index_t           blocksNumber = 0;
+    uint32_t                     descriptorsNumber = 0;
+    uint32_t                               version = 0;
+    profiler::processid_t                      pid = 0;
+    profiler::timestamp_t            blockOverhead = 0;
+
+    /** Loads file without statistics of the GUI. Returns false and writes reason into _log on error. */
+    bool load(const std::string& _filename, std::ostream& _log)
+    {
+        blocksNumber = fillTreesFromFile(_filename.c_str(), beginEndTime, serializedBlocks, serializedDescriptors,
+                                         descriptors, blocks, trees, bookmarks, descriptorsNumber, version, pid,
+                                         blockOverhead, false, _log);
+        return blocksNumber != 0;
+    }
+
+    profiler::block_getter_fn blockGetter() const
+    {
+        return [this](profiler::block_index_t i) -> const profiler::BlocksTree& {
+            return blocks[i];
+        };
+    }
+};
+
+#endif // EASY_PROFILER_READER_CAPTURE_H
@@ -0,0 +1,291 @@
+/**
+Lightweight profiler library for c++
+Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+
+Licensed under either of
+	* MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+    * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+at your option.
+
+The MIT License
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+	of the Software, and to permit persons to whom the Software is furnished
+	to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+	PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+	LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+	USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+The Apache License, Version 2.0 (the "License");
+	You may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+**/
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <regex>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include "capture.h"
+#include "diff_report.h"
+#include "report_format.h"
+
+namespace {
+
+using entries_t = std::vector<const profiler::DiffEntry*>;
+
+std::string pathName(const profiler::ProfileDiff& _diff, const profiler::DiffEntry& _entry)
+{
+    std::string name;
+    for (auto frame : _entry.path)
+    {
+        if (!name.empty())
+            name += " > ";
+        name += _diff.frames[frame].name;
+    }
+    return name;
+}
+
+bool regressed(const profiler::DiffEntry& _entry)
+{
+    return _entry.significant && _entry.current.total > _entry.baseline.total;
+}
+
+entries_t select(const profiler::ProfileDiff& _diff, const std::vector<profiler::DiffEntry>& _entries,
+                 const std::regex* _threadRegex, const std::regex* _nameRegex, size_t _top)
+{
+    entries_t selected;
+    for (const auto& entry : _entries)
+    {
+        if (!entry.significant)
+            continue;
+
+        const auto& first = _diff.frames[entry.path.front()];
+        if (_threadRegex != nullptr && first.thread && !std::regex_search(first.name, *_threadRegex))
+            continue;
+
+        if (_nameRegex != nullptr && !std::regex_search(_diff.frames[entry.path.back()].name, *_nameRegex))
+            continue;
+
+        selected.push_back(&entry);
+        if (selected.size() == _top)
+            break;
+    }
+
+    return selected;
+}
+
+std::string change(const profiler::DiffEntry& _entry)
+{
+    if (_entry.baseline.count == 0)
+        return "new";
+    if (_entry.current.count == 0)
+        return "removed";
+    if (_entry.baseline.total == 0)
+        return "-";
+
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%+.1f%%", 100. * (static_cast<double>(_entry.current.total) - static_cast<double>(_entry.baseline.total))
+                                                / static_cast<double>(_entry.baseline.total));
+    return buffer;
+}
+
+std::string delta(profiler::timestamp_t _baseline, profiler::timestamp_t _current)
+{
+    return _current >= _baseline ? "+" + us(_current - _baseline) : "-" + us(_baseline - _current);
+}
+
+void printEntries(const profiler::ProfileDiff& _diff, const entries_t& _entries)
+{
+    std::vector<std::string> names;
+    names.reserve(_entries.size());
+
+    size_t width = 4;
+    for (auto entry : _entries)
+    {
+        names.push_back(pathName(_diff, *entry));
+        width = std::max(width, names.back().size());
+    }
+
+    char buffer[512];
+    snprintf(buffer, sizeof(buffer), "  %-*s %10s %10s %14s %14s %14s %9s %14s %12s %12s", static_cast<int>(width), "Name",
+             "Calls", "Calls'", "Total", "Total'", "Delta", "Change", "Self delta", "P99", "P99'");
+    std::cout << buffer << std::endl;
+
+    for (size_t i = 0; i < _entries.size(); ++i)
+    {
+        const auto& entry = *_entries[i];
+        const auto& a = entry.baseline;
+        const auto& b = entry.current;
+        std::cout << "  " << names[i] << std::string(width - names[i].size(), ' ');
+        snprintf(buffer, sizeof(buffer), " %10llu %10llu %14s %14s %14s %9s %14s %12s %12s",
+                 static_cast<unsigned long long>(a.count), static_cast<unsigned long long>(b.count),
+                 us(a.total).c_str(), us(b.total).c_str(), delta(a.total, b.total).c_str(), change(entry).c_str(),
+                 delta(a.self, b.self).c_str(), us(a.p99).c_str(), us(b.p99).c_str());
+        std::cout << buffer << std::endl;
+    }
+}
+
+void writeJsonStats(std::ostream& _output, const profiler::DiffStats& _stats)
+{
+    _output << "{\"count\": " << _stats.count << ", \"total\": " << _stats.total << ", \"self\": " << _stats.self
+            << ", \"p50\": " << _stats.p50 << ", \"p99\": " << _stats.p99 << ", \"max\": " << _stats.max << "}";
+}
+
+void writeJsonEntries(std::ostream& _output, const profiler::ProfileDiff& _diff, const entries_t& _entries, bool _paths)
+{
+    const char* separator = "\n";
+    for (auto entry : _entries)
+    {
+        _output << separator << "    {";
+        if (_paths)
+        {
+            _output << "\"path\": [";
+            for (size_t i = 0; i < entry->path.size(); ++i)
+            {
+                if (i != 0)
+                    _output << ", ";
+                writeJsonString(_output, _diff.frames[entry->path[i]].name);
+            }
+            _output << "]";
+        }
+        else
+        {
+            const auto& frame = _diff.frames[entry->path.back()];
+            _output << "\"name\": ";
+            writeJsonString(_output, frame.name);
+            _output << ", \"file\": ";
+            writeJsonString(_output, frame.file);
+            _output << ", \"line\": " << frame.line;
+        }
+
+        _output << ", \"baseline\": ";
+        writeJsonStats(_output, entry->baseline);
+        _output << ", \"current\": ";
+        writeJsonStats(_output, entry->current);
+        _output << "}";
+        separator = ",\n";
+    }
+}
+
+// All times are in nanoseconds
+void writeJson(std::ostream& _output, const DiffReportOptions& _options, const Capture& _baseline, const Capture& _current,
+               const profiler::ProfileDiff& _diff, const entries_t& _blocks, const entries_t& _paths, size_t _regressions)
+{
+    _output << "{\n  \"baseline\": {\"file\": ";
+    writeJsonString(_output, _options.baselineFilename);
+    _output << ", \"blocks\": " << _baseline.blocksNumber << "},\n  \"current\": {\"file\": ";
+    writeJsonString(_output, _options.currentFilename);
+    _output << ", \"blocks\": " << _current.blocksNumber << "},\n  \"relative_threshold\": " << _options.diff.relative_threshold
+            << ",\n  \"absolute_threshold\": " << _options.diff.absolute_threshold << ",\n  \"regressions\": " << _regressions
+            << ",\n  \"blocks\": [";
+    writeJsonEntries(_output, _diff, _blocks, false);
+    _output << "\n  ],\n  \"call_paths\": [";
+    writeJsonEntries(_output, _diff, _paths, true);
+    _output << "\n  ]\n}\n";
+}
+
+} // END of namespace <noname>.
+
+int runDiff(const DiffReportOptions& _options)
+{
+    std::regex threadRegex, nameRegex;
+    try
+    {
+        if (!_options.threadFilter.empty())
+            threadRegex = std::regex(_options.threadFilter);
+        if (!_options.nameFilter.empty())
+            nameRegex = std::regex(_options.nameFilter);
+    }
+    catch (const std::regex_error& error)
+    {
+        std::cerr << "Invalid regular expression: " << error.what() << std::endl;
+        return 1;
+    }
+
+    Capture baseline, current;
+    std::stringstream baselineLog, currentLog;
+    bool baselineLoaded = false;
+
+    std::thread baselineThread([&] { baselineLoaded = baseline.load(_options.baselineFilename, baselineLog); });
+    const bool currentLoaded = current.load(_options.currentFilename, currentLog);
+    baselineThread.join();
+
+    if (!baselineLoaded || !currentLoaded)
+    {
+        if (!baselineLoaded)
+            std::cerr << "Can not read blocks from file " << _options.baselineFilename << "\nReason: " << baselineLog.str() << std::endl;
+        if (!currentLoaded)
+            std::cerr << "Can not read blocks from file " << _options.currentFilename << "\nReason: " << currentLog.str() << std::endl;
+        return 1;
+    }
+
+    profiler::ProfileDiff diff;
+    fillProfileDiff(baseline.trees, baseline.descriptors, baseline.blockGetter(),
+                    current.trees, current.descriptors, current.blockGetter(), _options.diff, diff);
+
+    const auto threadFilter = _options.threadFilter.empty() ? nullptr : &threadRegex;
+    const auto nameFilter = _options.nameFilter.empty() ? nullptr : &nameRegex;
+
+    size_t regressions = 0;
+    for (auto entry : select(diff, diff.blocks, nullptr, nameFilter, 0))
+        regressions += regressed(*entry) ? 1 : 0;
+
+    const auto blocks = select(diff, diff.blocks, nullptr, nameFilter, _options.top);
+    const auto paths = select(diff, diff.call_paths, threadFilter, nameFilter, _options.top);
+
+    if (_options.jsonFilename.empty())
+    {
+        std::cout << "Baseline: " << _options.baselineFilename << " (" << baseline.blocksNumber << " blocks), current: "
+                  << _options.currentFilename << " (" << current.blocksNumber << " blocks)" << std::endl;
+        std::cout << "Significant changes: at least " << _options.diff.relative_threshold * 100. << "% and "
+                  << us(_options.diff.absolute_threshold) << " us (times in us, ' - current capture)" << std::endl;
+
+        std::cout << "Blocks (" << regressions << " regressed):" << std::endl;
+        printEntries(diff, blocks);
+
+        if (_options.diff.call_paths)
+        {
+            std::cout << "Call paths:" << std::endl;
+            printEntries(diff, paths);
+        }
+    }
+    else if (_options.jsonFilename == "-")
+    {
+        writeJson(std::cout, _options, baseline, current, diff, blocks, paths, regressions);
+    }
+    else
+    {
+        std::ofstream output(_options.jsonFilename);
+        if (!output.is_open())
+        {
+            std::cerr << "Can not open " << _options.jsonFilename << " for writing" << std::endl;
+            return 1;
+        }
+
+        writeJson(output, _options, baseline, current, diff, blocks, paths, regressions);
+    }
+
+    return regressions != 0 ? 2 : 0;
+}
@@ -1,151 +1,426 @@
 #include <easy/profiler.h>
 #include <easy/reader.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
 #include <fstream>
-#include <list>
+#include <functional>
 #include <iostream>
 #include <map>
-#include <stack>
-#include <vector>
-#include <iterator>
-#include <algorithm> 
-#include <ctime>
-#include <chrono>
-#include <iostream>
-#include <string>
+#include <regex>
 #include <sstream>
+#include <string>
+#include <vector>
+#include "analyzer.h"
+#include "capture.h"
+#include "diff_report.h"
+#include "report_format.h"
 
-class TreePrinter
+enum class SortOrder : uint8_t { Total = 0, Self };
+
+static void printUsage(const char* _program)
 {
-    struct Info{
-        std::string name;
-        std::string info;
-    };
-    std::vector<Info> m_rows;
+    std::cout << "Usage: " << _program << " [-n TOP] [-s total|self] [-t THREAD] [-r NAME_REGEX] [-b BEGIN_MS] [-e END_MS]"
+                                          " [-f FRAME_THREAD] [-j JSON_FILE] [-o DUMP_PROF_FILE] INPUT_PROF_FILE\n"
+                                          "   or: " << _program << " -d BASELINE_PROF_FILE [-p PERCENT] [-a US] [-n TOP] [-t THREAD]"
+                                          " [-r NAME_REGEX] [-j JSON_FILE] INPUT_PROF_FILE\n"
+                                          "where:\n"
+                                          "INPUT_PROF_FILE // Required\n"
+                                          "TOP number of printed blocks (20 by default, 0 - all blocks) // Optional\n"
+                                          "total|self sort blocks by total or by self time (total by default) // Optional\n"
+                                          "THREAD thread id or regular expression matched against thread name // Optional\n"
+                                          "NAME_REGEX regular expression matched against block name // Optional\n"
+                                          "BEGIN_MS, END_MS time window in milliseconds since capture begin // Optional\n"
+                                          "FRAME_THREAD thread id or name regex of frames thread (\"Main\" by default) // Optional\n"
+                                          "JSON_FILE write results as JSON instead of text, \"-\" for stdout // Optional\n"
+                                          "DUMP_PROF_FILE profile reader itself and dump result into this file // Optional\n"
+                                          "BASELINE_PROF_FILE compare INPUT_PROF_FILE with this file per block and per call path,\n"
+                                          "    exit code is 2 if any block has become significantly slower // Optional\n"
+                                          "PERCENT minimum significant change in percents of baseline value (5 by default) // Optional\n"
+                                          "US minimum significant change in microseconds (1 by default) // Optional\n";
+}
+
+//////////////////////////////////////////////////////////////////////////
 
-public:
-    TreePrinter(){
+static void writeJsonStats(std::ostream& _output, const DurationStats& _stats)
+{
+    _output << "\"count\": " << _stats.count << ", \"total\": " << _stats.total << ", \"min\": " << _stats.min
+            << ", \"max\": " << _stats.max << ", \"avg\": " << _stats.average() << ", \"p50\": " << _stats.p50
+            << ", \"p90\": " << _stats.p90 << ", \"p99\": " << _stats.p99;
+}
 
+// All times are in nanoseconds
+static void writeJson(std::ostream& _output, const AnalysisResult& _result, const std::vector<const DescriptorSummary*>& _top,
+                      uint64_t _blocksNumber, SortOrder _order)
+{
+    _output << "{\n  \"blocks\": " << _blocksNumber << ",\n  \"sort\": \""
+            << (_order == SortOrder::Self ? "self" : "total") << "\",\n  \"threads\": [";
+
+    const char* separator = "\n";
+    for (const auto& thread : _result.threads)
+    {
+        _output << separator << "    {\"id\": " << thread.id << ", \"name\": ";
+        writeJsonString(_output, thread.name);
+        _output << ", \"blocks\": " << thread.blocks << ", \"begin\": " << thread.begin << ", \"end\": " << thread.end
+                << ", \"block_time\": " << thread.blockTime << ", \"busy_time\": " << thread.busyTime()
+                << ", \"wait_time\": " << thread.waitTime << ", \"context_switches\": " << thread.contextSwitches << "}";
+        separator = ",\n";
     }
-    void addNewRow(int level)
+
+    _output << "\n  ],\n  \"top\": [";
+
+    separator = "\n";
+    for (auto descriptor : _top)
     {
+        _output << separator << "    {\"id\": " << descriptor->id << ", \"name\": ";
+        writeJsonString(_output, descriptor->name);
+        _output << ", \"self\": " << descriptor->selfTime << ", ";
+        writeJsonStats(_output, descriptor->durations);
+        _output << "}";
+        separator = ",\n";
+    }
+
+    _output << "\n  ],\n  \"frames\": {\"thread\": ";
+    writeJsonString(_output, _result.frames.thread);
+    _output << ", ";
+    writeJsonStats(_output, _result.frames.durations);
+    _output << ", \"bin_width\": " << _result.frames.binWidth << ", \"histogram\": [";
 
+    separator = "";
+    for (auto count : _result.frames.histogram)
+    {
+        _output << separator << count;
+        separator = ", ";
     }
 
-    void printTree()
+    _output << "]}\n}\n";
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+static void printText(const AnalysisResult& _result, const std::vector<const DescriptorSummary*>& _top, SortOrder _order)
+{
+    std::cout << "Threads (times in us):" << std::endl;
+    for (const auto& thread : _result.threads)
     {
-        for (auto& row : m_rows){
-            std::cout << row.name << " " << row.info << std::endl;
-        }
+        std::cout << "  " << thread.id << " \"" << thread.name << "\": " << thread.blocks << " blocks, span "
+                  << us(thread.span()) << ", busy " << us(thread.busyTime()) << ", wait " << us(thread.waitTime)
+                  << " in " << thread.contextSwitches << " switches" << std::endl;
     }
-};
 
+    std::cout << "Top " << _top.size() << " blocks by " << (_order == SortOrder::Self ? "self" : "total")
+              << " time (times in us):" << std::endl;
 
-void printTree(TreePrinter& printer, const profiler::BlocksTree& tree, int level = 0, profiler::timestamp_t parent_dur = 0, profiler::timestamp_t root_dur = 0)
+    size_t width = 4;
+    for (auto descriptor : _top)
+        width = std::max(width, descriptor->name.size());
+
+    char buffer[256];
+    snprintf(buffer, sizeof(buffer), "  %-*s %10s %14s %14s %12s %12s %12s %12s", static_cast<int>(width), "Name",
+             "Calls", "Total", "Self", "Average", "P50", "P99", "Max");
+    std::cout << buffer << std::endl;
+
+    for (auto descriptor : _top)
+    {
+        const auto& stats = descriptor->durations;
+        std::cout << "  " << descriptor->name << std::string(width - descriptor->name.size(), ' ');
+        snprintf(buffer, sizeof(buffer), " %10llu %14s %14s %12s %12s %12s %12s", static_cast<unsigned long long>(stats.count),
+                 us(stats.total).c_str(), us(descriptor->selfTime).c_str(), us(stats.average()).c_str(),
+                 us(stats.p50).c_str(), us(stats.p99).c_str(), us(stats.max).c_str());
+        std::cout << buffer << std::endl;
+    }
+
+    const auto& frames = _result.frames;
+    if (frames.durations.count == 0)
+        return;
+
+    const auto& stats = frames.durations;
+    std::cout << "Frames of thread \"" << frames.thread << "\": " << stats.count << " frames, average " << us(stats.average())
+              << " us, p50 " << us(stats.p50) << " us, p90 " << us(stats.p90) << " us, p99 " << us(stats.p99)
+              << " us, max " << us(stats.max) << " us" << std::endl;
+
+    for (size_t i = 0; i < frames.histogram.size(); ++i)
+    {
+        const auto begin = stats.min + frames.binWidth * i;
+        std::cout << "  [" << us(begin) << ", " << us(begin + frames.binWidth) << ") us: " << frames.histogram[i] << std::endl;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+static void printDetails(const profiler::blocks_t& blocks, const profiler::thread_blocks_tree_t& threaded_trees,
+                         const profiler::descriptors_list_t& descriptors, profiler::timestamp_t block_overhead)
 {
-    //
-    //if (tree.node){
-    //    auto duration = tree.node->block()->duration();
-    //    float duration_ms = duration / 1e6f;
-    //    float percent = parent_dur ? float(duration) / float(parent_dur)*100.0f : 100.0f;
-    //    float rpercent = root_dur ? float(duration) / float(root_dur)*100.0f : 100.0f;
-    //    std::cout << std::string(level, '\t') << tree.node->getName() 
-    //        << std::string(5 - level, '\t') 
-    //        /*<< std::string(level, ' ')*/ << percent << "%| " 
-    //        << rpercent << "%| "
-    //        << duration_ms << " ms"
-    //        << std::endl;
-    //    if (root_dur == 0){
-    //        root_dur = tree.node->block()->duration();
-    //    }
-    //}
-    //else{
-    //    root_dur = 0;
-    //}
-    //
-
-    //for (const auto& i : tree.children){
-
-    //    printTree(printer, i, level + 1, tree.node ? tree.node->block()->duration() : 0, root_dur);
-    //}
+    {
+        profiler::async_links_t async_spans, flows;
+        fillAsyncLinks(threaded_trees, descriptors, [&blocks](profiler::block_index_t i) -> const profiler::BlocksTree& {
+            return blocks[i];
+        }, async_spans, flows);
+
+        if (!async_spans.empty() || !flows.empty())
+        {
+            std::cout << "Async spans: " << async_spans.size() << std::endl;
+            std::cout << "Flows: " << flows.size() << std::endl;
+        }
+
+        profiler::lock_stats_t lock_stats;
+        fillLockStats(threaded_trees, descriptors, [&blocks](profiler::block_index_t i) -> const profiler::BlocksTree& {
+            return blocks[i];
+        }, lock_stats);
+
+        if (!lock_stats.empty())
+        {
+            std::cout << "Lock contention (by total wait time):" << std::endl;
+            for (const auto& lock : lock_stats)
+            {
+                std::cout << "  " << lock.name << ": wait " << lock.total_wait_time / 1000 << " us in "
+                          << lock.waits_number << " waits (max " << lock.max_wait_time / 1000 << " us), hold "
+                          << lock.total_hold_time / 1000 << " us in " << lock.holds_number << " holds" << std::endl;
+
+                for (const auto& thread : lock.threads)
+                {
+                    if (thread.waits_number == 0)
+                        break;
+                    std::cout << "    thread " << thread.thread_id << ": wait " << thread.wait_time / 1000
+                              << " us in " << thread.waits_number << " waits" << std::endl;
+                }
+            }
+        }
+    }
+
+    if (block_overhead != 0)
+    {
+        // Estimate intrinsic profiler overhead of nested blocks
+        std::cout << "Block overhead: " << block_overhead << " ns" << std::endl;
+        for (const auto& thread : threaded_trees)
+        {
+            const auto& root = thread.second;
+            uint64_t nested = 0;
+            for (auto i : root.children)
+                nested += blocks[i].descendants;
+
+            if (nested == 0 || root.profiled_time == 0)
+                continue;
+
+            const auto overhead = nested * block_overhead;
+            std::cout << "  thread " << root.thread_id << ": " << nested << " nested blocks, ~" << overhead / 1000
+                      << " us overhead (" << 100. * static_cast<double>(overhead) / static_cast<double>(root.profiled_time)
+                      << "% of profiled time)" << std::endl;
+        }
+    }
+
+    {
+        // Extrapolate calls number and total duration of sampled blocks
+        struct Sampled { uint64_t stored = 0; profiler::timestamp_t duration = 0; };
+        std::map<profiler::block_id_t, Sampled> sampled;
+
+        std::function<void(const profiler::BlocksTree::children_t&)> collect = [&](const profiler::BlocksTree::children_t& children)
+        {
+            for (auto i : children)
+            {
+                const auto& tree = blocks[i];
+                const auto& desc = *descriptors[tree.node->id()];
+                if (desc.type() == profiler::BlockType::Block && desc.samplingPolicy() != profiler::SamplingPolicy::None)
+                {
+                    auto& s = sampled[desc.id()];
+                    ++s.stored;
+                    s.duration += tree.node->duration();
+                }
+
+                collect(tree.children);
+            }
+        };
+
+        for (const auto& thread : threaded_trees)
+            collect(thread.second.children);
+
+        if (!sampled.empty())
+        {
+            std::cout << "Sampled blocks (extrapolated):" << std::endl;
+            for (const auto& it : sampled)
+            {
+                const auto& desc = *descriptors[it.first];
+                const double weight = desc.samplingWeight();
+                std::cout << "  " << desc.name() << ": " << it.second.stored << " stored, ~"
+                          << static_cast<uint64_t>(it.second.stored * weight + 0.5) << " calls, ~"
+                          << static_cast<uint64_t>(it.second.duration * weight + 0.5) / 1000 << " us total (weight "
+                          << weight << ")" << std::endl;
+            }
+        }
+    }
 }
 
+//////////////////////////////////////////////////////////////////////////
+
 int main(int argc, char* argv[])
 {
+    std::string filename, baseline_filename, dump_filename, json_filename;
+    AnalyzerOptions options;
+    profiler::DiffOptions diff_options;
+    SortOrder order = SortOrder::Total;
+    size_t top = 20;
+    double begin_ms = -1, end_ms = -1;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg.size() != 2 || arg[0] != '-')
+        {
+            if (!filename.empty())
+            {
+                printUsage(argv[0]);
+                return 1;
+            }
+
+            filename = arg;
+            continue;
+        }
+
+        if (i + 1 >= argc)
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+
+        const std::string value = argv[++i];
+        switch (arg[1])
+        {
+            case 'n': top = static_cast<size_t>(std::strtoull(value.c_str(), nullptr, 10)); break;
+            case 't': options.threadFilter = value; break;
+            case 'r': options.nameFilter = value; break;
+            case 'b': begin_ms = std::atof(value.c_str()); break;
+            case 'e': end_ms = std::atof(value.c_str()); break;
+            case 'f': options.frameThread = value; break;
+            case 'j': json_filename = value; break;
+            case 'o': dump_filename = value; break;
+            case 'd': baseline_filename = value; break;
+            case 'p': diff_options.relative_threshold = std::atof(value.c_str()) * 0.01; break;
+            case 'a': diff_options.absolute_threshold = static_cast<profiler::timestamp_t>(std::atof(value.c_str()) * 1e3); break;
 
-    profiler::thread_blocks_tree_t threaded_trees;
+            case 's':
+            {
+                if (value == "total" || value == "self")
+                {
+                    order = value == "self" ? SortOrder::Self : SortOrder::Total;
+                    break;
+                }
 
-    ::std::string filename;// = "test.prof";
-    if (argc > 1 && argv[1])
+                printUsage(argv[0]);
+                return 1;
+            }
+
+            default:
+            {
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+    }
+
+    if (filename.empty())
     {
-        filename = argv[1];
+        printUsage(argv[0]);
+        return 1;
     }
-    else
+
+    if (!baseline_filename.empty())
     {
-        std::cout << "Specify prof file: ";
-        std::getline(std::cin, filename);
-        //return 255;
+        DiffReportOptions report;
+        report.baselineFilename = baseline_filename;
+        report.currentFilename = filename;
+        report.jsonFilename = json_filename;
+        report.threadFilter = options.threadFilter;
+        report.nameFilter = options.nameFilter;
+        report.top = top;
+        report.diff = diff_options;
+        return runDiff(report);
     }
 
-    ::std::string dump_filename;
-    if (argc > 2 && argv[2])
+    if (!dump_filename.empty())
     {
-        dump_filename = argv[2];
+        EASY_PROFILER_ENABLE;
     }
-    else
+
+    const bool text = json_filename.empty();
+    const auto start = std::chrono::steady_clock::now();
+
+    // Statistics of the GUI are not needed: analyzer gathers its own in parallel
+    Capture capture;
+    std::stringstream errorMessage;
+    if (!capture.load(filename, errorMessage))
     {
-        std::cout << "Specify output prof file: ";
-        std::getline(std::cin, dump_filename);
+        std::cerr << "Can not read blocks from file " << filename << "\nReason: " << errorMessage.str() << std::endl;
+        return 1;
     }
 
-    if (dump_filename.size() > 2)
+    const auto loaded = std::chrono::steady_clock::now();
+
+    if (begin_ms >= 0)
+        options.beginTime = capture.beginEndTime.beginTime + static_cast<profiler::timestamp_t>(begin_ms * 1e6);
+    if (end_ms >= 0)
+        options.endTime = capture.beginEndTime.beginTime + static_cast<profiler::timestamp_t>(end_ms * 1e6);
+
+    AnalysisResult result;
+    try
     {
-        EASY_PROFILER_ENABLE;
-        std::cout << "Will dump reader prof file to " << dump_filename << std::endl;
+        result = analyze(capture.blocks, capture.trees, capture.descriptors, options);
     }
-    else
+    catch (const std::regex_error& error)
     {
-        dump_filename.clear();
+        std::cerr << "Invalid regular expression: " << error.what() << std::endl;
+        return 1;
     }
 
+    const auto analyzed = std::chrono::steady_clock::now();
 
-    auto start = std::chrono::system_clock::now();
+    std::vector<const DescriptorSummary*> sorted;
+    sorted.reserve(result.descriptors.size());
+    for (const auto& descriptor : result.descriptors)
+        sorted.push_back(&descriptor);
 
-    profiler::SerializedData serialized_blocks, serialized_descriptors;
-    profiler::descriptors_list_t descriptors;
-    profiler::blocks_t blocks;
-    profiler::bookmarks_t bookmarks;
-    profiler::BeginEndTime beginEndTime;
-    std::stringstream errorMessage;
-    uint32_t descriptorsNumberInFile = 0;
-    uint32_t version = 0;
-    profiler::processid_t pid = 0;
-
-    auto blocks_counter = fillTreesFromFile(filename.c_str(), beginEndTime, serialized_blocks, serialized_descriptors,
-                                            descriptors, blocks, threaded_trees, bookmarks, descriptorsNumberInFile,
-                                            version, pid, true, errorMessage);
-    if (blocks_counter == 0)
-        std::cout << "Can not read blocks from file " << filename.c_str() << "\nReason: " << errorMessage.str();
-
-    auto end = std::chrono::system_clock::now();
-
-    std::cout << "Blocks count: " << blocks_counter << std::endl;
-    std::cout << "dT =  " << std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() << " usec" << std::endl;
-    //for (const auto & i : threaded_trees){
-    //    TreePrinter p;
-    //    std::cout << std::string(20, '=') << " thread "<< i.first << " "<< std::string(20, '=') << std::endl;
-    //    printTree(p, i.second.tree,-1);
-    //}
+    if (order == SortOrder::Self)
+    {
+        std::stable_sort(sorted.begin(), sorted.end(), [](const DescriptorSummary* a, const DescriptorSummary* b) {
+            return a->selfTime > b->selfTime;
+        });
+    }
 
-    if (!dump_filename.empty())
+    if (top != 0 && sorted.size() > top)
+        sorted.resize(top);
+
+    if (text)
     {
-        auto bcount = profiler::dumpBlocksToFile(dump_filename.c_str());
+        using namespace std::chrono;
+        std::cout << "Blocks count: " << capture.blocksNumber << std::endl;
+        std::cout << "Load time: " << duration_cast<milliseconds>(loaded - start).count() << " ms, analysis time: "
+                  << duration_cast<milliseconds>(analyzed - loaded).count() << " ms" << std::endl;
 
-        std::cout << "Blocks count for reader: " << bcount << std::endl;
+        printText(result, sorted, order);
+        printDetails(capture.blocks, capture.trees, capture.descriptors, capture.blockOverhead);
     }
+    else if (json_filename == "-")
+    {
+        writeJson(std::cout, result, sorted, capture.blocksNumber, order);
+    }
+    else
+    {
+        std::ofstream output(json_filename);
+        if (!output.is_open())
+        {
+            std::cerr << "Can not open " << json_filename << " for writing" << std::endl;
+            return 1;
+        }
 
-    //char c;
-    //::std::cin >> c;
+        writeJson(output, result, sorted, capture.blocksNumber, order);
+    }
 
+    if (!dump_filename.empty())
+    {
+        const auto bcount = profiler::dumpBlocksToFile(dump_filename.c_str());
+        if (text)
+            std::cout << "Blocks count for reader: " << bcount << std::endl;
+    }
 
     return 0;
 }
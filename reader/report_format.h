@@ -0,0 +1,90 @@
+/**
+Lightweight profiler library for c++
+Copyright(C) 2016-2019  Sergey Yagovtsev, Victor Zarubkin
+
+Licensed under either of
+	* MIT license (LICENSE.MIT or http://opensource.org/licenses/MIT)
+    * Apache License, Version 2.0, (LICENSE.APACHE or http://www.apache.org/licenses/LICENSE-2.0)
+at your option.
+
+The MIT License
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+	of the Software, and to permit persons to whom the Software is furnished
+	to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+	PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+	LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+	USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+The Apache License, Version 2.0 (the "License");
+	You may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+**/
+
+#ifndef EASY_PROFILER_READER_REPORT_FORMAT_H
+#define EASY_PROFILER_READER_REPORT_FORMAT_H
+
+#include <stdint.h>
+#include <cstdio>
+#include <ostream>
+#include <string>
+
+/** Formats nanoseconds as microseconds with 3 decimals. */
+inline std::string us(uint64_t _ns)
+{
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.3f", static_cast<double>(_ns) * 1e-3);
+    return buffer;
+}
+
+inline void writeJsonString(std::ostream& _output, const std::string& _value)
+{
+    _output << '"';
+    for (auto c : _value)
+    {
+        switch (c)
+        {
+            case '"': _output << "\\\""; break;
+            case '\\': _output << "\\\\"; break;
+            case '\n': _output << "\\n"; break;
+            case '\r': _output << "\\r"; break;
+            case '\t': _output << "\\t"; break;
+            default:
+            {
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    char buffer[8];
+                    snprintf(buffer, sizeof(buffer), "\\u%04x", static_cast<unsigned>(c));
+                    _output << buffer;
+                }
+                else
+                {
+                    _output << c;
+                }
+                break;
+            }
+        }
+    }
+    _output << '"';
+}
+
+#endif // EASY_PROFILER_READER_REPORT_FORMAT_H
@@ -0,0 +1,99 @@
+// Benchmark of compile-time block levels: compares a hot loop without instrumentation against the same loop
+// with blocks eliminated by EASY_PROFILER_MIN_LEVEL, with compiled blocks while profiler is disabled and
+// with compiled blocks while capturing.
+//
+// Usage: profiler_levels_benchmark [iterations]
+
+// Blocks of level profiler::levels::Fine are eliminated in this source file only
+#undef EASY_PROFILER_MIN_LEVEL
+#define EASY_PROFILER_MIN_LEVEL 1
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <type_traits>
+
+#include <easy/profiler.h>
+
+#ifdef USING_EASY_PROFILER
+static_assert(std::is_empty<profiler::LevelGate<false>::block_t>::value,
+              "Eliminated block must not occupy any storage");
+static_assert(!EASY_LEVEL_ENABLED(profiler::colors::Red, profiler::levels::Fine),
+              "Block of level Fine must be eliminated when EASY_PROFILER_MIN_LEVEL is 1");
+static_assert(EASY_LEVEL_ENABLED(profiler::colors::Red),
+              "Block without explicit level must be compiled when EASY_PROFILER_MIN_LEVEL is 1");
+#endif
+
+int ITERATIONS = 10000000;
+
+volatile uint64_t g_sink = 0;
+
+uint64_t plainLoop(int _iterations)
+{
+    uint64_t acc = 0;
+    for (int i = 0; i < _iterations; ++i)
+        acc = acc * 31 + static_cast<uint64_t>(i);
+    return acc;
+}
+
+uint64_t eliminatedLoop(int _iterations)
+{
+    uint64_t acc = 0;
+    for (int i = 0; i < _iterations; ++i)
+    {
+        EASY_BLOCK("Eliminated", profiler::colors::Red, profiler::levels::Fine);
+        acc = acc * 31 + static_cast<uint64_t>(i);
+    }
+    return acc;
+}
+
+uint64_t compiledLoop(int _iterations)
+{
+    uint64_t acc = 0;
+    for (int i = 0; i < _iterations; ++i)
+    {
+        EASY_BLOCK("Compiled", profiler::colors::Green);
+        acc = acc * 31 + static_cast<uint64_t>(i);
+    }
+    return acc;
+}
+
+template <class TFunc>
+void measure(const char* _name, TFunc _func)
+{
+    const auto start = std::chrono::steady_clock::now();
+    {
+        // Parent block: blocks inside the loop are not frames, so frame time accounting is not measured
+        EASY_BLOCK("Measure", profiler::colors::Blue, profiler::levels::Critical);
+        g_sink = _func(ITERATIONS);
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    std::cout << std::setw(36) << std::left << _name
+              << std::setw(10) << std::right << std::fixed << std::setprecision(3)
+              << static_cast<double>(ns) / ITERATIONS << " ns/iteration" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc > 1 && argv[1])
+        ITERATIONS = std::atoi(argv[1]);
+
+    std::cout << "Iterations: " << ITERATIONS << std::endl;
+
+    EASY_MAIN_THREAD; // Warm-up: thread registration and profiler initialization are not measured
+    measure("Warm-up", plainLoop);
+
+    measure("No blocks", plainLoop);
+    measure("Eliminated blocks (levels::Fine)", eliminatedLoop);
+    measure("Compiled blocks, profiler disabled", compiledLoop);
+
+    EASY_PROFILER_ENABLE;
+    measure("Eliminated blocks, capturing", eliminatedLoop);
+    measure("Compiled blocks, capturing", compiledLoop);
+    EASY_PROFILER_DISABLE;
+
+    return 0;
+}
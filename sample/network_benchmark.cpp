@@ -0,0 +1,246 @@
+// Loopback benchmark of capture transfer: measures transfer time, throughput and compression ratio
+// of Reply_Blocks payload for each supported wire compression mode.
+//
+// Usage: profiler_network_benchmark [capture_ms] [port]
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <easy/profiler.h>
+#include <easy/arbitrary_value.h>
+#include <easy/easy_compression.h>
+#include <easy/easy_net.h>
+#include <easy/easy_socket.h>
+
+int CAPTURE_MS = 2000;
+uint16_t PORT = 28078;
+
+std::atomic_bool g_stop;
+
+void workerThread(int _index)
+{
+    EASY_THREAD("Worker");
+
+    uint64_t counter = static_cast<uint64_t>(_index);
+    while (!g_stop.load(std::memory_order_acquire))
+    {
+        EASY_BLOCK("Frame", profiler::colors::Magenta);
+        for (int i = 0; i < 32; ++i)
+        {
+            EASY_BLOCK("Update", profiler::colors::Blue);
+            for (int j = 0; j < 8; ++j)
+            {
+                EASY_BLOCK("Calculate", profiler::colors::Green);
+                for (volatile int k = 0; k < 200; ++k);
+                counter = counter * 6364136223846793005ULL + 1442695040888963407ULL;
+            }
+            EASY_VALUE("counter", counter);
+        }
+        EASY_END_BLOCK;
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+}
+
+bool receiveExactly(EasySocket& _socket, char* _buffer, size_t _size)
+{
+    while (_size != 0)
+    {
+        const int bytes = _socket.receive(_buffer, _size);
+        if (bytes <= 0)
+        {
+            if (bytes < 0 && !_socket.isDisconnected())
+                continue; // timeout
+            return false;
+        }
+
+        _buffer += bytes;
+        _size -= static_cast<size_t>(bytes);
+    }
+
+    return true;
+}
+
+bool receiveMessage(EasySocket& _socket, profiler::net::MessageType& _type, std::string& _payload)
+{
+    profiler::net::Message message;
+    if (!receiveExactly(_socket, reinterpret_cast<char*>(&message), sizeof(message)) || !message.isEasyNetMessage())
+        return false;
+
+    _type = message.type;
+    _payload.clear();
+
+    size_t size = 0;
+    switch (_type)
+    {
+        case profiler::net::MessageType::Connection_Accepted:
+            size = sizeof(profiler::net::EasyProfilerStatus) - sizeof(message);
+            break;
+
+        case profiler::net::MessageType::Reply_Blocks:
+        case profiler::net::MessageType::Reply_Blocks_Compressed:
+        {
+            uint32_t dataSize = 0;
+            if (!receiveExactly(_socket, reinterpret_cast<char*>(&dataSize), sizeof(dataSize)))
+                return false;
+            size = dataSize;
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    _payload.resize(size);
+    return size == 0 || receiveExactly(_socket, &_payload[0], size);
+}
+
+bool capture(uint8_t _compression)
+{
+    EasySocket socket;
+    if (!socket.setAddress("127.0.0.1", PORT) || socket.connect() != 0)
+    {
+        std::cout << "Can not connect to 127.0.0.1:" << PORT << std::endl;
+        return false;
+    }
+
+    profiler::net::MessageType type;
+    std::string payload;
+    if (!receiveMessage(socket, type, payload) || type != profiler::net::MessageType::Connection_Accepted)
+        return false;
+
+    const auto status = reinterpret_cast<const profiler::net::EasyProfilerStatus*>(payload.data() - sizeof(profiler::net::Message));
+    (void)status;
+
+    const profiler::net::CompressionMessage compression(_compression);
+    socket.send(&compression, sizeof(compression));
+
+    const profiler::net::Message startCapture(profiler::net::MessageType::Request_Start_Capture);
+    socket.send(&startCapture, sizeof(startCapture));
+    if (!receiveMessage(socket, type, payload) || type != profiler::net::MessageType::Reply_Capturing_Started)
+        return false;
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(CAPTURE_MS));
+
+    const auto start = std::chrono::steady_clock::now();
+
+    const profiler::net::Message stopCapture(profiler::net::MessageType::Request_Stop_Capture);
+    socket.send(&stopCapture, sizeof(stopCapture));
+
+    std::string data;
+    size_t wireSize = 0;
+    bool packed = false;
+    while (receiveMessage(socket, type, payload))
+    {
+        if (type == profiler::net::MessageType::Reply_Blocks_End)
+            break;
+
+        if (type == profiler::net::MessageType::Reply_Blocks || type == profiler::net::MessageType::Reply_Blocks_Compressed)
+        {
+            packed = type == profiler::net::MessageType::Reply_Blocks_Compressed;
+            wireSize = payload.size();
+            data.swap(payload);
+        }
+    }
+
+    const auto received = std::chrono::steady_clock::now();
+
+    if (packed)
+    {
+        profiler::net::CompressedDataHeader header;
+        if (data.size() < sizeof(header))
+            return false;
+        memcpy(&header, data.data(), sizeof(header));
+
+        std::string unpacked;
+        unpacked.reserve(header.rawSize);
+
+        size_t consumed = 0;
+        if (!profiler::net::unpackChunks(data.data() + sizeof(header), data.size() - sizeof(header), consumed, unpacked)
+            || unpacked.size() != header.rawSize)
+        {
+            std::cout << "Can not unpack received data" << std::endl;
+            return false;
+        }
+
+        if ((header.flags & profiler::net::COMPRESSION_TIMESTAMP_DELTA) != 0 &&
+            !profiler::net::decodeTimestampDeltas(&unpacked[0], unpacked.size()))
+        {
+            std::cout << "Can not decode timestamps" << std::endl;
+            return false;
+        }
+
+        data.swap(unpacked);
+    }
+
+    const auto finish = std::chrono::steady_clock::now();
+
+    const auto transferMs = std::chrono::duration_cast<std::chrono::microseconds>(received - start).count() / 1000.;
+    const auto unpackMs = std::chrono::duration_cast<std::chrono::microseconds>(finish - received).count() / 1000.;
+    const auto totalMs = transferMs + unpackMs;
+
+    const char* name = "raw";
+    if (_compression == profiler::net::COMPRESSION_LZ4)
+        name = "lz4";
+    else if (_compression == (profiler::net::COMPRESSION_LZ4 | profiler::net::COMPRESSION_TIMESTAMP_DELTA))
+        name = "lz4+delta";
+
+    std::cout << std::fixed << std::setprecision(2)
+              << std::setw(10) << name
+              << " | raw " << std::setw(8) << data.size() / 1048576. << " MiB"
+              << " | wire " << std::setw(8) << wireSize / 1048576. << " MiB"
+              << " | ratio " << std::setw(6) << (wireSize != 0 ? double(data.size()) / double(wireSize) : 0.)
+              << " | dump+transfer " << std::setw(8) << transferMs << " ms"
+              << " | unpack " << std::setw(7) << unpackMs << " ms"
+              << " | throughput " << std::setw(8) << (totalMs > 0 ? data.size() / 1048576. * 1000. / totalMs : 0.) << " MiB/s"
+              << std::endl;
+
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc > 1 && argv[1])
+        CAPTURE_MS = std::atoi(argv[1]);
+    if (argc > 2 && argv[2])
+        PORT = static_cast<uint16_t>(std::atoi(argv[2]));
+
+    std::cout << "Capture duration: " << CAPTURE_MS << " ms" << std::endl;
+
+    g_stop = false;
+    profiler::startListen(PORT);
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i)
+        threads.emplace_back(workerThread, i);
+
+    const uint8_t modes[] = {
+        profiler::net::COMPRESSION_NONE,
+        profiler::net::COMPRESSION_LZ4,
+        profiler::net::COMPRESSION_LZ4 | profiler::net::COMPRESSION_TIMESTAMP_DELTA
+    };
+
+    int result = 0;
+    for (auto mode : modes)
+    {
+        if (!capture(mode))
+        {
+            result = 1;
+            break;
+        }
+    }
+
+    g_stop.store(true, std::memory_order_release);
+    for (auto& thread : threads)
+        thread.join();
+
+    profiler::stopListen();
+
+    return result;
+}
@@ -0,0 +1,45 @@
+#!/bin/bash
+
+# Runs several profiler_sample processes, captures them simultaneously with profiler_collector
+# and checks that merged file could be read.
+# Usage (from build directory): collector_test.sh [PROCESSES_COUNT] [DURATION_MS]
+
+unamestr=`uname`
+SUBDIR="./bin"
+if [[ ! "$unamestr" == 'Linux' ]]; then
+    SUBDIR="./bin/Release/"
+fi
+
+SAMPLE=$SUBDIR/profiler_sample
+COLLECTOR=$SUBDIR/profiler_collector
+READER=$SUBDIR/profiler_reader
+
+PROCESSES_COUNT=${1:-3}
+DURATION_MS=${2:-1000}
+FIRST_PORT=28100
+RESULT_FILE="merged.prof"
+
+PIDS=()
+SOURCES=()
+for (( i=0; i<$PROCESSES_COUNT; i++ ))
+do
+    PORT=$(($FIRST_PORT+$i))
+    $SAMPLE 100 100000 100000 20 $PORT > /dev/null &
+    PIDS+=($!)
+    SOURCES+=("127.0.0.1:$PORT")
+done
+
+# Wait for listeners
+sleep 1
+
+$COLLECTOR -o $RESULT_FILE -d $DURATION_MS ${SOURCES[@]}
+RESULT=$?
+
+kill ${PIDS[@]} 2> /dev/null
+
+if [[ $RESULT -ne 0 ]]; then
+    echo "Collector failed"
+    exit 1
+fi
+
+$READER -n 5 $RESULT_FILE
@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+"""Compares two JSON reports of profiler_benchmarks and reports regressions.
+
+Reports are produced by:
+    profiler_benchmarks --benchmark_format=json --benchmark_out=<file.json> [--benchmark_repetitions=N]
+
+If repetitions were used then median aggregates are compared, otherwise plain runs.
+Exit code is 1 if any benchmark became slower than the threshold allows.
+
+Usage: compare_benchmarks.py baseline.json current.json [--threshold PERCENT] [--metric real_time|cpu_time]
+"""
+
+import argparse
+import json
+import sys
+
+
+def load_results(filename, metric):
+    with open(filename) as f:
+        report = json.load(f)
+
+    runs, medians = {}, {}
+    for benchmark in report.get("benchmarks", []):
+        if benchmark.get("error_occurred"):
+            continue
+
+        if benchmark.get("run_type") == "aggregate":
+            if benchmark.get("aggregate_name") == "median":
+                medians[benchmark["run_name"]] = benchmark
+        else:
+            runs.setdefault(benchmark.get("run_name", benchmark["name"]), benchmark)
+
+    results = {}
+    for name, benchmark in (medians or runs).items():
+        results[name] = (benchmark[metric], benchmark["time_unit"])
+
+    return results
+
+
+UNITS = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+
+def to_ns(value, unit):
+    return value * UNITS[unit]
+
+
+def format_time(ns):
+    for unit in ("s", "ms", "us"):
+        if ns >= UNITS[unit]:
+            return "%.3f %s" % (ns / UNITS[unit], unit)
+    return "%.3f ns" % ns
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare two profiler_benchmarks JSON reports.")
+    parser.add_argument("baseline", help="JSON report of the baseline build")
+    parser.add_argument("current", help="JSON report of the current build")
+    parser.add_argument("--threshold", type=float, default=5.0,
+                        help="allowed slow-down in percents (default: 5)")
+    parser.add_argument("--metric", choices=("real_time", "cpu_time"), default="real_time",
+                        help="compared time metric (default: real_time)")
+    args = parser.parse_args()
+
+    baseline = load_results(args.baseline, args.metric)
+    current = load_results(args.current, args.metric)
+
+    names = [name for name in current if name in baseline]
+    if not names:
+        print("No common benchmarks found")
+        return 1
+
+    width = max(len(name) for name in set(baseline) | set(current))
+    print("%-*s  %14s  %14s  %9s" % (width, "Benchmark", "Baseline", "Current", "Change"))
+
+    regressions = 0
+    for name in sorted(names):
+        old = to_ns(*baseline[name])
+        new = to_ns(*current[name])
+        change = (new - old) * 100.0 / old if old > 0 else 0.0
+
+        mark = ""
+        if change > args.threshold:
+            mark = "  REGRESSION"
+            regressions += 1
+        elif change < -args.threshold:
+            mark = "  improvement"
+
+        print("%-*s  %14s  %14s  %+8.2f%%%s" % (width, name, format_time(old), format_time(new), change, mark))
+
+    for name in sorted(set(baseline) - set(current)):
+        print("%-*s  missing in current report" % (width, name))
+    for name in sorted(set(current) - set(baseline)):
+        print("%-*s  new benchmark" % (width, name))
+
+    print("\n%d of %d benchmarks regressed by more than %.1f%%" % (regressions, len(names), args.threshold))
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())